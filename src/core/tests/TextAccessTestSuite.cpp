@@ -1,3 +1,6 @@
+#include <fstream>
+#include <iterator>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -127,4 +130,32 @@ TEST_F(TextAccessFix, textAccessFileLinesCount) {
                              "God's sake I hope you managed to rectify that a bit.\"\n"));
 
   EXPECT_EQ(mTextAccess->getFilePath(), filePath);
-}
\ No newline at end of file
+}
+
+TEST(TextAccess, fileContentLineBreaksAreNormalized) {
+  const auto textAccess = TextAccess::createFromFileContent("int a;\r\nint b;\rint c;\nint d;");
+
+  EXPECT_THAT(textAccess->getAllLines(), testing::ElementsAre("int a;\n", "int b;\n", "int c;\n", "int d;\n"));
+  EXPECT_EQ(TextAccess::getContentHash(textAccess->getText()), textAccess->getContentHash());
+}
+
+TEST_F(TextAccessFix, fileContentMatchesTheFileOnDisk) {
+  std::ifstream file(filePath.str(), std::ios::binary);
+  const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  EXPECT_EQ(mTextAccess->getText(), TextAccess::createFromFileContent(content)->getText());
+}
+
+TEST(TextAccess, contentHashIsStableXxHash64) {
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, TextAccess::createFromString("")->getContentHash());
+  EXPECT_EQ(0x44BC2CF5AD770999ULL, TextAccess::createFromString("abc")->getContentHash());
+  EXPECT_EQ(0xFBCEA83C8A378BF1ULL, TextAccess::createFromString("Nobody inspects the spammish repetition")->getContentHash());
+}
+
+TEST(TextAccess, contentHashDetectsChangedText) {
+  const auto text = getTestText();
+
+  EXPECT_EQ(TextAccess::createFromString(text)->getContentHash(), TextAccess::createFromString(text)->getContentHash());
+  EXPECT_NE(TextAccess::createFromString(text)->getContentHash(),
+            TextAccess::createFromString(text + "\"With a torch.\"\n")->getContentHash());
+}
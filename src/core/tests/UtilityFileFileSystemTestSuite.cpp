@@ -11,6 +11,7 @@
 #include "FileSystem.h"
 #include "ScopedTemporaryFile.hpp"
 #include "utility.h"
+#include "utilityFile.h"
 
 namespace fs = std::filesystem;
 
@@ -254,3 +255,32 @@ TEST(FileSystem, copyFile) {
   // Clean
   fs::remove(toPath.str());
 }
+
+TEST(UtilityFile, sortFilePathsByExpectedDurationPutsLongestFirst) {
+  const FilePath fast(L"/tmp/project/fast.cpp");
+  const FilePath slow(L"/tmp/project/slow.cpp");
+  const FilePath medium(L"/tmp/project/medium.cpp");
+
+  const std::vector<FilePath> result = utility::sortFilePathsByExpectedDuration({fast, slow, medium},
+                                                                                {{fast, 10}, {slow, 5000}, {medium, 300}});
+
+  EXPECT_EQ((std::vector<FilePath>{slow, medium, fast}), result);
+}
+
+TEST(UtilityFile, sortFilePathsByExpectedDurationEstimatesUnknownFilesFromSize) {
+  const FilePath known(L"/tmp/project/known.cpp");
+  const FilePath unknown = FilePath(LIB_TEST_ROOT_DIR).concatenate(FilePath{"FileSystemTestSuite.cpp"});
+  ASSERT_TRUE(unknown.exists());
+
+  // the missing file counts as one byte, so the existing one is expected to take far longer
+  const std::vector<FilePath> result = utility::sortFilePathsByExpectedDuration({known, unknown}, {{known, 100}});
+
+  EXPECT_EQ((std::vector<FilePath>{unknown, known}), result);
+}
+
+TEST(UtilityFile, sortFilePathsByExpectedDurationOrdersTiesByPath) {
+  const FilePath first(L"/tmp/project/a.cpp");
+  const FilePath second(L"/tmp/project/b.cpp");
+
+  EXPECT_EQ((std::vector<FilePath>{first, second}), utility::sortFilePathsByExpectedDuration({second, first}, {}));
+}
@@ -1,42 +1,89 @@
 #include "TextAccess.h"
 
 #include <fstream>
+#include <iterator>
+#include <string_view>
 
 #include "logging.h"
 
 namespace {
-std::istream& safeGetline(std::istream& istream, std::string& text) {
-  text.clear();
-
-  // The characters in the stream are read one-by-one using a std::streambuf.
-  // That is faster than reading them one-by-one using the std::istream.
-  // Code that uses streambuf this way must be guarded by a sentry object.
-  // The sentry object performs various tasks,
-  // such as thread synchronization and updating the stream state.
-
-  const std::istream::sentry sentry(istream, true);
-  std::streambuf* pStreambuf = istream.rdbuf();
-
-  while(true) {
-    const int character = pStreambuf->sbumpc();
-    switch(character) {
-    case '\n':
-      return istream;
-    case '\r':
-      if(pStreambuf->sgetc() == '\n') {
-        pStreambuf->sbumpc();
-      }
-      return istream;
-    case std::streambuf::traits_type::eof():
-      // Also handle the case when the last line has no line ending
-      if(text.empty()) {
-        istream.setstate(std::ios::eofbit);
-      }
-      return istream;
-    default:
-      text += static_cast<char>(character);
+constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t rotateLeft(uint64_t value, unsigned bits) {
+  return (value << bits) | (value >> (64U - bits));
+}
+
+// little endian independent of the host, so the stored hashes stay comparable
+uint64_t readLittleEndian(const char* data, size_t byteCount) {
+  uint64_t value = 0;
+  for(size_t i = 0; i < byteCount; i++) {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t hashRound(uint64_t accumulator, uint64_t input) {
+  accumulator += input * Prime2;
+  return rotateLeft(accumulator, 31) * Prime1;
+}
+
+uint64_t mergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= hashRound(0, value);
+  return accumulator * Prime1 + Prime4;
+}
+
+// XXH64 with seed 0
+uint64_t xxHash64(std::string_view text) {
+  const char* data = text.data();
+  const char* const end = data + text.size();
+
+  uint64_t hash = 0;
+  if(text.size() >= 32) {
+    uint64_t v1 = Prime1 + Prime2;
+    uint64_t v2 = Prime2;
+    uint64_t v3 = 0;
+    uint64_t v4 = 0 - Prime1;
+    for(; data + 32 <= end; data += 32) {
+      v1 = hashRound(v1, readLittleEndian(data, 8));
+      v2 = hashRound(v2, readLittleEndian(data + 8, 8));
+      v3 = hashRound(v3, readLittleEndian(data + 16, 8));
+      v4 = hashRound(v4, readLittleEndian(data + 24, 8));
     }
+    hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+    hash = mergeRound(hash, v1);
+    hash = mergeRound(hash, v2);
+    hash = mergeRound(hash, v3);
+    hash = mergeRound(hash, v4);
+  } else {
+    hash = Prime5;
   }
+
+  hash += static_cast<uint64_t>(text.size());
+
+  for(; data + 8 <= end; data += 8) {
+    hash ^= hashRound(0, readLittleEndian(data, 8));
+    hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+  }
+  if(data + 4 <= end) {
+    hash ^= readLittleEndian(data, 4) * Prime1;
+    hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+    data += 4;
+  }
+  for(; data < end; data++) {
+    hash ^= static_cast<uint64_t>(static_cast<unsigned char>(*data)) * Prime5;
+    hash = rotateLeft(hash, 11) * Prime1;
+  }
+
+  hash ^= hash >> 33U;
+  hash *= Prime2;
+  hash ^= hash >> 29U;
+  hash *= Prime3;
+  hash ^= hash >> 32U;
+  return hash;
 }
 }    // namespace
 
@@ -67,6 +114,15 @@ std::shared_ptr<TextAccess> TextAccess::createFromLines(const std::vector<std::s
   return result;
 }
 
+std::shared_ptr<TextAccess> TextAccess::createFromFileContent(std::string_view content, const FilePath& filePath) {
+  const std::shared_ptr<TextAccess> result{new TextAccess};
+
+  result->m_lines = splitFileContentByLines(content);
+  result->m_filePath = filePath;
+
+  return result;
+}
+
 TextAccess::~TextAccess() = default;
 
 uint32_t TextAccess::getLineCount() const {
@@ -113,6 +169,14 @@ std::string TextAccess::getText() const {
   return result;
 }
 
+uint64_t TextAccess::getContentHash() const {
+  return xxHash64(getText());
+}
+
+uint64_t TextAccess::getContentHash(std::string_view text) {
+  return xxHash64(text);
+}
+
 std::vector<std::string> TextAccess::readFile(const FilePath& filePath) {
   std::vector<std::string> result;
 
@@ -125,13 +189,10 @@ std::vector<std::string> TextAccess::readFile(const FilePath& filePath) {
       return result;
     }
 
-    while(!srcFile.eof()) {
-      std::string line;
-      safeGetline(srcFile, line);
-      result.push_back(line + '\n');
-    }
-
+    const std::string content{std::istreambuf_iterator<char>(srcFile), std::istreambuf_iterator<char>()};
     srcFile.close();
+
+    result = splitFileContentByLines(content);
   } catch(std::exception& exception) {
     LOG_ERROR(fmt::format("Exception thrown while reading file \"{}\": ", filePath.str(), exception.what()));
     result.clear();
@@ -140,14 +201,6 @@ std::vector<std::string> TextAccess::readFile(const FilePath& filePath) {
     result.clear();
   }
 
-  if(!result.empty()) {
-    const std::string last = result.back().substr(0, result.back().size() - 1);
-    result.pop_back();
-    if(!last.empty()) {
-      result.push_back(last);
-    }
-  }
-
   return result;
 }
 
@@ -170,6 +223,29 @@ std::vector<std::string> TextAccess::splitStringByLines(const std::string& text)
   return result;
 }
 
+std::vector<std::string> TextAccess::splitFileContentByLines(std::string_view content) {
+  std::vector<std::string> result;
+  size_t lineStart = 0;
+
+  for(size_t i = 0; i < content.size(); i++) {
+    if(content[i] == '\n' || content[i] == '\r') {
+      result.emplace_back(content.substr(lineStart, i - lineStart)).push_back('\n');
+
+      if(content[i] == '\r' && i + 1 < content.size() && content[i + 1] == '\n') {
+        i++;
+      }
+      lineStart = i + 1;
+    }
+  }
+
+  // the last line gets a line break as well, but no empty line is added after a trailing one
+  if(lineStart < content.size()) {
+    result.emplace_back(content.substr(lineStart)).push_back('\n');
+  }
+
+  return result;
+}
+
 TextAccess::TextAccess() = default;
 
 bool TextAccess::checkIndexInRange(const uint32_t index) const {
@@ -1,6 +1,8 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "FilePath.h"
@@ -11,6 +13,13 @@ public:
   static std::shared_ptr<TextAccess> createFromString(const std::string& text, const FilePath& filePath = FilePath());
   static std::shared_ptr<TextAccess> createFromLines(const std::vector<std::string>& lines, const FilePath& filePath = FilePath());
 
+  /**
+   * @brief Splits the raw bytes of a file into lines exactly like createFromFile does when reading it
+   *
+   * Every line ends with '\n', "\r\n" and single '\r' line breaks are converted.
+   */
+  static std::shared_ptr<TextAccess> createFromFileContent(std::string_view content, const FilePath& filePath = FilePath());
+
   TextAccess(const TextAccess&) = delete;
   TextAccess& operator=(const TextAccess&) = delete;
 
@@ -37,9 +46,20 @@ public:
 
   [[nodiscard]] std::string getText() const;
 
+  /**
+   * @brief Stable 64 bit hash (XXH64) of getText(), meant to detect content changes across sessions
+   */
+  [[nodiscard]] uint64_t getContentHash() const;
+
+  /**
+   * @brief The hash getContentHash() returns for a TextAccess whose getText() is text
+   */
+  [[nodiscard]] static uint64_t getContentHash(std::string_view text);
+
 private:
   static std::vector<std::string> readFile(const FilePath& filePath);
   static std::vector<std::string> splitStringByLines(const std::string& text);
+  static std::vector<std::string> splitFileContentByLines(std::string_view content);
 
   TextAccess();
 
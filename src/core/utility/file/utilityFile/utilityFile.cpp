@@ -39,6 +39,53 @@ std::vector<FilePath> utility::partitionFilePathsBySize(const std::vector<FilePa
   return sortedFilePaths;
 }
 
+std::vector<FilePath> utility::sortFilePathsByExpectedDuration(const std::vector<FilePath>& filePaths,
+                                                               const std::map<FilePath, uint64_t>& durationsMs) {
+  struct ExpectedDuration {
+    double durationMs;
+    bool known;
+    unsigned long long byteSize;
+    const FilePath* path;
+  };
+
+  std::vector<ExpectedDuration> expectedDurations;
+  expectedDurations.reserve(filePaths.size());
+
+  double knownDurationMs = 0;
+  double knownByteSize = 0;
+  for(const FilePath& path : filePaths) {
+    const unsigned long long byteSize = path.exists() ? FileSystem::getFileByteSize(path) : 1;
+    if(const auto iterator = durationsMs.find(path); iterator != durationsMs.end()) {
+      expectedDurations.push_back({static_cast<double>(iterator->second), true, byteSize, &path});
+      knownDurationMs += static_cast<double>(iterator->second);
+      knownByteSize += static_cast<double>(byteSize);
+    } else {
+      expectedDurations.push_back({0, false, byteSize, &path});
+    }
+  }
+
+  const double msPerByte = (knownDurationMs > 0 && knownByteSize > 0) ? knownDurationMs / knownByteSize : 1.0;
+  for(ExpectedDuration& expected : expectedDurations) {
+    if(!expected.known) {
+      expected.durationMs = static_cast<double>(expected.byteSize) * msPerByte;
+    }
+  }
+
+  std::ranges::sort(expectedDurations, [](const ExpectedDuration& item0, const ExpectedDuration& item1) {
+    if(item0.durationMs != item1.durationMs) {
+      return item0.durationMs > item1.durationMs;
+    }
+    return item0.path->wstr() < item1.path->wstr();
+  });
+
+  std::vector<FilePath> sortedFilePaths;
+  sortedFilePaths.reserve(expectedDurations.size());
+  for(const ExpectedDuration& expected : expectedDurations) {
+    sortedFilePaths.push_back(*expected.path);
+  }
+  return sortedFilePaths;
+}
+
 std::vector<FilePath> utility::getTopLevelPaths(const std::vector<FilePath>& paths) {
   return utility::getTopLevelPaths(utility::toSet(paths));
 }
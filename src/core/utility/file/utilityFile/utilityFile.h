@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -9,6 +11,15 @@ namespace utility {
 
 std::vector<FilePath> partitionFilePathsBySize(const std::vector<FilePath>& filePaths, int partitionCount = 0);
 
+/**
+ * @brief Orders file paths longest expected duration first, so the slowest files do not end up last on one worker.
+ *
+ * Files without a known duration get one estimated from their byte size, using the milliseconds per byte observed
+ * for the known ones. Without any known durations this falls back to ordering by size.
+ */
+std::vector<FilePath> sortFilePathsByExpectedDuration(const std::vector<FilePath>& filePaths,
+                                                      const std::map<FilePath, uint64_t>& durationsMs);
+
 std::vector<FilePath> getTopLevelPaths(const std::vector<FilePath>& paths);
 
 std::vector<FilePath> getTopLevelPaths(const std::set<FilePath>& paths);
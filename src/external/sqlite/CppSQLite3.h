@@ -295,6 +295,10 @@ public:
 
   void setBusyTimeout(int nMillisecs);
 
+  int getLimit(int nId) {
+    return sqlite3_limit(mpDB, nId, -1);
+  }
+
   static const char* SQLiteVersion() {
     return SQLITE_VERSION;
   }
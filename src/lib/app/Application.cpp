@@ -26,6 +26,7 @@
 #include "NetworkFactory.h"
 #include "ProjectSettings.h"
 #include "SharedMemory.h"
+#include "SqliteStorage.h"
 #include "StorageCache.h"
 #include "TabId.h"
 #include "TaskScheduler.h"
@@ -188,6 +189,9 @@ void Application::loadSettings() {
     }
   }
 
+  SqliteStorage::setQueryPlanAuditEnabled(settings->getLoggingEnabled() &&
+                                          settings->getLoggingLevel() <= static_cast<int>(spdlog::level::debug));
+
   loadStyle(settings->getColorSchemePath());
 }
 
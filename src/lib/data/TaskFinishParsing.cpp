@@ -22,14 +22,28 @@ void TaskFinishParsing::terminate() {
 }
 
 void TaskFinishParsing::doEnter(std::shared_ptr<Blackboard> /*blackboard*/) {
+  m_storage->addMissingFileContents();
   m_storage->setMode(SqliteIndexStorage::STORAGE_MODE_READ);
 }
 
 Task::TaskState TaskFinishParsing::doUpdate(std::shared_ptr<Blackboard> blackboard) {
   TimeStamp start = TimeStamp::now();
 
+  if(blackboard->exists("indexing_costs")) {
+    // lets the next refresh start with the translation units that take longest
+    std::vector<StorageIndexingCost> indexingCosts;
+    blackboard->get("indexing_costs", indexingCosts);
+    m_storage->setIndexingCosts(indexingCosts);
+  }
+
+  m_dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Building fulltext search index");
+  m_storage->addFullTextSearchTrigrams();
+
   m_dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Optimizing database");
   m_storage->optimizeMemory();
+  // the database file is renamed once indexing is done while this connection is still open, a write-ahead log would stay
+  // behind under the old name
+  m_storage->leaveWriteAheadLog();
   m_dialogView->hideUnknownProgressDialog();
 
   double time = TimeStamp::durationSeconds(start);
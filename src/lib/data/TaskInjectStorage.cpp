@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "Blackboard.h"
 #include "Storage.h"
 #include "StorageProvider.h"
 
@@ -10,13 +11,15 @@ TaskInjectStorage::TaskInjectStorage(std::shared_ptr<StorageProvider> storagePro
 
 void TaskInjectStorage::doEnter(std::shared_ptr<Blackboard> /*blackboard*/) {}
 
-Task::TaskState TaskInjectStorage::doUpdate(std::shared_ptr<Blackboard> /*blackboard*/) {
+Task::TaskState TaskInjectStorage::doUpdate(std::shared_ptr<Blackboard> blackboard) {
   if(m_storageProvider->getStorageCount() > 0) {
     if(auto result = m_storageProvider->consumeLargestStorage()) {
       const auto source = std::move(result.value());
       // TODO(Hussein): What happen if lock failed but provider is consumed?!
       if(const auto target = m_target.lock()) {
         target->inject(source.get());
+        // repeats the injection right away and wakes indexing that waits for the queue to shrink
+        blackboard->notifyChange();
         return STATE_SUCCESS;
       }
     }
@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "Blackboard.h"
 #include "StorageProvider.h"
 
 TaskMergeStorages::TaskMergeStorages(std::shared_ptr<StorageProvider> storageProvider)
@@ -9,29 +10,15 @@ TaskMergeStorages::TaskMergeStorages(std::shared_ptr<StorageProvider> storagePro
 
 void TaskMergeStorages::doEnter(std::shared_ptr<Blackboard> /*blackboard*/) {}
 
-Task::TaskState TaskMergeStorages::doUpdate(std::shared_ptr<Blackboard> /*blackboard*/) {
-  if(m_storageProvider->getStorageCount() > 2)    // largest storage won't be touched here
-  {
-    std::shared_ptr<IntermediateStorage> target;
-    if(auto result = m_storageProvider->consumeSecondLargestStorage()) {
-      target = result.value();
-    }
-    std::shared_ptr<IntermediateStorage> source;
-    if(auto result = m_storageProvider->consumeSecondLargestStorage()) {
-      source = result.value();
-    }
-    if(target && source) {
-      target->inject(source.get());
-      m_storageProvider->insert(target);
-      return STATE_SUCCESS;
-    } else {
-      if(target) {
-        m_storageProvider->insert(target);
-      }
-      if(source) {
-        m_storageProvider->insert(source);
-      }
-    }
+Task::TaskState TaskMergeStorages::doUpdate(std::shared_ptr<Blackboard> blackboard) {
+  // several merge lanes run this task concurrently, each one works on a disjoint pair of storages
+  if(auto result = m_storageProvider->consumeStoragesToMerge()) {
+    auto [target, source] = std::move(result.value());
+    target->inject(source.get());
+    m_storageProvider->insert(std::move(target));
+    // wakes the other merge lanes and the inject task
+    blackboard->notifyChange();
+    return STATE_SUCCESS;
   }
 
   return STATE_FAILURE;
@@ -1,50 +1,196 @@
 #include "FullTextSearchIndex.h"
 
-#include <limits>
+#include <algorithm>
+#include <cwctype>
+#include <functional>
+#include <iterator>
 
-#include "logging.h"
+namespace {
+constexpr unsigned CharBits = 21;    // enough for every unicode code point
+constexpr FullTextSearchIndex::Trigram CharMask = (FullTextSearchIndex::Trigram(1) << CharBits) - 1;
 
-void FullTextSearchIndex::addFile(Id fileId, const std::wstring& fileContent) {
-  if(fileContent.empty()) {
-    LOG_ERROR("empty file not added to fulltextsearch index");
+wchar_t toLower(wchar_t character) {
+  return static_cast<wchar_t>(std::towlower(static_cast<std::wint_t>(character)));
+}
+
+FullTextSearchIndex::Trigram toTrigram(wchar_t first, wchar_t second, wchar_t third) {
+  return ((static_cast<FullTextSearchIndex::Trigram>(first) & CharMask) << (2 * CharBits)) |
+      ((static_cast<FullTextSearchIndex::Trigram>(second) & CharMask) << CharBits) |
+      (static_cast<FullTextSearchIndex::Trigram>(third) & CharMask);
+}
+}    // namespace
+
+std::vector<FullTextSearchIndex::Trigram> FullTextSearchIndex::getTrigrams(std::wstring_view text) {
+  std::vector<Trigram> trigrams;
+  if(text.size() < 3) {
+    return trigrams;
   }
 
-  if(static_cast<int>(fileContent.size()) >= std::numeric_limits<int>::max()) {
-    LOG_ERROR("file too big not added to fulltextsearch index");
+  trigrams.reserve(text.size() - 2);
+  wchar_t first = toLower(text[0]);
+  wchar_t second = toLower(text[1]);
+  for(size_t i = 2; i < text.size(); i++) {
+    const wchar_t third = toLower(text[i]);
+    trigrams.push_back(toTrigram(first, second, third));
+    first = second;
+    second = third;
   }
 
-  FullTextSearchFile fts_file(fileId, SuffixArray(fileContent));
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  return trigrams;
+}
+
+std::string FullTextSearchIndex::encodeTrigrams(const std::vector<Trigram>& trigrams) {
+  std::string data;
+  data.reserve(trigrams.size() * 3);
+
+  Trigram previous = 0;
+  for(const Trigram trigram : trigrams) {
+    Trigram delta = trigram - previous;
+    previous = trigram;
+    while(delta >= 0x80) {
+      data.push_back(static_cast<char>((delta & 0x7F) | 0x80));
+      delta >>= 7U;
+    }
+    data.push_back(static_cast<char>(delta));
+  }
+  return data;
+}
+
+std::vector<FullTextSearchIndex::Trigram> FullTextSearchIndex::decodeTrigrams(std::string_view data) {
+  std::vector<Trigram> trigrams;
+  trigrams.reserve(data.size() / 2);
 
-  {
-    std::lock_guard<std::mutex> lock(m_filesMutex);
-    m_files.push_back(fts_file);
+  Trigram previous = 0;
+  Trigram delta = 0;
+  unsigned shift = 0;
+  for(const char byte : data) {
+    delta |= static_cast<Trigram>(static_cast<unsigned char>(byte) & 0x7FU) << shift;
+    if((static_cast<unsigned char>(byte) & 0x80U) != 0) {
+      shift += 7;
+      continue;
+    }
+
+    previous += delta;
+    trigrams.push_back(previous);
+    delta = 0;
+    shift = 0;
   }
+  return trigrams;
 }
 
-std::vector<FullTextSearchResult> FullTextSearchIndex::searchForTerm(const std::wstring& term) const {
-  std::vector<FullTextSearchResult> ret;
-  {
-    std::lock_guard<std::mutex> lock(m_filesMutex);
-    for(auto& f : m_files) {
-      FullTextSearchResult hit;
-      hit.fileId = f.fileId;
-      hit.positions = f.array.searchForTerm(term);
-      std::sort(hit.positions.begin(), hit.positions.end());
-      if(!hit.positions.empty()) {
-        ret.push_back(hit);
-      }
+std::vector<int> FullTextSearchIndex::findTermPositions(std::wstring_view text, std::wstring_view term) {
+  std::vector<int> positions;
+  if(term.empty() || term.size() > text.size()) {
+    return positions;
+  }
+
+  const auto equalsIgnoreCase = [](wchar_t first, wchar_t second) { return toLower(first) == toLower(second); };
+  const std::default_searcher searcher(term.begin(), term.end(), equalsIgnoreCase);
+
+  auto begin = text.begin();
+  while(true) {
+    const auto found = std::search(begin, text.end(), searcher);
+    if(found == text.end()) {
+      break;
     }
+    positions.push_back(static_cast<int>(found - text.begin()));
+    begin = found + 1;
   }
+  return positions;
+}
 
-  return ret;
+void FullTextSearchIndex::addFile(Id fileId, const std::vector<Trigram>& trigrams) {
+  std::lock_guard<std::mutex> lock(m_filesMutex);
+  m_fileIds.push_back(fileId);
+  m_pendingPostings.reserve(m_pendingPostings.size() + trigrams.size());
+  for(const Trigram trigram : trigrams) {
+    m_pendingPostings.emplace_back(trigram, fileId);
+  }
+}
+
+void FullTextSearchIndex::finishSetup() {
+  std::lock_guard<std::mutex> lock(m_filesMutex);
+  std::sort(m_fileIds.begin(), m_fileIds.end());
+
+  // merge the already flattened postings so files can still be added after a previous setup
+  m_pendingPostings.reserve(m_pendingPostings.size() + m_postingFileIds.size());
+  for(size_t i = 0; i < m_trigrams.size(); i++) {
+    for(size_t j = m_postingOffsets[i]; j < m_postingOffsets[i + 1]; j++) {
+      m_pendingPostings.emplace_back(m_trigrams[i], m_postingFileIds[j]);
+    }
+  }
+  std::sort(m_pendingPostings.begin(), m_pendingPostings.end());
+
+  m_trigrams.clear();
+  m_postingOffsets.clear();
+  m_postingFileIds.clear();
+  m_postingFileIds.reserve(m_pendingPostings.size());
+  for(const auto& [trigram, fileId] : m_pendingPostings) {
+    if(m_trigrams.empty() || m_trigrams.back() != trigram) {
+      m_trigrams.push_back(trigram);
+      m_postingOffsets.push_back(m_postingFileIds.size());
+    }
+    m_postingFileIds.push_back(fileId);
+  }
+  m_postingOffsets.push_back(m_postingFileIds.size());
+
+  m_pendingPostings.clear();
+  m_pendingPostings.shrink_to_fit();
+}
+
+std::vector<Id> FullTextSearchIndex::getCandidateFileIds(const std::wstring& term) const {
+  const std::vector<Trigram> trigrams = getTrigrams(term);
+
+  std::lock_guard<std::mutex> lock(m_filesMutex);
+  if(trigrams.empty()) {
+    return m_fileIds;
+  }
+
+  // intersect the postings starting with the shortest one
+  std::vector<std::span<const Id>> postings;
+  postings.reserve(trigrams.size());
+  for(const Trigram trigram : trigrams) {
+    const std::span<const Id> posting = getPosting(trigram);
+    if(posting.empty()) {
+      return {};
+    }
+    postings.push_back(posting);
+  }
+  std::sort(postings.begin(), postings.end(), [](const auto& first, const auto& second) { return first.size() < second.size(); });
+
+  std::vector<Id> candidates(postings.front().begin(), postings.front().end());
+  std::vector<Id> intersection;
+  for(size_t i = 1; i < postings.size() && !candidates.empty(); i++) {
+    intersection.clear();
+    std::set_intersection(
+        candidates.begin(), candidates.end(), postings[i].begin(), postings[i].end(), std::back_inserter(intersection));
+    candidates.swap(intersection);
+  }
+  return candidates;
 }
 
 size_t FullTextSearchIndex::fileCount() const {
   std::lock_guard<std::mutex> lock(m_filesMutex);
-  return m_files.size();
+  return m_fileIds.size();
 }
 
 void FullTextSearchIndex::clear() {
   std::lock_guard<std::mutex> lock(m_filesMutex);
-  m_files.clear();
+  m_fileIds.clear();
+  m_pendingPostings.clear();
+  m_trigrams.clear();
+  m_postingOffsets.clear();
+  m_postingFileIds.clear();
+}
+
+std::span<const Id> FullTextSearchIndex::getPosting(Trigram trigram) const {
+  const auto found = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+  if(found == m_trigrams.end() || *found != trigram) {
+    return {};
+  }
+
+  const auto index = static_cast<size_t>(found - m_trigrams.begin());
+  return {m_postingFileIds.data() + m_postingOffsets[index], m_postingOffsets[index + 1] - m_postingOffsets[index]};
 }
@@ -1,37 +1,69 @@
 #pragma once
 // STL
+#include <cstdint>
 #include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-
-#include <unordered_map>
 // internal
 #include "GlobalId.hpp"
-#include "SuffixArray.h"
 
-class StorageAccess;
+/**
+ * @brief Trigram index over the lower case content of all indexed files
+ *
+ * The index only narrows a search down to the files that contain every trigram of the search term, the exact positions
+ * are found by scanning the content of these candidates. The trigrams of a file are small enough to be persisted
+ * alongside the file (see encodeTrigrams), so the index can be loaded without decoding any file content.
+ *
+ * After finishSetup the postings of all files are kept in one flat structure: the sorted trigrams, an offset per
+ * trigram and a single array of file ids. Looking up a trigram is one binary search regardless of the file count.
+ */
+class FullTextSearchIndex {
+public:
+  using Trigram = uint64_t;
 
-// contains all fulltextsearch results of one file
-struct FullTextSearchResult {
-  Id fileId;
-  std::vector<int> positions;
-};
+  /**
+   * @brief Sorted and unique trigrams of the lower case text
+   */
+  static std::vector<Trigram> getTrigrams(std::wstring_view text);
 
-struct FullTextSearchFile {
-  FullTextSearchFile(Id fileId_, SuffixArray array_) : fileId(fileId_), array(array_) {}
-  Id fileId;
-  SuffixArray array;
-};
+  /**
+   * @brief Compact binary form of sorted trigrams (delta encoded varints)
+   */
+  static std::string encodeTrigrams(const std::vector<Trigram>& trigrams);
+  static std::vector<Trigram> decodeTrigrams(std::string_view data);
 
-class FullTextSearchIndex {
-public:
-  void addFile(Id fileId, const std::wstring& file);
-  std::vector<FullTextSearchResult> searchForTerm(const std::wstring& term) const;
+  /**
+   * @brief All case-insensitive occurrences of term in text, in ascending order
+   */
+  static std::vector<int> findTermPositions(std::wstring_view text, std::wstring_view term);
+
+  void addFile(Id fileId, const std::vector<Trigram>& trigrams);
+
+  /**
+   * @brief Builds the flat postings, has to be called after the last addFile and before searching
+   */
+  void finishSetup();
+
+  /**
+   * @brief Files that may contain the term, every indexed file for terms shorter than a trigram
+   */
+  std::vector<Id> getCandidateFileIds(const std::wstring& term) const;
 
   size_t fileCount() const;
 
   void clear();
 
 private:
+  std::span<const Id> getPosting(Trigram trigram) const;
+
   mutable std::mutex m_filesMutex;
-  std::vector<FullTextSearchFile> m_files;
+  std::vector<Id> m_fileIds;
+  std::vector<std::pair<Trigram, Id>> m_pendingPostings;
+
+  std::vector<Trigram> m_trigrams;
+  std::vector<size_t> m_postingOffsets;
+  std::vector<Id> m_postingFileIds;
 };
@@ -16,6 +16,7 @@ public:
   IndexerCommandType getSupportedIndexerCommandType() const override;
   std::shared_ptr<IntermediateStorage> index(std::shared_ptr<IndexerCommand> indexerCommand) override;
   void interrupt() override;
+  void setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction claimHeader) override;
 
 private:
   virtual void doIndex(std::shared_ptr<T> indexerCommand,
@@ -41,6 +42,11 @@ void Indexer<T>::interrupt() {
   m_indexerStateInfo->indexingInterrupted = true;
 }
 
+template <typename T>
+void Indexer<T>::setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction claimHeader) {
+  m_indexerStateInfo->claimHeader = std::move(claimHeader);
+}
+
 template <typename T>
 std::shared_ptr<IntermediateStorage> Indexer<T>::index(std::shared_ptr<IndexerCommand> indexerCommand) {
   std::shared_ptr<T> castCommand = std::dynamic_pointer_cast<T>(indexerCommand);
@@ -2,4 +2,6 @@
 
 IndexerBase::IndexerBase() = default;
 
-IndexerBase::~IndexerBase() = default;
\ No newline at end of file
+IndexerBase::~IndexerBase() = default;
+
+void IndexerBase::setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction /*claimHeader*/) {}
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "IndexerCommandType.h"
+#include "IndexerStateInfo.h"
 
 class IndexerCommand;
 class IntermediateStorage;
@@ -15,4 +16,6 @@ public:
   [[nodiscard]] virtual IndexerCommandType getSupportedIndexerCommandType() const = 0;
   virtual std::shared_ptr<IntermediateStorage> index(std::shared_ptr<IndexerCommand> indexerCommand) = 0;
   virtual void interrupt() = 0;
+
+  virtual void setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction claimHeader);
 };
\ No newline at end of file
@@ -29,3 +29,9 @@ void IndexerComposite::interrupt() {
     indexer->interrupt();
   }
 }
+
+void IndexerComposite::setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction claimHeader) {
+  for(auto& [type, indexer] : m_indexers) {
+    indexer->setHeaderClaimFunction(claimHeader);
+  }
+}
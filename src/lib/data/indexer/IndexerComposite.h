@@ -17,6 +17,8 @@ public:
 
   void interrupt() override;
 
+  void setHeaderClaimFunction(IndexerStateInfo::HeaderClaimFunction claimHeader) override;
+
 private:
   std::map<IndexerCommandType, std::shared_ptr<IndexerBase>> m_indexers;
 };
\ No newline at end of file
@@ -1,6 +1,15 @@
 #pragma once
+#include <cstddef>
+#include <functional>
+
+class FilePath;
 
 struct IndexerStateInfo {
 public:
+  using HeaderClaimFunction = std::function<bool(const FilePath& headerPath, size_t preprocessorContextHash)>;
+
   bool indexingInterrupted;
+  // Returns false if the header was already indexed by another translation unit using the same preprocessor context.
+  // Empty if every translation unit has to index its headers itself.
+  HeaderClaimFunction claimHeader;
 };
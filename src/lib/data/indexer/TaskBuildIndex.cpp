@@ -15,7 +15,6 @@
 
 namespace {
 constexpr auto DelayTimeBeforeFinishUpdateInMs = 50;
-constexpr auto DelayTimeBeforeStatrWorkInMs = 200;
 constexpr auto DelayTimeInMs = 100;
 constexpr auto MaxProcessTimeInMs = 500;
 constexpr int MaxStorageCount = 10;
@@ -35,8 +34,14 @@ TaskBuildIndex::TaskBuildIndex(size_t processCount,
 
 void TaskBuildIndex::doEnter(std::shared_ptr<Blackboard> blackboard) {
   mInterprocessIndexingStatusManager.setIndexingInterrupted(false);
+  mInterprocessIndexingStatusManager.clearIndexedHeaders();
 
   mIndexingFileCount = 0;
+  mStartTime = TimeStamp::now();
+  mIndexingCosts.clear();
+  mBusyTimeMs.clear();
+  mInterprocessIndexingStatusManager.popIndexingCosts();    // drop records of an earlier, interrupted run
+
   updateIndexingDialog(blackboard, std::vector<FilePath>());
 
   // FIXME(Hussein): Multiprocess needs the file to log
@@ -83,6 +88,8 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
     updateIndexingDialog(blackboard, indexingFiles);
   }
 
+  collectIndexingCosts();
+
   if(mIndexerCommandQueueStopped && runningThreadCount == 0) {
     LOG_INFO("command queue stopped and no running threads. done.");
     return STATE_SUCCESS;
@@ -96,7 +103,13 @@ Task::TaskState TaskBuildIndex::doUpdate(std::shared_ptr<Blackboard> blackboard)
     updateIndexingDialog(blackboard, std::vector<FilePath>());
   }
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(DelayTimeBeforeFinishUpdateInMs));
+  // storages of indexer processes can only be polled, but an exiting indexer thread ends the wait right away
+  {
+    std::unique_lock<std::mutex> lock(mRunningThreadCountMutex);
+    mRunningThreadCountCondition.wait_for(lock, std::chrono::milliseconds(DelayTimeBeforeFinishUpdateInMs), [&]() {
+      return mRunningThreadCount != runningThreadCount;
+    });
+  }
 
   return STATE_RUNNING;
 }
@@ -110,10 +123,21 @@ void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard) {
 
   if(!mInterrupted) {
     while(fetchIntermediateStorages(blackboard)) {}
+  } else {
+    // the headers claimed by the dropped storages are missing in the index
+    mInterprocessIndexingStatusManager.releaseHeaderClaims();
   }
 
-  if(const std::vector<FilePath> crashedFiles = mInterprocessIndexingStatusManager.getCrashedSourceFilePaths();
-     !crashedFiles.empty()) {
+  collectIndexingCosts();
+  logWorkerUtilization();
+  if(!mInterrupted && !mIndexingCosts.empty()) {
+    // persisted by TaskFinishParsing, once no other task writes to the storage anymore
+    blackboard->set<std::vector<StorageIndexingCost>>("indexing_costs", mIndexingCosts);
+  }
+
+  const std::vector<FilePath> crashedFiles = mInterprocessIndexingStatusManager.getCrashedSourceFilePaths();
+  const std::vector<FilePath> lostHeaders = mInterprocessIndexingStatusManager.popLostHeaderPaths();
+  if(!crashedFiles.empty() || !lostHeaders.empty()) {
     const std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
     const std::shared_ptr<ParserClientImpl> parserClient = std::make_shared<ParserClientImpl>(storage.get());
 
@@ -131,6 +155,18 @@ void TaskBuildIndex::doExit(std::shared_ptr<Blackboard> blackboard) {
           ParseLocation(fileId, 1, 1));
       LOG_INFO(L"crashed translation unit: " + path.wstr());
     }
+
+    // the error keeps the header incomplete, so the next refresh indexes it again
+    for(const FilePath& path : lostHeaders) {
+      const Id fileId = parserClient->recordFile(path, true);
+      parserClient->recordError(L"The translation unit that indexed this header did not finish, its content is "
+                                L"indexed again on the next refresh.",
+                                false,
+                                true,
+                                path,
+                                ParseLocation(fileId, 1, 1));
+      LOG_INFO(L"header without indexed content: " + path.wstr());
+    }
     mStorageProvider->insert(storage);
   }
 
@@ -171,6 +207,7 @@ void TaskBuildIndex::runIndexerProcess(int processId, const std::wstring& logFil
     commandArguments.push_back(logFilePath);
   }
 
+  // the indexer only exits by itself once the command queue is drained, other exits are crashes and get a new process
   int result = 1;
   while((!mIndexerCommandQueueStopped || result != 0) && !mInterrupted) {
     result = utility::executeProcess(indexerProcessPath.wstr(), commandArguments, FilePath(), false, -1).exitCode;
@@ -182,23 +219,20 @@ void TaskBuildIndex::runIndexerProcess(int processId, const std::wstring& logFil
     const std::lock_guard<std::mutex> lock(mRunningThreadCountMutex);
     mRunningThreadCount--;
   }
+  mRunningThreadCountCondition.notify_all();
 }
 
 void TaskBuildIndex::runIndexerThread(int processId) {
-  do {    // NOLINT(cppcoreguidelines-avoid-do-while)
+  {
     InterprocessIndexer indexer(mAppUUID, static_cast<Id>(processId));
-    indexer.work();    // this will only return if there are no indexer commands left in the queue
-    if(!mInterrupted) {
-      // sleeping if interrupted may result in a crash due to objects that are already
-      // destroyed after waking up again
-      std::this_thread::sleep_for(std::chrono::milliseconds(DelayTimeBeforeStatrWorkInMs));
-    }
-  } while(!mIndexerCommandQueueStopped && !mInterrupted);
+    indexer.work();    // this will only return once the command queue is drained or indexing got interrupted
+  }
 
   {
     const std::lock_guard<std::mutex> lock(mRunningThreadCountMutex);
     mRunningThreadCount--;
   }
+  mRunningThreadCountCondition.notify_all();
 }
 
 bool TaskBuildIndex::fetchIntermediateStorages(const std::shared_ptr<Blackboard>& blackboard) {
@@ -207,7 +241,8 @@ bool TaskBuildIndex::fetchIntermediateStorages(const std::shared_ptr<Blackboard>
   if(const int providerStorageCount = mStorageProvider->getStorageCount(); providerStorageCount > MaxStorageCount) {
     LOG_INFO("waiting, too many storages queued: {}", providerStorageCount);
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(DelayTimeInMs));
+    // merging and injecting notify the blackboard whenever they consumed storages
+    blackboard->waitForChange(blackboard->getChangeCount(), std::chrono::milliseconds(DelayTimeInMs));
 
     return true;
   }
@@ -229,11 +264,13 @@ bool TaskBuildIndex::fetchIntermediateStorages(const std::shared_ptr<Blackboard>
 
     LOG_INFO("{} - storage count: {}", storageManager->getProcessId(), storageCount);
     mStorageProvider->insert(storageManager->popIntermediateStorage());
+    mInterprocessIndexingStatusManager.confirmHeaderClaims(finishedProcessId);
     poppedStorageCount++;
   } while(TimeStamp::now().deltaMS(currentTime) <
           MaxProcessTimeInMs);    // don't process all storages at once to allow for status updates in-between
 
   if(poppedStorageCount > 0) {
+    // also wakes the merge and inject tasks waiting for new storages
     blackboard->update<int>("indexed_source_file_count", [=](int count) { return count + poppedStorageCount; });
     return true;
   }
@@ -241,6 +278,44 @@ bool TaskBuildIndex::fetchIntermediateStorages(const std::shared_ptr<Blackboard>
   return false;
 }
 
+void TaskBuildIndex::collectIndexingCosts() {
+  for(auto& [processId, cost] : mInterprocessIndexingStatusManager.popIndexingCosts()) {
+    mBusyTimeMs[processId] += cost.durationMs;
+
+    // translation units without a storage were interrupted or crashed, their duration says nothing about the next run
+    if(cost.storageSize > 0) {
+      mIndexingCosts.push_back(std::move(cost));
+    }
+  }
+}
+
+void TaskBuildIndex::logWorkerUtilization() {
+  for(const auto& lifetime : mInterprocessIndexingStatusManager.popIndexerLifetimes()) {
+    LOG_INFO(fmt::format("indexer {} lifetime: {} translation units, {} ms startup, {} ms busy, {} ms waiting for commands",
+                         lifetime.processId,
+                         lifetime.translationUnitCount,
+                         lifetime.startupMs,
+                         lifetime.busyMs,
+                         lifetime.waitingMs));
+  }
+
+  const size_t wallTimeMs = TimeStamp::now().deltaMS(mStartTime);
+  if(0 == wallTimeMs || mBusyTimeMs.empty()) {
+    return;
+  }
+
+  uint64_t totalBusyTimeMs = 0;
+  for(const auto& [processId, busyTimeMs] : mBusyTimeMs) {
+    LOG_INFO(fmt::format("indexer {} busy for {} of {} ms ({}%)", processId, busyTimeMs, wallTimeMs, busyTimeMs * 100 / wallTimeMs));
+    totalBusyTimeMs += busyTimeMs;
+  }
+
+  LOG_INFO(fmt::format("indexer utilization: {}% of {} workers over {} ms",
+                       totalBusyTimeMs * 100 / (wallTimeMs * mProcessCount),
+                       mProcessCount,
+                       wallTimeMs));
+}
+
 void TaskBuildIndex::updateIndexingDialog(const std::shared_ptr<Blackboard>& blackboard, const std::vector<FilePath>& sourcePaths) {
   // TODO: factor in unindexed files...
   int sourceFileCount = 0;
@@ -1,11 +1,16 @@
 #pragma once
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <thread>
 
 #include "InterprocessIndexerCommandManager.h"
 #include "InterprocessIndexingStatusManager.h"
 #include "InterprocessIntermediateStorageManager.h"
 #include "MessageListener.h"
+#include "StorageIndexingCost.h"
 #include "Task.h"
+#include "TimeStamp.h"
 #include "type/indexing/MessageIndexingInterrupted.h"
 
 class DialogView;
@@ -35,6 +40,8 @@ protected:
   void runIndexerThread(int processId);
   bool fetchIntermediateStorages(const std::shared_ptr<Blackboard>& blackboard);
   void updateIndexingDialog(const std::shared_ptr<Blackboard>& blackboard, const std::vector<FilePath>& sourcePaths);
+  void collectIndexingCosts();
+  void logWorkerUtilization();
 
   static const std::wstring sProcessName;
 
@@ -50,10 +57,15 @@ protected:
   bool mInterrupted = false;
   size_t mIndexingFileCount = 0;
 
+  TimeStamp mStartTime;
+  std::vector<StorageIndexingCost> mIndexingCosts;
+  std::map<Id, uint64_t> mBusyTimeMs;    // indexing time per indexer process
+
   // store as plain pointers to avoid deallocation issues when closing app during indexing
   std::vector<std::unique_ptr<std::thread>> mProcessThreads;
   std::vector<std::shared_ptr<InterprocessIntermediateStorageManager>> mInterprocessIntermediateStorageManagers;
 
   size_t mRunningThreadCount = 0;
   std::mutex mRunningThreadCountMutex;
+  std::condition_variable mRunningThreadCountCondition;
 };
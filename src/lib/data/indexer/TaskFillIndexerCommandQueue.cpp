@@ -6,19 +6,29 @@
 #include "logging.h"
 #include "utilityFile.h"
 
+namespace {
+constexpr auto RefillDelayInMs = 50;
+}    // namespace
+
 TaskFillIndexerCommandsQueue::TaskFillIndexerCommandsQueue(const std::string& appUUID,
                                                            std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
+                                                           std::map<FilePath, uint64_t> expectedDurationsMs,
                                                            size_t maximumQueueSize)
     : m_indexerCommandProvider(std::move(indexerCommandProvider))
     , m_indexerCommandManager(appUUID, 0, true)
+    , m_expectedDurationsMs(std::move(expectedDurationsMs))
     , m_maximumQueueSize(maximumQueueSize) {}
 
 void TaskFillIndexerCommandsQueue::doEnter(std::shared_ptr<Blackboard> blackboard) {
   {
     std::lock_guard<std::mutex> lock(m_commandsMutex);
-    for(const FilePath& filePath : utility::partitionFilePathsBySize(m_indexerCommandProvider->getAllSourceFilePaths(), 2)) {
+    // all indexers pop from the same shared queue, so handing out the longest files first keeps the slow ones from
+    // ending up on a single worker at the tail of the run
+    for(const FilePath& filePath :
+        utility::sortFilePathsByExpectedDuration(m_indexerCommandProvider->getAllSourceFilePaths(), m_expectedDurationsMs)) {
       m_filePathQueue.emplace(filePath);
     }
+    m_expectedDurationsMs.clear();
   }
 
   fillCommandQueue();
@@ -26,7 +36,7 @@ void TaskFillIndexerCommandsQueue::doEnter(std::shared_ptr<Blackboard> blackboar
   blackboard->set<bool>("indexer_command_queue_started", true);
 }
 
-Task::TaskState TaskFillIndexerCommandsQueue::doUpdate(std::shared_ptr<Blackboard> /*blackboard*/) {
+Task::TaskState TaskFillIndexerCommandsQueue::doUpdate(std::shared_ptr<Blackboard> blackboard) {
   if(m_interrupted) {
     return STATE_FAILURE;
   }
@@ -39,12 +49,15 @@ Task::TaskState TaskFillIndexerCommandsQueue::doUpdate(std::shared_ptr<Blackboar
     }
   }
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  // every fetched storage updates the blackboard and usually means an indexer took a new command, the timeout covers the rest
+  blackboard->waitForChange(blackboard->getChangeCount(), std::chrono::milliseconds(RefillDelayInMs));
 
   return STATE_RUNNING;
 }
 
 void TaskFillIndexerCommandsQueue::doExit(std::shared_ptr<Blackboard> blackboard) {
+  // lets the waiting indexers shut down once the remaining commands are taken
+  m_indexerCommandManager.setIndexerCommandQueueStopped(true);
   blackboard->set<bool>("indexer_command_queue_stopped", true);
 }
 
@@ -1,6 +1,8 @@
 #ifndef TASK_FILL_INDEXER_COMMAND_QUEUE_H
 #define TASK_FILL_INDEXER_COMMAND_QUEUE_H
 
+#include <cstdint>
+#include <map>
 #include <queue>
 
 #include "../../../scheduling/Task.h"
@@ -16,6 +18,7 @@ class TaskFillIndexerCommandsQueue
 public:
   TaskFillIndexerCommandsQueue(const std::string& appUUID,
                                std::unique_ptr<IndexerCommandProvider> indexerCommandProvider,
+                               std::map<FilePath, uint64_t> expectedDurationsMs,
                                size_t maximumQueueSize);
 
 protected:
@@ -32,6 +35,7 @@ protected:
 private:
   std::unique_ptr<IndexerCommandProvider> m_indexerCommandProvider;
   InterprocessIndexerCommandManager m_indexerCommandManager;
+  std::map<FilePath, uint64_t> m_expectedDurationsMs;
 
   const size_t m_maximumQueueSize;
 
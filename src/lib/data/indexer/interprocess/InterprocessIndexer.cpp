@@ -1,5 +1,7 @@
 #include "InterprocessIndexer.h"
 
+#include <chrono>
+
 #include <fmt/format.h>
 
 #include "IndexerCommand.h"
@@ -8,6 +10,16 @@
 #include "logging.h"
 #include "ScopedFunctor.h"
 
+namespace {
+// how often a waiting indexer checks for interruption
+constexpr auto CommandWaitTimeout = std::chrono::milliseconds(500);
+
+uint64_t getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+}    // namespace
+
 InterprocessIndexer::InterprocessIndexer(const std::string& uuid, Id processId)
     : mInterprocessIndexerCommandManager(uuid, processId, false)
     , mInterprocessIndexingStatusManager(uuid, processId, false)
@@ -20,9 +32,16 @@ void InterprocessIndexer::work() {
   std::shared_ptr<std::thread> pUpdaterThread;
   std::shared_ptr<IndexerBase> pIndexer;
 
+  const auto startTime = std::chrono::steady_clock::now();
+  InterprocessIndexingStatusManager::IndexerLifetime lifetime;
+  lifetime.processId = mProcessId;
+
   try {
     LOG_INFO(fmt::format("{} starting up indexer", mProcessId));
     pIndexer = LanguagePackageManager::getInstance()->instantiateSupportedIndexers();
+    pIndexer->setHeaderClaimFunction([this](const FilePath& headerPath, size_t preprocessorContextHash) {
+      return mInterprocessIndexingStatusManager.claimIndexedHeader(headerPath, preprocessorContextHash);
+    });
 
     pUpdaterThread = std::make_shared<std::thread>([&]() {
       while(updaterThreadRunning) {
@@ -48,7 +67,19 @@ void InterprocessIndexer::work() {
       }
     });
 
-    while(auto pIndexerCommand = mInterprocessIndexerCommandManager.popIndexerCommand()) {
+    lifetime.startupMs = getElapsedMs(startTime);
+
+    while(updaterThreadRunning) {
+      const auto waitStart = std::chrono::steady_clock::now();
+      auto pIndexerCommand = mInterprocessIndexerCommandManager.waitForIndexerCommand(CommandWaitTimeout);
+      lifetime.waitingMs += getElapsedMs(waitStart);
+      if(!pIndexerCommand) {
+        if(mInterprocessIndexerCommandManager.isIndexerCommandQueueDrained()) {
+          break;
+        }
+        continue;
+      }
+
       LOG_INFO(fmt::format("{} fetched indexer command for \"{}\"", mProcessId, pIndexerCommand->getSourceFilePath().str()));
       LOG_INFO(fmt::format("{} indexer commands left: {}", mProcessId, mInterprocessIndexerCommandManager.indexerCommandCount()));
 
@@ -72,15 +103,21 @@ void InterprocessIndexer::work() {
       mInterprocessIndexingStatusManager.startIndexingSourceFile(pIndexerCommand->getSourceFilePath());
 
       LOG_INFO(fmt::format("{} starting to index current file", mProcessId));
+      const auto indexStart = std::chrono::steady_clock::now();
       auto pResult = pIndexer->index(pIndexerCommand);
+      const auto indexDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                                      indexStart);
 
+      size_t storageSize = 0;
       if(pResult) {
         LOG_INFO(fmt::format("{} spushing index to shared memory", mProcessId));
-        mInterprocessIntermediateStorageManager.pushIntermediateStorage(pResult);
+        storageSize = mInterprocessIntermediateStorageManager.pushIntermediateStorage(pResult);
       }
 
       LOG_INFO(fmt::format("{} sfinalizing indexer status for current file", mProcessId));
-      mInterprocessIndexingStatusManager.finishIndexingSourceFile();
+      mInterprocessIndexingStatusManager.finishIndexingSourceFile(static_cast<uint64_t>(indexDuration.count()), storageSize);
+      lifetime.translationUnitCount++;
+      lifetime.busyMs += static_cast<uint64_t>(indexDuration.count());
 
       LOG_INFO(fmt::format("{} sall done", mProcessId));
     }
@@ -94,5 +131,11 @@ void InterprocessIndexer::work() {
     LOG_INFO(fmt::format("{} something went wrong while running the indexer", mProcessId));
   }
 
-  LOG_INFO(fmt::format("{} shutting down indexer", mProcessId));
+  LOG_INFO(fmt::format("{} shutting down indexer after {} translation units, {} ms startup, {} ms busy, {} ms waiting",
+                       mProcessId,
+                       lifetime.translationUnitCount,
+                       lifetime.startupMs,
+                       lifetime.busyMs,
+                       lifetime.waitingMs));
+  mInterprocessIndexingStatusManager.reportIndexerLifetime(lifetime);
 }
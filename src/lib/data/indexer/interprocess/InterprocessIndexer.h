@@ -7,6 +7,11 @@ class InterprocessIndexer final {
 public:
   InterprocessIndexer(const std::string& uuid, Id processId);
 
+  /**
+   * @brief Indexes commands from the shared queue until all commands of the indexing run are taken or it is interrupted
+   *
+   * An empty queue is waited on, so the indexer and its caches stay warm for the whole run.
+   */
   void work();
 
 private:
@@ -7,6 +7,8 @@ const char* InterprocessIndexerCommandManager::sSharedMemoryNamePrefix = "icmd_"
 
 const char* InterprocessIndexerCommandManager::sIndexerCommandsKeyName = "indexer_commands";
 
+const char* InterprocessIndexerCommandManager::sIndexerCommandQueueStoppedKeyName = "indexer_commands_stopped";
+
 constexpr auto OneMb = 1048576;
 
 InterprocessIndexerCommandManager::InterprocessIndexerCommandManager(const std::string& instanceUuid, Id processId, bool isOwner)
@@ -47,6 +49,7 @@ void InterprocessIndexerCommandManager::pushIndexerCommands(const std::vector<st
   }
 
   LOG_INFO(access.logString());
+  access.notifyAll();
 }
 
 std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCommand() {
@@ -64,6 +67,52 @@ std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::popIndexerCom
   return command;
 }
 
+std::shared_ptr<IndexerCommand> InterprocessIndexerCommandManager::waitForIndexerCommand(std::chrono::milliseconds timeout) {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while(true) {
+    // looked up again after every wait, the memory may have moved
+    auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(sIndexerCommandsKeyName);
+    if(queue == nullptr) {
+      return nullptr;
+    }
+
+    if(!queue->empty()) {
+      std::shared_ptr<IndexerCommand> command = SharedIndexerCommand::fromShared(queue->front());
+      queue->pop_front();
+      return command;
+    }
+
+    const bool* stopped = access.accessValue<bool>(sIndexerCommandQueueStoppedKeyName);
+    const auto now = std::chrono::steady_clock::now();
+    if((stopped != nullptr && *stopped) || now >= deadline) {
+      return nullptr;
+    }
+
+    access.waitForChange(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+  }
+}
+
+void InterprocessIndexerCommandManager::setIndexerCommandQueueStopped(bool stopped) {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  bool* stoppedPtr = access.accessValue<bool>(sIndexerCommandQueueStoppedKeyName);
+  if(stoppedPtr != nullptr) {
+    *stoppedPtr = stopped;
+  }
+
+  access.notifyAll();
+}
+
+bool InterprocessIndexerCommandManager::isIndexerCommandQueueDrained() {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  const bool* stopped = access.accessValue<bool>(sIndexerCommandQueueStoppedKeyName);
+  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIndexerCommand>>(sIndexerCommandsKeyName);
+  return stopped != nullptr && *stopped && (queue == nullptr || queue->empty());
+}
+
 void InterprocessIndexerCommandManager::clearIndexerCommands() {
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
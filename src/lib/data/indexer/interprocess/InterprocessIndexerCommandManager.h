@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include "BaseInterprocessDataManager.h"
 #include "SharedIndexerCommand.h"
 
@@ -13,10 +15,23 @@ public:
   void pushIndexerCommands(const std::vector<std::shared_ptr<IndexerCommand>>& indexerCommands);
   std::shared_ptr<IndexerCommand> popIndexerCommand();
 
+  /**
+   * @brief Pops the next command, waiting for one to be pushed if the queue is empty
+   * @return nullptr if the timeout expired or no commands will follow, see isIndexerCommandQueueDrained()
+   */
+  std::shared_ptr<IndexerCommand> waitForIndexerCommand(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief Marks that all commands of the current indexing run were pushed and wakes waiting indexers
+   */
+  void setIndexerCommandQueueStopped(bool stopped);
+  bool isIndexerCommandQueueDrained();
+
   void clearIndexerCommands();
   size_t indexerCommandCount();
 
 private:
   static const char* sSharedMemoryNamePrefix;
   static const char* sIndexerCommandsKeyName;
+  static const char* sIndexerCommandQueueStoppedKeyName;
 };
\ No newline at end of file
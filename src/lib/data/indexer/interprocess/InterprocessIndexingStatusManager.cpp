@@ -1,5 +1,9 @@
 #include "InterprocessIndexingStatusManager.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+
 #include "logging.h"
 #include "utilityString.h"
 
@@ -10,9 +14,87 @@ const char* InterprocessIndexingStatusManager::sCurrentFilesKeyName = "current_f
 const char* InterprocessIndexingStatusManager::sCrashedFilesKeyName = "crashed_files";
 const char* InterprocessIndexingStatusManager::sFinishedProcessIdsKeyName = "finished_process_ids";
 const char* InterprocessIndexingStatusManager::sIndexingInterruptedKeyName = "indexing_interrupted_flag";
+const char* InterprocessIndexingStatusManager::sIndexedHeadersKeyName = "indexed_headers";
+const char* InterprocessIndexingStatusManager::sPendingHeaderClaimsKeyName = "pending_header_claims";
+const char* InterprocessIndexingStatusManager::sReleasedHeadersKeyName = "released_headers";
+const char* InterprocessIndexingStatusManager::sIndexingCostsKeyName = "indexing_costs";
+const char* InterprocessIndexingStatusManager::sIndexerLifetimesKeyName = "indexer_lifetimes";
 
 constexpr auto OneMb = 1048576;
 constexpr auto EstimatedPrefix = 262144;
+constexpr auto EstimatedSetNodeSize = 64;
+
+namespace {
+// pending claims are stored as "<process id>|<header key>", "<process id>|" ends the claims of a translation unit
+std::string getClaimPrefix(Id processId) {
+  return fmt::format("{}|", processId);
+}
+
+bool isClaimOfProcess(const SharedMemory::String& claim, const std::string& prefix) {
+  return claim.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), claim.begin());
+}
+
+bool isEndOfClaims(const SharedMemory::String& claim) {
+  return claim.back() == '|';
+}
+
+// releases the claims of the translation unit a process is indexing, or all pending claims without a process
+void releasePendingHeaderClaims(SharedMemory::ScopedAccess& access,
+                                std::optional<Id> processId,
+                                const char* pendingClaimsKeyName,
+                                const char* indexedHeadersKeyName,
+                                const char* releasedHeadersKeyName) {
+  auto* pendingClaimsPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(pendingClaimsKeyName);
+  if(pendingClaimsPtr == nullptr) {
+    return;
+  }
+
+  // every released claim is moved to the released headers
+  size_t estimatedSize = EstimatedPrefix;
+  for(const SharedMemory::String& claim : *pendingClaimsPtr) {
+    estimatedSize += sizeof(SharedMemory::String) + claim.size();
+  }
+  while(access.getFreeMemorySize() < estimatedSize) {
+    LOG_INFO(fmt::format("grow memory - est: {} size: {} free: {}", estimatedSize, access.getMemorySize(), access.getFreeMemorySize()));
+    access.growMemory(access.getMemorySize());
+    pendingClaimsPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(pendingClaimsKeyName);
+    if(pendingClaimsPtr == nullptr) {
+      return;
+    }
+  }
+
+  const std::string prefix = processId ? getClaimPrefix(*processId) : std::string();
+  auto begin = pendingClaimsPtr->begin();
+  if(processId) {
+    // claims before the last end marker of the process belong to storages that are pushed already
+    for(auto it = pendingClaimsPtr->begin(); it != pendingClaimsPtr->end(); ++it) {
+      if(isClaimOfProcess(*it, prefix) && isEndOfClaims(*it)) {
+        begin = it + 1;
+      }
+    }
+  }
+
+  auto* indexedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Set<SharedMemory::String>>(indexedHeadersKeyName);
+  auto* releasedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(releasedHeadersKeyName);
+  const auto end = std::remove_if(begin, pendingClaimsPtr->end(), [&](const SharedMemory::String& claim) {
+    if(!isClaimOfProcess(claim, prefix)) {
+      return false;
+    }
+
+    if(!isEndOfClaims(claim)) {
+      SharedMemory::String headerKey(claim.begin() + static_cast<long>(claim.find('|')) + 1, claim.end(), access.getAllocator());
+      if(indexedHeadersPtr != nullptr) {
+        indexedHeadersPtr->erase(headerKey);
+      }
+      if(releasedHeadersPtr != nullptr) {
+        releasedHeadersPtr->push_back(headerKey);
+      }
+    }
+    return true;
+  });
+  pendingClaimsPtr->erase(end, pendingClaimsPtr->end());
+}
+}    // namespace
 
 InterprocessIndexingStatusManager::InterprocessIndexingStatusManager(const std::string& instanceUuid, Id processId, bool isOwner)
     : BaseInterprocessDataManager(sSharedMemoryNamePrefix + instanceUuid, OneMb, instanceUuid, processId, isOwner) {}
@@ -60,6 +142,13 @@ void InterprocessIndexingStatusManager::startIndexingSourceFile(const FilePath&
       if(crashedFilesPtr != nullptr) {
         crashedFilesPtr->push_back(iterator->second);
       }
+
+      // the headers the crashed translation unit claimed are recorded by the next one reaching them
+      releasePendingHeaderClaims(access, getProcessId(), sPendingHeaderClaimsKeyName, sIndexedHeadersKeyName, sReleasedHeadersKeyName);
+      currentFilesPtr = access.accessValueWithAllocator<SharedMemory::Map<Id, SharedMemory::String>>(sCurrentFilesKeyName);
+      if(currentFilesPtr == nullptr) {
+        return;
+      }
     }
 
     SharedMemory::String str(access.getAllocator());
@@ -70,12 +159,46 @@ void InterprocessIndexingStatusManager::startIndexingSourceFile(const FilePath&
   }
 }
 
-void InterprocessIndexingStatusManager::finishIndexingSourceFile() {
+void InterprocessIndexingStatusManager::finishIndexingSourceFile(uint64_t durationMs, uint64_t storageSize) {
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
+  std::string filePath;
   auto* currentFilesPtr = access.accessValueWithAllocator<SharedMemory::Map<Id, SharedMemory::String>>(sCurrentFilesKeyName);
   if(currentFilesPtr != nullptr) {
-    currentFilesPtr->erase(currentFilesPtr->find(getProcessId()), currentFilesPtr->end());
+    auto iterator = currentFilesPtr->find(getProcessId());
+    if(iterator != currentFilesPtr->end()) {
+      filePath = iterator->second.c_str();
+      currentFilesPtr->erase(iterator);
+    }
+  }
+
+  if(!filePath.empty()) {
+    // "<process id>|<duration ms>|<storage size>|<utf8 path>"
+    const std::string record = fmt::format("{}|{}|{}|{}", mProcessId, durationMs, storageSize, filePath);
+
+    const size_t overestimationMultiplier = 3;
+    const size_t estimatedSize = (EstimatedPrefix + sizeof(SharedMemory::String) + record.size()) * overestimationMultiplier;
+    while(access.getFreeMemorySize() < estimatedSize) {
+      LOG_INFO(fmt::format("grow memory - est: {} size: {} free: {}", estimatedSize, access.getMemorySize(), access.getFreeMemorySize()));
+      access.growMemory(access.getMemorySize());
+    }
+
+    auto* indexingCostsPtr = access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(sIndexingCostsKeyName);
+    if(indexingCostsPtr != nullptr) {
+      SharedMemory::String recordStr(access.getAllocator());
+      recordStr = record.c_str();
+      indexingCostsPtr->push_back(recordStr);
+    }
+  }
+
+  if(storageSize == 0) {
+    // nothing of the claimed headers reaches the index
+    releasePendingHeaderClaims(access, mProcessId, sPendingHeaderClaimsKeyName, sIndexedHeadersKeyName, sReleasedHeadersKeyName);
+  } else if(auto* pendingClaimsPtr =
+                access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sPendingHeaderClaimsKeyName)) {
+    SharedMemory::String endStr(access.getAllocator());
+    endStr = getClaimPrefix(mProcessId).c_str();
+    pendingClaimsPtr->push_back(endStr);
   }
 
   auto* finishedProcessIdsPtr = access.accessValueWithAllocator<SharedMemory::Queue<Id>>(sFinishedProcessIdsKeyName);
@@ -117,6 +240,100 @@ Id InterprocessIndexingStatusManager::getNextFinishedProcessId() {
   return 0;
 }
 
+std::vector<std::pair<Id, StorageIndexingCost>> InterprocessIndexingStatusManager::popIndexingCosts() {
+  std::vector<std::string> records;
+  {
+    SharedMemory::ScopedAccess access(&mSharedMemory);
+
+    auto* indexingCostsPtr = access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(sIndexingCostsKeyName);
+    if(indexingCostsPtr != nullptr) {
+      while(!indexingCostsPtr->empty()) {
+        records.emplace_back(indexingCostsPtr->front().c_str());
+        indexingCostsPtr->pop_front();
+      }
+    }
+  }
+
+  std::vector<std::pair<Id, StorageIndexingCost>> costs;
+  costs.reserve(records.size());
+  for(const std::string& record : records) {
+    const size_t first = record.find('|');
+    const size_t second = record.find('|', first + 1);
+    const size_t third = record.find('|', second + 1);
+    if(third == std::string::npos) {
+      LOG_ERROR(fmt::format("Malformed indexing cost record: {}", record));
+      continue;
+    }
+
+    costs.emplace_back(static_cast<Id>(std::stoull(record.substr(0, first))),
+                       StorageIndexingCost(utility::decodeFromUtf8(record.substr(third + 1)),
+                                           std::stoull(record.substr(first + 1, second - first - 1)),
+                                           std::stoull(record.substr(second + 1, third - second - 1))));
+  }
+
+  return costs;
+}
+
+void InterprocessIndexingStatusManager::reportIndexerLifetime(const IndexerLifetime& lifetime) {
+  // "<process id>|<translation units>|<startup ms>|<busy ms>|<waiting ms>"
+  const std::string record = fmt::format("{}|{}|{}|{}|{}",
+                                         lifetime.processId,
+                                         lifetime.translationUnitCount,
+                                         lifetime.startupMs,
+                                         lifetime.busyMs,
+                                         lifetime.waitingMs);
+
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  const size_t overestimationMultiplier = 3;
+  const size_t estimatedSize = (EstimatedPrefix + sizeof(SharedMemory::String) + record.size()) * overestimationMultiplier;
+  while(access.getFreeMemorySize() < estimatedSize) {
+    LOG_INFO(fmt::format("grow memory - est: {} size: {} free: {}", estimatedSize, access.getMemorySize(), access.getFreeMemorySize()));
+    access.growMemory(access.getMemorySize());
+  }
+
+  auto* lifetimesPtr = access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(sIndexerLifetimesKeyName);
+  if(lifetimesPtr != nullptr) {
+    SharedMemory::String recordStr(access.getAllocator());
+    recordStr = record.c_str();
+    lifetimesPtr->push_back(recordStr);
+  }
+}
+
+std::vector<InterprocessIndexingStatusManager::IndexerLifetime> InterprocessIndexingStatusManager::popIndexerLifetimes() {
+  std::vector<std::string> records;
+  {
+    SharedMemory::ScopedAccess access(&mSharedMemory);
+
+    auto* lifetimesPtr = access.accessValueWithAllocator<SharedMemory::Queue<SharedMemory::String>>(sIndexerLifetimesKeyName);
+    if(lifetimesPtr != nullptr) {
+      while(!lifetimesPtr->empty()) {
+        records.emplace_back(lifetimesPtr->front().c_str());
+        lifetimesPtr->pop_front();
+      }
+    }
+  }
+
+  std::vector<IndexerLifetime> lifetimes;
+  lifetimes.reserve(records.size());
+  for(const std::string& record : records) {
+    std::vector<uint64_t> values;
+    for(size_t begin = 0; begin <= record.size();) {
+      const size_t end = std::min(record.find('|', begin), record.size());
+      values.push_back(std::strtoull(record.c_str() + begin, nullptr, 10));
+      begin = end + 1;
+    }
+    if(values.size() != 5) {
+      LOG_ERROR(fmt::format("Malformed indexer lifetime record: {}", record));
+      continue;
+    }
+
+    lifetimes.push_back({static_cast<Id>(values[0]), values[1], values[2], values[3], values[4]});
+  }
+
+  return lifetimes;
+}
+
 std::vector<FilePath> InterprocessIndexingStatusManager::getCurrentlyIndexedSourceFilePaths() {
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
@@ -146,12 +363,126 @@ std::vector<FilePath> InterprocessIndexingStatusManager::getCrashedSourceFilePat
     }
   }
 
+  std::vector<Id> crashedProcessIds;
   auto* currentFilesPtr = access.accessValueWithAllocator<SharedMemory::Map<Id, SharedMemory::String>>(sCurrentFilesKeyName);
   if(currentFilesPtr != nullptr) {
     for(SharedMemory::Map<Id, SharedMemory::String>::iterator it = currentFilesPtr->begin(); it != currentFilesPtr->end(); it++) {
       crashedFiles.emplace_back(utility::decodeFromUtf8(it->second.c_str()));
+      crashedProcessIds.push_back(it->first);
     }
   }
 
+  for(const Id processId : crashedProcessIds) {
+    releasePendingHeaderClaims(access, processId, sPendingHeaderClaimsKeyName, sIndexedHeadersKeyName, sReleasedHeadersKeyName);
+  }
+
   return crashedFiles;
 }
+
+bool InterprocessIndexingStatusManager::claimIndexedHeader(const FilePath& headerPath, size_t preprocessorContextHash) {
+  const std::string headerKey = fmt::format("{:x}|{}", preprocessorContextHash, utility::encodeToUtf8(headerPath.wstr()));
+
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  // the key is stored in the registry and as pending claim of the process
+  const size_t overestimationMultiplier = 3;
+  const size_t estimatedSize = (EstimatedSetNodeSize + 2 * (sizeof(SharedMemory::String) + headerKey.size()) + 16) *
+      overestimationMultiplier;
+  while(access.getFreeMemorySize() < estimatedSize) {
+    LOG_INFO(fmt::format("grow memory - est: {} size: {} free: {}", estimatedSize, access.getMemorySize(), access.getFreeMemorySize()));
+    access.growMemory(access.getMemorySize());
+  }
+
+  auto* indexedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Set<SharedMemory::String>>(sIndexedHeadersKeyName);
+  if(indexedHeadersPtr == nullptr) {
+    // without a registry every translation unit indexes its headers itself
+    return true;
+  }
+
+  SharedMemory::String keyStr(access.getAllocator());
+  keyStr = headerKey.c_str();
+  if(!indexedHeadersPtr->insert(keyStr).second) {
+    return false;
+  }
+
+  auto* pendingClaimsPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sPendingHeaderClaimsKeyName);
+  if(pendingClaimsPtr != nullptr) {
+    SharedMemory::String claimStr(access.getAllocator());
+    claimStr = (getClaimPrefix(mProcessId) + headerKey).c_str();
+    pendingClaimsPtr->push_back(claimStr);
+  }
+  return true;
+}
+
+void InterprocessIndexingStatusManager::clearIndexedHeaders() {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  auto* indexedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Set<SharedMemory::String>>(sIndexedHeadersKeyName);
+  if(indexedHeadersPtr != nullptr) {
+    indexedHeadersPtr->clear();
+  }
+
+  auto* pendingClaimsPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sPendingHeaderClaimsKeyName);
+  if(pendingClaimsPtr != nullptr) {
+    pendingClaimsPtr->clear();
+  }
+
+  auto* releasedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sReleasedHeadersKeyName);
+  if(releasedHeadersPtr != nullptr) {
+    releasedHeadersPtr->clear();
+  }
+}
+
+void InterprocessIndexingStatusManager::confirmHeaderClaims(Id processId) {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  auto* pendingClaimsPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sPendingHeaderClaimsKeyName);
+  if(pendingClaimsPtr == nullptr) {
+    return;
+  }
+
+  const std::string prefix = getClaimPrefix(processId);
+  auto end = std::find_if(pendingClaimsPtr->begin(), pendingClaimsPtr->end(), [&](const SharedMemory::String& claim) {
+    return isClaimOfProcess(claim, prefix) && isEndOfClaims(claim);
+  });
+  if(end == pendingClaimsPtr->end()) {
+    return;
+  }
+
+  pendingClaimsPtr->erase(std::remove_if(pendingClaimsPtr->begin(),
+                                         end + 1,
+                                         [&](const SharedMemory::String& claim) { return isClaimOfProcess(claim, prefix); }),
+                          end + 1);
+}
+
+void InterprocessIndexingStatusManager::releaseHeaderClaims() {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  releasePendingHeaderClaims(access, std::nullopt, sPendingHeaderClaimsKeyName, sIndexedHeadersKeyName, sReleasedHeadersKeyName);
+}
+
+std::vector<FilePath> InterprocessIndexingStatusManager::popLostHeaderPaths() {
+  SharedMemory::ScopedAccess access(&mSharedMemory);
+
+  auto* releasedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Vector<SharedMemory::String>>(sReleasedHeadersKeyName);
+  if(releasedHeadersPtr == nullptr) {
+    return {};
+  }
+
+  std::set<std::string> lostHeaderPaths;
+  auto* indexedHeadersPtr = access.accessValueWithAllocator<SharedMemory::Set<SharedMemory::String>>(sIndexedHeadersKeyName);
+  for(const SharedMemory::String& headerKey : *releasedHeadersPtr) {
+    if(indexedHeadersPtr == nullptr || indexedHeadersPtr->find(headerKey) == indexedHeadersPtr->end()) {
+      // "<preprocessor context hash>|<utf8 path>"
+      lostHeaderPaths.emplace(headerKey.begin() + static_cast<long>(headerKey.find('|')) + 1, headerKey.end());
+    }
+  }
+  releasedHeadersPtr->clear();
+
+  std::vector<FilePath> headerPaths;
+  headerPaths.reserve(lostHeaderPaths.size());
+  for(const std::string& headerPath : lostHeaderPaths) {
+    headerPaths.emplace_back(utility::decodeFromUtf8(headerPath));
+  }
+  return headerPaths;
+}
@@ -1,26 +1,85 @@
 #pragma once
 
+#include <cstdint>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "BaseInterprocessDataManager.h"
 #include "FilePath.h"
+#include "StorageIndexingCost.h"
 
 class InterprocessIndexingStatusManager : public BaseInterprocessDataManager {
 public:
+  /**
+   * @brief What an indexer did between starting up and shutting down
+   */
+  struct IndexerLifetime {
+    Id processId = 0;
+    uint64_t translationUnitCount = 0;
+    uint64_t startupMs = 0;    // until the indexer was ready for its first command
+    uint64_t busyMs = 0;
+    uint64_t waitingMs = 0;    // blocked on an empty command queue
+  };
+
   InterprocessIndexingStatusManager(const std::string& instanceUuid, Id processId, bool isOwner);
   ~InterprocessIndexingStatusManager() override;
 
   void startIndexingSourceFile(const FilePath& filePath);
-  void finishIndexingSourceFile();
+  /**
+   * @brief Marks the current source file of the process as done and records what indexing it cost.
+   * @param durationMs Wall time the indexer spent on the translation unit
+   * @param storageSize Byte size of the intermediate storage it produced
+   */
+  void finishIndexingSourceFile(uint64_t durationMs, uint64_t storageSize);
 
   void setIndexingInterrupted(bool interrupted);
   bool getIndexingInterrupted();
 
   Id getNextFinishedProcessId();
 
+  /**
+   * @brief Takes the indexing costs recorded by finishIndexingSourceFile since the last call.
+   * @return The ID of the indexer process together with the cost of the translation unit it indexed
+   */
+  std::vector<std::pair<Id, StorageIndexingCost>> popIndexingCosts();
+
+  void reportIndexerLifetime(const IndexerLifetime& lifetime);
+  /**
+   * @brief Takes the lifetimes reported by indexers that shut down since the last call.
+   */
+  std::vector<IndexerLifetime> popIndexerLifetimes();
+
   std::vector<FilePath> getCurrentlyIndexedSourceFilePaths();
   std::vector<FilePath> getCrashedSourceFilePaths();
 
+  /**
+   * @brief Claims a project header for the calling translation unit.
+   *
+   * The key is the canonical header path combined with a hash of the preprocessor context (defines, include paths,
+   * language standard) of the translation unit. Only the first caller for a key gets true and has to record the
+   * header's content, all other translation units of the current indexing run can skip it.
+   *
+   * A claim stays pending until the storage of the claiming translation unit was fetched, see confirmHeaderClaims. Claims
+   * of a crashed translation unit or of one without storage are released again and can be taken by later ones.
+   */
+  bool claimIndexedHeader(const FilePath& headerPath, size_t preprocessorContextHash);
+  void clearIndexedHeaders();
+
+  /**
+   * @brief Confirms the claims of the oldest translation unit of the process whose storage was not fetched yet.
+   */
+  void confirmHeaderClaims(Id processId);
+  /**
+   * @brief Releases all pending claims, e.g. because the storages of an interrupted run are not fetched anymore.
+   */
+  void releaseHeaderClaims();
+  /**
+   * @brief Takes the headers whose claims were released and not claimed again since the last call.
+   * @return Headers that are part of the index without their content
+   */
+  std::vector<FilePath> popLostHeaderPaths();
+
 private:
   static const char* sSharedMemoryNamePrefix;
 
@@ -29,4 +88,9 @@ private:
   static const char* sCrashedFilesKeyName;
   static const char* sFinishedProcessIdsKeyName;
   static const char* sIndexingInterruptedKeyName;
+  static const char* sIndexedHeadersKeyName;
+  static const char* sPendingHeaderClaimsKeyName;
+  static const char* sReleasedHeadersKeyName;
+  static const char* sIndexingCostsKeyName;
+  static const char* sIndexerLifetimesKeyName;
 };
\ No newline at end of file
@@ -1,37 +1,42 @@
 #include "InterprocessIntermediateStorageManager.h"
 
+#include "FlatIntermediateStorage.h"
 #include "IntermediateStorage.h"
 #include "logging.h"
-#include "SharedIntermediateStorage.h"
 
 const char* InterprocessIntermediateStorageManager::sSharedMemoryNamePrefix = "iist_";
 
 const char* InterprocessIntermediateStorageManager::sIntermediateStoragesKeyName = "intermediate_storages";
 
+namespace {
+// every storage is one flat buffer written once by the indexer and read once by the app
+using SharedStorageBuffer = SharedMemory::Vector<char>;
+
+constexpr size_t OneMb = 1048576;
+}    // namespace
+
 InterprocessIntermediateStorageManager::InterprocessIntermediateStorageManager(const std::string& instanceUuid,
                                                                                Id processId,
                                                                                bool isOwner)
     : BaseInterprocessDataManager(sSharedMemoryNamePrefix + std::to_string(processId) + "_" + instanceUuid,
-                                  3 * 1048576 /* 3 MB */,
+                                  3 * OneMb /* 3 MB */,
                                   instanceUuid,
                                   processId,
                                   isOwner) {}
 
 InterprocessIntermediateStorageManager::~InterprocessIntermediateStorageManager() = default;
 
-void InterprocessIntermediateStorageManager::pushIntermediateStorage(const std::shared_ptr<IntermediateStorage>& intermediateStorage) {
-  const size_t requiredInsertsToShrink = 10;
+size_t InterprocessIntermediateStorageManager::pushIntermediateStorage(const std::shared_ptr<IntermediateStorage>& intermediateStorage) {
+  const FlatIntermediateStorageWriter writer(*intermediateStorage);
 
-  const size_t overestimationMultiplier = 2;
-  const size_t requiredSize = (intermediateStorage->getByteSize(sizeof(SharedMemory::String)) + sizeof(SharedIntermediateStorage)) *
-          overestimationMultiplier +
-      1048576 /* 1 MB */;
+  // allocator bookkeeping and alignment padding of the buffer and the queue node
+  const size_t requiredSize = writer.getByteSize() + sizeof(SharedStorageBuffer) + OneMb;
 
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
-  const size_t freeMemory = access.getFreeMemorySize();
-  if(freeMemory < requiredSize) {
-    const size_t requiredGrowth = requiredSize - freeMemory;
+  if(const size_t freeMemory = access.getFreeMemorySize(); freeMemory < requiredSize) {
+    // grow at least by the current size, so a series of growing storages does not remap the segment every time
+    const size_t requiredGrowth = std::max(requiredSize - freeMemory, access.getMemorySize());
 
     LOG_INFO(fmt::format("grow memory - est: {} size: {} free: {} alloc: {}",
                          requiredSize,
@@ -42,66 +47,36 @@ void InterprocessIntermediateStorageManager::pushIntermediateStorage(const std::
     access.growMemory(requiredGrowth);
 
     LOG_INFO("growing memory succeeded");
-
-    mInsertsWithoutGrowth = 0;
-  } else {
-    mInsertsWithoutGrowth++;
   }
 
-  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(sIntermediateStoragesKeyName);
+  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedStorageBuffer>>(sIntermediateStoragesKeyName);
   if(!queue) {
-    return;
+    return 0;
   }
 
-  queue->push_back(SharedIntermediateStorage(access.getAllocator()));
-  SharedIntermediateStorage& storage = queue->back();
-
-  storage.setStorageNodes(intermediateStorage->getStorageNodes());
-  storage.setStorageFiles(intermediateStorage->getStorageFiles());
-  storage.setStorageSymbols(intermediateStorage->getStorageSymbols());
-  storage.setStorageEdges(intermediateStorage->getStorageEdges());
-  storage.setStorageLocalSymbols(intermediateStorage->getStorageLocalSymbols());
-  storage.setStorageSourceLocations(intermediateStorage->getStorageSourceLocations());
-  storage.setStorageOccurrences(intermediateStorage->getStorageOccurrences());
-  storage.setStorageComponentAccesses(intermediateStorage->getComponentAccesses());
-  storage.setStorageErrors(intermediateStorage->getErrors());
-
-  storage.setNextId(intermediateStorage->getNextId());
-
-  if(mInsertsWithoutGrowth >= requiredInsertsToShrink) {
-    mInsertsWithoutGrowth = 0;
-
-    LOG_INFO("shrinking shared memory");
-    access.shrinkToFitMemory();
-    LOG_INFO(fmt::format("shrunk memory - size: {} free: {}", access.getMemorySize(), access.getFreeMemorySize()));
-  }
+  queue->push_back(SharedStorageBuffer(access.getAllocator()));
+  SharedStorageBuffer& buffer = queue->back();
+  buffer.resize(writer.getByteSize());
+  writer.write(buffer.data());
 
   LOG_INFO(access.logString());
+
+  return writer.getByteSize();
 }
 
 std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::popIntermediateStorage() {
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
-  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(sIntermediateStoragesKeyName);
+  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedStorageBuffer>>(sIntermediateStoragesKeyName);
   if(!queue || queue->empty()) {
     return nullptr;
   }
 
-  SharedIntermediateStorage& sharedIntermediateStorage = queue->front();
-
-  std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
-
-  storage->setStorageNodes(sharedIntermediateStorage.getStorageNodes());
-  storage->setStorageFiles(sharedIntermediateStorage.getStorageFiles());
-  storage->setStorageSymbols(sharedIntermediateStorage.getStorageSymbols());
-  storage->setStorageEdges(sharedIntermediateStorage.getStorageEdges());
-  storage->setStorageLocalSymbols(sharedIntermediateStorage.getStorageLocalSymbols());
-  storage->setStorageSourceLocations(sharedIntermediateStorage.getStorageSourceLocations());
-  storage->setStorageOccurrences(sharedIntermediateStorage.getStorageOccurrences());
-  storage->setComponentAccesses(sharedIntermediateStorage.getStorageComponentAccesses());
-  storage->setErrors(sharedIntermediateStorage.getStorageErrors());
-
-  storage->setNextId(sharedIntermediateStorage.getNextId());
+  const SharedStorageBuffer& buffer = queue->front();
+  std::shared_ptr<IntermediateStorage> storage = FlatIntermediateStorageView(buffer.data(), buffer.size()).toIntermediateStorage();
+  if(!storage) {
+    LOG_ERROR(fmt::format("{} - dropping invalid intermediate storage of {} bytes", getProcessId(), buffer.size()));
+  }
 
   queue->pop_front();
   LOG_INFO(access.logString());
@@ -112,7 +87,7 @@ std::shared_ptr<IntermediateStorage> InterprocessIntermediateStorageManager::pop
 size_t InterprocessIntermediateStorageManager::getIntermediateStorageCount() {
   SharedMemory::ScopedAccess access(&mSharedMemory);
 
-  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedIntermediateStorage>>(sIntermediateStoragesKeyName);
+  auto* queue = access.accessValueWithAllocator<SharedMemory::Queue<SharedStorageBuffer>>(sIntermediateStoragesKeyName);
   if(!queue) {
     return 0;
   }
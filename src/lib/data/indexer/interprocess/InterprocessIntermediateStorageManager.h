@@ -9,7 +9,11 @@ public:
   InterprocessIntermediateStorageManager(const std::string& instanceUuid, Id processId, bool isOwner);
   ~InterprocessIntermediateStorageManager() override;
 
-  void pushIntermediateStorage(const std::shared_ptr<IntermediateStorage>& intermediateStorage);
+  /**
+   * @brief Appends the flat serialization of the storage to the shared queue.
+   * @return The byte size of the serialized storage or 0 if it could not be pushed
+   */
+  size_t pushIntermediateStorage(const std::shared_ptr<IntermediateStorage>& intermediateStorage);
   std::shared_ptr<IntermediateStorage> popIntermediateStorage();
 
   size_t getIntermediateStorageCount();
@@ -17,6 +21,4 @@ public:
 private:
   static const char* sSharedMemoryNamePrefix;
   static const char* sIntermediateStoragesKeyName;
-
-  size_t mInsertsWithoutGrowth = 0;
 };
@@ -0,0 +1,323 @@
+#include "FlatIntermediateStorage.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "IntermediateStorage.h"
+#include "logging.h"
+
+static_assert(std::is_trivially_copyable_v<StorageSymbol>);
+static_assert(std::is_trivially_copyable_v<StorageEdge>);
+static_assert(std::is_trivially_copyable_v<StorageSourceLocation>);
+static_assert(std::is_trivially_copyable_v<StorageOccurrence>);
+static_assert(std::is_trivially_copyable_v<StorageComponentAccess>);
+
+namespace {
+using namespace flat_storage;
+
+constexpr size_t align(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+void addSection(Header& header, Section section, size_t count, size_t& offset) {
+  offset = align(offset, alignof(T));
+  header.sections[section] = SectionRange{offset, count};
+  offset += count * sizeof(T);
+}
+
+template <typename T>
+T* getSectionData(char* buffer, const Header& header, Section section) {
+  return reinterpret_cast<T*>(buffer + header.sections[section].offset);    // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+template <typename T, typename Container>
+void writeTrivialSection(char* buffer, const Header& header, Section section, const Container& container) {
+  T* data = getSectionData<T>(buffer, header, section);
+  for(const T& item : container) {
+    std::memcpy(data++, &item, sizeof(T));
+  }
+}
+
+class StringTableWriter {
+public:
+  explicit StringTableWriter(wchar_t* table) : mTable(table) {}
+
+  StringRef add(const std::wstring& str) {
+    const StringRef ref{mOffset, str.size()};
+    std::memcpy(mTable + mOffset, str.data(), str.size() * sizeof(wchar_t));
+    mOffset += str.size();
+    return ref;
+  }
+
+private:
+  wchar_t* mTable;
+  uint64_t mOffset = 0;
+};
+}    // namespace
+
+FlatIntermediateStorageWriter::FlatIntermediateStorageWriter(const IntermediateStorage& storage) : mStorage(storage) {
+  size_t stringLength = 0;
+  size_t contentLength = 0;
+  for(const StorageNode& node : storage.getStorageNodes()) {
+    stringLength += node.serializedName.size();
+  }
+  for(const StorageFile& file : storage.getStorageFiles()) {
+    stringLength += file.filePath.size() + file.languageIdentifier.size();
+    contentLength += file.content ? file.content->size() : 0;
+  }
+  for(const StorageLocalSymbol& symbol : storage.getStorageLocalSymbols()) {
+    stringLength += symbol.name.size();
+  }
+  for(const StorageElementComponent& component : storage.getElementComponents()) {
+    stringLength += component.data.size();
+  }
+  for(const StorageError& error : storage.getErrors()) {
+    stringLength += error.message.size() + error.translationUnit.size();
+  }
+
+  size_t offset = sizeof(Header);
+  addSection<Node>(mHeader, SECTION_NODES, storage.getStorageNodes().size(), offset);
+  addSection<File>(mHeader, SECTION_FILES, storage.getStorageFiles().size(), offset);
+  addSection<StorageSymbol>(mHeader, SECTION_SYMBOLS, storage.getStorageSymbols().size(), offset);
+  addSection<StorageEdge>(mHeader, SECTION_EDGES, storage.getStorageEdges().size(), offset);
+  addSection<LocalSymbol>(mHeader, SECTION_LOCAL_SYMBOLS, storage.getStorageLocalSymbols().size(), offset);
+  addSection<StorageSourceLocation>(mHeader, SECTION_SOURCE_LOCATIONS, storage.getStorageSourceLocations().size(), offset);
+  addSection<StorageOccurrence>(mHeader, SECTION_OCCURRENCES, storage.getStorageOccurrences().size(), offset);
+  addSection<StorageComponentAccess>(mHeader, SECTION_COMPONENT_ACCESSES, storage.getComponentAccesses().size(), offset);
+  addSection<ElementComponent>(mHeader, SECTION_ELEMENT_COMPONENTS, storage.getElementComponents().size(), offset);
+  addSection<Error>(mHeader, SECTION_ERRORS, storage.getErrors().size(), offset);
+  addSection<wchar_t>(mHeader, SECTION_STRINGS, stringLength, offset);
+  addSection<char>(mHeader, SECTION_CONTENTS, contentLength, offset);
+
+  mHeader.byteSize = offset;
+  mHeader.nextId = storage.getNextId();
+}
+
+size_t FlatIntermediateStorageWriter::getByteSize() const {
+  return mHeader.byteSize;
+}
+
+void FlatIntermediateStorageWriter::write(char* buffer) const {
+  std::memcpy(buffer, &mHeader, sizeof(Header));
+
+  StringTableWriter strings(getSectionData<wchar_t>(buffer, mHeader, SECTION_STRINGS));
+  char* contents = getSectionData<char>(buffer, mHeader, SECTION_CONTENTS);
+  uint64_t contentOffset = 0;
+
+  Node* nodes = getSectionData<Node>(buffer, mHeader, SECTION_NODES);
+  for(const StorageNode& node : mStorage.getStorageNodes()) {
+    *nodes++ = Node{node.id, node.type, strings.add(node.serializedName)};
+  }
+
+  File* files = getSectionData<File>(buffer, mHeader, SECTION_FILES);
+  for(const StorageFile& file : mStorage.getStorageFiles()) {
+    StringRef content;
+    if(file.content) {
+      content = StringRef{contentOffset, file.content->size()};
+      std::memcpy(contents + contentOffset, file.content->data(), file.content->size());
+      contentOffset += file.content->size();
+    }
+
+    *files++ = File{file.id,
+                    strings.add(file.filePath),
+                    strings.add(file.languageIdentifier),
+                    content,
+                    static_cast<uint8_t>(file.indexed),
+                    static_cast<uint8_t>(file.complete),
+                    static_cast<uint8_t>(file.content != nullptr)};
+  }
+
+  LocalSymbol* localSymbols = getSectionData<LocalSymbol>(buffer, mHeader, SECTION_LOCAL_SYMBOLS);
+  for(const StorageLocalSymbol& symbol : mStorage.getStorageLocalSymbols()) {
+    *localSymbols++ = LocalSymbol{symbol.id, strings.add(symbol.name)};
+  }
+
+  ElementComponent* components = getSectionData<ElementComponent>(buffer, mHeader, SECTION_ELEMENT_COMPONENTS);
+  for(const StorageElementComponent& component : mStorage.getElementComponents()) {
+    *components++ = ElementComponent{component.elementId, component.type, strings.add(component.data)};
+  }
+
+  Error* errors = getSectionData<Error>(buffer, mHeader, SECTION_ERRORS);
+  for(const StorageError& error : mStorage.getErrors()) {
+    *errors++ = Error{error.id,
+                      strings.add(error.message),
+                      strings.add(error.translationUnit),
+                      static_cast<uint8_t>(error.fatal),
+                      static_cast<uint8_t>(error.indexed)};
+  }
+
+  writeTrivialSection<StorageSymbol>(buffer, mHeader, SECTION_SYMBOLS, mStorage.getStorageSymbols());
+  writeTrivialSection<StorageEdge>(buffer, mHeader, SECTION_EDGES, mStorage.getStorageEdges());
+  writeTrivialSection<StorageSourceLocation>(buffer, mHeader, SECTION_SOURCE_LOCATIONS, mStorage.getStorageSourceLocations());
+  writeTrivialSection<StorageOccurrence>(buffer, mHeader, SECTION_OCCURRENCES, mStorage.getStorageOccurrences());
+  writeTrivialSection<StorageComponentAccess>(buffer, mHeader, SECTION_COMPONENT_ACCESSES, mStorage.getComponentAccesses());
+}
+
+FlatIntermediateStorageView::FlatIntermediateStorageView(const char* buffer, size_t size) : mBuffer(buffer), mSize(size) {
+  if(mBuffer == nullptr || mSize < sizeof(Header) || reinterpret_cast<uintptr_t>(mBuffer) % alignof(Header) != 0) {
+    return;
+  }
+
+  const auto* header = reinterpret_cast<const Header*>(mBuffer);    // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  if(header->magic != Header::Magic || header->version != Header::Version || header->byteSize > mSize) {
+    LOG_ERROR("Flat intermediate storage has an incompatible header.");
+    return;
+  }
+
+  mHeader = header;
+}
+
+bool FlatIntermediateStorageView::isValid() const {
+  return mHeader != nullptr;
+}
+
+Id FlatIntermediateStorageView::getNextId() const {
+  return isValid() ? mHeader->nextId : 1;
+}
+
+template <typename T>
+std::span<const T> FlatIntermediateStorageView::getSection(Section section) const {
+  if(!isValid()) {
+    return {};
+  }
+
+  const SectionRange& range = mHeader->sections[section];
+  if(range.offset + range.count * sizeof(T) > mHeader->byteSize) {
+    LOG_ERROR("Flat intermediate storage section exceeds the buffer.");
+    return {};
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<const T*>(mBuffer + range.offset), static_cast<size_t>(range.count)};
+}
+
+std::span<const Node> FlatIntermediateStorageView::getNodes() const {
+  return getSection<Node>(SECTION_NODES);
+}
+
+std::span<const File> FlatIntermediateStorageView::getFiles() const {
+  return getSection<File>(SECTION_FILES);
+}
+
+std::span<const StorageSymbol> FlatIntermediateStorageView::getSymbols() const {
+  return getSection<StorageSymbol>(SECTION_SYMBOLS);
+}
+
+std::span<const StorageEdge> FlatIntermediateStorageView::getEdges() const {
+  return getSection<StorageEdge>(SECTION_EDGES);
+}
+
+std::span<const LocalSymbol> FlatIntermediateStorageView::getLocalSymbols() const {
+  return getSection<LocalSymbol>(SECTION_LOCAL_SYMBOLS);
+}
+
+std::span<const StorageSourceLocation> FlatIntermediateStorageView::getSourceLocations() const {
+  return getSection<StorageSourceLocation>(SECTION_SOURCE_LOCATIONS);
+}
+
+std::span<const StorageOccurrence> FlatIntermediateStorageView::getOccurrences() const {
+  return getSection<StorageOccurrence>(SECTION_OCCURRENCES);
+}
+
+std::span<const StorageComponentAccess> FlatIntermediateStorageView::getComponentAccesses() const {
+  return getSection<StorageComponentAccess>(SECTION_COMPONENT_ACCESSES);
+}
+
+std::span<const ElementComponent> FlatIntermediateStorageView::getElementComponents() const {
+  return getSection<ElementComponent>(SECTION_ELEMENT_COMPONENTS);
+}
+
+std::span<const Error> FlatIntermediateStorageView::getErrors() const {
+  return getSection<Error>(SECTION_ERRORS);
+}
+
+std::wstring_view FlatIntermediateStorageView::getString(const StringRef& ref) const {
+  const std::span<const wchar_t> strings = getSection<wchar_t>(SECTION_STRINGS);
+  if(ref.offset + ref.length > strings.size()) {
+    return {};
+  }
+  return {strings.data() + ref.offset, static_cast<size_t>(ref.length)};
+}
+
+std::string_view FlatIntermediateStorageView::getContent(const StringRef& ref) const {
+  const std::span<const char> contents = getSection<char>(SECTION_CONTENTS);
+  if(ref.offset + ref.length > contents.size()) {
+    return {};
+  }
+  return {contents.data() + ref.offset, static_cast<size_t>(ref.length)};
+}
+
+std::shared_ptr<IntermediateStorage> FlatIntermediateStorageView::toIntermediateStorage() const {
+  if(!isValid()) {
+    return nullptr;
+  }
+
+  auto storage = std::make_shared<IntermediateStorage>();
+
+  {
+    std::vector<StorageNode> nodes;
+    nodes.reserve(getNodes().size());
+    for(const Node& node : getNodes()) {
+      nodes.emplace_back(node.id, node.type, std::wstring(getString(node.serializedName)));
+    }
+    storage->setStorageNodes(std::move(nodes));
+  }
+
+  {
+    std::vector<StorageFile> files;
+    files.reserve(getFiles().size());
+    for(const File& file : getFiles()) {
+      files.emplace_back(file.id,
+                         std::wstring(getString(file.filePath)),
+                         std::wstring(getString(file.languageIdentifier)),
+                         "",
+                         file.indexed != 0,
+                         file.complete != 0);
+      if(file.hasContent != 0) {
+        files.back().content = std::make_shared<const std::string>(getContent(file.content));
+      }
+    }
+    storage->setStorageFiles(std::move(files));
+  }
+
+  storage->setStorageSymbols({getSymbols().begin(), getSymbols().end()});
+  storage->setStorageEdges({getEdges().begin(), getEdges().end()});
+
+  {
+    std::set<StorageLocalSymbol> localSymbols;
+    for(const LocalSymbol& symbol : getLocalSymbols()) {
+      localSymbols.emplace_hint(localSymbols.end(), symbol.id, std::wstring(getString(symbol.name)));
+    }
+    storage->setStorageLocalSymbols(std::move(localSymbols));
+  }
+
+  storage->setStorageSourceLocations({getSourceLocations().begin(), getSourceLocations().end()});
+  storage->setStorageOccurrences({getOccurrences().begin(), getOccurrences().end()});
+  storage->setComponentAccesses({getComponentAccesses().begin(), getComponentAccesses().end()});
+
+  {
+    std::set<StorageElementComponent> components;
+    for(const ElementComponent& component : getElementComponents()) {
+      components.emplace_hint(components.end(), component.elementId, component.type, std::wstring(getString(component.data)));
+    }
+    storage->setElementComponents(std::move(components));
+  }
+
+  {
+    std::vector<StorageError> errors;
+    errors.reserve(getErrors().size());
+    for(const Error& error : getErrors()) {
+      errors.emplace_back(error.id,
+                          std::wstring(getString(error.message)),
+                          std::wstring(getString(error.translationUnit)),
+                          error.fatal != 0,
+                          error.indexed != 0);
+    }
+    storage->setErrors(std::move(errors));
+  }
+
+  storage->setNextId(getNextId());
+
+  return storage;
+}
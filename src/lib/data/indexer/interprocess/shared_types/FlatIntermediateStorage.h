@@ -0,0 +1,170 @@
+#pragma once
+/**
+ * @file FlatIntermediateStorage.h
+ * @brief Flat, position independent serialization of an IntermediateStorage.
+ *
+ * The indexer writes one contiguous buffer per translation unit: a header with section offsets, one POD array per
+ * storage type, a wchar_t string table and a byte table with the captured file contents. Strings and contents are
+ * referenced by offset and length into their table, so the buffer can be placed anywhere (e.g. in shared memory) and
+ * read without any pointer fix-up or re-encoding.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "GlobalId.hpp"
+#include "StorageComponentAccess.h"
+#include "StorageEdge.h"
+#include "StorageOccurrence.h"
+#include "StorageSourceLocation.h"
+#include "StorageSymbol.h"
+
+class IntermediateStorage;
+
+namespace flat_storage {
+
+struct StringRef {
+  uint64_t offset = 0;
+  uint64_t length = 0;
+};
+
+struct Node {
+  Id id = 0;
+  int32_t type = 0;
+  StringRef serializedName;
+};
+
+struct File {
+  Id id = 0;
+  StringRef filePath;
+  StringRef languageIdentifier;
+  StringRef content;    // into SECTION_CONTENTS
+  uint8_t indexed = 0;
+  uint8_t complete = 0;
+  uint8_t hasContent = 0;
+};
+
+struct LocalSymbol {
+  Id id = 0;
+  StringRef name;
+};
+
+struct ElementComponent {
+  Id elementId = 0;
+  int32_t type = 0;
+  StringRef data;
+};
+
+struct Error {
+  Id id = 0;
+  StringRef message;
+  StringRef translationUnit;
+  uint8_t fatal = 0;
+  uint8_t indexed = 0;
+};
+
+enum Section : uint32_t {
+  SECTION_NODES = 0,
+  SECTION_FILES,
+  SECTION_SYMBOLS,
+  SECTION_EDGES,
+  SECTION_LOCAL_SYMBOLS,
+  SECTION_SOURCE_LOCATIONS,
+  SECTION_OCCURRENCES,
+  SECTION_COMPONENT_ACCESSES,
+  SECTION_ELEMENT_COMPONENTS,
+  SECTION_ERRORS,
+  SECTION_STRINGS,
+  SECTION_CONTENTS,
+  SECTION_COUNT
+};
+
+struct SectionRange {
+  uint64_t offset = 0;
+  uint64_t count = 0;
+};
+
+struct Header {
+  static constexpr uint32_t Magic = 0x53465354;    // "STFS"
+  static constexpr uint32_t Version = 2;
+
+  uint32_t magic = Magic;
+  uint32_t version = Version;
+  uint64_t byteSize = 0;
+  Id nextId = 1;
+  SectionRange sections[SECTION_COUNT] = {};
+};
+
+}    // namespace flat_storage
+
+/**
+ * @class FlatIntermediateStorageWriter
+ * @brief Serializes an IntermediateStorage into a caller provided buffer of getByteSize() bytes.
+ */
+class FlatIntermediateStorageWriter final {
+public:
+  explicit FlatIntermediateStorageWriter(const IntermediateStorage& storage);
+
+  /**
+   * @brief Exact number of bytes write() needs.
+   */
+  [[nodiscard]] size_t getByteSize() const;
+
+  /**
+   * @brief Writes the storage to buffer, which has to be at least getByteSize() bytes and 8-byte aligned.
+   */
+  void write(char* buffer) const;
+
+private:
+  const IntermediateStorage& mStorage;
+  flat_storage::Header mHeader;
+};
+
+/**
+ * @class FlatIntermediateStorageView
+ * @brief Read-only view over a buffer written by FlatIntermediateStorageWriter.
+ *
+ * The view does not own the buffer and all accessors are valid as long as the buffer is.
+ */
+class FlatIntermediateStorageView final {
+public:
+  FlatIntermediateStorageView(const char* buffer, size_t size);
+
+  /**
+   * @brief False if the buffer is too small or was written by an incompatible version.
+   */
+  [[nodiscard]] bool isValid() const;
+
+  [[nodiscard]] Id getNextId() const;
+
+  [[nodiscard]] std::span<const flat_storage::Node> getNodes() const;
+  [[nodiscard]] std::span<const flat_storage::File> getFiles() const;
+  [[nodiscard]] std::span<const StorageSymbol> getSymbols() const;
+  [[nodiscard]] std::span<const StorageEdge> getEdges() const;
+  [[nodiscard]] std::span<const flat_storage::LocalSymbol> getLocalSymbols() const;
+  [[nodiscard]] std::span<const StorageSourceLocation> getSourceLocations() const;
+  [[nodiscard]] std::span<const StorageOccurrence> getOccurrences() const;
+  [[nodiscard]] std::span<const StorageComponentAccess> getComponentAccesses() const;
+  [[nodiscard]] std::span<const flat_storage::ElementComponent> getElementComponents() const;
+  [[nodiscard]] std::span<const flat_storage::Error> getErrors() const;
+
+  [[nodiscard]] std::wstring_view getString(const flat_storage::StringRef& ref) const;
+  [[nodiscard]] std::string_view getContent(const flat_storage::StringRef& ref) const;
+
+  /**
+   * @brief Builds an IntermediateStorage from the view in a single pass.
+   *
+   * Set based members are filled from the already sorted arrays with end hints, so no re-sorting takes place.
+   */
+  [[nodiscard]] std::shared_ptr<IntermediateStorage> toIntermediateStorage() const;
+
+private:
+  template <typename T>
+  [[nodiscard]] std::span<const T> getSection(flat_storage::Section section) const;
+
+  const char* mBuffer;
+  size_t mSize;
+  const flat_storage::Header* mHeader = nullptr;
+};
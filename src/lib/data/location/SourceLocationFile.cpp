@@ -70,7 +70,8 @@ SourceLocation* SourceLocationFile::addSourceLocation(LocationType type,
                                                       size_t startColumnNumber,
                                                       size_t endLineNumber,
                                                       size_t endColumnNumber) {
-  auto pStart = std::make_shared<SourceLocation>(this, type, locationId, tokenIds, startLineNumber, startColumnNumber, true);
+  auto pStart = std::make_shared<SourceLocation>(
+      this, type, locationId, std::move(tokenIds), startLineNumber, startColumnNumber, true);
   auto pEnd = std::make_shared<SourceLocation>(pStart.get(), endLineNumber, endColumnNumber);
 
   m_locations.insert(pStart);
@@ -1,6 +1,7 @@
 #pragma once
 // STL
 #include <string>
+#include <string_view>
 // internal
 #include "AccessKind.h"
 #include "DefinitionKind.h"
@@ -16,6 +17,10 @@ public:
 
   virtual Id recordFile(const FilePath& filePath, bool indexed) = 0;
   virtual void recordFileLanguage(Id fileId, const std::wstring& languageIdentifier) = 0;
+  /**
+   * @brief Hands over the bytes the parser read for the file, so they need not be read again when the file is stored
+   */
+  virtual void recordFileContent(Id fileId, std::string_view content) = 0;
 
   virtual Id recordSymbol(const NameHierarchy& symbolName) = 0;
   virtual void recordSymbolKind(Id symbolId, SymbolKind symbolKind) = 0;
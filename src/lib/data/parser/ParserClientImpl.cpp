@@ -16,6 +16,10 @@ void ParserClientImpl::recordFileLanguage(Id fileId, const std::wstring& languag
   m_storage->setFileLanguage(fileId, languageIdentifier);
 }
 
+void ParserClientImpl::recordFileContent(Id fileId, std::string_view content) {
+  m_storage->setFileContent(fileId, content);
+}
+
 Id ParserClientImpl::recordSymbol(const NameHierarchy& symbolName) {
   return addNodeHierarchy(symbolName);
 }
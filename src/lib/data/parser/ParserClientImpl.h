@@ -14,6 +14,7 @@ public:
 
   Id recordFile(const FilePath& filePath, bool indexed) override;
   void recordFileLanguage(Id fileId, const std::wstring& languageIdentifier) override;
+  void recordFileContent(Id fileId, std::string_view content) override;
 
   Id recordSymbol(const NameHierarchy& symbolName) override;
   void recordSymbolKind(Id symbolId, SymbolKind symbolKind) override;
@@ -14,7 +14,10 @@ class PersistentStorage;
 
 class TaskParseWrapper : public TaskDecorator {
 public:
-  TaskParseWrapper(std::weak_ptr<PersistentStorage> storage, std::shared_ptr<DialogView> dialogView);
+  /**
+   * @param bulkLoad Fill the storage in bulk load mode, only valid if the storage was empty before indexing.
+   */
+  TaskParseWrapper(std::weak_ptr<PersistentStorage> storage, std::shared_ptr<DialogView> dialogView, bool bulkLoad = false);
 
 private:
   void doEnter(std::shared_ptr<Blackboard> blackboard) override;
@@ -24,6 +27,7 @@ private:
 
   std::weak_ptr<PersistentStorage> m_storage;
   std::shared_ptr<DialogView> m_dialogView;
+  bool m_bulkLoad;
 
   TimeStamp m_start;
 };
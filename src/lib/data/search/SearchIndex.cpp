@@ -1,29 +1,90 @@
 #include "SearchIndex.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <iterator>
+#include <thread>
+#include <type_traits>
 
 #include <ctype.h>
 
 #include "utility.h"
 #include "utilityString.h"
 
+namespace {
+// below this size a search is faster on the calling thread than spread over workers
+constexpr size_t ParallelSearchNodeCount = 100000;
+
+bool isAscii(wchar_t c) {
+  return static_cast<std::make_unsigned_t<wchar_t>>(c) < 128;
+}
+}    // namespace
+
+void SearchIndex::Gate::add(wchar_t lowerChar) {
+  if(isAscii(lowerChar)) {
+    const auto bit = static_cast<unsigned>(lowerChar);
+    ascii[bit >> 6] |= uint64_t(1) << (bit & 63);
+  } else if(auto it = std::ranges::lower_bound(other, lowerChar); it == other.end() || *it != lowerChar) {
+    other.insert(it, lowerChar);
+  }
+}
+
+void SearchIndex::Gate::add(const Gate& gate) {
+  ascii[0] |= gate.ascii[0];
+  ascii[1] |= gate.ascii[1];
+
+  if(!gate.other.empty()) {
+    std::vector<wchar_t> merged;
+    merged.reserve(other.size() + gate.other.size());
+    std::ranges::set_union(other, gate.other, std::back_inserter(merged));
+    other = std::move(merged);
+  }
+}
+
+bool SearchIndex::Gate::contains(const Gate& gate) const {
+  return ((gate.ascii[0] & ~ascii[0]) | (gate.ascii[1] & ~ascii[1])) == 0 &&
+      (gate.other.empty() || std::ranges::includes(other, gate.other));
+}
+
 SearchIndex::SearchIndex() {
   clear();
 }
 
+SearchIndex::SearchIndex(SearchIndex&& other) {
+  *this = std::move(other);
+}
+
+SearchIndex& SearchIndex::operator=(SearchIndex&& other) {
+  if(this != &other) {
+    m_nodes = std::move(other.m_nodes);
+    m_edges = std::move(other.m_edges);
+    m_freeNodes = std::move(other.m_freeNodes);
+    m_freeEdges = std::move(other.m_freeEdges);
+    m_elementNodes = std::move(other.m_elementNodes);
+    m_elementNodesTracked = other.m_elementNodesTracked;
+    m_gatesPopulated = other.m_gatesPopulated;
+    other.clear();
+  }
+  return *this;
+}
+
 SearchIndex::~SearchIndex() = default;
 
 void SearchIndex::addNode(Id id, std::wstring name, NodeType type) {
-  SearchNode* currentNode = m_root;
+  Index currentNode = 0;
 
   while(name.size() > 0) {
-    currentNode->containedTypes.add(type);
+    m_nodes[currentNode].containedTypes.add(type);
 
-    auto it = currentNode->edges.find(name[0]);
-    if(it != currentNode->edges.end()) {
-      SearchEdge* currentEdge = it->second;
-      const std::wstring& edgeString = currentEdge->s;
+    const auto& edges = m_nodes[currentNode].edges;
+    auto it = std::ranges::lower_bound(edges, name[0], {}, &std::pair<wchar_t, Index>::first);
+    const auto position = it - edges.begin();
+
+    if(it != edges.end() && it->first == name[0]) {
+      const Index currentEdge = it->second;
+      const std::wstring& edgeString = m_edges[currentEdge].s;
 
       size_t matchCount = 1;
       for(size_t j = 1; j < edgeString.size() && j < name.size(); j++) {
@@ -34,51 +95,118 @@ void SearchIndex::addNode(Id id, std::wstring name, NodeType type) {
       }
 
       if(matchCount < edgeString.size()) {
-        // split current edge
-        m_nodes.push_back(std::make_unique<SearchNode>(currentNode->containedTypes));
-        SearchNode* n = m_nodes.back().get();
+        // split current edge, adding entries invalidates references into the arrays
+        std::wstring lowerString = edgeString.substr(matchCount);
+        const Index n = addNodeEntry(m_nodes[currentNode].containedTypes, currentEdge);
+        const Index e = addEdgeEntry(n, m_edges[currentEdge].target, std::move(lowerString));
+        if(m_gatesPopulated) {
+          // the lower part keeps the whole gate, a superset of what is left below it
+          m_edges[e].gate = m_edges[currentEdge].gate;
+        }
 
-        m_edges.push_back(std::make_unique<SearchEdge>(currentEdge->target, edgeString.substr(matchCount)));
-        SearchEdge* e = m_edges.back().get();
+        m_nodes[n].edges.emplace_back(m_edges[e].s[0], e);
+        m_nodes[m_edges[e].target].parentEdge = e;
 
-        n->edges.emplace(e->s[0], e);
+        m_edges[currentEdge].s.resize(matchCount);
+        m_edges[currentEdge].target = n;
+      }
 
-        currentEdge->s = edgeString.substr(0, matchCount);
-        currentEdge->target = n;
+      if(m_gatesPopulated) {
+        addToGate(&m_edges[currentEdge].gate, name);
       }
 
-      name = name.substr(matchCount);
-      currentNode = currentEdge->target;
+      name.erase(0, matchCount);
+      currentNode = m_edges[currentEdge].target;
     } else {
-      m_nodes.push_back(std::make_unique<SearchNode>(currentNode->containedTypes));
-      SearchNode* n = m_nodes.back().get();
-
-      m_edges.push_back(std::make_unique<SearchEdge>(n, std::move(name)));
-      SearchEdge* e = m_edges.back().get();
+      const Index n = addNodeEntry(m_nodes[currentNode].containedTypes, NoIndex);
+      const wchar_t firstChar = name[0];
+      const Index e = addEdgeEntry(currentNode, n, std::move(name));
+      m_nodes[n].parentEdge = e;
+      if(m_gatesPopulated) {
+        addToGate(&m_edges[e].gate, m_edges[e].s);
+      }
 
-      currentNode->edges.emplace(e->s[0], e);
+      auto& currentEdges = m_nodes[currentNode].edges;
+      currentEdges.emplace(currentEdges.begin() + position, firstChar, e);
       currentNode = n;
 
       name.clear();
     }
   }
 
-  currentNode->elementIds.emplace(id, type);
+  auto& elementIds = m_nodes[currentNode].elementIds;
+  auto it = std::ranges::lower_bound(elementIds, id, {}, &std::pair<Id, NodeType>::first);
+  if(it == elementIds.end() || it->first != id) {
+    elementIds.emplace(it, id, type);
+    if(m_elementNodesTracked) {
+      m_elementNodes.emplace(id, currentNode);
+    }
+  }
+}
+
+void SearchIndex::removeNodes(const std::unordered_set<Id>& ids) {
+  if(ids.empty()) {
+    return;
+  }
+
+  if(!m_elementNodesTracked) {
+    size_t elementCount = 0;
+    for(const SearchNode& node : m_nodes) {
+      elementCount += node.elementIds.size();
+    }
+    m_elementNodes.reserve(elementCount);
+    for(Index nodeIndex = 0; nodeIndex < m_nodes.size(); nodeIndex++) {
+      for(const auto& element : m_nodes[nodeIndex].elementIds) {
+        m_elementNodes.emplace(element.first, nodeIndex);
+      }
+    }
+    m_elementNodesTracked = true;
+  }
+
+  std::vector<Index> changedNodes;
+  for(const Id id : ids) {
+    const auto [begin, end] = m_elementNodes.equal_range(id);
+    for(auto it = begin; it != end; ++it) {
+      std::erase_if(m_nodes[it->second].elementIds, [id](const auto& element) { return element.first == id; });
+      changedNodes.push_back(it->second);
+    }
+    m_elementNodes.erase(begin, end);
+  }
+
+  std::ranges::sort(changedNodes);
+  const auto duplicates = std::ranges::unique(changedNodes);
+  changedNodes.erase(duplicates.begin(), duplicates.end());
+
+  for(const Index nodeIndex : changedNodes) {
+    // the node may already be gone with the branch of another changed node
+    if(nodeIndex == 0 || m_nodes[nodeIndex].parentEdge != NoIndex) {
+      narrowPath(removeEmptyBranch(nodeIndex));
+    }
+  }
 }
 
 void SearchIndex::finishSetup() {
-  for(auto& p : m_root->edges) {
+  if(m_gatesPopulated) {
+    return;
+  }
+
+  compact();
+  for(const auto& p : m_nodes[0].edges) {
     populateEdgeGate(p.second);
   }
+  m_gatesPopulated = true;
 }
 
 void SearchIndex::clear() {
   m_nodes.clear();
   m_edges.clear();
+  m_freeNodes.clear();
+  m_freeEdges.clear();
+  m_elementNodes.clear();
+  m_elementNodesTracked = false;
 
-  m_nodes.push_back(std::make_unique<SearchNode>(NodeTypeSet()));
-
-  m_root = m_nodes.back().get();
+  m_nodes.emplace_back(NodeTypeSet());
+  m_gatesPopulated = false;
 }
 
 std::vector<SearchResult> SearchIndex::search(const std::wstring& query,
@@ -86,150 +214,344 @@ std::vector<SearchResult> SearchIndex::search(const std::wstring& query,
                                               size_t maxResultCount,
                                               size_t maxBestScoredResultsLength) const {
   // find paths containing query
-  std::vector<SearchPath> paths;
-  searchRecursive(SearchPath(L"", {}, m_root), utility::toLowerCase(query), acceptedNodeTypes, &paths);
+  const std::vector<SearchPath> paths = findPaths(utility::toLowerCase(query), acceptedNodeTypes);
 
   // create scored search results
-  std::multiset<SearchResult> searchResults = createScoredResults(paths, acceptedNodeTypes, maxResultCount * 3);
+  const std::vector<SearchResult> searchResults = createScoredResults(paths, acceptedNodeTypes, maxResultCount * 3);
 
   // find maximum length for best scores
-  std::multiset<size_t> resultLengths;
-  for(const SearchResult& result : searchResults) {
-    resultLengths.insert(result.text.size());
-  }
   size_t maxResultLength = 0;
-  if(resultLengths.size() > 1000) {
-    auto it = resultLengths.begin();
-    std::advance(it, 1000);
-    maxResultLength = *it;
+  if(searchResults.size() > 1000) {
+    std::vector<size_t> resultLengths;
+    resultLengths.reserve(searchResults.size());
+    for(const SearchResult& result : searchResults) {
+      resultLengths.push_back(result.text.size());
+    }
+    std::ranges::nth_element(resultLengths, resultLengths.begin() + 1000);
+    maxResultLength = resultLengths[1000];
   }
 
   // find best scores
-  std::map<std::wstring, SearchResult> scoresCache;
-  std::multiset<SearchResult> bestResults;
+  ScoresCache scoresCache;
+  std::vector<SearchResult> bestResults;
   for(const SearchResult& result : searchResults) {
     if(!maxResultLength || result.text.size() <= maxResultLength) {
-      bestResults.insert(bestScoredResult(result, &scoresCache, maxBestScoredResultsLength));
+      bestResults.push_back(bestScoredResult(result, &scoresCache, maxBestScoredResultsLength));
     }
   }
+  std::stable_sort(bestResults.begin(), bestResults.end());
 
   // narrow down to max result count
-  auto it = bestResults.end();
   if(maxResultCount && bestResults.size() > maxResultCount) {
-    it = bestResults.begin();
-    std::advance(it, maxResultCount);
+    bestResults.erase(bestResults.begin() + static_cast<std::ptrdiff_t>(maxResultCount), bestResults.end());
   }
 
-  return std::vector<SearchResult>(bestResults.begin(), it);
+  return bestResults;
 }
 
-void SearchIndex::populateEdgeGate(SearchEdge* e) {
-  for(auto& p : e->target->edges) {
-    SearchEdge* targetEdge = p.second;
-    populateEdgeGate(targetEdge);
-    utility::append(e->gate, targetEdge->gate);
+SearchIndex::Index SearchIndex::addNodeEntry(NodeTypeSet containedTypes, Index parentEdge) {
+  Index nodeIndex = 0;
+  if(m_freeNodes.empty()) {
+    nodeIndex = static_cast<Index>(m_nodes.size());
+    m_nodes.emplace_back(containedTypes);
+  } else {
+    nodeIndex = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    m_nodes[nodeIndex] = SearchNode(containedTypes);
   }
 
-  for(const wchar_t& c : e->s) {
-    e->gate.insert(static_cast<wchar_t>(towlower(static_cast<wint_t>(c))));
+  m_nodes[nodeIndex].parentEdge = parentEdge;
+  return nodeIndex;
+}
+
+SearchIndex::Index SearchIndex::addEdgeEntry(Index source, Index target, std::wstring text) {
+  if(m_freeEdges.empty()) {
+    m_edges.emplace_back(source, target, std::move(text));
+    return static_cast<Index>(m_edges.size() - 1);
   }
+
+  const Index edgeIndex = m_freeEdges.back();
+  m_freeEdges.pop_back();
+  m_edges[edgeIndex] = SearchEdge(source, target, std::move(text));
+  return edgeIndex;
 }
 
-void SearchIndex::searchRecursive(const SearchPath& path,
-                                  const std::wstring& remainingQuery,
-                                  NodeTypeSet acceptedNodeTypes,
-                                  std::vector<SearchIndex::SearchPath>* results) const {
-  for(const auto& p : path.node->edges) {
-    const SearchEdge* currentEdge = p.second;
+void SearchIndex::removeNodeEntry(Index nodeIndex) {
+  m_nodes[nodeIndex] = SearchNode(NodeTypeSet());
+  m_freeNodes.push_back(nodeIndex);
+}
+
+void SearchIndex::removeEdgeEntry(Index edgeIndex) {
+  m_edges[edgeIndex] = SearchEdge(NoIndex, NoIndex, {});
+  m_freeEdges.push_back(edgeIndex);
+}
 
-    if(!acceptedNodeTypes.intersectsWith(currentEdge->target->containedTypes)) {
-      continue;
+void SearchIndex::populateEdgeGate(Index edgeIndex) {
+  for(const auto& p : m_nodes[m_edges[edgeIndex].target].edges) {
+    populateEdgeGate(p.second);
+    m_edges[edgeIndex].gate.add(m_edges[p.second].gate);
+  }
+
+  addToGate(&m_edges[edgeIndex].gate, m_edges[edgeIndex].s);
+}
+
+void SearchIndex::addToGate(Gate* gate, const std::wstring& text) {
+  for(const wchar_t& c : text) {
+    gate->add(static_cast<wchar_t>(towlower(static_cast<wint_t>(c))));
+  }
+}
+
+SearchIndex::Index SearchIndex::removeEmptyBranch(Index nodeIndex) {
+  // drops the node and the ancestors that are left without elements and edges
+  while(nodeIndex != 0 && m_nodes[nodeIndex].elementIds.empty() && m_nodes[nodeIndex].edges.empty()) {
+    const Index edgeIndex = m_nodes[nodeIndex].parentEdge;
+    const Index parentIndex = m_edges[edgeIndex].source;
+    std::erase_if(m_nodes[parentIndex].edges, [edgeIndex](const auto& p) { return p.second == edgeIndex; });
+
+    removeNodeEntry(nodeIndex);
+    removeEdgeEntry(edgeIndex);
+    nodeIndex = parentIndex;
+  }
+
+  // a node with a single edge and no elements is joined into one edge with the edge above it
+  if(nodeIndex != 0 && m_nodes[nodeIndex].elementIds.empty() && m_nodes[nodeIndex].edges.size() == 1) {
+    const Index parentEdge = m_nodes[nodeIndex].parentEdge;
+    const Index childEdge = m_nodes[nodeIndex].edges.front().second;
+
+    m_edges[parentEdge].s += m_edges[childEdge].s;
+    m_edges[parentEdge].target = m_edges[childEdge].target;
+    m_nodes[m_edges[parentEdge].target].parentEdge = parentEdge;
+
+    removeNodeEntry(nodeIndex);
+    removeEdgeEntry(childEdge);
+    nodeIndex = m_edges[parentEdge].target;
+  }
+
+  return nodeIndex;
+}
+
+void SearchIndex::narrowPath(Index nodeIndex) {
+  // the first node lost elements or edges below it, its ancestors only change as long as the values below them do
+  const Index changedNode = nodeIndex;
+  for(bool changed = true; changed;) {
+    SearchNode& node = m_nodes[nodeIndex];
+
+    NodeTypeSet containedTypes;
+    for(const auto& element : node.elementIds) {
+      containedTypes.add(element.second);
     }
+    for(const auto& p : node.edges) {
+      containedTypes.add(m_nodes[m_edges[p.second].target].containedTypes);
+    }
+    changed = nodeIndex == changedNode || containedTypes != node.containedTypes;
+    node.containedTypes = containedTypes;
 
-    // test if s passes the edge's gate.
-    bool passesGate = true;
-    for(const wchar_t& c : remainingQuery) {
-      if(currentEdge->gate.find(c) == currentEdge->gate.end()) {
-        passesGate = false;
-        break;
-      }
+    if(nodeIndex == 0) {
+      return;
     }
 
-    if(!passesGate) {
-      continue;
+    SearchEdge& parentEdge = m_edges[node.parentEdge];
+    if(m_gatesPopulated) {
+      Gate gate;
+      for(const auto& p : node.edges) {
+        gate.add(m_edges[p.second].gate);
+      }
+      addToGate(&gate, parentEdge.s);
+
+      changed = changed || gate != parentEdge.gate;
+      parentEdge.gate = std::move(gate);
     }
 
-    // consume characters for edge
-    const std::wstring& edgeString = currentEdge->s;
-    SearchPath currentPath{path.text + edgeString, path.indices, currentEdge->target};
+    nodeIndex = parentEdge.source;
+  }
+}
+
+void SearchIndex::compact() {
+  // lays the reachable nodes and edges out in depth first order, so each subtree is one range of the arrays
+  std::vector<SearchNode> nodes;
+  std::vector<SearchEdge> edges;
+  std::vector<Index> newNodeIndices(m_nodes.size(), NoIndex);
+  nodes.reserve(m_nodes.size() - m_freeNodes.size());
+  edges.reserve(m_edges.size() - m_freeEdges.size());
+  compactRecursive(0, &nodes, &edges, &newNodeIndices);
+
+  m_nodes = std::move(nodes);
+  m_edges = std::move(edges);
+  m_freeNodes.clear();
+  m_freeEdges.clear();
+  for(auto& p : m_elementNodes) {
+    p.second = newNodeIndices[p.second];
+  }
+}
 
-    size_t j = 0;
-    for(size_t i = 0; i < edgeString.size() && j < remainingQuery.size(); i++) {
-      if(towlower(static_cast<wint_t>(edgeString[i])) == static_cast<wint_t>(remainingQuery[j])) {
-        currentPath.indices.push_back(path.text.size() + i);
-        j++;
-      }
+SearchIndex::Index SearchIndex::compactRecursive(Index nodeIndex,
+                                                 std::vector<SearchNode>* nodes,
+                                                 std::vector<SearchEdge>* edges,
+                                                 std::vector<Index>* newNodeIndices) {
+  const auto newNodeIndex = static_cast<Index>(nodes->size());
+  nodes->push_back(std::move(m_nodes[nodeIndex]));
+  (*newNodeIndices)[nodeIndex] = newNodeIndex;
+
+  for(size_t i = 0; i < (*nodes)[newNodeIndex].edges.size(); i++) {
+    const auto newEdgeIndex = static_cast<Index>(edges->size());
+    edges->push_back(std::move(m_edges[(*nodes)[newNodeIndex].edges[i].second]));
+    (*nodes)[newNodeIndex].edges[i].second = newEdgeIndex;
+    (*edges)[newEdgeIndex].source = newNodeIndex;
+
+    const Index target = compactRecursive((*edges)[newEdgeIndex].target, nodes, edges, newNodeIndices);
+    (*edges)[newEdgeIndex].target = target;
+    (*nodes)[target].parentEdge = newEdgeIndex;
+  }
+
+  return newNodeIndex;
+}
+
+std::vector<SearchIndex::SearchPath> SearchIndex::findPaths(const std::wstring& lowerQuery, NodeTypeSet acceptedNodeTypes) const {
+  // the characters of every query suffix, an edge is only entered if its gate holds all of them
+  std::vector<Gate> suffixGates(lowerQuery.size() + 1);
+  for(size_t i = lowerQuery.size(); i-- > 0;) {
+    suffixGates[i] = suffixGates[i + 1];
+    suffixGates[i].add(lowerQuery[i]);
+  }
+
+  const auto& rootEdges = m_nodes[0].edges;
+  const size_t threadCount = m_nodes.size() < ParallelSearchNodeCount ?
+      1 :
+      std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), rootEdges.size());
+
+  if(threadCount <= 1) {
+    SearchState state{&suffixGates, acceptedNodeTypes, {}, {}, {}};
+    searchRecursive(0, lowerQuery, &state);
+    return std::move(state.results);
+  }
+
+  // the subtrees of the root edges are searched in parallel and joined in edge order
+  std::vector<std::vector<SearchPath>> edgeResults(rootEdges.size());
+  std::atomic<size_t> nextEdge = 0;
+  const auto searchEdges = [&]() {
+    SearchState state{&suffixGates, acceptedNodeTypes, {}, {}, {}};
+    for(size_t i = nextEdge++; i < rootEdges.size(); i = nextEdge++) {
+      searchEdge(rootEdges[i].second, lowerQuery, &state);
+      edgeResults[i] = std::exchange(state.results, {});
     }
+  };
 
-    if(j == remainingQuery.size()) {
-      results->push_back(std::move(currentPath));
-    } else {
-      searchRecursive(currentPath, remainingQuery.substr(j), acceptedNodeTypes, results);
+  std::vector<std::future<void>> workers;
+  for(size_t i = 1; i < threadCount; i++) {
+    workers.push_back(std::async(std::launch::async, searchEdges));
+  }
+  searchEdges();
+  for(auto& worker : workers) {
+    worker.get();
+  }
+
+  std::vector<SearchPath> paths;
+  for(auto& results : edgeResults) {
+    std::ranges::move(results, std::back_inserter(paths));
+  }
+  return paths;
+}
+
+void SearchIndex::searchRecursive(Index nodeIndex, std::wstring_view remainingQuery, SearchState* state) const {
+  for(const auto& p : m_nodes[nodeIndex].edges) {
+    searchEdge(p.second, remainingQuery, state);
+  }
+}
+
+void SearchIndex::searchEdge(Index edgeIndex, std::wstring_view remainingQuery, SearchState* state) const {
+  const SearchEdge& currentEdge = m_edges[edgeIndex];
+
+  if(!state->acceptedNodeTypes.intersectsWith(m_nodes[currentEdge.target].containedTypes)) {
+    return;
+  }
+
+  // test if the remaining query passes the edge's gate
+  if(!currentEdge.gate.contains((*state->suffixGates)[state->suffixGates->size() - 1 - remainingQuery.size()])) {
+    return;
+  }
+
+  // consume characters for edge
+  const std::wstring& edgeString = currentEdge.s;
+  const size_t textSize = state->text.size();
+  const size_t indicesSize = state->indices.size();
+
+  size_t j = 0;
+  for(size_t i = 0; i < edgeString.size() && j < remainingQuery.size(); i++) {
+    if(towlower(static_cast<wint_t>(edgeString[i])) == static_cast<wint_t>(remainingQuery[j])) {
+      state->indices.push_back(textSize + i);
+      j++;
     }
   }
+  state->text += edgeString;
+
+  if(j == remainingQuery.size()) {
+    state->results.emplace_back(state->text, state->indices, currentEdge.target);
+  } else {
+    searchRecursive(currentEdge.target, remainingQuery.substr(j), state);
+  }
+
+  state->text.resize(textSize);
+  state->indices.resize(indicesSize);
 }
 
-std::multiset<SearchResult> SearchIndex::createScoredResults(const std::vector<SearchPath>& paths,
-                                                             NodeTypeSet acceptedNodeTypes,
-                                                             size_t maxResultCount) const {
+std::vector<SearchResult> SearchIndex::createScoredResults(const std::vector<SearchPath>& paths,
+                                                           NodeTypeSet acceptedNodeTypes,
+                                                           size_t maxResultCount) const {
   // score and order initial paths
-  std::multimap<int, SearchPath, std::greater<int>> scoredPaths;
+  std::vector<std::pair<int, const SearchPath*>> scoredPaths;
+  scoredPaths.reserve(paths.size());
   for(const SearchPath& path : paths) {
-    scoredPaths.emplace(scoreText(path.text, path.indices), path);
+    scoredPaths.emplace_back(scoreText(path.text, path.indices), &path);
   }
+  std::ranges::stable_sort(scoredPaths, std::greater<int>(), &std::pair<int, const SearchPath*>::first);
 
-  // score paths and subpaths
-  std::multiset<SearchResult> searchResults;
+  // score paths and subpaths, a subpath only extends the text and keeps the indices of its path
+  std::vector<SearchResult> searchResults;
+  std::vector<std::pair<std::wstring, Index>> currentPaths;
+  std::vector<std::pair<std::wstring, Index>> nextPaths;
   for(const auto& [scored, searchPath] : scoredPaths) {
-    std::vector<SearchPath> currentPaths;
-    currentPaths.push_back(searchPath);
+    currentPaths.clear();
+    currentPaths.emplace_back(searchPath->text, searchPath->node);
 
     while(!currentPaths.empty()) {
-      std::vector<SearchPath> nextPaths;
+      nextPaths.clear();
 
-      for(const SearchPath& path : currentPaths) {
-        if(!path.node->elementIds.empty() && (acceptedNodeTypes.intersectsWith(path.node->containedTypes))) {
+      for(const auto& [text, nodeIndex] : currentPaths) {
+        const SearchNode& node = m_nodes[nodeIndex];
+        if(!node.elementIds.empty() && (acceptedNodeTypes.intersectsWith(node.containedTypes))) {
           std::vector<Id> elementIds;
-          for(const auto& p : path.node->elementIds) {
+          for(const auto& p : node.elementIds) {
             if(acceptedNodeTypes.contains(p.second)) {
               elementIds.push_back(p.first);
             }
           }
 
           if(!elementIds.empty()) {
-            searchResults.emplace(path.text, std::move(elementIds), path.indices, scoreText(path.text, path.indices));
+            searchResults.emplace_back(text, std::move(elementIds), searchPath->indices, scoreText(text, searchPath->indices));
 
             if(maxResultCount && searchResults.size() >= maxResultCount) {
+              std::stable_sort(searchResults.begin(), searchResults.end());
               return searchResults;
             }
           }
         }
 
-        for(auto p : path.node->edges) {
-          const SearchEdge* edge = p.second;
-          nextPaths.emplace_back(path.text + edge->s, path.indices, edge->target);
+        for(const auto& p : node.edges) {
+          const SearchEdge& edge = m_edges[p.second];
+          nextPaths.emplace_back(text + edge.s, edge.target);
         }
       }
 
-      currentPaths = std::move(nextPaths);
+      std::swap(currentPaths, nextPaths);
     }
   }
 
+  std::stable_sort(searchResults.begin(), searchResults.end());
   return searchResults;
 }
 
 SearchResult SearchIndex::bestScoredResult(SearchResult result,
-                                           std::map<std::wstring, SearchResult>* scoresCache,
+                                           ScoresCache* scoresCache,
                                            size_t maxBestScoredResultsLength) {
   const std::wstring text = result.text;
 
@@ -265,7 +587,7 @@ void SearchIndex::bestScoredResultRecursive(const std::wstring& lowerText,
                                             const std::vector<size_t>& indices,
                                             const size_t lastIndex,
                                             const size_t indicesPos,
-                                            std::map<std::wstring, SearchResult>* scoresCache,
+                                            ScoresCache* scoresCache,
                                             SearchResult* result) {
   // left for debugging
   // std::cout << lowerText << std::endl;
@@ -436,7 +758,7 @@ SearchResult SearchIndex::rescoreText(const std::wstring& fulltext,
   result.score = scoreText(text, textIndices);
   result.indices = textIndices;
 
-  std::map<std::wstring, SearchResult> scoresCache;
+  ScoresCache scoresCache;
   result = bestScoredResult(result, &scoresCache, maxBestScoredResultsLength);
 
   for(size_t i = 0; i < result.indices.size(); i++) {
@@ -1,9 +1,12 @@
 #pragma once
 
-#include <map>
-#include <memory>
-#include <set>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "GlobalId.hpp"
@@ -25,12 +28,39 @@ struct SearchResult {
   int score;
 };
 
+/**
+ * @brief Fuzzy search over names, stored as a radix tree in flat arrays
+ *
+ * Nodes and edges live in two vectors and refer to each other by index. Every edge carries a gate with the lowercase
+ * characters of its own text and of everything below it, a query only descends into an edge whose gate holds all the
+ * characters it still has to match. ASCII characters are kept as a 128 bit mask, so that test is two word operations
+ * for the common case.
+ *
+ * A search over a large index walks the subtrees of the root edges on several threads. The paths of each subtree are
+ * collected separately and concatenated in edge order, which gives the same results as a walk on one thread.
+ */
 class SearchIndex {
 public:
   SearchIndex();
+  SearchIndex(const SearchIndex&) = delete;
+  SearchIndex(SearchIndex&& other);
+  SearchIndex& operator=(const SearchIndex&) = delete;
+  SearchIndex& operator=(SearchIndex&& other);
   virtual ~SearchIndex();
 
+  /**
+   * @brief Adds the element to the index, after finishSetup() the gates of its path are extended right away
+   */
   void addNode(Id id, std::wstring name, NodeType type = NodeType(NODE_SYMBOL));
+
+  /**
+   * @brief Removes the elements and only touches the paths from their nodes to the root
+   *
+   * Branches left without elements are dropped and a node left with a single edge and no elements is merged with the
+   * edges around it. Gates and contained types are narrowed on the way up until they stop changing.
+   */
+  void removeNodes(const std::unordered_set<Id>& ids);
+
   void finishSetup();
   void clear();
 
@@ -41,51 +71,89 @@ public:
                                    size_t maxBestScoredResultsLength = 0) const;
 
 private:
-  struct SearchEdge;
+  using Index = uint32_t;
+
+  static constexpr Index NoIndex = std::numeric_limits<Index>::max();
+
+  // lowercase characters, a bit for each ASCII character and a sorted list of all others
+  struct Gate {
+    void add(wchar_t lowerChar);
+    void add(const Gate& other);
+    bool contains(const Gate& other) const;
+    bool operator==(const Gate& other) const = default;
+
+    uint64_t ascii[2] = {0, 0};
+    std::vector<wchar_t> other;
+  };
 
   struct SearchNode {
-    SearchNode(NodeTypeSet containedTypes_) : containedTypes(containedTypes_) {}
+    explicit SearchNode(NodeTypeSet containedTypes_) : containedTypes(containedTypes_) {}
 
-    std::map<Id, NodeType> elementIds;
     NodeTypeSet containedTypes;
-    std::map<wchar_t, SearchEdge*> edges;
+    // sorted by id
+    std::vector<std::pair<Id, NodeType>> elementIds;
+    // first character of the edge text and the edge index, sorted by character
+    std::vector<std::pair<wchar_t, Index>> edges;
+    // NoIndex for the root and for unused entries
+    Index parentEdge = NoIndex;
   };
 
   struct SearchEdge {
-    SearchEdge(SearchNode* target_, std::wstring text) : target(target_), s(std::move(text)) {}
+    SearchEdge(Index source_, Index target_, std::wstring text) : source(source_), target(target_), s(std::move(text)) {}
 
-    SearchNode* target;
+    Index source;
+    Index target;
     std::wstring s;
-    std::set<wchar_t> gate;
+    Gate gate;
   };
 
   struct SearchPath {
-    SearchPath(std::wstring text_, std::vector<size_t> indices_, SearchNode* node_)
+    SearchPath(std::wstring text_, std::vector<size_t> indices_, Index node_)
         : text(std::move(text_)), indices(std::move(indices_)), node(node_) {}
 
     std::wstring text;
     std::vector<size_t> indices;
-    SearchNode* node;
+    Index node;
   };
 
-  void populateEdgeGate(SearchEdge* e);
-  void searchRecursive(const SearchPath& path,
-                       const std::wstring& remainingQuery,
-                       NodeTypeSet acceptedNodeTypes,
-                       std::vector<SearchIndex::SearchPath>* results) const;
-
-  std::multiset<SearchResult> createScoredResults(const std::vector<SearchPath>& paths,
-                                                  NodeTypeSet acceptedNodeTypes,
-                                                  size_t maxResultCount) const;
+  // state of one walk, the text and indices are extended and truncated in place while descending
+  struct SearchState {
+    const std::vector<Gate>* suffixGates;
+    NodeTypeSet acceptedNodeTypes;
+    std::wstring text;
+    std::vector<size_t> indices;
+    std::vector<SearchPath> results;
+  };
 
-  static SearchResult bestScoredResult(SearchResult result,
-                                       std::map<std::wstring, SearchResult>* scoresCache,
-                                       size_t maxBestScoredResultsLength);
+  using ScoresCache = std::unordered_map<std::wstring, SearchResult>;
+
+  Index addNodeEntry(NodeTypeSet containedTypes, Index parentEdge);
+  Index addEdgeEntry(Index source, Index target, std::wstring text);
+  void removeNodeEntry(Index nodeIndex);
+  void removeEdgeEntry(Index edgeIndex);
+  void populateEdgeGate(Index edgeIndex);
+  static void addToGate(Gate* gate, const std::wstring& text);
+  Index removeEmptyBranch(Index nodeIndex);
+  void narrowPath(Index nodeIndex);
+  void compact();
+  Index compactRecursive(Index nodeIndex,
+                         std::vector<SearchNode>* nodes,
+                         std::vector<SearchEdge>* edges,
+                         std::vector<Index>* newNodeIndices);
+  std::vector<SearchPath> findPaths(const std::wstring& lowerQuery, NodeTypeSet acceptedNodeTypes) const;
+  void searchRecursive(Index nodeIndex, std::wstring_view remainingQuery, SearchState* state) const;
+  void searchEdge(Index edgeIndex, std::wstring_view remainingQuery, SearchState* state) const;
+
+  std::vector<SearchResult> createScoredResults(const std::vector<SearchPath>& paths,
+                                                NodeTypeSet acceptedNodeTypes,
+                                                size_t maxResultCount) const;
+
+  static SearchResult bestScoredResult(SearchResult result, ScoresCache* scoresCache, size_t maxBestScoredResultsLength);
   static void bestScoredResultRecursive(const std::wstring& lowerText,
                                         const std::vector<size_t>& indices,
                                         const size_t lastIndex,
                                         const size_t indicesPos,
-                                        std::map<std::wstring, SearchResult>* scoresCache,
+                                        ScoresCache* scoresCache,
                                         SearchResult* result);
   static int scoreText(const std::wstring& text, const std::vector<size_t>& indices);
 
@@ -99,7 +167,15 @@ public:
   static bool isNoLetter(const wchar_t c);
 
 private:
-  std::vector<std::unique_ptr<SearchNode>> m_nodes;
-  std::vector<std::unique_ptr<SearchEdge>> m_edges;
-  SearchNode* m_root;
+  // m_nodes[0] is the root
+  std::vector<SearchNode> m_nodes;
+  std::vector<SearchEdge> m_edges;
+  // entries left by removed elements, reused by the next additions
+  std::vector<Index> m_freeNodes;
+  std::vector<Index> m_freeEdges;
+  // the node holding each element, so removing it does not search the whole index. filled by the first removal, an
+  // index that never removes anything does not pay for it
+  std::unordered_multimap<Id, Index> m_elementNodes;
+  bool m_elementNodesTracked = false;
+  bool m_gatesPopulated = false;
 };
@@ -0,0 +1,380 @@
+#include "GraphSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "FilePath.h"
+#include "logging.h"
+
+static_assert(std::is_trivially_copyable_v<StorageEdge>);
+
+namespace {
+using namespace graph_snapshot;
+
+constexpr size_t align(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+void addSection(Header& header, Section section, size_t count, size_t& offset) {
+  offset = align(offset, alignof(T));
+  header.sections[section] = SectionRange{offset, count};
+  offset += count * sizeof(T);
+}
+
+template <typename T>
+T* getSectionData(char* buffer, const Header& header, Section section) {
+  return reinterpret_cast<T*>(buffer + header.sections[section].offset);    // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+constexpr size_t getSectionElementSize(Section section) {
+  switch(section) {
+  case SECTION_NODES:
+    return sizeof(Node);
+  case SECTION_EDGES:
+    return sizeof(StorageEdge);
+  case SECTION_OUTGOING_OFFSETS:
+  case SECTION_INCOMING_OFFSETS:
+    return sizeof(uint64_t);
+  case SECTION_OUTGOING_EDGES:
+  case SECTION_INCOMING_EDGES:
+    return sizeof(uint32_t);
+  case SECTION_STRINGS:
+    return sizeof(wchar_t);
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Fills one CSR adjacency: offsets has one entry per node plus one, edgeIndexes holds the indexes of all edges whose
+ * endpoint is a known node, grouped by that node and ordered by edge type within each group.
+ */
+void writeAdjacency(const std::vector<StorageEdge>& edges,
+                    const std::vector<std::optional<uint32_t>>& endpointNodeIndexes,
+                    size_t nodeCount,
+                    uint64_t* offsets,
+                    uint32_t* edgeIndexes) {
+  std::fill(offsets, offsets + nodeCount + 1, 0);
+  for(const std::optional<uint32_t>& nodeIndex : endpointNodeIndexes) {
+    if(nodeIndex) {
+      offsets[*nodeIndex + 1]++;
+    }
+  }
+  for(size_t index = 0; index < nodeCount; ++index) {
+    offsets[index + 1] += offsets[index];
+  }
+
+  std::vector<uint64_t> cursors(offsets, offsets + nodeCount);
+  for(size_t edgeIndex = 0; edgeIndex < endpointNodeIndexes.size(); ++edgeIndex) {
+    if(const std::optional<uint32_t>& nodeIndex = endpointNodeIndexes[edgeIndex]) {
+      edgeIndexes[cursors[*nodeIndex]++] = static_cast<uint32_t>(edgeIndex);
+    }
+  }
+
+  // edges were added in id order, a stable sort keeps that order for edges of the same type
+  for(size_t index = 0; index < nodeCount; ++index) {
+    std::stable_sort(edgeIndexes + offsets[index], edgeIndexes + offsets[index + 1], [&edges](uint32_t first, uint32_t second) {
+      return edges[first].type < edges[second].type;
+    });
+  }
+}
+}    // namespace
+
+struct GraphSnapshot::Mapping {
+  explicit Mapping(const FilePath& filePath)
+      : file(filePath.str().c_str(), boost::interprocess::read_only), region(file, boost::interprocess::read_only) {}
+
+  boost::interprocess::file_mapping file;
+  boost::interprocess::mapped_region region;
+};
+
+bool GraphSnapshot::write(const FilePath& filePath,
+                          uint64_t token,
+                          std::vector<StorageNode> nodes,
+                          std::vector<StorageEdge> edges) {
+  if(edges.size() > std::numeric_limits<uint32_t>::max() || nodes.size() > std::numeric_limits<uint32_t>::max()) {
+    LOG_WARNING(fmt::format("Graph too large for a snapshot: {} nodes, {} edges", nodes.size(), edges.size()));
+    return false;
+  }
+
+  std::ranges::sort(nodes, {}, &StorageNode::id);
+  std::ranges::sort(edges, {}, &StorageEdge::id);
+
+  const auto getNodeIndex = [&nodes](Id nodeId) -> std::optional<uint32_t> {
+    const auto iterator = std::ranges::lower_bound(nodes, nodeId, {}, &StorageNode::id);
+    if(iterator == nodes.end() || iterator->id != nodeId) {
+      return std::nullopt;
+    }
+    return static_cast<uint32_t>(iterator - nodes.begin());
+  };
+
+  std::vector<std::optional<uint32_t>> sourceNodeIndexes;
+  std::vector<std::optional<uint32_t>> targetNodeIndexes;
+  sourceNodeIndexes.reserve(edges.size());
+  targetNodeIndexes.reserve(edges.size());
+  size_t outgoingCount = 0;
+  size_t incomingCount = 0;
+  for(const StorageEdge& edge : edges) {
+    sourceNodeIndexes.push_back(getNodeIndex(edge.sourceNodeId));
+    targetNodeIndexes.push_back(getNodeIndex(edge.targetNodeId));
+    outgoingCount += sourceNodeIndexes.back() ? 1 : 0;
+    incomingCount += targetNodeIndexes.back() ? 1 : 0;
+  }
+
+  size_t stringLength = 0;
+  for(const StorageNode& node : nodes) {
+    stringLength += node.serializedName.size();
+  }
+
+  Header header;
+  header.token = token;
+
+  size_t offset = sizeof(Header);
+  addSection<Node>(header, SECTION_NODES, nodes.size(), offset);
+  addSection<StorageEdge>(header, SECTION_EDGES, edges.size(), offset);
+  addSection<uint64_t>(header, SECTION_OUTGOING_OFFSETS, nodes.size() + 1, offset);
+  addSection<uint32_t>(header, SECTION_OUTGOING_EDGES, outgoingCount, offset);
+  addSection<uint64_t>(header, SECTION_INCOMING_OFFSETS, nodes.size() + 1, offset);
+  addSection<uint32_t>(header, SECTION_INCOMING_EDGES, incomingCount, offset);
+  addSection<wchar_t>(header, SECTION_STRINGS, stringLength, offset);
+  header.byteSize = align(offset, alignof(Header));
+
+  std::vector<char> buffer(header.byteSize);
+  std::memcpy(buffer.data(), &header, sizeof(Header));
+
+  Node* nodeData = getSectionData<Node>(buffer.data(), header, SECTION_NODES);
+  wchar_t* stringData = getSectionData<wchar_t>(buffer.data(), header, SECTION_STRINGS);
+  uint64_t stringOffset = 0;
+  for(const StorageNode& node : nodes) {
+    *nodeData++ = Node{node.id, node.type, StringRef{stringOffset, node.serializedName.size()}};
+    std::memcpy(stringData + stringOffset, node.serializedName.data(), node.serializedName.size() * sizeof(wchar_t));
+    stringOffset += node.serializedName.size();
+  }
+
+  std::memcpy(
+      getSectionData<StorageEdge>(buffer.data(), header, SECTION_EDGES), edges.data(), edges.size() * sizeof(StorageEdge));
+
+  writeAdjacency(edges,
+                 sourceNodeIndexes,
+                 nodes.size(),
+                 getSectionData<uint64_t>(buffer.data(), header, SECTION_OUTGOING_OFFSETS),
+                 getSectionData<uint32_t>(buffer.data(), header, SECTION_OUTGOING_EDGES));
+  writeAdjacency(edges,
+                 targetNodeIndexes,
+                 nodes.size(),
+                 getSectionData<uint64_t>(buffer.data(), header, SECTION_INCOMING_OFFSETS),
+                 getSectionData<uint32_t>(buffer.data(), header, SECTION_INCOMING_EDGES));
+
+  // written next to the target and renamed, so an interrupted write never leaves a damaged snapshot behind
+  const std::filesystem::path path(filePath.wstr());
+  std::filesystem::path tempPath = path;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if(!file) {
+      LOG_WARNING(fmt::format("Unable to write graph snapshot: {}", tempPath.string()));
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, path, error);
+  if(error) {
+    LOG_WARNING(fmt::format("Unable to write graph snapshot: {}", error.message()));
+    std::filesystem::remove(tempPath, error);
+    return false;
+  }
+
+  return true;
+}
+
+std::unique_ptr<GraphSnapshot> GraphSnapshot::open(const FilePath& filePath, uint64_t token) {
+  if(token == 0 || !filePath.exists()) {
+    return nullptr;
+  }
+
+  std::unique_ptr<Mapping> mapping;
+  try {
+    mapping = std::make_unique<Mapping>(filePath);
+  } catch(const boost::interprocess::interprocess_exception& exception) {
+    LOG_WARNING(fmt::format("Unable to map graph snapshot: {}", exception.what()));
+    return nullptr;
+  }
+
+  const size_t size = mapping->region.get_size();
+  const auto* header = static_cast<const Header*>(mapping->region.get_address());
+  if(size < sizeof(Header) || header->magic != Header::Magic || header->version != Header::Version ||
+     header->byteSize != size || header->token != token) {
+    LOG_INFO("Graph snapshot is outdated.");
+    return nullptr;
+  }
+
+  for(uint32_t section = 0; section < SECTION_COUNT; ++section) {
+    const SectionRange& range = header->sections[section];
+    if(range.offset > size || range.count > (size - range.offset) / getSectionElementSize(static_cast<Section>(section))) {
+      LOG_ERROR("Graph snapshot section exceeds the file.");
+      return nullptr;
+    }
+  }
+
+  if(header->sections[SECTION_OUTGOING_OFFSETS].count != header->sections[SECTION_NODES].count + 1 ||
+     header->sections[SECTION_INCOMING_OFFSETS].count != header->sections[SECTION_NODES].count + 1) {
+    LOG_ERROR("Graph snapshot adjacency does not match its nodes.");
+    return nullptr;
+  }
+
+  return std::unique_ptr<GraphSnapshot>(new GraphSnapshot(std::move(mapping)));
+}
+
+GraphSnapshot::GraphSnapshot(std::unique_ptr<Mapping> mapping)
+    : m_mapping(std::move(mapping)), m_header(static_cast<const Header*>(m_mapping->region.get_address())) {
+  m_nodes = getSection<Node>(SECTION_NODES);
+  m_edges = getSection<StorageEdge>(SECTION_EDGES);
+
+  const std::span<const wchar_t> strings = getSection<wchar_t>(SECTION_STRINGS);
+  m_strings = std::wstring_view(strings.data(), strings.size());
+}
+
+GraphSnapshot::~GraphSnapshot() = default;
+
+size_t GraphSnapshot::getNodeCount() const {
+  return m_nodes.size();
+}
+
+size_t GraphSnapshot::getEdgeCount() const {
+  return m_edges.size();
+}
+
+StorageNode GraphSnapshot::getNodeById(Id nodeId) const {
+  if(const std::optional<size_t> index = getNodeIndex(nodeId)) {
+    return toStorageNode(m_nodes[*index]);
+  }
+  return {};
+}
+
+std::optional<int> GraphSnapshot::getNodeType(Id nodeId) const {
+  if(const std::optional<size_t> index = getNodeIndex(nodeId)) {
+    return m_nodes[*index].type;
+  }
+  return std::nullopt;
+}
+
+std::vector<StorageNode> GraphSnapshot::getNodesByIds(const std::vector<Id>& nodeIds) const {
+  std::vector<StorageNode> nodes;
+  nodes.reserve(nodeIds.size());
+  for(const Id nodeId : nodeIds) {
+    if(const std::optional<size_t> index = getNodeIndex(nodeId)) {
+      nodes.push_back(toStorageNode(m_nodes[*index]));
+    }
+  }
+  return nodes;
+}
+
+bool GraphSnapshot::isEdge(Id edgeId) const {
+  return std::ranges::binary_search(m_edges, edgeId, {}, &StorageEdge::id);
+}
+
+std::vector<StorageEdge> GraphSnapshot::getEdgesByIds(const std::vector<Id>& edgeIds) const {
+  std::vector<StorageEdge> edges;
+  edges.reserve(edgeIds.size());
+  for(const Id edgeId : edgeIds) {
+    const auto iterator = std::ranges::lower_bound(m_edges, edgeId, {}, &StorageEdge::id);
+    if(iterator != m_edges.end() && iterator->id == edgeId) {
+      edges.push_back(*iterator);
+    }
+  }
+  return edges;
+}
+
+std::vector<StorageEdge> GraphSnapshot::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const {
+  std::vector<StorageEdge> edges;
+  appendAdjacentEdges(SECTION_OUTGOING_OFFSETS, SECTION_OUTGOING_EDGES, sourceIds, edges);
+  return edges;
+}
+
+std::vector<StorageEdge> GraphSnapshot::getEdgesByTargetIds(const std::vector<Id>& targetIds) const {
+  std::vector<StorageEdge> edges;
+  appendAdjacentEdges(SECTION_INCOMING_OFFSETS, SECTION_INCOMING_EDGES, targetIds, edges);
+  return edges;
+}
+
+std::vector<StorageEdge> GraphSnapshot::getEdgesBySourceOrTargetId(Id nodeId) const {
+  std::vector<StorageEdge> edges;
+  appendAdjacentEdges(SECTION_OUTGOING_OFFSETS, SECTION_OUTGOING_EDGES, {nodeId}, edges);
+  appendAdjacentEdges(SECTION_INCOMING_OFFSETS, SECTION_INCOMING_EDGES, {nodeId}, edges);
+
+  // self references are adjacent in both directions
+  std::ranges::sort(edges, {}, &StorageEdge::id);
+  const auto duplicates = std::ranges::unique(edges, {}, &StorageEdge::id);
+  edges.erase(duplicates.begin(), duplicates.end());
+  return edges;
+}
+
+void GraphSnapshot::forEachNode(const std::function<void(StorageNode&&)>& func) const {
+  for(const Node& node : m_nodes) {
+    func(toStorageNode(node));
+  }
+}
+
+void GraphSnapshot::forEachEdgeOfType(int type, const std::function<void(const StorageEdge&)>& func) const {
+  for(const StorageEdge& edge : m_edges) {
+    if(edge.type == type) {
+      func(edge);
+    }
+  }
+}
+
+template <typename T>
+std::span<const T> GraphSnapshot::getSection(Section section) const {
+  const SectionRange& range = m_header->sections[section];
+  const char* data = static_cast<const char*>(m_mapping->region.get_address()) + range.offset;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<const T*>(data), static_cast<size_t>(range.count)};
+}
+
+std::optional<size_t> GraphSnapshot::getNodeIndex(Id nodeId) const {
+  const auto iterator = std::ranges::lower_bound(m_nodes, nodeId, {}, &Node::id);
+  if(iterator == m_nodes.end() || iterator->id != nodeId) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(iterator - m_nodes.begin());
+}
+
+StorageNode GraphSnapshot::toStorageNode(const Node& node) const {
+  return {node.id,
+          node.type,
+          std::wstring(m_strings.substr(std::min<size_t>(node.serializedName.offset, m_strings.size()),
+                                        static_cast<size_t>(node.serializedName.length)))};
+}
+
+void GraphSnapshot::appendAdjacentEdges(Section offsetSection,
+                                        Section edgeSection,
+                                        const std::vector<Id>& nodeIds,
+                                        std::vector<StorageEdge>& edges) const {
+  const std::span<const uint64_t> offsets = getSection<uint64_t>(offsetSection);
+  const std::span<const uint32_t> edgeIndexes = getSection<uint32_t>(edgeSection);
+
+  for(const Id nodeId : nodeIds) {
+    const std::optional<size_t> index = getNodeIndex(nodeId);
+    if(!index) {
+      continue;
+    }
+
+    const size_t end = std::min<size_t>(offsets[*index + 1], edgeIndexes.size());
+    for(size_t position = offsets[*index]; position < end; ++position) {
+      if(edgeIndexes[position] < m_edges.size()) {
+        edges.push_back(m_edges[edgeIndexes[position]]);
+      }
+    }
+  }
+}
@@ -0,0 +1,119 @@
+#pragma once
+// STL
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+// internal
+#include "GlobalId.hpp"
+#include "StorageEdge.h"
+#include "StorageNode.h"
+
+class FilePath;
+
+namespace graph_snapshot {
+
+struct StringRef {
+  uint64_t offset = 0;
+  uint64_t length = 0;
+};
+
+struct Node {
+  Id id = 0;
+  int32_t type = 0;
+  StringRef serializedName;
+};
+
+enum Section : uint32_t {
+  SECTION_NODES = 0,
+  SECTION_EDGES,
+  SECTION_OUTGOING_OFFSETS,
+  SECTION_OUTGOING_EDGES,
+  SECTION_INCOMING_OFFSETS,
+  SECTION_INCOMING_EDGES,
+  SECTION_STRINGS,
+  SECTION_COUNT
+};
+
+struct SectionRange {
+  uint64_t offset = 0;
+  uint64_t count = 0;
+};
+
+struct Header {
+  static constexpr uint32_t Magic = 0x53475354;    // "TSGS"
+  static constexpr uint32_t Version = 1;
+
+  uint32_t magic = Magic;
+  uint32_t version = Version;
+  uint64_t token = 0;
+  uint64_t byteSize = 0;
+  SectionRange sections[SECTION_COUNT] = {};
+};
+
+}    // namespace graph_snapshot
+
+/**
+ * @brief Read-only, memory mapped copy of the node and edge tables
+ *
+ * The snapshot is one flat file: nodes and edges sorted by id, a CSR adjacency of the edges by source and by target
+ * node (each node's edges ordered by type) and a wchar_t string pool for the serialized names. Graph queries read these
+ * arrays in place, so neither opening the snapshot nor answering a query touches the database.
+ *
+ * The token written into the header has to match the one the caller expects, which ties a snapshot to the state of the
+ * database it was written from.
+ */
+class GraphSnapshot final {
+public:
+  static bool write(const FilePath& filePath, uint64_t token, std::vector<StorageNode> nodes, std::vector<StorageEdge> edges);
+
+  /**
+   * @brief Maps the snapshot file, nullptr if it is missing, damaged or was written with another token
+   */
+  static std::unique_ptr<GraphSnapshot> open(const FilePath& filePath, uint64_t token);
+
+  ~GraphSnapshot();
+
+  size_t getNodeCount() const;
+  size_t getEdgeCount() const;
+
+  /**
+   * @brief The node or a node with id 0 if there is none, like SqliteIndexStorage::getFirstById
+   */
+  StorageNode getNodeById(Id nodeId) const;
+  std::optional<int> getNodeType(Id nodeId) const;
+  std::vector<StorageNode> getNodesByIds(const std::vector<Id>& nodeIds) const;
+
+  bool isEdge(Id edgeId) const;
+  std::vector<StorageEdge> getEdgesByIds(const std::vector<Id>& edgeIds) const;
+  std::vector<StorageEdge> getEdgesBySourceIds(const std::vector<Id>& sourceIds) const;
+  std::vector<StorageEdge> getEdgesByTargetIds(const std::vector<Id>& targetIds) const;
+  std::vector<StorageEdge> getEdgesBySourceOrTargetId(Id nodeId) const;
+
+  void forEachNode(const std::function<void(StorageNode&&)>& func) const;
+  void forEachEdgeOfType(int type, const std::function<void(const StorageEdge&)>& func) const;
+
+private:
+  struct Mapping;
+
+  explicit GraphSnapshot(std::unique_ptr<Mapping> mapping);
+
+  template <typename T>
+  std::span<const T> getSection(graph_snapshot::Section section) const;
+
+  std::optional<size_t> getNodeIndex(Id nodeId) const;
+  StorageNode toStorageNode(const graph_snapshot::Node& node) const;
+  void appendAdjacentEdges(graph_snapshot::Section offsetSection,
+                           graph_snapshot::Section edgeSection,
+                           const std::vector<Id>& nodeIds,
+                           std::vector<StorageEdge>& edges) const;
+
+  std::unique_ptr<Mapping> m_mapping;
+  const graph_snapshot::Header* m_header = nullptr;
+  std::span<const graph_snapshot::Node> m_nodes;
+  std::span<const StorageEdge> m_edges;
+  std::wstring_view m_strings;
+};
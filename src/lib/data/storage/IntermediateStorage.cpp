@@ -6,20 +6,22 @@
 #include <range/v3/view/transform.hpp>
 
 #include "LocationType.h"
+#include "TextAccess.h"
 #include "utility.h"
 
-IntermediateStorage::IntermediateStorage() = default;
+IntermediateStorage::IntermediateStorage()
+    : mNodesIndex(0, {&mNodes}, {&mNodes}), mFilesIndex(0, {&mFiles}, {&mFiles}) {}
 
 IntermediateStorage::~IntermediateStorage() = default;
 
 void IntermediateStorage::clear() {
+  mNodes.clear();
   mNodesIndex.clear();
   mNodeIdIndex.clear();
-  mNodes.clear();
 
+  mFiles.clear();
   mFilesIndex.clear();
   mFilesIdIndex.clear();
-  mFiles.clear();
 
   mSymbols.clear();
 
@@ -30,6 +32,7 @@ void IntermediateStorage::clear() {
   mSourceLocations.clear();
   mOccurrences.clear();
   mComponentAccesses.clear();
+  mElementComponents.clear();
 
   mErrorsIndex.clear();
   mErrors.clear();
@@ -44,6 +47,9 @@ size_t IntermediateStorage::getByteSize(size_t stringSize) const {
     byteSize += sizeof(StorageFile);
     byteSize += stringSize + storageFile.filePath.size();
     byteSize += stringSize + storageFile.modificationTime.size();
+    if(storageFile.content) {
+      byteSize += stringSize + storageFile.content->size();
+    }
   }
 
   for(const StorageErrorData& storageError : getErrors()) {
@@ -97,8 +103,8 @@ void IntermediateStorage::setFilesWithErrorsIncomplete() {
 }
 
 std::pair<Id, bool> IntermediateStorage::addNode(const StorageNodeData& nodeData) {
-  if(auto found = mNodesIndex.find(nodeData); found != mNodesIndex.end()) {
-    StorageNode& storedNode = mNodes[found->second];
+  if(auto found = mNodesIndex.find(std::wstring_view(nodeData.serializedName)); found != mNodesIndex.end()) {
+    StorageNode& storedNode = mNodes[*found];
     if(storedNode.type < nodeData.type) {
       storedNode.type = nodeData.type;
     }
@@ -107,7 +113,7 @@ std::pair<Id, bool> IntermediateStorage::addNode(const StorageNodeData& nodeData
 
   const Id nodeId = mNextId++;
   mNodes.emplace_back(nodeId, nodeData);
-  mNodesIndex.emplace(nodeData, mNodes.size() - 1);
+  mNodesIndex.emplace(mNodes.size() - 1);
   mNodeIdIndex.emplace(nodeId, mNodes.size() - 1);
   return {nodeId, true};
 }
@@ -124,8 +130,8 @@ void IntermediateStorage::setNodeType(Id nodeId, int nodeType) {
 }
 
 void IntermediateStorage::addFile(const StorageFile& file) {
-  if(auto found = mFilesIndex.find(file); found != mFilesIndex.end()) {
-    StorageFile& storedFile = mFiles[found->second];
+  if(auto found = mFilesIndex.find(std::wstring_view(file.filePath)); found != mFilesIndex.end()) {
+    StorageFile& storedFile = mFiles[*found];
 
     if(file.indexed) {
       storedFile.indexed = true;
@@ -138,10 +144,14 @@ void IntermediateStorage::addFile(const StorageFile& file) {
     if(!file.languageIdentifier.empty()) {
       storedFile.languageIdentifier = file.languageIdentifier;
     }
+
+    if(!storedFile.content) {
+      storedFile.content = file.content;
+    }
   } else {
-    mFilesIndex.emplace(file, mFiles.size());
-    mFilesIdIndex.emplace(file.id, mFiles.size());
     mFiles.emplace_back(file);
+    mFilesIndex.emplace(mFiles.size() - 1);
+    mFilesIdIndex.emplace(file.id, mFiles.size() - 1);
   }
 }
 
@@ -151,6 +161,12 @@ void IntermediateStorage::setFileLanguage(Id fileId, const std::wstring& languag
   }
 }
 
+void IntermediateStorage::setFileContent(Id fileId, std::string_view content) {
+  if(auto found = mFilesIdIndex.find(fileId); found != mFilesIdIndex.end()) {
+    mFiles[found->second].content = std::make_shared<const std::string>(TextAccess::createFromFileContent(content)->getText());
+  }
+}
+
 Id IntermediateStorage::addEdge(const StorageEdgeData& edgeData) {
   if(auto found = mEdgesIndex.find(edgeData); found != mEdgesIndex.end()) {
     return mEdges[found->second].id;
@@ -168,12 +184,14 @@ std::vector<Id> IntermediateStorage::addEdges(const std::vector<StorageEdge>& ed
 }
 
 Id IntermediateStorage::addLocalSymbol(const StorageLocalSymbolData& localSymbolData) {
-  if(auto found = mLocalSymbols.find(StorageLocalSymbol(0, localSymbolData)); found != mLocalSymbols.end()) {
+  // a single tree traversal for both the lookup and the insertion
+  auto found = mLocalSymbols.lower_bound(StorageLocalSymbol(0, localSymbolData));
+  if(found != mLocalSymbols.end() && !(localSymbolData < *found)) {
     return found->id;
   }
 
   const Id localSymbolId = mNextId++;
-  mLocalSymbols.emplace(localSymbolId, localSymbolData);
+  mLocalSymbols.emplace_hint(found, localSymbolId, localSymbolData);
   return localSymbolId;
 }
 
@@ -183,12 +201,14 @@ std::vector<Id> IntermediateStorage::addLocalSymbols(const std::set<StorageLocal
 }
 
 Id IntermediateStorage::addSourceLocation(const StorageSourceLocationData& sourceLocationData) {
-  if(auto found = mSourceLocations.find(StorageSourceLocation(0, sourceLocationData)); found != mSourceLocations.end()) {
+  // a single tree traversal for both the lookup and the insertion
+  auto found = mSourceLocations.lower_bound(StorageSourceLocation(0, sourceLocationData));
+  if(found != mSourceLocations.end() && !(sourceLocationData < *found)) {
     return found->id;
   }
 
   const Id sourceLocationId = mNextId++;
-  mSourceLocations.emplace(sourceLocationId, sourceLocationData);
+  mSourceLocations.emplace_hint(found, sourceLocationId, sourceLocationData);
   return sourceLocationId;
 }
 
@@ -211,32 +231,22 @@ Id IntermediateStorage::addError(const StorageErrorData& errorData) {
 
 void IntermediateStorage::setStorageNodes(std::vector<StorageNode> storageNodes) {
   mNodes = std::move(storageNodes);
-
-  mNodesIndex.clear();
-  mNodeIdIndex.clear();
-  for(const auto& [index, node] : ranges::views::enumerate(mNodes)) {
-    mNodesIndex.emplace(node, index);
-    mNodeIdIndex.emplace(node.id, index);
-  }
+  rebuildNodeIndices();
 }
 
 void IntermediateStorage::setStorageFiles(std::vector<StorageFile> storageFiles) {
   mFiles = std::move(storageFiles);
-
-  mFilesIndex.clear();
-  mFilesIdIndex.clear();
-  for(const auto& [index, file] : ranges::views::enumerate(mFiles)) {
-    mFilesIndex.emplace(file, index);
-    mFilesIdIndex.emplace(file.id, index);
-  }
+  rebuildFileIndices();
 }
 
 void IntermediateStorage::setStorageEdges(std::vector<StorageEdge> storageEdges) {
   mEdges = std::move(storageEdges);
 
-  mEdgesIndex = mEdges | ranges::views::enumerate |
-      ranges::views::transform([](const auto& item) -> std::pair<StorageEdgeData, size_t> { return {item.second, item.first}; }) |
-      ranges::to<std::map>();
+  mEdgesIndex.clear();
+  mEdgesIndex.reserve(mEdges.size());
+  for(const auto& [index, edge] : ranges::views::enumerate(mEdges)) {
+    mEdgesIndex.emplace(edge, index);
+  }
 }
 
 void IntermediateStorage::setErrors(std::vector<StorageError> errors) {
@@ -246,3 +256,25 @@ void IntermediateStorage::setErrors(std::vector<StorageError> errors) {
       ranges::views::transform([](const auto& item) -> std::pair<StorageErrorData, size_t> { return {item.second, item.first}; }) |
       ranges::to<std::map>();
 }
+
+void IntermediateStorage::rebuildNodeIndices() {
+  mNodesIndex.clear();
+  mNodeIdIndex.clear();
+  mNodesIndex.reserve(mNodes.size());
+  mNodeIdIndex.reserve(mNodes.size());
+  for(const auto& [index, node] : ranges::views::enumerate(mNodes)) {
+    mNodesIndex.emplace(index);
+    mNodeIdIndex.emplace(node.id, index);
+  }
+}
+
+void IntermediateStorage::rebuildFileIndices() {
+  mFilesIndex.clear();
+  mFilesIdIndex.clear();
+  mFilesIndex.reserve(mFiles.size());
+  mFilesIdIndex.reserve(mFiles.size());
+  for(const auto& [index, file] : ranges::views::enumerate(mFiles)) {
+    mFilesIndex.emplace(index);
+    mFilesIdIndex.emplace(file.id, index);
+  }
+}
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "Storage.h"
 
@@ -43,6 +47,11 @@ public:
 
   void setFileLanguage(Id fileId, const std::wstring& languageIdentifier);
 
+  /**
+   * @brief Keeps the text of the file with its line breaks normalized like TextAccess::createFromFile does
+   */
+  void setFileContent(Id fileId, std::string_view content);
+
   Id addEdge(const StorageEdgeData& edgeData) override;
 
   std::vector<Id> addEdges(const std::vector<StorageEdge>& edges) override;
@@ -147,6 +156,10 @@ public:
     mComponentAccesses = std::move(componentAccesses);
   }
 
+  void setElementComponents(std::set<StorageElementComponent> elementComponents) {
+    mElementComponents = std::move(elementComponents);
+  }
+
   void setErrors(std::vector<StorageError> errors);
 
   [[nodiscard]] Id getNextId() const {
@@ -158,17 +171,76 @@ public:
   }
 
 private:
-  std::map<StorageNodeData, size_t> mNodesIndex;
-  std::map<Id, size_t> mNodeIdIndex;
+  /**
+   * Hash index over a record vector that stores positions instead of keys, so every name is held only once (by the
+   * record itself) and lookups by name do not allocate.
+   */
+  template <typename Record, auto Key>
+  struct RecordKeyHash {
+    using is_transparent = void;
+
+    size_t operator()(size_t index) const {
+      return std::hash<std::wstring_view>{}((*records)[index].*Key);
+    }
+
+    size_t operator()(std::wstring_view key) const {
+      return std::hash<std::wstring_view>{}(key);
+    }
+
+    const std::vector<Record>* records;
+  };
+
+  template <typename Record, auto Key>
+  struct RecordKeyEqual {
+    using is_transparent = void;
+
+    bool operator()(size_t indexA, size_t indexB) const {
+      return (*records)[indexA].*Key == (*records)[indexB].*Key;
+    }
+
+    bool operator()(std::wstring_view key, size_t index) const {
+      return key == (*records)[index].*Key;
+    }
+
+    bool operator()(size_t index, std::wstring_view key) const {
+      return (*records)[index].*Key == key;
+    }
+
+    const std::vector<Record>* records;
+  };
+
+  template <typename Record, auto Key>
+  using RecordIndex = std::unordered_set<size_t, RecordKeyHash<Record, Key>, RecordKeyEqual<Record, Key>>;
+
+  struct EdgeDataHash {
+    size_t operator()(const StorageEdgeData& edge) const {
+      size_t seed = std::hash<int>{}(edge.type);
+      seed ^= std::hash<Id>{}(edge.sourceNodeId) + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+      seed ^= std::hash<Id>{}(edge.targetNodeId) + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+      return seed;
+    }
+  };
+
+  struct EdgeDataEqual {
+    bool operator()(const StorageEdgeData& edgeA, const StorageEdgeData& edgeB) const {
+      return edgeA.type == edgeB.type && edgeA.sourceNodeId == edgeB.sourceNodeId && edgeA.targetNodeId == edgeB.targetNodeId;
+    }
+  };
+
+  void rebuildNodeIndices();
+  void rebuildFileIndices();
+
   std::vector<StorageNode> mNodes;
+  RecordIndex<StorageNode, &StorageNodeData::serializedName> mNodesIndex;
+  std::unordered_map<Id, size_t> mNodeIdIndex;
 
-  std::map<StorageFile, size_t> mFilesIndex;    // this is used to prevent duplicates (unique)
-  std::map<Id, size_t> mFilesIdIndex;
   std::vector<StorageFile> mFiles;
+  RecordIndex<StorageFile, &StorageFile::filePath> mFilesIndex;    // this is used to prevent duplicates (unique)
+  std::unordered_map<Id, size_t> mFilesIdIndex;
 
   std::vector<StorageSymbol> mSymbols;
 
-  std::map<StorageEdgeData, size_t> mEdgesIndex;
+  std::unordered_map<StorageEdgeData, size_t, EdgeDataHash, EdgeDataEqual> mEdgesIndex;
   std::vector<StorageEdge> mEdges;
 
   std::set<StorageLocalSymbol> mLocalSymbols;
@@ -0,0 +1,79 @@
+#include "NameTable.h"
+
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr size_t ChunkSize = 64 * 1024;
+}    // namespace
+
+NameTable::NameTable() : m_index(0, {&m_names}, {&m_names}) {}
+
+NameTable::~NameTable() = default;
+
+std::pair<NameTable::Handle, bool> NameTable::intern(std::string_view name) {
+  if(auto found = m_index.find(name); found != m_index.end()) {
+    return {*found, false};
+  }
+
+  if(m_names.size() >= std::numeric_limits<Handle>::max()) {
+    throw std::length_error("NameTable is out of handles");
+  }
+
+  const auto handle = static_cast<Handle>(m_names.size());
+  m_names.push_back(store(name));
+  m_index.insert(handle);
+  return {handle, true};
+}
+
+std::optional<NameTable::Handle> NameTable::find(std::string_view name) const {
+  if(auto found = m_index.find(name); found != m_index.end()) {
+    return *found;
+  }
+  return std::nullopt;
+}
+
+size_t NameTable::getByteSize() const {
+  // an unordered_set node holds the handle, the cached hash and the next pointer
+  return m_arenaSize + m_names.capacity() * sizeof(std::string_view) +
+      m_index.size() * (sizeof(Handle) + 2 * sizeof(void*)) + m_index.bucket_count() * sizeof(void*);
+}
+
+void NameTable::clear() {
+  m_index.clear();
+  m_names.clear();
+  m_chunks.clear();
+  m_chunkUsed = 0;
+  m_chunkSize = 0;
+  m_arenaSize = 0;
+}
+
+std::string_view NameTable::store(std::string_view name) {
+  if(name.empty()) {
+    return {};
+  }
+
+  // long names get a chunk of their own in front of the current one, which keeps its free space
+  if(name.size() > ChunkSize / 4) {
+    auto chunk = std::make_unique<char[]>(name.size());
+    std::memcpy(chunk.get(), name.data(), name.size());
+    const std::string_view stored(chunk.get(), name.size());
+    m_chunks.insert(m_chunks.empty() ? m_chunks.end() : std::prev(m_chunks.end()), std::move(chunk));
+    m_arenaSize += name.size();
+    return stored;
+  }
+
+  if(m_chunkSize - m_chunkUsed < name.size()) {
+    m_chunks.emplace_back(std::make_unique<char[]>(ChunkSize));
+    m_chunkUsed = 0;
+    m_chunkSize = ChunkSize;
+    m_arenaSize += ChunkSize;
+  }
+
+  char* data = m_chunks.back().get() + m_chunkUsed;
+  std::memcpy(data, name.data(), name.size());
+  m_chunkUsed += name.size();
+  return {data, name.size()};
+}
@@ -0,0 +1,100 @@
+#pragma once
+// STL
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Interns UTF-8 names and hands out dense 32-bit handles for them
+ *
+ * Every distinct name is copied once into an append-only arena, so the string_view returned by get() stays valid until
+ * clear() is called and the handles are stable for the lifetime of the table. Handles are assigned in insertion order
+ * starting at 0, which lets callers keep per-name data in a plain vector indexed by handle.
+ *
+ * The table is not synchronized, each owner keeps its own.
+ */
+class NameTable final {
+public:
+  using Handle = uint32_t;
+
+  NameTable();
+  NameTable(const NameTable&) = delete;
+  NameTable(NameTable&&) = delete;
+  NameTable& operator=(const NameTable&) = delete;
+  NameTable& operator=(NameTable&&) = delete;
+  ~NameTable();
+
+  /**
+   * @brief Returns the handle of the name and whether it was added by this call
+   */
+  std::pair<Handle, bool> intern(std::string_view name);
+
+  [[nodiscard]] std::optional<Handle> find(std::string_view name) const;
+
+  [[nodiscard]] std::string_view get(Handle handle) const {
+    return m_names[handle];
+  }
+
+  [[nodiscard]] size_t size() const {
+    return m_names.size();
+  }
+
+  [[nodiscard]] bool empty() const {
+    return m_names.empty();
+  }
+
+  /**
+   * @brief Bytes held by the arena, the handle table and the hash index
+   */
+  [[nodiscard]] size_t getByteSize() const;
+
+  void clear();
+
+private:
+  struct HandleHash {
+    using is_transparent = void;
+
+    size_t operator()(Handle handle) const {
+      return std::hash<std::string_view>{}((*names)[handle]);
+    }
+
+    size_t operator()(std::string_view name) const {
+      return std::hash<std::string_view>{}(name);
+    }
+
+    const std::vector<std::string_view>* names;
+  };
+
+  struct HandleEqual {
+    using is_transparent = void;
+
+    bool operator()(Handle handleA, Handle handleB) const {
+      return handleA == handleB;
+    }
+
+    bool operator()(std::string_view name, Handle handle) const {
+      return name == (*names)[handle];
+    }
+
+    bool operator()(Handle handle, std::string_view name) const {
+      return (*names)[handle] == name;
+    }
+
+    const std::vector<std::string_view>* names;
+  };
+
+  std::string_view store(std::string_view name);
+
+  std::vector<std::unique_ptr<char[]>> m_chunks;
+  size_t m_chunkUsed = 0;
+  size_t m_chunkSize = 0;
+  size_t m_arenaSize = 0;
+
+  std::vector<std::string_view> m_names;
+  std::unordered_set<Handle, HandleHash, HandleEqual> m_index;
+};
@@ -1,6 +1,8 @@
 #include "PersistentStorage.h"
 
+#include <optional>
 #include <queue>
+#include <random>
 
 #include <QVector2D>
 
@@ -44,6 +46,10 @@ PersistentStorage::PersistentStorage(const FilePath& dbPath, const FilePath& boo
   m_commandIndex.finishSetup();
 }
 
+PersistentStorage::~PersistentStorage() {
+  waitForCacheBuildReport();
+}
+
 std::pair<Id, bool> PersistentStorage::addNode(const StorageNodeData& data) {
   return std::make_pair(m_sqliteIndexStorage.addNode(data), true);
 }
@@ -70,6 +76,11 @@ void PersistentStorage::addFile(const StorageFile& data) {
       m_sqliteIndexStorage.setFileIndexed(storedFile.id, data.indexed);
     }
 
+    // a header is recorded by every translation unit including it, only the one claiming it captures its content
+    if(data.indexed && data.content && !m_sqliteIndexStorage.hasFileContent(storedFile.id)) {
+      m_sqliteIndexStorage.setFileContent(storedFile.id, *data.content);
+    }
+
     if(storedFile.complete != data.complete) {
       m_sqliteIndexStorage.setFileCompleteIfNoError(storedFile.id, storedFile.filePath, data.complete);
     }
@@ -236,13 +247,129 @@ void PersistentStorage::afterErrorRecording() {
 }
 
 void PersistentStorage::setMode(const SqliteIndexStorage::StorageModeType mode) {
+  // the journal mode can only change while the main connection is the only one
+  setReadConnectionsEnabled(false);
+
+  if(mode != SqliteIndexStorage::STORAGE_MODE_READ && m_sqliteIndexStorage.getGraphSnapshotToken() != 0) {
+    // the graph is about to change, so the snapshot no longer matches
+    m_graphSnapshot.reset();
+    m_sqliteIndexStorage.setGraphSnapshotToken(0);
+  }
+
   m_sqliteIndexStorage.setMode(mode);
+
+  // reads during indexing have to see the uncommitted writes of the main connection
+  setReadConnectionsEnabled(mode == SqliteIndexStorage::STORAGE_MODE_READ);
+}
+
+void PersistentStorage::addMissingFileContents() {
+  if(const size_t fileCount = m_sqliteIndexStorage.addMissingFileContentsFromDisk(); fileCount > 0) {
+    LOG_INFO(fmt::format("Read the content of {} indexed files from disk", fileCount));
+  }
+}
+
+void PersistentStorage::addFullTextSearchTrigrams() {
+  const TextCodec codec(IApplicationSettings::getInstanceRaw()->getTextEncoding());
+
+  std::vector<std::pair<Id, std::string>> encodedTrigrams;
+  std::mutex encodedTrigramsMutex;
+  computeFullTextSearchTrigrams(m_sqliteIndexStorage.getIndexedFileIdsWithoutFullTextSearchTrigrams(codec.getName()),
+                                codec,
+                                [&](Id fileId, const std::vector<FullTextSearchIndex::Trigram>& trigrams) {
+                                  std::string encoded = FullTextSearchIndex::encodeTrigrams(trigrams);
+                                  const std::lock_guard<std::mutex> lock(encodedTrigramsMutex);
+                                  encodedTrigrams.emplace_back(fileId, std::move(encoded));
+                                });
+  m_sqliteIndexStorage.addFullTextSearchTrigrams(encodedTrigrams, codec.getName());
+}
+
+void PersistentStorage::checkpoint() const {
+  m_sqliteIndexStorage.checkpoint();
+}
+
+void PersistentStorage::leaveWriteAheadLog() {
+  setReadConnectionsEnabled(false);
+  m_sqliteIndexStorage.leaveWriteAheadLog();
+}
+
+template <typename Func>
+auto PersistentStorage::withReadConnection(Func&& func) const {
+  std::unique_ptr<SqliteIndexStorage> connection = acquireReadConnection();
+  if(!connection) {
+    // the main connection serves one thread at a time, so concurrent callers like the fulltext search workers take turns
+    const std::lock_guard<std::mutex> lock(m_mainConnectionMutex);
+    return func(m_sqliteIndexStorage);
+  }
+
+  struct Release {
+    const PersistentStorage* storage;
+    std::unique_ptr<SqliteIndexStorage>& connection;
+    ~Release() {
+      storage->releaseReadConnection(std::move(connection));
+    }
+  } release{this, connection};
+  return func(static_cast<const SqliteIndexStorage&>(*connection));
+}
+
+std::unique_ptr<SqliteIndexStorage> PersistentStorage::acquireReadConnection() const {
+  {
+    std::unique_lock<std::mutex> lock(m_readConnectionMutex);
+    // the cached statements of a connection must not be shared between threads, so callers beyond the limit wait
+    m_readConnectionReleased.wait(lock, [this]() {
+      return !m_readConnectionsEnabled || !m_readConnections.empty() || m_readConnectionCount < MaxReadConnectionCount;
+    });
+    if(!m_readConnectionsEnabled) {
+      return nullptr;
+    }
+    if(!m_readConnections.empty()) {
+      std::unique_ptr<SqliteIndexStorage> connection = std::move(m_readConnections.back());
+      m_readConnections.pop_back();
+      return connection;
+    }
+    m_readConnectionCount++;
+  }
+
+  try {
+    return std::make_unique<SqliteIndexStorage>(getIndexDbFilePath(), SqliteStorage::OpenMode::ReadOnly);
+  } catch(...) {
+    // already logged, the query falls back to the main connection
+    std::lock_guard<std::mutex> lock(m_readConnectionMutex);
+    m_readConnectionCount--;
+    m_readConnectionReleased.notify_one();
+    return nullptr;
+  }
+}
+
+void PersistentStorage::releaseReadConnection(std::unique_ptr<SqliteIndexStorage> connection) const {
+  {
+    std::lock_guard<std::mutex> lock(m_readConnectionMutex);
+    if(m_readConnectionsEnabled) {
+      m_readConnections.push_back(std::move(connection));
+    } else {
+      m_readConnectionCount--;
+    }
+  }
+  m_readConnectionReleased.notify_one();
+}
+
+void PersistentStorage::setReadConnectionsEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_readConnectionMutex);
+  m_readConnectionsEnabled = enabled && !getIndexDbFilePath().empty();
+  if(!m_readConnectionsEnabled) {
+    m_readConnectionCount -= m_readConnections.size();
+    m_readConnections.clear();
+    m_readConnectionReleased.notify_all();
+  }
 }
 
 FilePath PersistentStorage::getIndexDbFilePath() const {
   return m_sqliteIndexStorage.getDbFilePath();
 }
 
+FilePath PersistentStorage::getGraphSnapshotFilePath() const {
+  return FilePath(getIndexDbFilePath().wstr() + L".graph");
+}
+
 FilePath PersistentStorage::getBookmarkDbFilePath() const {
   return m_sqliteBookmarkStorage.getDbFilePath();
 }
@@ -284,6 +411,13 @@ void PersistentStorage::clear() {
 }
 
 void PersistentStorage::clearCaches() {
+  waitForCacheBuildReport();
+  m_cacheBuildReport = {};
+  m_inheritanceCacheBuild = {};
+  m_symbolIndexBuild = {};
+
+  m_graphSnapshot.reset();
+
   m_symbolIndex.clear();
   m_fileIndex.clear();
 
@@ -295,7 +429,10 @@ void PersistentStorage::clearCaches() {
   m_fileNodeLanguage.clear();
   m_symbolDefinitionKinds.clear();
 
+  m_memberEdgeIdOrderMap.clear();
+
   m_hierarchyCache.clear();
+  m_inheritanceCache.clear();
   m_fullTextSearchIndex.clear();
   m_fullTextSearchCodec = "";
 }
@@ -352,6 +489,22 @@ std::vector<FileInfo> PersistentStorage::getFileInfoForAllFiles() const {
   return fileInfos;
 }
 
+std::map<FilePath, uint64_t> PersistentStorage::getContentHashesForAllFiles() const {
+  std::map<FilePath, uint64_t> contentHashes;
+  for(auto& [filePath, contentHash] : m_sqliteIndexStorage.getFileContentHashes()) {
+    contentHashes.emplace(FilePath(filePath), contentHash);
+  }
+  return contentHashes;
+}
+
+std::vector<StorageIndexingCost> PersistentStorage::getIndexingCosts() const {
+  return m_sqliteIndexStorage.getIndexingCosts();
+}
+
+void PersistentStorage::setIndexingCosts(const std::vector<StorageIndexingCost>& costs) {
+  m_sqliteIndexStorage.setIndexingCosts(costs);
+}
+
 std::set<FilePath> PersistentStorage::getIncompleteFiles() const {
   std::set<FilePath> incompleteFiles;
   for(const auto& [id, complete] : m_fileNodeComplete) {
@@ -372,13 +525,117 @@ bool PersistentStorage::getFilePathIndexed(const FilePath& path) const {
   return false;
 }
 
-void PersistentStorage::buildCaches() {
+void PersistentStorage::buildCaches(bool buildInBackground) {
   clearCaches();
 
+  m_graphSnapshot = GraphSnapshot::open(getGraphSnapshotFilePath(), m_sqliteIndexStorage.getGraphSnapshotToken());
+  if(m_graphSnapshot) {
+    LOG_INFO(fmt::format("Using graph snapshot with {} nodes and {} edges",
+                         m_graphSnapshot->getNodeCount(),
+                         m_graphSnapshot->getEdgeCount()));
+  }
+
+  // all tables are scanned on this thread, the database connection must not be shared with the workers
+  TimeStamp start = TimeStamp::now();
   buildFilePathMaps();
-  buildSearchIndex();
-  buildMemberEdgeIdOrderMap();
-  buildHierarchyCache();
+  const size_t filePathMapsMs = TimeStamp::now().deltaMS(start);
+
+  // an adopted symbol index only needs the nodes that changed since the database was copied
+  const std::optional<std::vector<Id>> changedNodeIds = m_sqliteIndexStorage.takeChangedNodeIds();
+  std::unordered_set<Id> removedNodeIds;
+  if(m_adoptedSymbolIndex && changedNodeIds) {
+    m_symbolIndex = std::move(*m_adoptedSymbolIndex);
+    removedNodeIds.insert(changedNodeIds->begin(), changedNodeIds->end());
+  }
+  const bool updateSymbolIndex = m_adoptedSymbolIndex && changedNodeIds;
+  m_adoptedSymbolIndex.reset();
+
+  start = TimeStamp::now();
+  std::vector<StorageNode> symbolNodes = buildFileIndex(updateSymbolIndex ? &*changedNodeIds : nullptr);
+  const size_t fileIndexMs = TimeStamp::now().deltaMS(start);
+
+  m_symbolIndexBuild = std::async(std::launch::async,
+                                  [this, removedNodeIds = std::move(removedNodeIds), symbolNodes = std::move(symbolNodes)]() {
+                                    return buildSymbolIndex(removedNodeIds, symbolNodes);
+                                  })
+                           .share();
+
+  start = TimeStamp::now();
+  std::vector<StorageEdge> memberEdges;
+  forEachStorageEdgeOfType(Edge::typeToInt(Edge::EDGE_MEMBER),
+                           [&memberEdges](StorageEdge&& edge) { memberEdges.push_back(std::move(edge)); });
+  buildHierarchyCache(memberEdges);
+  const size_t hierarchyMs = TimeStamp::now().deltaMS(start);
+
+  start = TimeStamp::now();
+  buildMemberEdgeIdOrderMap(memberEdges);
+  const size_t memberEdgeOrderMs = TimeStamp::now().deltaMS(start);
+
+  std::vector<StorageEdge> inheritanceEdges;
+  forEachStorageEdgeOfType(Edge::typeToInt(Edge::EDGE_INHERITANCE),
+                           [&inheritanceEdges](StorageEdge&& edge) { inheritanceEdges.push_back(std::move(edge)); });
+
+  const std::wstring times = fmt::format(L"file paths {} ms, file search {} ms, hierarchy {} ms, member order {} ms",
+                                         filePathMapsMs,
+                                         fileIndexMs,
+                                         hierarchyMs,
+                                         memberEdgeOrderMs);
+
+  m_inheritanceCacheBuild = std::async(std::launch::async,
+                                       [this, inheritanceEdges = std::move(inheritanceEdges)]() {
+                                         return buildInheritanceCache(inheritanceEdges);
+                                       })
+                                .share();
+
+  // neither worker waits for the other, the report is assembled once both are done
+  auto reportCacheBuild = [buildInBackground,
+                           times,
+                           inheritanceCacheBuild = m_inheritanceCacheBuild,
+                           symbolIndexBuild = m_symbolIndexBuild]() {
+    const std::wstring message = fmt::format(
+        L"Built caches: {}, inheritance {} ms, symbol search {} ms", times, inheritanceCacheBuild.get(), symbolIndexBuild.get());
+
+    LOG_INFO(message);
+    if(buildInBackground) {
+      // dispatch only queues the message, the message loop delivers it on its own thread
+      MessageStatus(message, false, false).dispatch();
+    }
+  };
+  m_cacheBuildReport = std::async(std::launch::async, std::move(reportCacheBuild));
+
+  if(!buildInBackground) {
+    waitForCacheBuildReport();
+  }
+}
+
+void PersistentStorage::trackSymbolIndexChanges() {
+  m_sqliteIndexStorage.trackNodeChanges();
+}
+
+SearchIndex PersistentStorage::takeSymbolIndex() {
+  waitForSymbolIndex();
+  return std::move(m_symbolIndex);
+}
+
+void PersistentStorage::adoptSymbolIndex(SearchIndex symbolIndex) {
+  m_adoptedSymbolIndex.emplace(std::move(symbolIndex));
+}
+
+void PersistentStorage::writeGraphSnapshot() {
+  m_graphSnapshot.reset();
+
+  // the token ties the snapshot to this database, so a snapshot left behind by another database is never used
+  std::random_device randomDevice;
+  const uint64_t token = (static_cast<uint64_t>(randomDevice()) << 32U | randomDevice()) | 1U;
+
+  TimeStamp start = TimeStamp::now();
+  if(GraphSnapshot::write(getGraphSnapshotFilePath(),
+                          token,
+                          m_sqliteIndexStorage.getAll<StorageNode>(),
+                          m_sqliteIndexStorage.getAll<StorageEdge>())) {
+    m_sqliteIndexStorage.setGraphSnapshotToken(token);
+    LOG_INFO(fmt::format("Wrote graph snapshot in {} ms", TimeStamp::now().deltaMS(start)));
+  }
 }
 
 void PersistentStorage::optimizeMemory() {
@@ -408,12 +665,12 @@ std::vector<Id> PersistentStorage::getNodeIdsForNameHierarchies(const std::vecto
 }
 
 NameHierarchy PersistentStorage::getNameHierarchyForNodeId(Id nodeId) const {
-  return NameHierarchy::deserialize(m_sqliteIndexStorage.getFirstById<StorageNode>(nodeId).serializedName);
+  return NameHierarchy::deserialize(getStorageNodeById(nodeId).serializedName);
 }
 
 std::vector<NameHierarchy> PersistentStorage::getNameHierarchiesForNodeIds(const std::vector<Id>& nodeIds) const {
   std::vector<NameHierarchy> nameHierarchies;
-  for(const StorageNode& storageNode : m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIds)) {
+  for(const StorageNode& storageNode : getStorageNodesByIds(nodeIds)) {
     nameHierarchies.push_back(NameHierarchy::deserialize(storageNode.serializedName));
   }
   return nameHierarchies;
@@ -454,11 +711,11 @@ std::map<Id, std::pair<Id, NameHierarchy>> PersistentStorage::getNodeIdToParentF
 }
 
 NodeType PersistentStorage::getNodeTypeForNodeWithId(Id nodeId) const {
-  return NodeType(intToNodeKind(m_sqliteIndexStorage.getFirstById<StorageNode>(nodeId).type));
+  return NodeType(intToNodeKind(getStorageNodeById(nodeId).type));
 }
 
 StorageEdge PersistentStorage::getEdgeById(Id edgeId) const {
-  return m_sqliteIndexStorage.getEdgeById(edgeId);
+  return getStorageEdgeById(edgeId);
 }
 
 std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLocations(const std::wstring& searchTerm,
@@ -486,25 +743,32 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLo
   {
     std::vector<std::shared_ptr<std::thread>> threads;
     std::mutex collectionMutex;
-    for(std::vector<FullTextSearchResult> fileResults : utility::splitToEquallySizedParts(
-            m_fullTextSearchIndex.searchForTerm(searchTerm), static_cast<std::size_t>(utility::getIdealThreadCount()))) {
+    for(std::vector<Id> fileIds : utility::splitToEquallySizedParts(
+            m_fullTextSearchIndex.getCandidateFileIds(searchTerm), static_cast<std::size_t>(utility::getIdealThreadCount()))) {
       std::shared_ptr<std::thread> thread = std::make_shared<std::thread>([this,
                                                                            &searchTerm,
                                                                            &caseSensitive,
                                                                            &codec,
-                                                                           /*no ref here!*/ fileResults,
+                                                                           /*no ref here!*/ fileIds,
                                                                            &collection,
                                                                            &collectionMutex]() {
         const int termLength = static_cast<int>(searchTerm.length());
-        for(const FullTextSearchResult& fileResult : fileResults) {
-          const FilePath filePath = getFileNodePath(fileResult.fileId);
+        for(const Id fileId : fileIds) {
+          const FilePath filePath = getFileNodePath(fileId);
           std::shared_ptr<TextAccess> fileContent = getFileContent(filePath, false);
 
+          // the trigram index only yields candidates, the exact positions are found in the decoded content
+          const std::vector<int> positions = FullTextSearchIndex::findTermPositions(codec.decode(fileContent->getText()),
+                                                                                    searchTerm);
+          if(positions.empty()) {
+            continue;
+          }
+
           int charsTotal = 0;
           uint32_t lineNumber = 1U;
           std::wstring line = codec.decode(fileContent->getLine(lineNumber));
 
-          for(int pos : fileResult.positions) {
+          for(int pos : positions) {
             while(charsTotal + static_cast<int>(line.length()) <= pos) {
               charsTotal += static_cast<int>(line.length());
               lineNumber++;
@@ -515,7 +779,7 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getFullTextSearchLo
             location.startLineNumber = lineNumber;
             location.startColumnNumber = static_cast<std::size_t>(pos - charsTotal + 1);
 
-            if(caseSensitive && line.substr(location.startColumnNumber - 1, static_cast<std::size_t>(termLength)) != searchTerm) {
+            if(caseSensitive && line.compare(location.startColumnNumber - 1, static_cast<std::size_t>(termLength), searchTerm) != 0) {
               continue;
             }
             while((charsTotal + static_cast<int>(line.length())) < pos + termLength) {
@@ -642,6 +906,8 @@ std::vector<SearchMatch> PersistentStorage::getAutocompletionSymbolMatches(const
                                                                            size_t maxResultsCount,
                                                                            size_t maxBestScoredResultsLength) const {
   // search in indices
+  waitForSymbolIndex();
+
   const std::vector<SearchResult> results = m_symbolIndex.search(
       query, acceptedNodeTypes, maxResultsCount, maxBestScoredResultsLength);
 
@@ -654,7 +920,7 @@ std::vector<SearchMatch> PersistentStorage::getAutocompletionSymbolMatches(const
       elementIds.insert(elementIds.end(), result.elementIds.begin(), result.elementIds.end());
     }
 
-    for(const StorageNode& node : m_sqliteIndexStorage.getAllByIds<StorageNode>(elementIds)) {
+    for(const StorageNode& node : getStorageNodesByIds(elementIds)) {
       storageNodeMap.emplace(node.id, node);
     }
   }
@@ -792,7 +1058,7 @@ std::vector<SearchMatch> PersistentStorage::getSearchMatchesForTokenIds(const st
 
   // fetch StorageNodes for node ids
   std::map<Id, StorageNode> storageNodeMap;
-  for(StorageNode& node : m_sqliteIndexStorage.getAllByIds<StorageNode>(elementIds)) {
+  for(StorageNode& node : getStorageNodesByIds(elementIds)) {
     storageNodeMap.emplace(node.id, node);
   }
 
@@ -826,7 +1092,7 @@ std::vector<SearchMatch> PersistentStorage::getSearchMatchesForTokenIds(const st
 std::shared_ptr<Graph> PersistentStorage::getGraphForAll() const {
   std::shared_ptr<Graph> graph = std::make_shared<Graph>();
   const size_t sdk_size = m_symbolDefinitionKinds.size();
-  m_sqliteIndexStorage.forEach<StorageNode>([&, sdk_size](StorageNode&& storageNode) {
+  forEachStorageNode([&, sdk_size](StorageNode&& storageNode) {
     const NodeType type(intToNodeKind(storageNode.type));
     if(type.isFile()) {
       auto fn_it = m_fileNodeIndexed.find(storageNode.id);
@@ -850,7 +1116,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForAll() const {
 std::shared_ptr<Graph> PersistentStorage::getGraphForNodeTypes(NodeTypeSet nodeTypes) const {
   std::vector<Id> tokenIds;
 
-  m_sqliteIndexStorage.forEach<StorageNode>([&](StorageNode&& node) {
+  forEachStorageNode([&](StorageNode&& node) {
     if(nodeTypes.contains(NodeType(intToNodeKind(node.type)))) {
       auto iterator = m_symbolDefinitionKinds.find(node.id);
       if(iterator != m_symbolDefinitionKinds.end() && iterator->second == DEFINITION_EXPLICIT) {
@@ -887,7 +1153,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(const std::v
 
   if(tokenIds.size() == 1) {
     const Id elementId = tokenIds[0];
-    const StorageNode node = m_sqliteIndexStorage.getFirstById<StorageNode>(elementId);
+    const StorageNode node = getStorageNodeById(elementId);
 
     if(node.id > 0) {
       const NodeType nodeType(intToNodeKind(node.type));
@@ -908,7 +1174,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(const std::v
         nodeIds.push_back(elementId);
         edgeIds.clear();
 
-        for(const StorageEdge& edge : m_sqliteIndexStorage.getEdgesBySourceOrTargetId(elementId)) {
+        for(const StorageEdge& edge : getStorageEdgesBySourceOrTargetId(elementId)) {
           Edge::EdgeType edgeType = Edge::intToType(edge.type);
           if(edgeType == Edge::EDGE_MEMBER) {
             continue;
@@ -930,7 +1196,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(const std::v
           addBundledEdges = true;
         }
       }
-    } else if(m_sqliteIndexStorage.isEdge(elementId)) {
+    } else if(isStorageEdge(elementId)) {
       edgeIds.push_back(elementId);
     }
   }
@@ -943,7 +1209,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(const std::v
       }
       symbolIds.insert(symbol.id);
     }
-    for(const StorageNode& node : m_sqliteIndexStorage.getAllByIds<StorageNode>(ids)) {
+    for(const StorageNode& node : getStorageNodesByIds(ids)) {
       if(symbolIds.find(node.id) == symbolIds.end()) {
         nodeIds.push_back(node.id);
       }
@@ -951,7 +1217,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForActiveTokenIds(const std::v
 
     if(!isPackage) {
       if(nodeIds.size() != ids.size()) {
-        for(const StorageEdge& edge : m_sqliteIndexStorage.getAllByIds<StorageEdge>(ids)) {
+        for(const StorageEdge& edge : getStorageEdgesByIds(ids)) {
           if(edge.id > 0) {
             edgeIds.push_back(edge.id);
           }
@@ -1050,13 +1316,13 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(Id originId,
   }
 
   while(nodeIdsToProcess.size() && (!depth || currentDepth < depth)) {
-    std::vector<StorageEdge> edges = forward ? m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess) :
-                                               m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess);
+    std::vector<StorageEdge> edges = forward ? getStorageEdgesBySourceIds(nodeIdsToProcess) :
+                                               getStorageEdgesByTargetIds(nodeIdsToProcess);
 
     if(!directed || trailTypes & Edge::LAYOUT_VERTICAL) {
       utility::append(edges,
-                      forward ? m_sqliteIndexStorage.getEdgesByTargetIds(nodeIdsToProcess) :
-                                m_sqliteIndexStorage.getEdgesBySourceIds(nodeIdsToProcess));
+                      forward ? getStorageEdgesByTargetIds(nodeIdsToProcess) :
+                                getStorageEdgesBySourceIds(nodeIdsToProcess));
     }
 
     std::vector<Id> nodeIdsToCheck;
@@ -1095,7 +1361,7 @@ std::shared_ptr<Graph> PersistentStorage::getGraphForTrail(Id originId,
     nodeIdsToProcess.clear();
 
     if(nodeTypes != 0) {
-      for(const StorageNode& node : m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIdsToCheck)) {
+      for(const StorageNode& node : getStorageNodesByIds(nodeIdsToCheck)) {
         NodeKind kind = intToNodeKind(node.type);
         if(kind & nodeTypes || (kind == NODE_SYMBOL && nodeNonIndexed)) {
           if(!nodeNonIndexed) {
@@ -1212,7 +1478,7 @@ std::vector<Id> PersistentStorage::getActiveTokenIdsForId(Id tokenId, Id* declar
   std::vector<Id> activeTokenIds;
 
   bool isNode = m_sqliteIndexStorage.isNode(tokenId);
-  bool isEdge = m_sqliteIndexStorage.isEdge(tokenId);
+  bool isEdge = isStorageEdge(tokenId);
 
   if(!isEdge && !isNode) {
     return activeTokenIds;
@@ -1223,7 +1489,7 @@ std::vector<Id> PersistentStorage::getActiveTokenIdsForId(Id tokenId, Id* declar
   if(isNode) {
     *declarationId = tokenId;
 
-    for(const StorageEdge& edge : m_sqliteIndexStorage.getEdgesByTargetId(tokenId)) {
+    for(const StorageEdge& edge : getStorageEdgesByTargetIds({tokenId})) {
       activeTokenIds.push_back(edge.id);
     }
   }
@@ -1238,7 +1504,7 @@ std::vector<Id> PersistentStorage::getNodeIdsForLocationIds(const std::vector<Id
   for(const StorageOccurrence& occurrence : m_sqliteIndexStorage.getOccurrencesForLocationIds(locationIds)) {
     Id elementId = occurrence.elementId;
 
-    const StorageEdge edge = m_sqliteIndexStorage.getFirstById<StorageEdge>(elementId);
+    const StorageEdge edge = getStorageEdgeById(elementId);
     if(edge.id != 0) {
       elementId = edge.targetNodeId;
     }
@@ -1268,7 +1534,7 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
 
     // check for non-indexed file
     if(path.empty() && m_symbolDefinitionKinds.find(tokenId) == m_symbolDefinitionKinds.end()) {
-      const StorageNode fileNode = m_sqliteIndexStorage.getNodeById(tokenId);
+      const StorageNode fileNode = getStorageNodeById(tokenId);
       if(NodeType(intToNodeKind(fileNode.type)).isFile()) {
         path = FilePath(NameHierarchy::deserialize(fileNode.serializedName).getQualifiedName());
       }
@@ -1290,12 +1556,15 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
     // FIXME: can we use get SqliteIndexStorage::getSourceLocationsForElementIds() here instead?
     std::vector<Id> locationIds;
     std::unordered_map<Id, Id> locationIdToElementIdMap;
-    for(const StorageOccurrence& occurrence : m_sqliteIndexStorage.getOccurrencesForElementIds(nonFileIds)) {
-      locationIds.push_back(occurrence.sourceLocationId);
-      locationIdToElementIdMap[occurrence.sourceLocationId] = occurrence.elementId;
-    }
+    const std::vector<StorageSourceLocation> sourceLocations = withReadConnection([&](const SqliteIndexStorage& storage) {
+      for(const StorageOccurrence& occurrence : storage.getOccurrencesForElementIds(nonFileIds)) {
+        locationIds.push_back(occurrence.sourceLocationId);
+        locationIdToElementIdMap[occurrence.sourceLocationId] = occurrence.elementId;
+      }
+      return storage.getAllByIds<StorageSourceLocation>(locationIds);
+    });
 
-    for(const StorageSourceLocation& sourceLocation : m_sqliteIndexStorage.getAllByIds<StorageSourceLocation>(locationIds)) {
+    for(const StorageSourceLocation& sourceLocation : sourceLocations) {
       const LocationType type = intToLocationType(sourceLocation.type);
       if(type != LOCATION_TOKEN && type != LOCATION_SCOPE && type != LOCATION_LOCAL_SYMBOL && type != LOCATION_UNSOLVED) {
         continue;
@@ -1309,7 +1578,7 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
       FilePath path = getFileNodePath(sourceLocation.fileNodeId);
       // FIXME: This shouldn't be necessary since all files are stored, even non-indexed
       if(path.empty()) {
-        const StorageNode fileNode = m_sqliteIndexStorage.getNodeById(sourceLocation.fileNodeId);
+        const StorageNode fileNode = getStorageNodeById(sourceLocation.fileNodeId);
         if(fileNode.id) {
           const FilePath path2 = FilePath(NameHierarchy::deserialize(fileNode.serializedName).getQualifiedName());
           if(path2.exists()) {
@@ -1340,11 +1609,14 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
   std::shared_ptr<SourceLocationCollection> collection = std::make_shared<SourceLocationCollection>();
 
   std::map<Id, std::vector<Id>> m_locationIdToElementIds;
-  for(const StorageOccurrence& occurrence : m_sqliteIndexStorage.getOccurrencesForLocationIds(locationIds)) {
-    m_locationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
-  }
+  const std::vector<StorageSourceLocation> locations = withReadConnection([&](const SqliteIndexStorage& storage) {
+    for(const StorageOccurrence& occurrence : storage.getOccurrencesForLocationIds(locationIds)) {
+      m_locationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
+    }
+    return storage.getAllByIds<StorageSourceLocation>(locationIds);
+  });
 
-  for(StorageSourceLocation location : m_sqliteIndexStorage.getAllByIds<StorageSourceLocation>(locationIds)) {
+  for(StorageSourceLocation location : locations) {
     const LocationType type = intToLocationType(location.type);
     if(type != LOCATION_TOKEN && type != LOCATION_SCOPE && type != LOCATION_LOCAL_SYMBOL && type != LOCATION_UNSOLVED) {
       continue;
@@ -1366,25 +1638,30 @@ std::shared_ptr<SourceLocationCollection> PersistentStorage::getSourceLocationsF
 }
 
 std::shared_ptr<SourceLocationFile> PersistentStorage::getSourceLocationsForFile(const FilePath& filePath) const {
-  return m_sqliteIndexStorage.getSourceLocationsForFile(filePath)->getFilteredByTypes(
+  return withReadConnection([&](const SqliteIndexStorage& storage) { return storage.getSourceLocationsForFile(filePath); })
+      ->getFilteredByTypes(
       {LOCATION_TOKEN, LOCATION_SCOPE, LOCATION_QUALIFIER, LOCATION_LOCAL_SYMBOL, LOCATION_UNSOLVED});
 }
 
 std::shared_ptr<SourceLocationFile> PersistentStorage::getSourceLocationsForLinesInFile(const FilePath& filePath,
                                                                                         size_t startLine,
                                                                                         size_t endLine) const {
-  return m_sqliteIndexStorage.getSourceLocationsForLinesInFile(filePath, startLine, endLine)
+  return withReadConnection([&](const SqliteIndexStorage& storage) {
+           return storage.getSourceLocationsForLinesInFile(filePath, startLine, endLine);
+         })
       ->getFilteredByLines(startLine, endLine)
       ->getFilteredByTypes({LOCATION_TOKEN, LOCATION_SCOPE, LOCATION_QUALIFIER, LOCATION_LOCAL_SYMBOL, LOCATION_UNSOLVED});
 }
 
 std::shared_ptr<SourceLocationFile> PersistentStorage::getSourceLocationsOfTypeInFile(const FilePath& filePath,
                                                                                       LocationType type) const {
-  return m_sqliteIndexStorage.getSourceLocationsOfTypeInFile(filePath, type);
+  return withReadConnection(
+      [&](const SqliteIndexStorage& storage) { return storage.getSourceLocationsOfTypeInFile(filePath, type); });
 }
 
 std::shared_ptr<TextAccess> PersistentStorage::getFileContent(const FilePath& filePath, bool /*showsErrors*/) const {
-  std::shared_ptr<TextAccess> fileContent = m_sqliteIndexStorage.getFileContentByPath(filePath.wstr());
+  std::shared_ptr<TextAccess> fileContent = withReadConnection(
+      [&](const SqliteIndexStorage& storage) { return storage.getFileContentByPath(filePath.wstr()); });
   if(fileContent->getLineCount() > 0) {
     return fileContent;
   }
@@ -1392,15 +1669,13 @@ std::shared_ptr<TextAccess> PersistentStorage::getFileContent(const FilePath& fi
 }
 
 bool PersistentStorage::hasContentForFile(const FilePath& filePath) const {
-  std::shared_ptr<TextAccess> fileContent = m_sqliteIndexStorage.getFileContentByPath(filePath.wstr());
-  if(fileContent->getLineCount() > 0) {
-    return true;
-  }
-  return false;
+  return withReadConnection(
+      [&](const SqliteIndexStorage& storage) { return !storage.getFileLinesByPath(filePath.wstr(), 1, 1).empty(); });
 }
 
 FileInfo PersistentStorage::getFileInfoForFileId(Id id) const {
-  StorageFile storageFile = m_sqliteIndexStorage.getFirstById<StorageFile>(id);
+  StorageFile storageFile = withReadConnection(
+      [id](const SqliteIndexStorage& storage) { return storage.getFirstById<StorageFile>(id); });
   return FileInfo(FilePath(storageFile.filePath), storageFile.modificationTime);
 }
 
@@ -1411,7 +1686,8 @@ FileInfo PersistentStorage::getFileInfoForFilePath(const FilePath& filePath) con
 std::vector<FileInfo> PersistentStorage::getFileInfosForFilePaths(const std::vector<FilePath>& filePaths) const {
   std::vector<FileInfo> fileInfos;
 
-  for(const StorageFile& file : m_sqliteIndexStorage.getFilesByPaths(filePaths)) {
+  for(const StorageFile& file :
+      withReadConnection([&](const SqliteIndexStorage& storage) { return storage.getFilesByPaths(filePaths); })) {
     fileInfos.push_back(FileInfo(FilePath(file.filePath), file.modificationTime));
   }
 
@@ -1419,26 +1695,28 @@ std::vector<FileInfo> PersistentStorage::getFileInfosForFilePaths(const std::vec
 }
 
 StorageStats PersistentStorage::getStorageStats() const {
-  StorageStats stats;
+  return withReadConnection([](const SqliteIndexStorage& storage) {
+    StorageStats stats;
 
-  stats.nodeCount = static_cast<std::size_t>(m_sqliteIndexStorage.getNodeCount());
-  stats.edgeCount = static_cast<std::size_t>(m_sqliteIndexStorage.getEdgeCount());
+    stats.nodeCount = static_cast<std::size_t>(storage.getNodeCount());
+    stats.edgeCount = static_cast<std::size_t>(storage.getEdgeCount());
 
-  stats.fileCount = static_cast<std::size_t>(m_sqliteIndexStorage.getFileCount());
-  stats.completedFileCount = static_cast<std::size_t>(m_sqliteIndexStorage.getCompletedFileCount());
-  stats.fileLOCCount = static_cast<std::size_t>(m_sqliteIndexStorage.getFileLineSum());
+    stats.fileCount = static_cast<std::size_t>(storage.getFileCount());
+    stats.completedFileCount = static_cast<std::size_t>(storage.getCompletedFileCount());
+    stats.fileLOCCount = static_cast<std::size_t>(storage.getFileLineSum());
 
-  stats.timestamp = m_sqliteIndexStorage.getTime();
+    stats.timestamp = storage.getTime();
 
-  return stats;
+    return stats;
+  });
 }
 
 ErrorCountInfo PersistentStorage::getErrorCount() const {
-  return ErrorCountInfo(m_sqliteIndexStorage.getAllErrorInfos());
+  return ErrorCountInfo(withReadConnection([](const SqliteIndexStorage& storage) { return storage.getAllErrorInfos(); }));
 }
 
 std::vector<ErrorInfo> PersistentStorage::getErrorsLimited(const ErrorFilter& filter) const {
-  return filter.filterErrors(m_sqliteIndexStorage.getAllErrorInfos());
+  return filter.filterErrors(withReadConnection([](const SqliteIndexStorage& storage) { return storage.getAllErrorInfos(); }));
 }
 
 std::vector<ErrorInfo> PersistentStorage::getErrorsForFileLimited(const ErrorFilter& filter, const FilePath& filePath) const {
@@ -1461,7 +1739,8 @@ std::vector<ErrorInfo> PersistentStorage::getErrorsForFileLimited(const ErrorFil
 
   std::vector<ErrorInfo> res;
 
-  std::vector<ErrorInfo> errors = m_sqliteIndexStorage.getAllErrorInfos();
+  std::vector<ErrorInfo> errors = withReadConnection(
+      [](const SqliteIndexStorage& storage) { return storage.getAllErrorInfos(); });
   for(const ErrorInfo& error : errors) {
     if(filter.filter(error) && fileIds.find(getFileNodeId(FilePath(error.filePath))) != fileIds.end()) {
       res.push_back(error);
@@ -1524,7 +1803,7 @@ Id PersistentStorage::addNodeBookmark(const NodeBookmark& bookmark) {
 
   for(const Id& nodeId : bookmark.getNodeIds()) {
     m_sqliteBookmarkStorage.addBookmarkedNode(
-        StorageBookmarkedNodeData(id, m_sqliteIndexStorage.getNodeById(nodeId).serializedName));
+        StorageBookmarkedNodeData(id, getStorageNodeById(nodeId).serializedName));
   }
 
   return id;
@@ -1537,14 +1816,14 @@ Id PersistentStorage::addEdgeBookmark(const EdgeBookmark& bookmark) {
                         bookmark.getName(), bookmark.getComment(), bookmark.getTimeStamp().toString(), categoryId))
                     .id;
   for(const Id& edgeId : bookmark.getEdgeIds()) {
-    const StorageEdge storageEdge = m_sqliteIndexStorage.getEdgeById(edgeId);
+    const StorageEdge storageEdge = getStorageEdgeById(edgeId);
 
     bool sourceNodeActive = storageEdge.sourceNodeId == bookmark.getActiveNodeId();
     m_sqliteBookmarkStorage.addBookmarkedEdge(
         StorageBookmarkedEdgeData(id,
                                   // todo: optimization for multiple edges in same bookmark: use a local cache here
-                                  m_sqliteIndexStorage.getNodeById(storageEdge.sourceNodeId).serializedName,
-                                  m_sqliteIndexStorage.getNodeById(storageEdge.targetNodeId).serializedName,
+                                  getStorageNodeById(storageEdge.sourceNodeId).serializedName,
+                                  getStorageNodeById(storageEdge.targetNodeId).serializedName,
                                   storageEdge.type,
                                   sourceNodeActive));
   }
@@ -1673,12 +1952,12 @@ TooltipInfo PersistentStorage::getTooltipInfoForTokenIds(const std::vector<Id>&
     return info;
   }
 
-  StorageNode node = m_sqliteIndexStorage.getFirstById<StorageNode>(tokenIds[0]);
+  StorageNode node = getStorageNodeById(tokenIds[0]);
   if(node.id == 0 && origin == TOOLTIP_ORIGIN_CODE) {
-    const StorageEdge edge = m_sqliteIndexStorage.getFirstById<StorageEdge>(tokenIds[0]);
+    const StorageEdge edge = getStorageEdgeById(tokenIds[0]);
 
     if(edge.id > 0) {
-      node = m_sqliteIndexStorage.getFirstById<StorageNode>(edge.targetNodeId);
+      node = getStorageNodeById(edge.targetNodeId);
     }
   }
 
@@ -1718,7 +1997,7 @@ TooltipInfo PersistentStorage::getTooltipInfoForTokenIds(const std::vector<Id>&
 
   info.count = 0;
   info.countText = "reference";
-  for(const auto& edge : m_sqliteIndexStorage.getEdgesByTargetId(node.id)) {
+  for(const auto& edge : getStorageEdgesByTargetIds({node.id})) {
     if(Edge::intToType(edge.type) != Edge::EDGE_MEMBER) {
       info.count++;
     }
@@ -1769,9 +2048,14 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
       };
 
       std::vector<Annotation> annotations;
-      std::vector<std::string> lines = getFileContent(sigLoc->getFilePath(), false)
-                                           ->getLines(static_cast<unsigned int>(sigLoc->getLineNumber()),
-                                                      static_cast<unsigned int>(sigLoc->getEndLocation()->getLineNumber()));
+      const auto firstLine = static_cast<uint32_t>(sigLoc->getLineNumber());
+      const auto lastLine = static_cast<uint32_t>(sigLoc->getEndLocation()->getLineNumber());
+      std::vector<std::string> lines = withReadConnection([&](const SqliteIndexStorage& storage) {
+        return storage.getFileLinesByPath(sigLoc->getFilePath().wstr(), firstLine, lastLine);
+      });
+      if(lines.empty() && !hasContentForFile(sigLoc->getFilePath())) {
+        lines = TextAccess::createFromFile(sigLoc->getFilePath())->getLines(firstLine, lastLine);
+      }
 
       // check if signature location refers to correct locations in the code
       // wrongly recorded signature locations of implicit template methods in C++ caused crashes
@@ -1866,7 +2150,7 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
                                            static_cast<std::size_t>(IApplicationSettings::getInstanceRaw()->getCodeTabWidth()));
 
     std::vector<Id> typeNodeIds;
-    for(const auto& edge : m_sqliteIndexStorage.getEdgesBySourceId(node.id)) {
+    for(const auto& edge : getStorageEdgesBySourceIds({node.id})) {
       if(Edge::intToType(edge.type) == Edge::EDGE_TYPE_USAGE) {
         typeNodeIds.push_back(edge.targetNodeId);
       }
@@ -1882,7 +2166,7 @@ TooltipSnippet PersistentStorage::getTooltipSnippetForNode(const StorageNode& no
         });
 
     typeNames.insert(std::make_pair(nameHierarchy.getQualifiedName(), node.id));
-    for(const auto& typeNode : m_sqliteIndexStorage.getAllByIds<StorageNode>(typeNodeIds)) {
+    for(const auto& typeNode : getStorageNodesByIds(typeNodeIds)) {
       typeNames.insert(std::make_pair(NameHierarchy::deserialize(typeNode.serializedName).getQualifiedName(), typeNode.id));
     }
 
@@ -1936,7 +2220,7 @@ TooltipInfo PersistentStorage::getTooltipInfoForSourceLocationIdsAndLocalSymbolI
 
     const std::vector<Id> nodeIds = getNodeIdsForLocationIds(locationIds);
 
-    for(const StorageNode& node : m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIds)) {
+    for(const StorageNode& node : getStorageNodesByIds(nodeIds)) {
       TooltipSnippet snippet;
 
       const NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
@@ -2051,10 +2335,9 @@ std::wstring PersistentStorage::getFileNodeLanguage(Id fileId) const {
 std::unordered_map<Id, std::set<Id>> PersistentStorage::getFileIdToIncludingFileIdMap() const {
   std::unordered_map<Id, std::set<Id>> fileIdToIncludingFileIdMap;
 
-  m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-      Edge::typeToInt(Edge::EDGE_INCLUDE), [&fileIdToIncludingFileIdMap](StorageEdge&& edge) {
-        fileIdToIncludingFileIdMap[edge.targetNodeId].insert(edge.sourceNodeId);
-      });
+  forEachStorageEdgeOfType(Edge::typeToInt(Edge::EDGE_INCLUDE), [&fileIdToIncludingFileIdMap](StorageEdge&& edge) {
+    fileIdToIncludingFileIdMap[edge.targetNodeId].insert(edge.sourceNodeId);
+  });
 
   return fileIdToIncludingFileIdMap;
 }
@@ -2062,10 +2345,9 @@ std::unordered_map<Id, std::set<Id>> PersistentStorage::getFileIdToIncludingFile
 std::unordered_map<Id, std::set<Id>> PersistentStorage::getFileIdToIncludedFileIdMap() const {
   std::unordered_map<Id, std::set<Id>> fileIdToIncludingFileIdMap;
 
-  m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-      Edge::typeToInt(Edge::EDGE_INCLUDE), [&fileIdToIncludingFileIdMap](StorageEdge&& edge) {
-        fileIdToIncludingFileIdMap[edge.sourceNodeId].insert(edge.targetNodeId);
-      });
+  forEachStorageEdgeOfType(Edge::typeToInt(Edge::EDGE_INCLUDE), [&fileIdToIncludingFileIdMap](StorageEdge&& edge) {
+    fileIdToIncludingFileIdMap[edge.sourceNodeId].insert(edge.targetNodeId);
+  });
 
   return fileIdToIncludingFileIdMap;
 }
@@ -2076,7 +2358,7 @@ std::unordered_map<Id, std::set<Id>> PersistentStorage::getFileIdToImportingFile
     std::vector<Id> importedElementIds;
     std::map<Id, std::set<Id>> elementIdToImportingFileIds;
 
-    m_sqliteIndexStorage.forEachOfType<StorageEdge>(
+    forEachStorageEdgeOfType(
         Edge::typeToInt(Edge::EDGE_IMPORT), [&importedElementIds, &elementIdToImportingFileIds](StorageEdge&& edge) {
           importedElementIds.push_back(edge.targetNodeId);
           elementIdToImportingFileIds[edge.targetNodeId].insert(edge.sourceNodeId);
@@ -2207,7 +2489,7 @@ void PersistentStorage::addNodesToGraph(const std::vector<Id>& newNodeIds, Graph
     return;
   }
 
-  for(const StorageNode& storageNode : m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIds)) {
+  for(const StorageNode& storageNode : getStorageNodesByIds(nodeIds)) {
     const NodeType type(intToNodeKind(storageNode.type));
     if(type.isFile()) {
       addFileNodeToGraph(storageNode, graph);
@@ -2258,7 +2540,7 @@ void PersistentStorage::addEdgesToGraph(const std::vector<Id>& newEdgeIds, Graph
     return;
   }
 
-  for(const StorageEdge& storageEdge : m_sqliteIndexStorage.getAllByIds<StorageEdge>(edgeIds)) {
+  for(const StorageEdge& storageEdge : getStorageEdgesByIds(edgeIds)) {
     Node* sourceNode = graph->getNodeById(storageEdge.sourceNodeId);
     Node* targetNode = graph->getNodeById(storageEdge.targetNodeId);
 
@@ -2287,7 +2569,7 @@ void PersistentStorage::addNodesWithParentsAndEdgesToGraph(const std::vector<Id>
   std::set<Id> allEdgeIds(edgeIds.begin(), edgeIds.end());
 
   if(edgeIds.size() > 0) {
-    for(const StorageEdge& storageEdge : m_sqliteIndexStorage.getAllByIds<StorageEdge>(edgeIds)) {
+    for(const StorageEdge& storageEdge : getStorageEdgesByIds(edgeIds)) {
       allNodeIds.insert(storageEdge.sourceNodeId);
       allNodeIds.insert(storageEdge.targetNodeId);
     }
@@ -2329,7 +2611,7 @@ void PersistentStorage::addBundledEdgesToGraph(Id nodeId, const std::vector<Stor
     connectedNodeIds[isSource ? edge.targetNodeId : edge.sourceNodeId].push_back(edgeInfo);
   }
 
-  const std::vector<StorageEdge> outgoingEdges = m_sqliteIndexStorage.getEdgesBySourceIds(childNodeIds);
+  const std::vector<StorageEdge> outgoingEdges = getStorageEdgesBySourceIds(childNodeIds);
   for(const StorageEdge& outEdge : outgoingEdges) {
     EdgeInfo edgeInfo;
     edgeInfo.edgeId = outEdge.id;
@@ -2337,7 +2619,7 @@ void PersistentStorage::addBundledEdgesToGraph(Id nodeId, const std::vector<Stor
     connectedNodeIds[outEdge.targetNodeId].push_back(edgeInfo);
   }
 
-  const std::vector<StorageEdge> incomingEdges = m_sqliteIndexStorage.getEdgesByTargetIds(childNodeIds);
+  const std::vector<StorageEdge> incomingEdges = getStorageEdgesByTargetIds(childNodeIds);
   for(const StorageEdge& inEdge : incomingEdges) {
     EdgeInfo edgeInfo;
     edgeInfo.edgeId = inEdge.id;
@@ -2487,12 +2769,14 @@ void PersistentStorage::addInheritanceChainsToGraph(const std::vector<Id>& activ
   nodeIdSets.push_back(&activeNodeIdsSet);
   nodeIdSets.push_back(&nodeIdsSet);
 
+  waitForInheritanceCache();
+
   size_t inheritanceEdgeCount = 1;
 
   for(size_t i = 0; i < nodeIdSets.size(); i++) {
     for(const Id nodeId : *nodeIdSets[i]) {
       for(const std::tuple<Id, Id, std::vector<Id>>& edge :
-          m_hierarchyCache.getInheritanceEdgesForNodeId(nodeId, *nodeIdSets[(i + 1) % 2])) {
+          m_inheritanceCache.getInheritanceEdgesForNodeId(nodeId, *nodeIdSets[(i + 1) % 2])) {
         const Id sourceId = std::get<0>(edge);
         const Id targetId = std::get<1>(edge);
         const std::vector<Id> edgeIds = std::get<2>(edge);
@@ -2513,6 +2797,59 @@ void PersistentStorage::addInheritanceChainsToGraph(const std::vector<Id>& activ
   }
 }
 
+StorageNode PersistentStorage::getStorageNodeById(Id nodeId) const {
+  return m_graphSnapshot ? m_graphSnapshot->getNodeById(nodeId) : m_sqliteIndexStorage.getFirstById<StorageNode>(nodeId);
+}
+
+std::vector<StorageNode> PersistentStorage::getStorageNodesByIds(const std::vector<Id>& nodeIds) const {
+  return m_graphSnapshot ? m_graphSnapshot->getNodesByIds(nodeIds) : m_sqliteIndexStorage.getAllByIds<StorageNode>(nodeIds);
+}
+
+void PersistentStorage::forEachStorageNode(const std::function<void(StorageNode&&)>& func) const {
+  if(m_graphSnapshot) {
+    m_graphSnapshot->forEachNode(func);
+  } else {
+    m_sqliteIndexStorage.forEach<StorageNode>(func);
+  }
+}
+
+bool PersistentStorage::isStorageEdge(Id edgeId) const {
+  return m_graphSnapshot ? m_graphSnapshot->isEdge(edgeId) : m_sqliteIndexStorage.isEdge(edgeId);
+}
+
+StorageEdge PersistentStorage::getStorageEdgeById(Id edgeId) const {
+  if(m_graphSnapshot) {
+    const std::vector<StorageEdge> edges = m_graphSnapshot->getEdgesByIds({edgeId});
+    return edges.empty() ? StorageEdge() : edges.front();
+  }
+  return m_sqliteIndexStorage.getEdgeById(edgeId);
+}
+
+std::vector<StorageEdge> PersistentStorage::getStorageEdgesByIds(const std::vector<Id>& edgeIds) const {
+  return m_graphSnapshot ? m_graphSnapshot->getEdgesByIds(edgeIds) : m_sqliteIndexStorage.getAllByIds<StorageEdge>(edgeIds);
+}
+
+std::vector<StorageEdge> PersistentStorage::getStorageEdgesBySourceIds(const std::vector<Id>& sourceIds) const {
+  return m_graphSnapshot ? m_graphSnapshot->getEdgesBySourceIds(sourceIds) : m_sqliteIndexStorage.getEdgesBySourceIds(sourceIds);
+}
+
+std::vector<StorageEdge> PersistentStorage::getStorageEdgesByTargetIds(const std::vector<Id>& targetIds) const {
+  return m_graphSnapshot ? m_graphSnapshot->getEdgesByTargetIds(targetIds) : m_sqliteIndexStorage.getEdgesByTargetIds(targetIds);
+}
+
+std::vector<StorageEdge> PersistentStorage::getStorageEdgesBySourceOrTargetId(Id nodeId) const {
+  return m_graphSnapshot ? m_graphSnapshot->getEdgesBySourceOrTargetId(nodeId) :
+                           m_sqliteIndexStorage.getEdgesBySourceOrTargetId(nodeId);
+}
+
+void PersistentStorage::forEachStorageEdgeOfType(int type, const std::function<void(StorageEdge&&)>& func) const {
+  if(m_graphSnapshot) {
+    m_graphSnapshot->forEachEdgeOfType(type, [&func](const StorageEdge& edge) { func(StorageEdge(edge)); });
+  } else {
+    m_sqliteIndexStorage.forEachOfType<StorageEdge>(type, func);
+  }
+}
+
 void PersistentStorage::buildFilePathMaps() {
   m_sqliteIndexStorage.forEach<StorageFile>([&](StorageFile&& file) {
     const FilePath path(file.filePath);
@@ -2529,10 +2866,11 @@ void PersistentStorage::buildFilePathMaps() {
       [&](StorageSymbol&& symbol) { m_symbolDefinitionKinds.emplace(symbol.id, intToDefinitionKind(symbol.definitionKind)); });
 }
 
-void PersistentStorage::buildSearchIndex() {
+std::vector<StorageNode> PersistentStorage::buildFileIndex(const std::vector<Id>* changedNodeIds) {
   const FilePath dbPath = getIndexDbFilePath();
 
-  m_sqliteIndexStorage.forEach<StorageNode>([&](StorageNode&& node) {
+  std::vector<StorageNode> symbolNodes;
+  auto addNode = [&](StorageNode&& node) {
     const NodeType type(intToNodeKind(node.type));
     if(type.isFile()) {
       bool indexed = getFileNodeIndexed(node.id);
@@ -2552,27 +2890,61 @@ void PersistentStorage::buildSearchIndex() {
       }
     } else {
       auto it = m_symbolDefinitionKinds.find(node.id);
-      const DefinitionKind defKind = (it != m_symbolDefinitionKinds.end() ? it->second : DEFINITION_NONE);
-      if(defKind != DEFINITION_IMPLICIT) {
-        const NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
-
-        // we don't use the signature here, so elements with the same signature share the
-        // same node.
-        std::wstring name = nameHierarchy.getQualifiedName();
-
-        // replace template arguments with .. to avoid clutter in search results and have
-        // different template specializations share the same node.
-        if(defKind == DEFINITION_NONE && nameHierarchy.getDelimiter() == nameDelimiterTypeToString(NAME_DELIMITER_CXX)) {
-          name = utility::replaceBetween(name, L'<', L'>', L"..");
-        }
-
-        m_symbolIndex.addNode(node.id, std::move(name), type);
+      if(it == m_symbolDefinitionKinds.end() || it->second != DEFINITION_IMPLICIT) {
+        symbolNodes.push_back(std::move(node));
       }
     }
-  });
+  };
+
+  if(changedNodeIds != nullptr) {
+    // the file nodes are looked up by the ids from the file table, only changed symbols are returned
+    std::vector<Id> nodeIds = *changedNodeIds;
+    for(const auto& [fileId, filePath] : m_fileNodePaths) {
+      nodeIds.push_back(fileId);
+    }
+    std::ranges::sort(nodeIds);
+    nodeIds.erase(std::ranges::unique(nodeIds).begin(), nodeIds.end());
+
+    for(StorageNode& node : getStorageNodesByIds(nodeIds)) {
+      addNode(std::move(node));
+    }
+  } else {
+    forEachStorageNode(addNode);
+  }
 
-  m_symbolIndex.finishSetup();
   m_fileIndex.finishSetup();
+
+  return symbolNodes;
+}
+
+size_t PersistentStorage::buildSymbolIndex(const std::unordered_set<Id>& removedNodeIds,
+                                           const std::vector<StorageNode>& symbolNodes) {
+  TimeStamp start = TimeStamp::now();
+
+  // changed nodes are removed first and added again below if they still exist
+  m_symbolIndex.removeNodes(removedNodeIds);
+
+  for(const StorageNode& node : symbolNodes) {
+    auto it = m_symbolDefinitionKinds.find(node.id);
+    const DefinitionKind defKind = (it != m_symbolDefinitionKinds.end() ? it->second : DEFINITION_NONE);
+    const NameHierarchy nameHierarchy = NameHierarchy::deserialize(node.serializedName);
+
+    // we don't use the signature here, so elements with the same signature share the
+    // same node.
+    std::wstring name = nameHierarchy.getQualifiedName();
+
+    // replace template arguments with .. to avoid clutter in search results and have
+    // different template specializations share the same node.
+    if(defKind == DEFINITION_NONE && nameHierarchy.getDelimiter() == nameDelimiterTypeToString(NAME_DELIMITER_CXX)) {
+      name = utility::replaceBetween(name, L'<', L'>', L"..");
+    }
+
+    m_symbolIndex.addNode(node.id, std::move(name), NodeType(intToNodeKind(node.type)));
+  }
+
+  m_symbolIndex.finishSetup();
+
+  return TimeStamp::now().deltaMS(start);
 }
 
 void PersistentStorage::buildFullTextSearchIndex() const {
@@ -2582,40 +2954,64 @@ void PersistentStorage::buildFullTextSearchIndex() const {
 
   m_fullTextSearchIndex.clear();
 
-  std::vector<std::shared_ptr<std::thread>> threads;
-  {
-    std::vector<StorageFile> indexedFiles;
-    for(const StorageFile& file : m_sqliteIndexStorage.getAll<StorageFile>()) {
-      if(file.indexed) {
-        indexedFiles.push_back(file);
-      }
+  std::set<Id> indexedFileIds;
+  auto fileCursor = m_sqliteIndexStorage.getCursor<StorageFileView>();
+  while(fileCursor.next()) {
+    if(fileCursor.get().indexed) {
+      indexedFileIds.insert(fileCursor.get().id);
     }
-    for(std::vector<StorageFile> part :
-        utility::splitToEquallySizedParts(indexedFiles, static_cast<std::size_t>(utility::getIdealThreadCount()))) {
-      std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-          [&](const std::vector<StorageFile>& files) {
-            for(const StorageFile& file : files) {
-              m_fullTextSearchIndex.addFile(file.id, codec.decode(m_sqliteIndexStorage.getFileContentById(file.id)->getText()));
-            }
-          },
-          part);
-      threads.push_back(thread);
+  }
+
+  // stored trigrams are only valid for the codec they were computed with
+  m_sqliteIndexStorage.forEachFullTextSearchTrigrams(codec.getName(), [&](Id fileId, std::string_view trigrams) {
+    if(indexedFileIds.erase(fileId) > 0) {
+      m_fullTextSearchIndex.addFile(fileId, FullTextSearchIndex::decodeTrigrams(trigrams));
     }
+  });
+
+  // trigrams are stored when indexing finishes, files without them were indexed with another text codec
+  if(!indexedFileIds.empty()) {
+    computeFullTextSearchTrigrams(utility::toVector(indexedFileIds),
+                                  codec,
+                                  [this](Id fileId, const std::vector<FullTextSearchIndex::Trigram>& trigrams) {
+                                    m_fullTextSearchIndex.addFile(fileId, trigrams);
+                                  });
+  }
+
+  m_fullTextSearchIndex.finishSetup();
+}
+
+void PersistentStorage::computeFullTextSearchTrigrams(
+    const std::vector<Id>& fileIds,
+    const TextCodec& codec,
+    const std::function<void(Id, const std::vector<FullTextSearchIndex::Trigram>&)>& func) const {
+  std::vector<std::shared_ptr<std::thread>> threads;
+  for(std::vector<Id> part :
+      utility::splitToEquallySizedParts(fileIds, static_cast<std::size_t>(utility::getIdealThreadCount()))) {
+    std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
+        [&](const std::vector<Id>& partFileIds) {
+          for(const Id fileId : partFileIds) {
+            const std::shared_ptr<TextAccess> content = withReadConnection(
+                [fileId](const SqliteIndexStorage& storage) { return storage.getFileContentById(fileId); });
+            func(fileId, FullTextSearchIndex::getTrigrams(codec.decode(content->getText())));
+          }
+        },
+        part);
+    threads.push_back(thread);
   }
   for(std::shared_ptr<std::thread> thread : threads) {
     thread->join();
   }
 }
 
-void PersistentStorage::buildMemberEdgeIdOrderMap() {
+void PersistentStorage::buildMemberEdgeIdOrderMap(const std::vector<StorageEdge>& memberEdges) {
   std::vector<Id> childNodeIds;
   std::unordered_map<Id, Id> childIdToMemberEdgeIdMap;
 
-  m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-      Edge::typeToInt(Edge::EDGE_MEMBER), [&childNodeIds, &childIdToMemberEdgeIdMap](StorageEdge&& edge) {
-        childNodeIds.push_back(edge.targetNodeId);
-        childIdToMemberEdgeIdMap.emplace(edge.targetNodeId, edge.id);
-      });
+  for(const StorageEdge& edge : memberEdges) {
+    childNodeIds.push_back(edge.targetNodeId);
+    childIdToMemberEdgeIdMap.emplace(edge.targetNodeId, edge.id);
+  }
 
   std::vector<Id> locationIds;
   std::unordered_map<Id, Id> locationIdToElementIdMap;
@@ -2648,23 +3044,28 @@ void PersistentStorage::buildMemberEdgeIdOrderMap() {
   });
 }
 
-void PersistentStorage::buildHierarchyCache() {
+void PersistentStorage::buildHierarchyCache(const std::vector<StorageEdge>& memberEdges) {
   std::vector<Id> sourceNodeIds;
-  std::vector<StorageEdge> memberEdges;
-
-  m_sqliteIndexStorage.forEachOfType<StorageEdge>(
-      Edge::typeToInt(Edge::EDGE_MEMBER), [&sourceNodeIds, &memberEdges](StorageEdge&& edge) {
-        sourceNodeIds.push_back(edge.sourceNodeId);
-        memberEdges.emplace_back(edge);
-      });
+  for(const StorageEdge& edge : memberEdges) {
+    sourceNodeIds.push_back(edge.sourceNodeId);
+  }
 
   std::set<Id> invisibleParentSourceNodeIds;
 
-  m_sqliteIndexStorage.forEachByIds<StorageNode>(sourceNodeIds, [&invisibleParentSourceNodeIds](StorageNode&& node) {
-    if(!NodeType(intToNodeKind(node.type)).isVisibleAsParentInGraph()) {
-      invisibleParentSourceNodeIds.insert(node.id);
+  if(m_graphSnapshot) {
+    for(const Id sourceNodeId : sourceNodeIds) {
+      const std::optional<int> type = m_graphSnapshot->getNodeType(sourceNodeId);
+      if(type && !NodeType(intToNodeKind(*type)).isVisibleAsParentInGraph()) {
+        invisibleParentSourceNodeIds.insert(sourceNodeId);
+      }
     }
-  });
+  } else {
+    m_sqliteIndexStorage.forEachByIds<StorageNode>(sourceNodeIds, [&invisibleParentSourceNodeIds](StorageNode&& node) {
+      if(!NodeType(intToNodeKind(node.type)).isVisibleAsParentInGraph()) {
+        invisibleParentSourceNodeIds.insert(node.id);
+      }
+    });
+  }
 
   for(const StorageEdge& edge : memberEdges) {
     bool sourceIsVisible = true;
@@ -2687,8 +3088,34 @@ void PersistentStorage::buildHierarchyCache() {
     m_hierarchyCache.createConnection(
         edge.id, edge.sourceNodeId, edge.targetNodeId, sourceIsVisible, sourceIsImplicit, targetIsImplicit);
   }
+}
 
-  m_sqliteIndexStorage.forEachOfType<StorageEdge>(Edge::typeToInt(Edge::EDGE_INHERITANCE), [this](StorageEdge&& edge) {
-    m_hierarchyCache.createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
-  });
+size_t PersistentStorage::buildInheritanceCache(const std::vector<StorageEdge>& inheritanceEdges) {
+  TimeStamp start = TimeStamp::now();
+
+  for(const StorageEdge& edge : inheritanceEdges) {
+    m_inheritanceCache.createInheritance(edge.id, edge.sourceNodeId, edge.targetNodeId);
+  }
+
+  return TimeStamp::now().deltaMS(start);
+}
+
+void PersistentStorage::waitForSymbolIndex() const {
+  if(m_symbolIndexBuild.valid()) {
+    m_symbolIndexBuild.wait();
+  }
+}
+
+void PersistentStorage::waitForInheritanceCache() const {
+  if(m_inheritanceCacheBuild.valid()) {
+    m_inheritanceCacheBuild.wait();
+  }
+}
+
+void PersistentStorage::waitForCacheBuildReport() const {
+  waitForInheritanceCache();
+  waitForSymbolIndex();
+  if(m_cacheBuildReport.valid()) {
+    m_cacheBuildReport.wait();
+  }
 }
@@ -1,9 +1,18 @@
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "FullTextSearchIndex.h"
+#include "GraphSnapshot.h"
 #include "HierarchyCache.h"
 #include "SearchIndex.h"
 #include "SqliteBookmarkStorage.h"
@@ -11,11 +20,14 @@
 #include "Storage.h"
 #include "StorageAccess.h"
 
+class TextCodec;
+
 class PersistentStorage
     : public Storage
     , public StorageAccess {
 public:
   PersistentStorage(const FilePath& dbPath, const FilePath& bookmarkPath);
+  ~PersistentStorage() override;
 
   std::pair<Id, bool> addNode(const StorageNodeData& data) override;
   std::vector<Id> addNodes(const std::vector<StorageNode>& nodes) override;
@@ -71,8 +83,33 @@ public:
   void beforeErrorRecording();
   void afterErrorRecording();
 
+  /**
+   * @brief Switches the index database to mode. In read mode StorageAccess queries run on read-only connections of their
+   * own, so concurrent queries do not share the main connection and do not wait for writes on it.
+   */
   void setMode(const SqliteIndexStorage::StorageModeType mode);
 
+  /**
+   * @brief Reads the content of indexed files that no translation unit captured from disk, once all storages are injected
+   */
+  void addMissingFileContents();
+
+  /**
+   * @brief Stores the fulltext search trigrams of indexed files that have none for the current text encoding yet, so the
+   * first fulltext search only reads them
+   */
+  void addFullTextSearchTrigrams();
+
+  /**
+   * @brief Moves the write-ahead log into the index database file, which has to happen before the file is copied
+   */
+  void checkpoint() const;
+
+  /**
+   * @brief Closes the read connections and leaves WAL mode, so the index database file can be renamed while it is open
+   */
+  void leaveWriteAheadLog();
+
   FilePath getIndexDbFilePath() const;
   FilePath getBookmarkDbFilePath() const;
 
@@ -93,10 +130,44 @@ public:
   void clearFileElements(const std::vector<FilePath>& filePaths, std::function<void(int)> updateStatusCallback);
 
   std::vector<FileInfo> getFileInfoForAllFiles() const;
+  std::map<FilePath, uint64_t> getContentHashesForAllFiles() const;
+  std::vector<StorageIndexingCost> getIndexingCosts() const;
+  void setIndexingCosts(const std::vector<StorageIndexingCost>& costs);
   std::set<FilePath> getIncompleteFiles() const;
   bool getFilePathIndexed(const FilePath& path) const;
 
-  void buildCaches();
+  /**
+   * @brief Builds all in-memory caches from one scan per table.
+   *
+   * The symbol search index and the inheritance part of the hierarchy are built on worker threads. With buildInBackground
+   * the function returns before they are done, queries that need them wait for them, and the build times are reported in
+   * the status bar once everything is ready.
+   */
+  void buildCaches(bool buildInBackground = false);
+
+  /**
+   * @brief Records the nodes that change from now on in the database, see SqliteIndexStorage::trackNodeChanges
+   */
+  void trackSymbolIndexChanges();
+
+  /**
+   * @brief Moves the finished symbol search index out, the storage answers no more searches afterwards
+   */
+  SearchIndex takeSymbolIndex();
+
+  /**
+   * @brief Takes over the symbol search index of the storage whose database this one was copied from
+   *
+   * If the changes since the copy were tracked with trackSymbolIndexChanges, the next buildCaches only removes and
+   * re-adds the changed nodes instead of building the index from all nodes.
+   */
+  void adoptSymbolIndex(SearchIndex symbolIndex);
+
+  /**
+   * @brief Writes a memory mapped copy of the node and edge tables next to the database, which buildCaches and all graph
+   * queries use instead of the database until the graph is written to again.
+   */
+  void writeGraphSnapshot();
 
   void optimizeMemory();
 
@@ -240,6 +311,9 @@ public:
                                                                   const std::vector<Id>& localSymbolIds) const override;
 
 private:
+  // more readers wait for an idle connection, see acquireReadConnection
+  static constexpr size_t MaxReadConnectionCount = 8;
+
   mutable struct {
     std::vector<StorageNode> nodes;
     std::vector<StorageFile> files;
@@ -289,11 +363,45 @@ private:
   void addCompleteFlagsToSourceLocationCollection(SourceLocationCollection* collection) const;
   void addInheritanceChainsToGraph(const std::vector<Id>& nodeIds, Graph* graph) const;
 
+  FilePath getGraphSnapshotFilePath() const;
+
+  /**
+   * @brief Runs func with an idle read-only connection of the pool, or with the main connection outside of read mode
+   *
+   * Falling back to the main connection is serialized, so concurrent callers never run on it at the same time.
+   */
+  template <typename Func>
+  auto withReadConnection(Func&& func) const;
+  std::unique_ptr<SqliteIndexStorage> acquireReadConnection() const;
+  void releaseReadConnection(std::unique_ptr<SqliteIndexStorage> connection) const;
+  void setReadConnectionsEnabled(bool enabled);
+
+  // read nodes and edges from the graph snapshot if there is a valid one, otherwise from the database
+  StorageNode getStorageNodeById(Id nodeId) const;
+  std::vector<StorageNode> getStorageNodesByIds(const std::vector<Id>& nodeIds) const;
+  void forEachStorageNode(const std::function<void(StorageNode&&)>& func) const;
+  bool isStorageEdge(Id edgeId) const;
+  StorageEdge getStorageEdgeById(Id edgeId) const;
+  std::vector<StorageEdge> getStorageEdgesByIds(const std::vector<Id>& edgeIds) const;
+  std::vector<StorageEdge> getStorageEdgesBySourceIds(const std::vector<Id>& sourceIds) const;
+  std::vector<StorageEdge> getStorageEdgesByTargetIds(const std::vector<Id>& targetIds) const;
+  std::vector<StorageEdge> getStorageEdgesBySourceOrTargetId(Id nodeId) const;
+  void forEachStorageEdgeOfType(int type, const std::function<void(StorageEdge&&)>& func) const;
+
   void buildFilePathMaps();
-  void buildSearchIndex();
+  std::vector<StorageNode> buildFileIndex(const std::vector<Id>* changedNodeIds);
+  size_t buildSymbolIndex(const std::unordered_set<Id>& removedNodeIds, const std::vector<StorageNode>& symbolNodes);
   void buildFullTextSearchIndex() const;
-  void buildMemberEdgeIdOrderMap();
-  void buildHierarchyCache();
+  // calls func from several threads at once with the trigrams of each file's stored content
+  void computeFullTextSearchTrigrams(const std::vector<Id>& fileIds,
+                                     const TextCodec& codec,
+                                     const std::function<void(Id, const std::vector<FullTextSearchIndex::Trigram>&)>& func) const;
+  void buildMemberEdgeIdOrderMap(const std::vector<StorageEdge>& memberEdges);
+  void buildHierarchyCache(const std::vector<StorageEdge>& memberEdges);
+  size_t buildInheritanceCache(const std::vector<StorageEdge>& inheritanceEdges);
+  void waitForSymbolIndex() const;
+  void waitForInheritanceCache() const;
+  void waitForCacheBuildReport() const;
 
   bool m_preIndexingErrorCountSet = false;
   size_t m_preIndexingErrorCount = 0;
@@ -301,6 +409,7 @@ private:
 
   SearchIndex m_commandIndex;
   SearchIndex m_symbolIndex;
+  std::optional<SearchIndex> m_adoptedSymbolIndex;
   SearchIndex m_fileIndex;
 
   mutable FullTextSearchIndex m_fullTextSearchIndex;
@@ -308,6 +417,17 @@ private:
   mutable std::mutex m_fullTextSearchMutex;
 
   SqliteIndexStorage m_sqliteIndexStorage;
+  // held by withReadConnection while it falls back to the main connection
+  mutable std::mutex m_mainConnectionMutex;
+  std::unique_ptr<GraphSnapshot> m_graphSnapshot;
+
+  // idle read-only connections, closed before the main connection so that it can remove the write-ahead log
+  mutable std::mutex m_readConnectionMutex;
+  mutable std::vector<std::unique_ptr<SqliteIndexStorage>> m_readConnections;
+  // idle and busy read-only connections, bounded by MaxReadConnectionCount
+  mutable size_t m_readConnectionCount = 0;
+  mutable std::condition_variable m_readConnectionReleased;
+  bool m_readConnectionsEnabled = false;
   SqliteBookmarkStorage m_sqliteBookmarkStorage;
 
   std::map<FilePath, Id> m_fileNodeIds;
@@ -321,4 +441,10 @@ private:
   std::map<Id, Id> m_memberEdgeIdOrderMap;
 
   HierarchyCache m_hierarchyCache;
+  HierarchyCache m_inheritanceCache;
+
+  // results are the build times in ms, both are waited for before the caches are cleared
+  std::shared_future<size_t> m_symbolIndexBuild;
+  std::shared_future<size_t> m_inheritanceCacheBuild;
+  std::future<void> m_cacheBuildReport;
 };
@@ -1,9 +1,9 @@
 #include "Storage.h"
 
 #include <cstddef>
-#include <map>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "logging.h"
@@ -16,8 +16,11 @@ Storage::~Storage() = default;
 void Storage::inject(Storage* injected) {
   const std::lock_guard<std::mutex> lock(mDataMutex);
 
-  std::map<Id, Id> injectedIdToOwnElementId;
-  std::map<Id, Id> injectedIdToOwnSourceLocationId;
+  std::unordered_map<Id, Id> injectedIdToOwnElementId;
+  std::unordered_map<Id, Id> injectedIdToOwnSourceLocationId;
+  injectedIdToOwnElementId.reserve(injected->getErrors().size() + injected->getStorageNodes().size() +
+                                   injected->getStorageEdges().size() + injected->getStorageLocalSymbols().size());
+  injectedIdToOwnSourceLocationId.reserve(injected->getStorageSourceLocations().size());
 
   startInjection();
 
@@ -43,8 +46,10 @@ void Storage::inject(Storage* injected) {
   {
     for(const StorageFile& file : injected->getStorageFiles()) {
       if(auto iterator = injectedIdToOwnElementId.find(file.id); iterator != injectedIdToOwnElementId.end()) {
-        addFile(StorageFile(
-            iterator->second, file.filePath, file.languageIdentifier, file.modificationTime, file.indexed, file.complete));
+        StorageFile injectedFile(
+            iterator->second, file.filePath, file.languageIdentifier, file.modificationTime, file.indexed, file.complete);
+        injectedFile.content = file.content;
+        addFile(injectedFile);
       }
     }
   }
@@ -25,27 +25,29 @@ nonstd::expected<void, std::string> StorageProvider::insert(std::shared_ptr<Inte
   return {};
 }
 
-nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> StorageProvider::consumeSecondLargestStorage() noexcept {
+nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> StorageProvider::consumeLargestStorage() noexcept {
   {
     const std::lock_guard lock(mStoragesMutex);
-    if(mStorages.size() > 1) {
-      auto iterator = mStorages.begin();
-      ++iterator;
-      auto storage = *iterator;
-      mStorages.erase(iterator);
-      return storage;
+    if(!mStorages.empty()) {
+      auto ret = mStorages.front();
+      mStorages.pop_front();
+      return ret;
     }
   }
   return nonstd::make_unexpected("No Storage found");
 }
 
-nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> StorageProvider::consumeLargestStorage() noexcept {
+nonstd::expected<std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>>, std::string>
+StorageProvider::consumeStoragesToMerge() noexcept {
   {
     const std::lock_guard lock(mStoragesMutex);
-    if(!mStorages.empty()) {
-      auto ret = mStorages.front();
-      mStorages.pop_front();
-      return ret;
+    if(mStorages.size() > 2) {    // largest storage won't be touched here
+      // merging the smallest storages first keeps the merge tree balanced
+      auto source = std::move(mStorages.back());
+      mStorages.pop_back();
+      auto target = std::move(mStorages.back());
+      mStorages.pop_back();
+      return std::make_pair(std::move(target), std::move(source));
     }
   }
   return nonstd::make_unexpected("No Storage found");
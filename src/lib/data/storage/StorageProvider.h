@@ -11,6 +11,7 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #include <nonstd/expected.hpp>
 
@@ -48,22 +49,24 @@ public:
   nonstd::expected<void, std::string> insert(std::shared_ptr<IntermediateStorage> storage) noexcept;
 
   /**
-   * @brief Consume the second-largest storage
+   * @brief Consume the largest storage
    *
    * @note This function is thread-safe
    *
-   * @return std::shared_ptr<IntermediateStorage> The second-largest storage
+   * @return std::shared_ptr<IntermediateStorage> The largest storage
    */
-  nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> consumeSecondLargestStorage() noexcept;
+  nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> consumeLargestStorage() noexcept;
 
   /**
-   * @brief Consume the largest storage
+   * @brief Consume the two smallest storages as one merge job
    *
-   * @note This function is thread-safe
+   * @note This function is thread-safe. Both storages are taken under one lock, so concurrent merge lanes never hold
+   * half a pair each. The largest storage is never handed out, it is reserved for the injection into the database.
    *
-   * @return std::shared_ptr<IntermediateStorage> The largest storage
+   * @return A pair of the larger (merge target) and the smaller (merge source) storage
    */
-  nonstd::expected<std::shared_ptr<IntermediateStorage>, std::string> consumeLargestStorage() noexcept;
+  nonstd::expected<std::pair<std::shared_ptr<IntermediateStorage>, std::shared_ptr<IntermediateStorage>>, std::string>
+  consumeStoragesToMerge() noexcept;
 
 private:
   std::list<std::shared_ptr<IntermediateStorage>> mStorages;    // larger storages are in front
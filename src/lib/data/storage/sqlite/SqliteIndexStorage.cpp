@@ -1,5 +1,12 @@
 #include "SqliteIndexStorage.h"
 
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
 #include "FileSystem.h"
 #include "GlobalId.hpp"
 #include "LocationType.h"
@@ -9,7 +16,9 @@
 #include "TextAccess.h"
 #include "utilityString.h"
 
-const size_t SqliteIndexStorage::sStorageVersion = 25;
+#include <zlib.h>
+
+const size_t SqliteIndexStorage::sStorageVersion = 28;
 
 namespace {
 std::pair<std::wstring, std::wstring> splitLocalSymbolName(const std::wstring& name) {
@@ -20,6 +29,57 @@ std::pair<std::wstring, std::wstring> splitLocalSymbolName(const std::wstring& n
 
   return std::make_pair(name.substr(0, pos), name.substr(pos + 1, name.size() - pos - 2));
 }
+
+// parses the hex text written by fmt::format("{:016x}"), nullopt for an empty or corrupt value
+std::optional<uint64_t> parseHex(std::string_view text) {
+  uint64_t value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+  if(text.empty() || error != std::errc() || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// a last line without a line break counts as well
+int countLines(std::string_view text) {
+  int lineCount = static_cast<int>(std::ranges::count(text, '\n'));
+  if(!text.empty() && text.back() != '\n') {
+    lineCount++;
+  }
+  return lineCount;
+}
+
+// paths bound per query of getFilesByPaths, unless the connection allows fewer variables
+constexpr size_t FilePathBatchSize = 256;
+
+// uncompressed size of a file content block, blocks end at a line break unless a single line is longer
+constexpr size_t FileContentBlockSize = 32 * 1024;
+
+std::string compressFileContentBlock(std::string_view text) {
+  uLongf length = compressBound(static_cast<uLong>(text.size()));
+  std::string data(length, '\0');
+  if(compress2(reinterpret_cast<Bytef*>(data.data()),
+               &length,
+               reinterpret_cast<const Bytef*>(text.data()),
+               static_cast<uLong>(text.size()),
+               Z_DEFAULT_COMPRESSION) != Z_OK) {
+    return {};
+  }
+  data.resize(length);
+  return data;
+}
+
+bool decompressFileContentBlock(const unsigned char* data, int length, size_t size, std::string& text) {
+  const size_t offset = text.size();
+  text.resize(offset + size);
+  uLongf decompressedLength = static_cast<uLongf>(size);
+  return uncompress(reinterpret_cast<Bytef*>(text.data() + offset), &decompressedLength, data, static_cast<uLong>(length)) ==
+      Z_OK &&
+      decompressedLength == size;
+}
+
+// defined with the cursor rows below
+bool decodeRow(CppSQLite3Query& query, StorageSourceLocation& row);
 }    // namespace
 
 size_t SqliteIndexStorage::getStorageVersion() {
@@ -28,20 +88,29 @@ size_t SqliteIndexStorage::getStorageVersion() {
 
 SqliteIndexStorage::SqliteIndexStorage() = default;
 
-SqliteIndexStorage::SqliteIndexStorage(const FilePath& dbFilePath) : SqliteStorage(dbFilePath.getCanonical()) {}
+SqliteIndexStorage::SqliteIndexStorage(const FilePath& dbFilePath, OpenMode openMode)
+    : SqliteStorage(dbFilePath.getCanonical(), openMode) {}
 
 size_t SqliteIndexStorage::getStaticVersion() const {
   return sStorageVersion;
 }
 
 void SqliteIndexStorage::setMode(StorageModeType mode) {
-  m_tempNodeNameIndex.clear();
-  m_tempWNodeNameIndex.clear();
-  m_tempNodeTypes.clear();
+  m_tempNodeNames.clear();
+  m_tempNodes.clear();
   m_tempEdgeIndex.clear();
   m_tempLocalSymbolIndex.clear();
   m_tempSourceLocationIndices.clear();
 
+  if(STORAGE_MODE_BULK_LOAD == mode) {
+    beginBulkLoad();
+  } else {
+    endBulkLoad();
+    // with a write-ahead log, readers on other connections neither block nor wait for the writer
+    executeStatement("PRAGMA journal_mode=WAL;");
+    executeStatement("PRAGMA synchronous=NORMAL;");
+  }
+
   std::vector<std::pair<int, SqliteDatabaseIndex>> indices = getIndices();
   for(auto& [index, databaseIndex] : indices) {
     if(index & mode) {
@@ -50,6 +119,7 @@ void SqliteIndexStorage::setMode(StorageModeType mode) {
       std::ignore = databaseIndex.removeFromDatabase(m_database);
     }
   }
+  clearAuditedQueryPlans();
 }
 
 std::string SqliteIndexStorage::getProjectSettingsText() const {
@@ -60,63 +130,113 @@ void SqliteIndexStorage::setProjectSettingsText(const std::string& text) {
   insertOrUpdateMetaValue("project_settings", text);
 }
 
+uint64_t SqliteIndexStorage::getGraphSnapshotToken() const {
+  // a corrupt token matches no snapshot, so the snapshot is rebuilt
+  return parseHex(getMetaValue("graph_snapshot_token")).value_or(0);
+}
+
+void SqliteIndexStorage::setGraphSnapshotToken(uint64_t token) {
+  insertOrUpdateMetaValue("graph_snapshot_token", token == 0 ? std::string() : fmt::format("{:016x}", token));
+}
+
+void SqliteIndexStorage::trackNodeChanges() {
+  try {
+    dropNodeChangeTracking();
+    m_database.execDML(
+        "CREATE TABLE main.changed_node("
+        "id INTEGER NOT NULL, "
+        "PRIMARY KEY(id));");
+
+    // temp triggers belong to this connection and fire for rows removed by foreign key cascades as well
+    for(const char* trigger : {
+            "CREATE TEMP TRIGGER IF NOT EXISTS node_inserted AFTER INSERT ON main.node "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(new.id); END;",
+            "CREATE TEMP TRIGGER IF NOT EXISTS node_deleted AFTER DELETE ON main.node "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(old.id); END;",
+            "CREATE TEMP TRIGGER IF NOT EXISTS node_type_updated AFTER UPDATE OF type ON main.node "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(new.id); END;",
+            "CREATE TEMP TRIGGER IF NOT EXISTS symbol_inserted AFTER INSERT ON main.symbol "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(new.id); END;",
+            "CREATE TEMP TRIGGER IF NOT EXISTS symbol_deleted AFTER DELETE ON main.symbol "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(old.id); END;",
+            "CREATE TEMP TRIGGER IF NOT EXISTS symbol_updated AFTER UPDATE ON main.symbol "
+            "BEGIN INSERT OR IGNORE INTO changed_node(id) VALUES(new.id); END;"}) {
+      m_database.execDML(trigger);
+    }
+  } catch(CppSQLite3Exception& e) {
+    LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+  }
+}
+
+std::optional<std::vector<Id>> SqliteIndexStorage::takeChangedNodeIds() {
+  if(!hasTable("changed_node")) {
+    return std::nullopt;
+  }
+
+  std::vector<Id> nodeIds;
+  {
+    CppSQLite3Query query = executeQuery("SELECT id FROM changed_node;");
+    for(; !query.eof(); query.nextRow()) {
+      nodeIds.push_back(static_cast<Id>(query.getIntField(0, 0)));
+    }
+  }
+
+  try {
+    dropNodeChangeTracking();
+  } catch(CppSQLite3Exception& e) {
+    LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+  }
+  return nodeIds;
+}
+
+void SqliteIndexStorage::dropNodeChangeTracking() {
+  for(const char* trigger :
+      {"node_inserted", "node_deleted", "node_type_updated", "symbol_inserted", "symbol_deleted", "symbol_updated"}) {
+    m_database.execDML(fmt::format("DROP TRIGGER IF EXISTS temp.{};", trigger).c_str());
+  }
+  m_database.execDML("DROP TABLE IF EXISTS main.changed_node;");
+}
+
 Id SqliteIndexStorage::addNode(const StorageNodeData& data) {
   std::vector<Id> ids = addNodes({StorageNode(0, data)});
   return ids.empty() ? 0 : ids.front();
 }
 
 std::vector<Id> SqliteIndexStorage::addNodes(const std::vector<StorageNode>& nodes) {
-  if(m_tempNodeNameIndex.empty() && m_tempWNodeNameIndex.empty()) {
-    forEach<StorageNode>([this](StorageNode&& node) {
-      const std::string name = utility::encodeToUtf8(node.serializedName);
-      if(name.size() != node.serializedName.size()) {
-        m_tempWNodeNameIndex.add(node.serializedName, static_cast<uint32_t>(node.id));
-      } else {
-        m_tempNodeNameIndex.add(name, static_cast<uint32_t>(node.id));
+  if(m_tempNodeNames.empty()) {
+    // the stored UTF-8 names are interned as they are, without a round trip through std::wstring
+    auto cursor = getCursor<StorageNodeView>();
+    while(cursor.next()) {
+      const StorageNodeView& node = cursor.get();
+      if(m_tempNodeNames.intern(node.serializedName).second) {
+        m_tempNodes.push_back({static_cast<uint32_t>(node.id), node.type});
       }
-
-      m_tempNodeTypes.emplace(static_cast<uint32_t>(node.id), node.type);
-    });
+    }
   }
 
   std::vector<Id> nodeIds(nodes.size(), 0);
   std::vector<StorageNode> nodesToInsert;
   for(size_t i = 0; i < nodes.size(); i++) {
     const StorageNodeData& data = nodes[i];
-    const std::string name = utility::encodeToUtf8(data.serializedName);
-    {
-      Id nodeId = 0U;
-      if(name.size() != data.serializedName.size()) {
-        nodeId = m_tempWNodeNameIndex.find(data.serializedName);
-      } else {
-        nodeId = m_tempNodeNameIndex.find(name);
-      }
+    const auto [handle, added] = m_tempNodeNames.intern(utility::encodeToUtf8(data.serializedName));
+    if(added) {
+      const Id lastRowId = insertElement();
 
-      if(0U != nodeId) {
-        if(auto iterator = m_tempNodeTypes.find(static_cast<uint32_t>(nodeId));
-           iterator != m_tempNodeTypes.end() && iterator->second < data.type) {
-          setNodeType(data.type, nodeId);
-          m_tempNodeTypes[static_cast<uint32_t>(nodeId)] = data.type;
-        }
-
-        nodeIds[i] = nodeId;
-      } else {
-        executeStatement(m_insertElementStmt);
-        const Id lastRowId = static_cast<Id>(m_database.lastRowId());
-
-        nodesToInsert.emplace_back(lastRowId, data);
-        nodeIds[i] = lastRowId;
-
-        if(name.size() != data.serializedName.size()) {
-          m_tempWNodeNameIndex.add(data.serializedName, static_cast<uint32_t>(lastRowId));
-        } else {
-          m_tempNodeNameIndex.add(name, static_cast<uint32_t>(lastRowId));
-        }
-        m_tempNodeTypes.emplace(static_cast<uint32_t>(lastRowId), data.type);
+      nodesToInsert.emplace_back(lastRowId, data);
+      nodeIds[i] = lastRowId;
+      m_tempNodes.push_back({static_cast<uint32_t>(lastRowId), data.type});
+    } else {
+      TempNode& node = m_tempNodes[handle];
+      if(node.type < data.type) {
+        setNodeType(data.type, node.id);
+        node.type = data.type;
       }
+
+      nodeIds[i] = node.id;
     }
   }
 
+  flushPendingElements();
   if(!nodesToInsert.empty()) {
     m_insertNodeBatchStatement.execute(nodesToInsert, this);
   }
@@ -144,12 +264,10 @@ bool SqliteIndexStorage::addFile(const StorageFile& data) {
     modificationTime = FileSystem::getFileInfoForPath(filePath).lastWriteTime.toString();
   }
 
-  std::shared_ptr<TextAccess> content;
-  int lineCount = 0;
-  if(data.indexed) {
-    content = TextAccess::createFromFile(filePath);
-    lineCount = static_cast<int>(content->getLineCount());
-  }
+  // the indexer captures the content it parsed, indexed files without it get theirs from the translation unit that claims
+  // them or from disk in addMissingFileContentsFromDisk
+  const bool hasContent = data.indexed && data.content;
+  const std::string contentHash = hasContent ? fmt::format("{:016x}", TextAccess::getContentHash(*data.content)) : "";
 
   bool success = false;
   {
@@ -159,19 +277,94 @@ bool SqliteIndexStorage::addFile(const StorageFile& data) {
     m_insertFileStmt.bind(4, modificationTime.c_str());
     m_insertFileStmt.bind(5, data.indexed ? 1 : 0);
     m_insertFileStmt.bind(6, data.complete ? 1 : 0);
-    m_insertFileStmt.bind(7, lineCount);
+    m_insertFileStmt.bind(7, hasContent ? countLines(*data.content) : 0);
+    if(hasContent) {
+      m_insertFileStmt.bind(8, contentHash.c_str());
+    } else {
+      m_insertFileStmt.bindNull(8);
+    }
     success = executeStatement(m_insertFileStmt);
   }
 
-  if(success && content) {
-    m_insertFileContentStmt.bind(1, int(data.id));
-    m_insertFileContentStmt.bind(2, content->getText().c_str());
-    success = executeStatement(m_insertFileContentStmt);
+  if(success && hasContent) {
+    success = addFileContent(contentHash, *data.content);
   }
 
   return success;
 }
 
+bool SqliteIndexStorage::hasFileContent(Id fileId) const {
+  return executeCachedStatementScalar("SELECT content_hash IS NOT NULL FROM file WHERE id == ?;", {fileId}, 0) != 0;
+}
+
+bool SqliteIndexStorage::setFileContent(Id fileId, std::string_view content) {
+  const std::string contentHash = fmt::format("{:016x}", TextAccess::getContentHash(content));
+  return executeCachedStatement("UPDATE file SET line_count = ?, content_hash = ? WHERE id == ?;",
+                                {countLines(content), contentHash, fileId}) &&
+      addFileContent(contentHash, content);
+}
+
+size_t SqliteIndexStorage::addMissingFileContentsFromDisk() {
+  std::vector<std::pair<Id, std::wstring>> files;
+  forEach<StorageFile>("WHERE indexed = 1 AND content_hash IS NULL", {}, [&files](StorageFile&& file) {
+    files.emplace_back(file.id, std::move(file.filePath));
+  });
+
+  for(const auto& [fileId, filePath] : files) {
+    setFileContent(fileId, TextAccess::createFromFile(FilePath(filePath))->getText());
+  }
+  return files.size();
+}
+
+bool SqliteIndexStorage::addFileContent(const std::string& contentHash, std::string_view text) {
+  if(executeStatementScalar(getCachedStatement("SELECT EXISTS(SELECT 1 FROM file_content_block WHERE content_hash = ?);",
+                                               {contentHash})
+                                .get(),
+                            0) != 0) {
+    return true;
+  }
+
+  uint32_t firstLine = 1;
+  size_t blockStart = 0;
+  while(blockStart < text.size()) {
+    size_t blockEnd = text.size();
+    if(blockEnd - blockStart > FileContentBlockSize) {
+      size_t lineEnd = text.rfind('\n', blockStart + FileContentBlockSize - 1);
+      if(lineEnd == std::string_view::npos || lineEnd < blockStart) {
+        lineEnd = text.find('\n', blockStart + FileContentBlockSize);
+      }
+      blockEnd = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+    }
+
+    const std::string_view block = text.substr(blockStart, blockEnd - blockStart);
+    auto lineCount = static_cast<uint32_t>(std::ranges::count(block, '\n'));
+    if(block.back() != '\n') {
+      lineCount++;
+    }
+
+    const std::string data = compressFileContentBlock(block);
+    if(data.empty()) {
+      LOG_ERROR("Failed to compress content " + contentHash);
+      return false;
+    }
+
+    m_insertFileContentBlockStmt.bind(1, contentHash.c_str());
+    m_insertFileContentBlockStmt.bind(2, static_cast<int>(firstLine));
+    m_insertFileContentBlockStmt.bind(3, static_cast<int>(lineCount));
+    m_insertFileContentBlockStmt.bind(4, static_cast<int>(block.size()));
+    m_insertFileContentBlockStmt.bind(
+        5, reinterpret_cast<const unsigned char*>(data.data()), static_cast<int>(data.size()));
+    if(!executeStatement(m_insertFileContentBlockStmt)) {
+      return false;
+    }
+
+    firstLine += lineCount;
+    blockStart = blockEnd;
+  }
+
+  return true;
+}
+
 Id SqliteIndexStorage::addEdge(const StorageEdgeData& data) {
   const std::vector<Id> ids = addEdges({StorageEdge(0, data)});
   return ids.empty() ? 0 : ids.front();
@@ -191,8 +384,7 @@ std::vector<Id> SqliteIndexStorage::addEdges(const std::vector<StorageEdge>& edg
     if(auto iterator = m_tempEdgeIndex.find(data); iterator != m_tempEdgeIndex.end()) {
       edgeIds[i] = iterator->second;
     } else {
-      executeStatement(m_insertElementStmt);
-      const Id lastRowId = static_cast<Id>(m_database.lastRowId());
+      const Id lastRowId = insertElement();
 
       edgeIds[i] = lastRowId;
       edgesToInsert.emplace_back(lastRowId, data);
@@ -201,6 +393,7 @@ std::vector<Id> SqliteIndexStorage::addEdges(const std::vector<StorageEdge>& edg
     }
   }
 
+  flushPendingElements();
   if(!edgesToInsert.empty()) {
     m_insertEdgeBatchStatement.execute(edgesToInsert, this);
   }
@@ -240,8 +433,7 @@ std::vector<Id> SqliteIndexStorage::addLocalSymbols(const std::set<StorageLocalS
     }
 
     if(0U == symbolIds[i]) {
-      std::ignore = executeStatement(m_insertElementStmt);
-      const Id lastRowId = static_cast<Id>(m_database.lastRowId());
+      const Id lastRowId = insertElement();
 
       symbolIds[i] = lastRowId;
       symbolsToInsert.emplace_back(lastRowId, data);
@@ -253,6 +445,7 @@ std::vector<Id> SqliteIndexStorage::addLocalSymbols(const std::set<StorageLocalS
     iterator++;
   }
 
+  flushPendingElements();
   if(!symbolsToInsert.empty()) {
     m_insertLocalSymbolBatchStatement.execute(symbolsToInsert, this);
   }
@@ -280,7 +473,9 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
 
   std::vector<Id> locationIds(locations.size(), 0);
   std::vector<StorageSourceLocationData> locationsToInsert;
-  const size_t lastRowId = static_cast<size_t>(executeStatementScalar("SELECT MAX(rowid) from source_location", 0));
+  const size_t lastRowId = m_bulkLoading ?
+      static_cast<size_t>(m_lastSourceLocationId) :
+      static_cast<size_t>(executeStatementScalar("SELECT MAX(rowid) from source_location", 0));
 
   for(size_t i = 0; i < locations.size(); i++) {
     const StorageSourceLocation& data = locations[i];
@@ -294,7 +489,7 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
     if(auto iterator = index.find(tempLoc); iterator != index.end()) {
       locationIds[i] = iterator->second;
     } else {
-      std::ignore = executeStatement(m_insertElementStmt);
+      std::ignore = insertElement();
       Id newId = lastRowId + 1 + locationsToInsert.size();
 
       locationIds[i] = newId;
@@ -304,8 +499,10 @@ std::vector<Id> SqliteIndexStorage::addSourceLocations(const std::vector<Storage
     }
   }
 
+  flushPendingElements();
   if(!locationsToInsert.empty()) {
     m_insertSourceLocationBatchStatement.execute(locationsToInsert, this);
+    m_lastSourceLocationId = lastRowId + locationsToInsert.size();
   }
 
   return locationIds;
@@ -357,8 +554,8 @@ StorageError SqliteIndexStorage::addError(const StorageErrorData& data) {
   }
 
   if(0 == lastRowId) {
-    executeStatement(m_insertElementStmt);
-    lastRowId = static_cast<Id>(m_database.lastRowId());
+    lastRowId = insertElement();
+    flushPendingElements();
 
     m_insertErrorStmt.bind(1, int(lastRowId));
     m_insertErrorStmt.bind(2, utility::encodeToUtf8(sanitizedMessage).c_str());
@@ -382,12 +579,13 @@ void SqliteIndexStorage::removeElement(Id elementId) {
 }
 
 void SqliteIndexStorage::removeElements(const std::vector<Id>& ids) {
-  executeStatement("DELETE FROM element WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ");");
+  const IdList idList(*this, ids);
+  executeCachedStatement("DELETE FROM element WHERE id IN " + idList.getSelect() + ";");
 }
 
 void SqliteIndexStorage::removeOccurrence(const StorageOccurrence& occurrence) {
-  executeStatement("DELETE FROM occurrence WHERE element_id = " + std::to_string(occurrence.elementId) +
-                   " AND source_location_id = " + std::to_string(occurrence.sourceLocationId) + ";");
+  executeCachedStatement("DELETE FROM occurrence WHERE element_id = ? AND source_location_id = ?;",
+                         {occurrence.elementId, occurrence.sourceLocationId});
 }
 
 void SqliteIndexStorage::removeOccurrences(const std::vector<StorageOccurrence>& occurrences) {
@@ -397,8 +595,9 @@ void SqliteIndexStorage::removeOccurrences(const std::vector<StorageOccurrence>&
 }
 
 void SqliteIndexStorage::removeElementsWithoutOccurrences(const std::vector<Id>& elementIds) {
-  executeStatement("DELETE FROM element WHERE id IN (" + utility::join(utility::toStrings(elementIds), ',') +
-                   ") AND id NOT IN (SELECT element_id FROM occurrence);");
+  const IdList idList(*this, elementIds);
+  executeCachedStatement("DELETE FROM element WHERE id IN " + idList.getSelect() +
+                         " AND id NOT IN (SELECT element_id FROM occurrence);");
 }
 
 void SqliteIndexStorage::removeElementsWithLocationInFiles(const std::vector<Id>& fileIds,
@@ -423,6 +622,8 @@ void SqliteIndexStorage::removeElementsWithLocationInFiles(const std::vector<Id>
     updateStatusCallback(3);
   }
 
+  const IdList fileIdList(*this, fileIds);
+
   // store ids of all elements located in fileIds into element_id_to_clear
   executeStatement(
       "INSERT INTO element_id_to_clear "
@@ -431,9 +632,8 @@ void SqliteIndexStorage::removeElementsWithLocationInFiles(const std::vector<Id>
       "	INNER JOIN source_location ON ("
       "		occurrence.source_location_id = source_location.id"
       "	) "
-      "	WHERE source_location.file_node_id IN (" +
-      utility::join(utility::toStrings(fileIds), ',') +
-      ")"
+      "	WHERE source_location.file_node_id IN " +
+      fileIdList.getSelect() +
       "	GROUP BY (occurrence.element_id)");
 
   if(updateStatusCallback != nullptr) {
@@ -481,7 +681,7 @@ void SqliteIndexStorage::removeElementsWithLocationInFiles(const std::vector<Id>
   }
 
   // delete source locations from fileIds (this also deletes the respective occurrences)
-  executeStatement("DELETE FROM source_location WHERE file_node_id IN (" + utility::join(utility::toStrings(fileIds), ',') + ");");
+  executeStatement("DELETE FROM source_location WHERE file_node_id IN " + fileIdList.getSelect() + ";");
 
   if(updateStatusCallback != nullptr) {
     updateStatusCallback(45);
@@ -531,95 +731,81 @@ void SqliteIndexStorage::removeAllErrors() {
 }
 
 bool SqliteIndexStorage::isEdge(Id elementId) const {
-  return executeStatementScalar("SELECT count(*) FROM edge WHERE id = " + std::to_string(elementId) + ";", 0) > 0;
+  return executeCachedStatementScalar("SELECT count(*) FROM edge WHERE id = ?;", {elementId}, 0) > 0;
 }
 
 bool SqliteIndexStorage::isNode(Id elementId) const {
-  return executeStatementScalar("SELECT count(*) FROM node WHERE id = " + std::to_string(elementId) + ";", 0) > 0;
+  return executeCachedStatementScalar("SELECT count(*) FROM node WHERE id = ?;", {elementId}, 0) > 0;
 }
 
 bool SqliteIndexStorage::isFile(Id elementId) const {
-  return executeStatementScalar("SELECT count(*) FROM file WHERE id = " + std::to_string(elementId) + ";", 0) > 0;
+  return executeCachedStatementScalar("SELECT count(*) FROM file WHERE id = ?;", {elementId}, 0) > 0;
 }
 
 StorageEdge SqliteIndexStorage::getEdgeById(Id edgeId) const {
-  const std::vector<StorageEdge> candidates = doGetAll<StorageEdge>("WHERE id = " + std::to_string(edgeId));
+  const std::vector<StorageEdge> candidates = doGetAll<StorageEdge>("WHERE id = ?", {edgeId});
 
   return candidates.empty() ? StorageEdge{} : candidates.front();
 }
 
 StorageEdge SqliteIndexStorage::getEdgeBySourceTargetType(Id sourceId, Id targetId, int type) const {
-  return doGetFirst<StorageEdge>(
-      "WHERE "
-      "source_node_id == " +
-      std::to_string(sourceId) +
-      " AND "
-      "target_node_id == " +
-      std::to_string(targetId) +
-      " AND "
-      "type == " +
-      std::to_string(type));
+  return doGetFirst<StorageEdge>("WHERE source_node_id == ? AND target_node_id == ? AND type == ?", {sourceId, targetId, type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceId(Id sourceId) const {
-  return doGetAll<StorageEdge>("WHERE source_node_id == " + std::to_string(sourceId));
+  return doGetAll<StorageEdge>("WHERE source_node_id == ?", {sourceId});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceIds(const std::vector<Id>& sourceIds) const {
-  return doGetAll<StorageEdge>("WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') + ")");
+  const IdList idList(*this, sourceIds);
+  return doGetAll<StorageEdge>("WHERE source_node_id IN " + idList.getSelect(), {});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetId(Id targetId) const {
-  return doGetAll<StorageEdge>("WHERE target_node_id == " + std::to_string(targetId));
+  return doGetAll<StorageEdge>("WHERE target_node_id == ?", {targetId});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetIds(const std::vector<Id>& targetIds) const {
-  return doGetAll<StorageEdge>("WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') + ")");
+  const IdList idList(*this, targetIds);
+  return doGetAll<StorageEdge>("WHERE target_node_id IN " + idList.getSelect(), {});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceOrTargetId(Id targetId) const {
-  return doGetAll<StorageEdge>("WHERE source_node_id == " + std::to_string(targetId) +
-                               " OR target_node_id == " + std::to_string(targetId));
+  return doGetAll<StorageEdge>("WHERE source_node_id == ? OR target_node_id == ?", {targetId, targetId});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByType(int type) const {
-  return doGetAll<StorageEdge>("WHERE type == " + std::to_string(type));
+  return doGetAll<StorageEdge>("WHERE type == ?", {type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourceType(Id sourceId, int type) const {
-  return doGetAll<StorageEdge>("WHERE source_node_id == " + std::to_string(sourceId) + " AND type == " + std::to_string(type));
+  return doGetAll<StorageEdge>("WHERE source_node_id == ? AND type == ?", {sourceId, type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesBySourcesType(const std::vector<Id>& sourceIds, int type) const {
-  return doGetAll<StorageEdge>("WHERE source_node_id IN (" + utility::join(utility::toStrings(sourceIds), ',') +
-                               ")"
-                               " AND type == " +
-                               std::to_string(type));
+  const IdList idList(*this, sourceIds);
+  return doGetAll<StorageEdge>("WHERE source_node_id IN " + idList.getSelect() + " AND type == ?", {type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetType(Id targetId, int type) const {
-  return doGetAll<StorageEdge>("WHERE target_node_id == " + std::to_string(targetId) + " AND type == " + std::to_string(type));
+  return doGetAll<StorageEdge>("WHERE target_node_id == ? AND type == ?", {targetId, type});
 }
 
 std::vector<StorageEdge> SqliteIndexStorage::getEdgesByTargetsType(const std::vector<Id>& targetIds, int type) const {
-  return doGetAll<StorageEdge>("WHERE target_node_id IN (" + utility::join(utility::toStrings(targetIds), ',') +
-                               ")"
-                               " AND type == " +
-                               std::to_string(type));
+  const IdList idList(*this, targetIds);
+  return doGetAll<StorageEdge>("WHERE target_node_id IN " + idList.getSelect() + " AND type == ?", {type});
 }
 
 StorageNode SqliteIndexStorage::getNodeById(Id nodeId) const {
-  const std::vector<StorageNode> candidates = doGetAll<StorageNode>("WHERE id = " + std::to_string(nodeId));
+  const std::vector<StorageNode> candidates = doGetAll<StorageNode>("WHERE id = ?", {nodeId});
 
   return candidates.empty() ? StorageNode{} : candidates.front();
 }
 
 StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& serializedName) const {
-  CppSQLite3Statement stmt = m_database.compileStatement(
-      "SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;");
-
-  stmt.bind(1, utility::encodeToUtf8(serializedName).c_str());
-  CppSQLite3Query query = executeQuery(stmt);
+  CachedStatement stmt = getCachedStatement("SELECT id, type, serialized_name FROM node WHERE serialized_name == ? LIMIT 1;",
+                                            {utility::encodeToUtf8(serializedName)});
+  CppSQLite3Query query = executeQuery(stmt.get());
 
   if(!query.eof()) {
     const Id elementId = static_cast<Id>(query.getIntField(0, 0));
@@ -631,8 +817,6 @@ StorageNode SqliteIndexStorage::getNodeBySerializedName(const std::wstring& seri
     }
   }
 
-  stmt.reset();
-
   return {};
 }
 
@@ -671,60 +855,215 @@ std::vector<int> SqliteIndexStorage::getAvailableEdgeTypes() const {
 }
 
 StorageFile SqliteIndexStorage::getFileByPath(const std::wstring& filePath) const {
-  return doGetFirst<StorageFile>("WHERE file.path == '" + utility::encodeToUtf8(filePath) + "'");
+  return doGetFirst<StorageFile>("WHERE file.path == ?", {utility::encodeToUtf8(filePath)});
 }
 
 std::vector<StorageFile> SqliteIndexStorage::getFilesByPaths(const std::vector<FilePath>& filePaths) const {
-  return doGetAll<StorageFile>("WHERE file.path IN ('" + utility::join(utility::toStrings(filePaths), "', '") + "')");
+  const std::set<FilePath> uniquePaths(filePaths.begin(), filePaths.end());
+  if(uniquePaths.empty()) {
+    return {};
+  }
+
+  // the last batch is padded with its final path, so every batch runs the same cached statement
+  const size_t batchSize = std::clamp<size_t>(m_maxVariableCount, 1, FilePathBatchSize);
+  std::string query = "WHERE file.path IN (?";
+  for(size_t i = 1; i < batchSize; i++) {
+    query += ", ?";
+  }
+  query += ")";
+
+  std::vector<StorageFile> files;
+  std::vector<Parameter> parameters;
+  parameters.reserve(batchSize);
+  for(auto it = uniquePaths.begin(); it != uniquePaths.end();) {
+    parameters.clear();
+    for(; it != uniquePaths.end() && parameters.size() < batchSize; ++it) {
+      parameters.emplace_back(utility::encodeToUtf8(it->wstr()));
+    }
+    parameters.resize(batchSize, parameters.back());
+
+    forEach<StorageFile>(query, parameters, [&files](StorageFile&& file) { files.push_back(std::move(file)); });
+  }
+  return files;
 }
 
+namespace {
+// selects the content blocks overlapping the lines [?2, ?3] of a file
+const std::string FileContentBlocksById =
+    "SELECT b.first_line, b.size, b.data "
+    "FROM file "
+    "INNER JOIN file_content_block AS b ON b.content_hash = file.content_hash "
+    "WHERE file.id = ?1 AND b.first_line <= ?3 AND b.first_line + b.line_count > ?2 "
+    "ORDER BY b.first_line;";
+const std::string FileContentBlocksByPath =
+    "SELECT b.first_line, b.size, b.data "
+    "FROM file "
+    "INNER JOIN file_content_block AS b ON b.content_hash = file.content_hash "
+    "WHERE file.path = ?1 AND b.first_line <= ?3 AND b.first_line + b.line_count > ?2 "
+    "ORDER BY b.first_line;";
+
+constexpr uint32_t MaxLine = static_cast<uint32_t>(std::numeric_limits<int>::max());
+}    // namespace
+
 std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentById(Id fileId) const {
-  CppSQLite3Query query = executeQuery("SELECT content FROM filecontent WHERE id = '" + std::to_string(fileId) + "';");
-  if(!query.eof()) {
-    return TextAccess::createFromString(query.getStringField(0, ""));
+  return TextAccess::createFromString(readFileContent(FileContentBlocksById, fileId, 1, MaxLine));
+}
+
+std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::wstring& filePath) const {
+  return TextAccess::createFromString(readFileContent(FileContentBlocksByPath, utility::encodeToUtf8(filePath), 1, MaxLine));
+}
+
+std::vector<std::string> SqliteIndexStorage::getFileLinesByPath(const std::wstring& filePath,
+                                                                uint32_t firstLine,
+                                                                uint32_t lastLine) const {
+  if(firstLine == 0 || firstLine > lastLine) {
+    return {};
+  }
+
+  uint32_t textFirstLine = 1;
+  const std::string text = readFileContent(
+      FileContentBlocksByPath, utility::encodeToUtf8(filePath), firstLine, std::min(lastLine, MaxLine), &textFirstLine);
+  if(text.empty()) {
+    return {};
   }
 
-  return TextAccess::createFromString("");
+  return TextAccess::createFromString(text)->getLines(firstLine - textFirstLine + 1, lastLine - textFirstLine + 1);
 }
 
-std::shared_ptr<TextAccess> SqliteIndexStorage::getFileContentByPath(const std::wstring& filePath) const {
+std::string SqliteIndexStorage::readFileContent(
+    const std::string& sql, const Parameter& file, uint32_t firstLine, uint32_t lastLine, uint32_t* textFirstLine) const {
+  std::string text;
   try {
-    CppSQLite3Query query = executeQuery(
-        "SELECT filecontent.content "
-        "FROM filecontent "
-        "INNER JOIN file ON filecontent.id = file.id "
-        "WHERE file.path = '" +
-        utility::encodeToUtf8(filePath) + "';");
-
-    if(!query.eof()) {
-      return TextAccess::createFromString(query.getStringField(0, ""));
+    CachedStatement statement = getCachedStatement(sql, {file, static_cast<int>(firstLine), static_cast<int>(lastLine)});
+    CppSQLite3Query query = executeQuery(statement.get());
+    if(!query.eof() && textFirstLine != nullptr) {
+      *textFirstLine = static_cast<uint32_t>(query.getIntField(0, 1));
+    }
+
+    while(!query.eof()) {
+      int length = 0;
+      const unsigned char* data = query.getBlobField(2, length);
+      if(!decompressFileContentBlock(data, length, static_cast<size_t>(query.getIntField(1, 0)), text)) {
+        LOG_ERROR("Failed to decompress stored file content");
+        return {};
+      }
+      query.nextRow();
     }
   } catch(CppSQLite3Exception& e) {
     LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
+    return {};
+  }
+
+  return text;
+}
+
+void SqliteIndexStorage::addFullTextSearchTrigrams(const std::vector<std::pair<Id, std::string>>& fileTrigrams,
+                                                   const std::string& codecName) {
+  executeStatement("BEGIN TRANSACTION;");
+  for(const auto& [fileId, trigrams] : fileTrigrams) {
+    m_insertFullTextSearchTrigramsStmt.bind(1, int(fileId));
+    m_insertFullTextSearchTrigramsStmt.bind(2, codecName.c_str());
+    m_insertFullTextSearchTrigramsStmt.bind(
+        3, reinterpret_cast<const unsigned char*>(trigrams.data()), static_cast<int>(trigrams.size()));
+    executeStatement(m_insertFullTextSearchTrigramsStmt);
+  }
+  executeStatement("COMMIT TRANSACTION;");
+}
+
+std::vector<Id> SqliteIndexStorage::getIndexedFileIdsWithoutFullTextSearchTrigrams(const std::string& codecName) const {
+  std::vector<Id> fileIds;
+  forEach<StorageFile>("WHERE indexed = 1 AND id NOT IN (SELECT id FROM fulltext_search_trigrams WHERE codec = ?)",
+                       {codecName},
+                       [&fileIds](StorageFile&& file) { fileIds.push_back(file.id); });
+  return fileIds;
+}
+
+void SqliteIndexStorage::forEachFullTextSearchTrigrams(const std::string& codecName,
+                                                       const std::function<void(Id, std::string_view)>& func) const {
+  CppSQLite3Statement statement = m_database.compileStatement(
+      "SELECT id, trigrams FROM fulltext_search_trigrams WHERE codec = ?;");
+  statement.bind(1, codecName.c_str());
+
+  CppSQLite3Query query = executeQuery(statement);
+  while(!query.eof()) {
+    const Id fileId = static_cast<Id>(query.getIntField(0, 0));
+    int length = 0;
+    const unsigned char* data = query.getBlobField(1, length);
+    if(0 != fileId) {
+      func(fileId, std::string_view(reinterpret_cast<const char*>(data), static_cast<size_t>(length)));
+    }
+
+    query.nextRow();
+  }
+}
+
+void SqliteIndexStorage::setIndexingCosts(const std::vector<StorageIndexingCost>& costs) {
+  constexpr uint64_t MaxInt = static_cast<uint64_t>(std::numeric_limits<int>::max());
+
+  executeStatement("BEGIN TRANSACTION;");
+  for(const StorageIndexingCost& cost : costs) {
+    m_insertIndexingCostStmt.bind(1, utility::encodeToUtf8(cost.filePath).c_str());
+    m_insertIndexingCostStmt.bind(2, static_cast<int>(std::min(cost.durationMs, MaxInt)));
+    m_insertIndexingCostStmt.bind(3, static_cast<int>(std::min(cost.storageSize, MaxInt)));
+    executeStatement(m_insertIndexingCostStmt);
+  }
+  executeStatement("COMMIT TRANSACTION;");
+}
+
+std::vector<StorageIndexingCost> SqliteIndexStorage::getIndexingCosts() const {
+  std::vector<StorageIndexingCost> costs;
+
+  CppSQLite3Query query = executeQuery("SELECT path, duration_ms, storage_size FROM indexing_cost;");
+  while(!query.eof()) {
+    const std::string filePath = query.getStringField(0, "");
+    if(!filePath.empty()) {
+      costs.emplace_back(utility::decodeFromUtf8(filePath),
+                         static_cast<uint64_t>(query.getInt64Field(1, 0)),
+                         static_cast<uint64_t>(query.getInt64Field(2, 0)));
+    }
+    query.nextRow();
+  }
+
+  return costs;
+}
+
+std::vector<std::pair<std::wstring, uint64_t>> SqliteIndexStorage::getFileContentHashes() const {
+  std::vector<std::pair<std::wstring, uint64_t>> contentHashes;
+
+  CppSQLite3Query query = executeQuery("SELECT path, content_hash FROM file WHERE content_hash IS NOT NULL;");
+  while(!query.eof()) {
+    const std::string filePath = query.getStringField(0, "");
+    // a file without a valid hash is left out and therefore treated as changed
+    const std::optional<uint64_t> contentHash = parseHex(query.getStringField(1, ""));
+    if(!filePath.empty() && contentHash) {
+      contentHashes.emplace_back(utility::decodeFromUtf8(filePath), *contentHash);
+    }
+    query.nextRow();
   }
 
-  return TextAccess::createFromString("");
+  return contentHashes;
 }
 
 void SqliteIndexStorage::setFileIndexed(Id fileId, bool indexed) {
-  executeStatement("UPDATE file SET indexed = " + std::to_string(indexed) + " WHERE id == " + std::to_string(fileId) + ";");
+  executeCachedStatement("UPDATE file SET indexed = ? WHERE id == ?;", {indexed, fileId});
 }
 
 void SqliteIndexStorage::setFileCompleteIfNoError(Id fileId, const std::wstring& /*filePath*/, bool complete) {
-  const bool fileHasErrors = doGetFirst<StorageSourceLocation>("WHERE file_node_id == " + std::to_string(fileId) +
-                                                               " AND type == " + std::to_string(locationTypeToInt(LOCATION_ERROR)))
+  const bool fileHasErrors = doGetFirst<StorageSourceLocation>("WHERE file_node_id == ? AND type == ?",
+                                                               {fileId, locationTypeToInt(LOCATION_ERROR)})
                                  .id != 0U;
   if(fileHasErrors != complete) {
-    executeStatement("UPDATE file SET complete = " + std::to_string(complete) + " WHERE id == " + std::to_string(fileId) + ";");
+    executeCachedStatement("UPDATE file SET complete = ? WHERE id == ?;", {complete, fileId});
   }
 }
 
 void SqliteIndexStorage::setNodeType(int type, Id nodeId) {
-  executeStatement("UPDATE node SET type = " + std::to_string(type) + " WHERE id == " + std::to_string(nodeId) + ";");
+  executeCachedStatement("UPDATE node SET type = ? WHERE id == ?;", {type, nodeId});
 }
 
 std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFile(const FilePath& filePath,
-                                                                                  const std::string& query) const {
+                                                                                  const std::string& query,
+                                                                                  const std::vector<Parameter>& parameters) const {
   std::shared_ptr<SourceLocationFile> ret = std::make_shared<SourceLocationFile>(filePath, L"", true, false, false);
 
   const StorageFile file = getFileByPath(filePath.wstr());
@@ -737,31 +1076,52 @@ std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFil
   ret->setIsComplete(file.complete);
   ret->setIsIndexed(file.indexed);
 
-  const std::vector<StorageSourceLocation> sourceLocations = doGetAll<StorageSourceLocation>(
-      "WHERE file_node_id == " + std::to_string(file.id) + " " + query);
-
-  std::vector<Id> sourceLocationIds;
-  sourceLocationIds.reserve(sourceLocations.size());
-  for(const StorageSourceLocation& storageLocation : sourceLocations) {
-    sourceLocationIds.push_back(storageLocation.id);
-  }
+  std::vector<Parameter> fileParameters = {file.id};
+  fileParameters.insert(fileParameters.end(), parameters.begin(), parameters.end());
+
+  // A single pass along source_location_file_line_index. The ORDER BY is the index order, so SQLite does not sort, and
+  // each location's occurrences arrive as adjacent rows.
+  CachedStatement statement = getCachedStatement(
+      "SELECT source_location.id, source_location.file_node_id, source_location.start_line, source_location.start_column, "
+      "source_location.end_line, source_location.end_column, source_location.type, occurrence.element_id "
+      "FROM source_location LEFT JOIN occurrence ON (occurrence.source_location_id = source_location.id) "
+      "WHERE source_location.file_node_id == ? " +
+          query +
+          " ORDER BY source_location.start_line, source_location.end_line, source_location.start_column, "
+          "source_location.end_column, source_location.type, source_location.id;",
+      fileParameters);
+  CppSQLite3Query result = executeQuery(statement.get());
+
+  StorageSourceLocation location;
+  StorageSourceLocation nextLocation;
+  std::vector<Id> elementIds;
+  auto addLocation = [&]() {
+    if(0 != location.id) {
+      ret->addSourceLocation(intToLocationType(location.type),
+                             location.id,
+                             std::exchange(elementIds, {}),
+                             location.startLine,
+                             location.startCol,
+                             location.endLine,
+                             location.endCol);
+    }
+  };
 
-  std::map<Id, std::vector<Id>> sourceLocationIdToElementIds;
-  for(const StorageOccurrence& occurrence : getOccurrencesForLocationIds(sourceLocationIds)) {
-    sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
-  }
+  for(; !result.eof(); result.nextRow()) {
+    if(!decodeRow(result, nextLocation)) {
+      continue;
+    }
 
-  for(const StorageSourceLocation& location : sourceLocations) {
-    auto iterator = sourceLocationIdToElementIds.find(location.id);
+    if(nextLocation.id != location.id) {
+      addLocation();
+      location = nextLocation;
+    }
 
-    ret->addSourceLocation(intToLocationType(location.type),
-                           location.id,
-                           iterator != sourceLocationIdToElementIds.end() ? iterator->second : std::vector<Id>(),
-                           location.startLine,
-                           location.startCol,
-                           location.endLine,
-                           location.endCol);
+    if(const auto elementId = static_cast<Id>(result.getIntField(7, 0)); 0 != elementId) {
+      elementIds.push_back(elementId);
+    }
   }
+  addLocation();
 
   return ret;
 }
@@ -769,55 +1129,58 @@ std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForFil
 std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsForLinesInFile(const FilePath& filePath,
                                                                                          size_t startLine,
                                                                                          size_t endLine) const {
-  return getSourceLocationsForFile(
-      filePath, "AND start_line <= " + std::to_string(endLine) + " AND end_line >= " + std::to_string(startLine));
+  return getSourceLocationsForFile(filePath, "AND start_line <= ? AND end_line >= ?", {endLine, startLine});
 }
 
 std::shared_ptr<SourceLocationFile> SqliteIndexStorage::getSourceLocationsOfTypeInFile(const FilePath& filePath,
                                                                                        LocationType type) const {
-  return getSourceLocationsForFile(filePath, "AND type == " + std::to_string(locationTypeToInt(type)));
+  return getSourceLocationsForFile(filePath, "AND type == ?", {locationTypeToInt(type)});
 }
 
 std::shared_ptr<SourceLocationCollection> SqliteIndexStorage::getSourceLocationsForElementIds(const std::vector<Id>& elementIds) const {
   std::vector<Id> sourceLocationIds;
-  std::map<Id, std::vector<Id>> sourceLocationIdToElementIds;
+  std::unordered_map<Id, std::vector<Id>> sourceLocationIdToElementIds;
   for(const StorageOccurrence& occurrence : getOccurrencesForElementIds(elementIds)) {
-    sourceLocationIds.push_back(occurrence.sourceLocationId);
-    sourceLocationIdToElementIds[occurrence.sourceLocationId].push_back(occurrence.elementId);
+    auto [iterator, inserted] = sourceLocationIdToElementIds.try_emplace(occurrence.sourceLocationId);
+    if(inserted) {
+      sourceLocationIds.push_back(occurrence.sourceLocationId);
+    }
+    iterator->second.push_back(occurrence.elementId);
   }
 
-  CppSQLite3Query query = executeQuery(
-      "SELECT source_location.id, file.path, source_location.start_line, "
-      "source_location.start_column, "
-      "source_location.end_line, source_location.end_column, source_location.type "
-      "FROM source_location INNER JOIN file ON (file.id = source_location.file_node_id) "
-      "WHERE source_location.id IN (" +
-      utility::join(utility::toStrings(sourceLocationIds), ',') + ");");
+  std::vector<StorageSourceLocation> sourceLocations;
+  std::vector<Id> fileIds;
+  {
+    const IdList idList(*this, sourceLocationIds);
+    Cursor<StorageSourceLocation> cursor(*this, "WHERE id IN " + idList.getSelect(), {});
+    while(cursor.next()) {
+      sourceLocations.push_back(cursor.get());
+      fileIds.push_back(cursor.get().fileNodeId);
+    }
+  }
+  std::ranges::sort(fileIds);
+  fileIds.erase(std::ranges::unique(fileIds).begin(), fileIds.end());
+
+  // each path is decoded once per file instead of once per location
+  std::unordered_map<Id, FilePath> filePaths;
+  for(const StorageFile& file : getAllByIds<StorageFile>(fileIds)) {
+    if(!file.filePath.empty()) {
+      filePaths.emplace(file.id, FilePath(file.filePath));
+    }
+  }
 
   std::shared_ptr<SourceLocationCollection> ret = std::make_shared<SourceLocationCollection>();
-
-  while(!query.eof()) {
-    const Id elementId = static_cast<Id>(query.getIntField(0, 0));
-    const std::string filePath = query.getStringField(1, "");
-    const int startLineNumber = query.getIntField(2, -1);
-    const int startColNumber = query.getIntField(3, -1);
-    const int endLineNumber = query.getIntField(4, -1);
-    const int endColNumber = query.getIntField(5, -1);
-    const int type = query.getIntField(6, -1);
-
-    if(elementId != 0 && !filePath.empty() && startLineNumber != -1 && startColNumber != -1 && endLineNumber != -1 &&
-       endColNumber != -1 && type != -1) {
-      ret->addSourceLocation(intToLocationType(type),
-                             elementId,
-                             sourceLocationIdToElementIds[elementId],
-                             FilePath(utility::decodeFromUtf8(filePath)),
-                             static_cast<size_t>(startLineNumber),
-                             static_cast<size_t>(startColNumber),
-                             static_cast<size_t>(endLineNumber),
-                             static_cast<size_t>(endColNumber));
+  for(const StorageSourceLocation& location : sourceLocations) {
+    if(auto filePath = filePaths.find(location.fileNodeId); filePath != filePaths.end()) {
+      ret->addSourceLocation(intToLocationType(location.type),
+                             location.id,
+                             std::move(sourceLocationIdToElementIds[location.id]),
+                             filePath->second,
+                             location.startLine,
+                             location.startCol,
+                             location.endLine,
+                             location.endCol);
     }
-
-    query.nextRow();
   }
 
   return ret;
@@ -828,23 +1191,27 @@ std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationId(I
 }
 
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForLocationIds(const std::vector<Id>& locationIds) const {
-  return doGetAll<StorageOccurrence>("WHERE source_location_id IN (" + utility::join(utility::toStrings(locationIds), ',') + ")");
+  const IdList idList(*this, locationIds);
+  return doGetAll<StorageOccurrence>("WHERE source_location_id IN " + idList.getSelect(), {});
 }
 
 std::vector<StorageOccurrence> SqliteIndexStorage::getOccurrencesForElementIds(const std::vector<Id>& elementIds) const {
-  return doGetAll<StorageOccurrence>("WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+  const IdList idList(*this, elementIds);
+  return doGetAll<StorageOccurrence>("WHERE element_id IN " + idList.getSelect(), {});
 }
 
 StorageComponentAccess SqliteIndexStorage::getComponentAccessByNodeId(Id nodeId) const {
-  return doGetFirst<StorageComponentAccess>("WHERE node_id == " + std::to_string(nodeId));
+  return doGetFirst<StorageComponentAccess>("WHERE node_id == ?", {nodeId});
 }
 
 std::vector<StorageComponentAccess> SqliteIndexStorage::getComponentAccessesByNodeIds(const std::vector<Id>& nodeIds) const {
-  return doGetAll<StorageComponentAccess>("WHERE node_id IN (" + utility::join(utility::toStrings(nodeIds), ',') + ")");
+  const IdList idList(*this, nodeIds);
+  return doGetAll<StorageComponentAccess>("WHERE node_id IN " + idList.getSelect(), {});
 }
 
 std::vector<StorageElementComponent> SqliteIndexStorage::getElementComponentsByElementIds(const std::vector<Id>& elementIds) const {
-  return doGetAll<StorageElementComponent>("WHERE element_id IN (" + utility::join(utility::toStrings(elementIds), ',') + ")");
+  const IdList idList(*this, elementIds);
+  return doGetAll<StorageElementComponent>("WHERE element_id IN " + idList.getSelect(), {});
 }
 
 std::vector<ErrorInfo> SqliteIndexStorage::getAllErrorInfos() const {
@@ -927,31 +1294,94 @@ int SqliteIndexStorage::getErrorCount() const {
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 std::vector<std::pair<int, SqliteDatabaseIndex>> SqliteIndexStorage::getIndices() const {
   std::vector<std::pair<int, SqliteDatabaseIndex>> indices;
-  indices.emplace_back(STORAGE_MODE_CLEAR, SqliteDatabaseIndex("edge_source_node_id_index", "edge(source_node_id)"));
-  indices.emplace_back(STORAGE_MODE_CLEAR, SqliteDatabaseIndex("edge_target_node_id_index", "edge(target_node_id)"));
+  // the edge and source location indices cover their queries, so reads never touch the table rows
+  indices.emplace_back(STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
+                       SqliteDatabaseIndex("edge_source_type_target_index", "edge(source_node_id, type, target_node_id)"));
+  indices.emplace_back(STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
+                       SqliteDatabaseIndex("edge_target_type_source_index", "edge(target_node_id, type, source_node_id)"));
+  indices.emplace_back(
+      STORAGE_MODE_READ, SqliteDatabaseIndex("edge_type_source_target_index", "edge(type, source_node_id, target_node_id)"));
   indices.emplace_back(
       STORAGE_MODE_READ | STORAGE_MODE_CLEAR, SqliteDatabaseIndex("node_serialized_name_index", "node(serialized_name)"));
-  indices.emplace_back(STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
-                       SqliteDatabaseIndex("source_location_file_node_id_index", "source_location(file_node_id)"));
-  indices.emplace_back(STORAGE_MODE_WRITE, SqliteDatabaseIndex("error_all_data_index", "error(message, fatal)"));
-  indices.emplace_back(STORAGE_MODE_WRITE, SqliteDatabaseIndex("file_path_index", "file(path)"));
   indices.emplace_back(
-      STORAGE_MODE_READ | STORAGE_MODE_CLEAR, SqliteDatabaseIndex("occurrence_element_id_index", "occurrence(element_id)"));
+      STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
+      SqliteDatabaseIndex("source_location_file_line_index",
+                          "source_location(file_node_id, start_line, end_line, start_column, end_column, type)"));
   indices.emplace_back(STORAGE_MODE_READ | STORAGE_MODE_CLEAR,
-                       SqliteDatabaseIndex("occurrence_source_location_id_index", "occurrence(source_location_id)"));
+                       SqliteDatabaseIndex("occurrence_source_location_id_index", "occurrence(source_location_id, element_id)"));
   indices.emplace_back(
       STORAGE_MODE_CLEAR, SqliteDatabaseIndex("element_component_foreign_key_index", "element_component(element_id)"));
-  indices.emplace_back(STORAGE_MODE_CLEAR, SqliteDatabaseIndex("edge_source_foreign_key_index", "edge(source_node_id)"));
-  indices.emplace_back(STORAGE_MODE_CLEAR, SqliteDatabaseIndex("edge_target_foreign_key_index", "edge(target_node_id)"));
-  indices.emplace_back(
-      STORAGE_MODE_CLEAR, SqliteDatabaseIndex("source_location_foreign_key_index", "source_location(file_node_id)"));
-  indices.emplace_back(STORAGE_MODE_CLEAR, SqliteDatabaseIndex("occurrence_element_foreign_key_index", "occurrence(element_id)"));
+  indices.emplace_back(STORAGE_MODE_READ | STORAGE_MODE_WRITE | STORAGE_MODE_BULK_LOAD,
+                       SqliteDatabaseIndex("file_path_index", "file(path)"));
+  // used by the file_content_block_cleanup trigger when files are removed
+  indices.emplace_back(STORAGE_MODE_WRITE | STORAGE_MODE_CLEAR,
+                       SqliteDatabaseIndex("file_content_hash_index", "file(content_hash)"));
   indices.emplace_back(
-      STORAGE_MODE_CLEAR, SqliteDatabaseIndex("occurrence_source_location_foreign_key_index", "occurrence(source_location_id)"));
+      STORAGE_MODE_WRITE | STORAGE_MODE_BULK_LOAD, SqliteDatabaseIndex("error_all_data_index", "error(message, fatal)"));
+
+  // replaced by the indices above, listed without a mode so that setMode drops them from older databases
+  for(const char* retiredIndex : {"edge_source_node_id_index",
+                                  "edge_target_node_id_index",
+                                  "source_location_file_node_id_index",
+                                  "occurrence_element_id_index",
+                                  "edge_source_foreign_key_index",
+                                  "edge_target_foreign_key_index",
+                                  "source_location_foreign_key_index",
+                                  "occurrence_element_foreign_key_index",
+                                  "occurrence_source_location_foreign_key_index"}) {
+    indices.emplace_back(0, SqliteDatabaseIndex(retiredIndex, ""));
+  }
 
   return indices;
 }
 
+void SqliteIndexStorage::beginBulkLoad() {
+  if(m_bulkLoading) {
+    return;
+  }
+
+  // nothing reads from the database while it is filled, so skip checks and durability and trust the in memory indices
+  executeStatement("PRAGMA foreign_keys=OFF;");
+  executeStatement("PRAGMA synchronous=OFF;");
+  executeStatement("PRAGMA journal_mode=MEMORY;");
+  executeStatement("PRAGMA temp_store=MEMORY;");
+  executeStatement("PRAGMA cache_size=-262144;");    // 256 MB
+
+  m_lastElementId = static_cast<Id>(executeStatementScalar("SELECT MAX(id) FROM element;", 0));
+  m_lastSourceLocationId = static_cast<Id>(executeStatementScalar("SELECT MAX(rowid) FROM source_location;", 0));
+  m_bulkLoading = true;
+}
+
+void SqliteIndexStorage::endBulkLoad() {
+  if(!m_bulkLoading) {
+    return;
+  }
+
+  flushPendingElements();
+  m_bulkLoading = false;
+
+  executeStatement("PRAGMA cache_size=-2000;");
+  executeStatement("PRAGMA temp_store=DEFAULT;");
+  executeStatement("PRAGMA foreign_keys=ON;");
+}
+
+Id SqliteIndexStorage::insertElement() {
+  if(m_bulkLoading) {
+    m_pendingElementIds.push_back(++m_lastElementId);
+    return m_lastElementId;
+  }
+
+  executeStatement(m_insertElementStmt);
+  return static_cast<Id>(m_database.lastRowId());
+}
+
+void SqliteIndexStorage::flushPendingElements() {
+  if(!m_pendingElementIds.empty()) {
+    m_insertElementBatchStatement.execute(m_pendingElementIds, this);
+    m_pendingElementIds.clear();
+  }
+}
+
 void SqliteIndexStorage::clearTables() {
   try {
     m_database.execDML("DROP TABLE IF EXISTS main.error;");
@@ -959,6 +1389,10 @@ void SqliteIndexStorage::clearTables() {
     m_database.execDML("DROP TABLE IF EXISTS main.occurrence;");
     m_database.execDML("DROP TABLE IF EXISTS main.source_location;");
     m_database.execDML("DROP TABLE IF EXISTS main.local_symbol;");
+    m_database.execDML("DROP TABLE IF EXISTS main.fulltext_search_trigrams;");
+    m_database.execDML("DROP TABLE IF EXISTS main.indexing_cost;");
+    m_database.execDML("DROP TABLE IF EXISTS main.file_content_block;");
+    // replaced by file_content_block in storage version 28
     m_database.execDML("DROP TABLE IF EXISTS main.filecontent;");
     m_database.execDML("DROP TABLE IF EXISTS main.file;");
     m_database.execDML("DROP TABLE IF EXISTS main.symbol;");
@@ -967,6 +1401,7 @@ void SqliteIndexStorage::clearTables() {
     m_database.execDML("DROP TABLE IF EXISTS main.element_component;");
     m_database.execDML("DROP TABLE IF EXISTS main.element;");
     m_database.execDML("DROP TABLE IF EXISTS main.meta;");
+    dropNodeChangeTracking();
   } catch(CppSQLite3Exception& e) {
     LOG_ERROR(std::to_string(e.errorCode()) + ": " + e.errorMessage());
   }
@@ -1024,17 +1459,39 @@ void SqliteIndexStorage::setupTables() {
         "indexed INTEGER, "
         "complete INTEGER, "
         "line_count INTEGER, "
+        "content_hash TEXT, "
         "PRIMARY KEY(id), "
         "FOREIGN KEY(id) REFERENCES node(id) ON DELETE CASCADE);");
 
+    // file content in compressed blocks of whole lines, shared by all files with the same content_hash
     m_database.execDML(
-        "CREATE TABLE IF NOT EXISTS filecontent("
-        "id INTEGER, "
-        "content TEXT, "
+        "CREATE TABLE IF NOT EXISTS file_content_block("
+        "content_hash TEXT NOT NULL, "
+        "first_line INTEGER NOT NULL, "
+        "line_count INTEGER NOT NULL, "
+        "size INTEGER NOT NULL, "
+        "data BLOB, "
+        "PRIMARY KEY(content_hash, first_line));");
+
+    m_database.execDML(
+        "CREATE TRIGGER IF NOT EXISTS file_content_block_cleanup AFTER DELETE ON file "
+        "WHEN old.content_hash IS NOT NULL AND NOT EXISTS(SELECT 1 FROM file WHERE content_hash = old.content_hash) "
+        "BEGIN DELETE FROM file_content_block WHERE content_hash = old.content_hash; END;");
+
+    m_database.execDML(
+        "CREATE TABLE IF NOT EXISTS fulltext_search_trigrams("
+        "id INTEGER NOT NULL, "
+        "codec TEXT, "
+        "trigrams BLOB, "
         "PRIMARY KEY(id), "
-        "FOREIGN KEY(id) REFERENCES file(id)"
-        "ON DELETE CASCADE "
-        "ON UPDATE CASCADE);");
+        "FOREIGN KEY(id) REFERENCES file(id) ON DELETE CASCADE);");
+
+    m_database.execDML(
+        "CREATE TABLE IF NOT EXISTS indexing_cost("
+        "path TEXT NOT NULL, "
+        "duration_ms INTEGER, "
+        "storage_size INTEGER, "
+        "PRIMARY KEY(path));");
 
     m_database.execDML(
         "CREATE TABLE IF NOT EXISTS local_symbol("
@@ -1088,6 +1545,12 @@ void SqliteIndexStorage::setupTables() {
 
 void SqliteIndexStorage::setupPrecompiledStatements() {
   try {
+    m_insertElementBatchStatement.compile(
+        "INSERT INTO element(id) VALUES",
+        1,
+        [](CppSQLite3Statement& stmt, const Id& elementId, size_t index) { stmt.bind(int(index) + 1, int(elementId)); },
+        m_maxVariableCount,
+        m_database);
     m_insertNodeBatchStatement.compile(
         "INSERT INTO node(id, type, serialized_name) VALUES",
         3,
@@ -1096,6 +1559,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 3 + 2, int(node.type));
           stmt.bind(int(index) * 3 + 3, utility::encodeToUtf8(node.serializedName).c_str());
         },
+        m_maxVariableCount,
         m_database);
     m_insertEdgeBatchStatement.compile(
         "INSERT INTO edge(id, type, source_node_id, target_node_id) VALUES",
@@ -1106,6 +1570,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 4 + 3, int(edge.sourceNodeId));
           stmt.bind(int(index) * 4 + 4, int(edge.targetNodeId));
         },
+        m_maxVariableCount,
         m_database);
     m_insertSymbolBatchStatement.compile(
         "INSERT OR IGNORE INTO symbol(id, definition_kind) VALUES",
@@ -1114,6 +1579,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 2 + 1, int(symbol.id));
           stmt.bind(int(index) * 2 + 2, int(symbol.definitionKind));
         },
+        m_maxVariableCount,
         m_database);
     m_insertLocalSymbolBatchStatement.compile(
         "INSERT INTO local_symbol(id, name) VALUES",
@@ -1122,6 +1588,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 2 + 1, int(symbol.id));
           stmt.bind(int(index) * 2 + 2, utility::encodeToUtf8(symbol.name).c_str());
         },
+        m_maxVariableCount,
         m_database);
     m_insertSourceLocationBatchStatement.compile(
         "INSERT INTO source_location(file_node_id, start_line, start_column, end_line, "
@@ -1135,6 +1602,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 6 + 5, int(location.endCol));
           stmt.bind(int(index) * 6 + 6, int(location.type));
         },
+        m_maxVariableCount,
         m_database);
     m_insertOccurrenceBatchStatement.compile(
         "INSERT OR IGNORE INTO occurrence(element_id, source_location_id) VALUES",
@@ -1143,6 +1611,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 2 + 1, int(occurrence.elementId));
           stmt.bind(int(index) * 2 + 2, int(occurrence.sourceLocationId));
         },
+        m_maxVariableCount,
         m_database);
     m_insertComponentAccessBatchStatement.compile(
         "INSERT OR IGNORE INTO component_access(node_id, type) VALUES",
@@ -1151,6 +1620,7 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
           stmt.bind(int(index) * 2 + 1, int(componentAccess.nodeId));
           stmt.bind(int(index) * 2 + 2, int(componentAccess.type));
         },
+        m_maxVariableCount,
         m_database);
 
     m_insertElementStmt = m_database.compileStatement("INSERT INTO element(id) VALUES(NULL);");
@@ -1158,8 +1628,13 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
         "INSERT INTO element_component(id, element_id, type, data) VALUES(NULL, ?, ?, ?);");
     m_insertFileStmt = m_database.compileStatement(
         "INSERT INTO file(id, path, language, modification_time, indexed, complete, "
-        "line_count) VALUES(?, ?, ?, ?, ?, ?, ?);");
-    m_insertFileContentStmt = m_database.compileStatement("INSERT INTO filecontent(id, content) VALUES(?, ?);");
+        "line_count, content_hash) VALUES(?, ?, ?, ?, ?, ?, ?, ?);");
+    m_insertFileContentBlockStmt = m_database.compileStatement(
+        "INSERT INTO file_content_block(content_hash, first_line, line_count, size, data) VALUES(?, ?, ?, ?, ?);");
+    m_insertFullTextSearchTrigramsStmt = m_database.compileStatement(
+        "INSERT OR REPLACE INTO fulltext_search_trigrams(id, codec, trigrams) VALUES(?, ?, ?);");
+    m_insertIndexingCostStmt = m_database.compileStatement(
+        "INSERT OR REPLACE INTO indexing_cost(path, duration_ms, storage_size) VALUES(?, ?, ?);");
     m_checkErrorExistsStmt = m_database.compileStatement(
         "SELECT id FROM error WHERE "
         "message = ? AND "
@@ -1177,199 +1652,228 @@ void SqliteIndexStorage::setupPrecompiledStatements() {
   }
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageEdge>(const std::string& query, const std::function<void(StorageEdge&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT id, type, source_node_id, target_node_id FROM edge {};", query));
-
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const int type = queryResult.getIntField(1, -1);
-    const Id sourceId = static_cast<Id>(queryResult.getIntField(2, 0));
-    const Id targetId = static_cast<Id>(queryResult.getIntField(3, 0));
-
-    if(0 != elementId && -1 != type) {
-      func(StorageEdge(elementId, type, sourceId, targetId));
-    }
+SqliteIndexStorage::IdList::IdList(const SqliteIndexStorage& storage, const std::vector<Id>& ids)
+    : m_storage(storage), m_use(&storage), m_level(storage.m_idListLevel) {
+  if(m_level == m_storage.m_idListInsertStatements.size()) {
+    m_storage.executeStatement(
+        fmt::format("CREATE TEMP TABLE IF NOT EXISTS id_list_{}(id INTEGER NOT NULL, PRIMARY KEY(id)) WITHOUT ROWID;", m_level));
+
+    auto insertStatement = std::make_unique<InsertBatchStatement<Id>>();
+    insertStatement->compile(
+        fmt::format("INSERT OR IGNORE INTO temp.id_list_{}(id) VALUES", m_level),
+        1,
+        [](CppSQLite3Statement& stmt, const Id& elementId, size_t index) { stmt.bind(int(index) + 1, int(elementId)); },
+        m_storage.m_maxVariableCount,
+        m_storage.m_database);
+    m_storage.m_idListInsertStatements.push_back(std::move(insertStatement));
+  }
 
-    queryResult.nextRow();
+  try {
+    m_storage.m_idListInsertStatements[m_level]->execute(ids, &m_storage);
+  } catch(...) {
+    // the destructor doesn't run, so neither the rows inserted so far nor the level may outlive the failed fill
+    m_storage.executeCachedStatement(fmt::format("DELETE FROM temp.id_list_{};", m_level));
+    throw;
   }
+  m_storage.m_idListLevel++;
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageNode>(const std::string& query, const std::function<void(StorageNode&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT id, type, serialized_name FROM node {};", query));
-
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const int type = queryResult.getIntField(1, -1);
-    const std::string serializedName = queryResult.getStringField(2, "");
+SqliteIndexStorage::IdList::~IdList() {
+  m_storage.executeCachedStatement(fmt::format("DELETE FROM temp.id_list_{};", m_level));
+  m_storage.m_idListLevel--;
+}
 
-    if(0 != elementId && -1 != type) {
-      func(StorageNode(elementId, type, utility::decodeFromUtf8(serializedName)));
-    }
+std::string SqliteIndexStorage::IdList::getSelect() const {
+  return fmt::format("(SELECT id FROM temp.id_list_{})", m_level);
+}
 
-    queryResult.nextRow();
-  }
+namespace {
+// the columns of each cursor row, decodeRow reads them in this order
+const char* getSelect(std::type_identity<StorageEdge> /*row*/) {
+  return "SELECT id, type, source_node_id, target_node_id FROM edge";
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageSymbol>(const std::string& query, const std::function<void(StorageSymbol&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT id, definition_kind FROM symbol {};", query));
+const char* getSelect(std::type_identity<StorageNodeView> /*row*/) {
+  return "SELECT id, type, serialized_name FROM node";
+}
 
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const int definitionKind = queryResult.getIntField(1, 0);
+const char* getSelect(std::type_identity<StorageSymbol> /*row*/) {
+  return "SELECT id, definition_kind FROM symbol";
+}
 
-    if(0 != elementId) {
-      func(StorageSymbol(elementId, definitionKind));
-    }
+const char* getSelect(std::type_identity<StorageFileView> /*row*/) {
+  return "SELECT id, path, language, modification_time, indexed, complete FROM file";
+}
 
-    queryResult.nextRow();
-  }
+const char* getSelect(std::type_identity<StorageLocalSymbolView> /*row*/) {
+  return "SELECT id, name FROM local_symbol";
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageFile>(const std::string& query, const std::function<void(StorageFile&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(
-      fmt::format("SELECT id, path, language, modification_time, indexed, complete FROM file {};", query));
+const char* getSelect(std::type_identity<StorageSourceLocation> /*row*/) {
+  return "SELECT id, file_node_id, start_line, start_column, end_line, end_column, type FROM source_location";
+}
 
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const std::string filePath = queryResult.getStringField(1, "");
-    const std::string languageIdentifier = queryResult.getStringField(2, "");
-    const std::string modificationTime = queryResult.getStringField(3, "");
-    const bool indexed = queryResult.getIntField(4, 0) != 0;
-    const bool complete = queryResult.getIntField(5, 0) != 0;
+const char* getSelect(std::type_identity<StorageOccurrence> /*row*/) {
+  return "SELECT element_id, source_location_id FROM occurrence";
+}
 
-    if(0 != elementId) {
-      func(StorageFile(elementId,
-                       utility::decodeFromUtf8(filePath),
-                       utility::decodeFromUtf8(languageIdentifier),
-                       modificationTime,
-                       indexed,
-                       complete));
-    }
-    queryResult.nextRow();
-  }
+const char* getSelect(std::type_identity<StorageComponentAccess> /*row*/) {
+  return "SELECT node_id, type FROM component_access";
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageLocalSymbol>(const std::string& query,
-                                                     const std::function<void(StorageLocalSymbol&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT id, name FROM local_symbol {};", query));
+const char* getSelect(std::type_identity<StorageElementComponentView> /*row*/) {
+  return "SELECT element_id, type, data FROM element_component";
+}
 
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const std::string name = queryResult.getStringField(1, "");
+const char* getSelect(std::type_identity<StorageErrorView> /*row*/) {
+  return "SELECT id, message, fatal, indexed, translation_unit FROM error";
+}
 
-    if(0 != elementId) {
-      func(StorageLocalSymbol(elementId, utility::decodeFromUtf8(name)));
-    }
+// the text stays owned by the query until it moves to the next row
+std::string_view getTextField(CppSQLite3Query& query, int field) {
+  return query.getStringField(field, "");
+}
 
-    queryResult.nextRow();
-  }
-}
-
-template <>
-void SqliteIndexStorage::forEach<StorageSourceLocation>(const std::string& query,
-                                                        const std::function<void(StorageSourceLocation&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(
-      fmt::format("SELECT id, file_node_id, start_line, start_column, end_line, end_column, type FROM "
-                  "source_location {};",
-                  query));
-
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const Id fileNodeId = static_cast<Id>(queryResult.getIntField(1, 0));
-    const int startLineNumber = queryResult.getIntField(2, -1);
-    const int startColNumber = queryResult.getIntField(3, -1);
-    const int endLineNumber = queryResult.getIntField(4, -1);
-    const int endColNumber = queryResult.getIntField(5, -1);
-    const int type = queryResult.getIntField(6, -1);
-
-    if(elementId != 0 && fileNodeId != 0 && startLineNumber != -1 && startColNumber != -1 && endLineNumber != -1 &&
-       endColNumber != -1 && type != -1) {
-      func(StorageSourceLocation(elementId,
-                                 fileNodeId,
-                                 static_cast<size_t>(startLineNumber),
-                                 static_cast<size_t>(startColNumber),
-                                 static_cast<size_t>(endLineNumber),
-                                 static_cast<size_t>(endColNumber),
-                                 type));
-    }
+bool decodeRow(CppSQLite3Query& query, StorageEdge& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.type = query.getIntField(1, -1);
+  row.sourceNodeId = static_cast<Id>(query.getIntField(2, 0));
+  row.targetNodeId = static_cast<Id>(query.getIntField(3, 0));
+  return 0 != row.id && -1 != row.type;
+}
 
-    queryResult.nextRow();
-  }
+bool decodeRow(CppSQLite3Query& query, StorageNodeView& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.type = query.getIntField(1, -1);
+  row.serializedName = getTextField(query, 2);
+  return 0 != row.id && -1 != row.type;
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageOccurrence>(const std::string& query,
-                                                    const std::function<void(StorageOccurrence&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT element_id, source_location_id FROM occurrence {};", query));
+bool decodeRow(CppSQLite3Query& query, StorageSymbol& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.definitionKind = query.getIntField(1, 0);
+  return 0 != row.id;
+}
 
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const Id sourceLocationId = static_cast<Id>(queryResult.getIntField(1, 0));
+bool decodeRow(CppSQLite3Query& query, StorageFileView& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.filePath = getTextField(query, 1);
+  row.languageIdentifier = getTextField(query, 2);
+  row.modificationTime = getTextField(query, 3);
+  row.indexed = query.getIntField(4, 0) != 0;
+  row.complete = query.getIntField(5, 0) != 0;
+  return 0 != row.id;
+}
 
-    if(0 != elementId && 0 != sourceLocationId) {
-      func(StorageOccurrence(elementId, sourceLocationId));
-    }
+bool decodeRow(CppSQLite3Query& query, StorageLocalSymbolView& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.name = getTextField(query, 1);
+  return 0 != row.id;
+}
 
-    queryResult.nextRow();
+bool decodeRow(CppSQLite3Query& query, StorageSourceLocation& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.fileNodeId = static_cast<Id>(query.getIntField(1, 0));
+  const int startLine = query.getIntField(2, -1);
+  const int startCol = query.getIntField(3, -1);
+  const int endLine = query.getIntField(4, -1);
+  const int endCol = query.getIntField(5, -1);
+  row.type = query.getIntField(6, -1);
+  if(0 == row.id || 0 == row.fileNodeId || -1 == startLine || -1 == startCol || -1 == endLine || -1 == endCol ||
+     -1 == row.type) {
+    return false;
   }
-}
 
-template <>
-void SqliteIndexStorage::forEach<StorageComponentAccess>(const std::string& query,
-                                                         const std::function<void(StorageComponentAccess&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT node_id, type FROM component_access {};", query));
+  row.startLine = static_cast<size_t>(startLine);
+  row.startCol = static_cast<size_t>(startCol);
+  row.endLine = static_cast<size_t>(endLine);
+  row.endCol = static_cast<size_t>(endCol);
+  return true;
+}
 
-  while(!queryResult.eof()) {
-    const Id nodeId = static_cast<Id>(queryResult.getIntField(0, 0));
-    const int type = queryResult.getIntField(1, -1);
+bool decodeRow(CppSQLite3Query& query, StorageOccurrence& row) {
+  row.elementId = static_cast<Id>(query.getIntField(0, 0));
+  row.sourceLocationId = static_cast<Id>(query.getIntField(1, 0));
+  return 0 != row.elementId && 0 != row.sourceLocationId;
+}
 
-    if(0 != nodeId && -1 != type) {
-      func(StorageComponentAccess(nodeId, type));
-    }
+bool decodeRow(CppSQLite3Query& query, StorageComponentAccess& row) {
+  row.nodeId = static_cast<Id>(query.getIntField(0, 0));
+  row.type = query.getIntField(1, -1);
+  return 0 != row.nodeId && -1 != row.type;
+}
 
-    queryResult.nextRow();
-  }
+bool decodeRow(CppSQLite3Query& query, StorageElementComponentView& row) {
+  row.elementId = static_cast<Id>(query.getIntField(0, 0));
+  row.type = query.getIntField(1, -1);
+  row.data = getTextField(query, 2);
+  return 0 != row.elementId && -1 != row.type;
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageElementComponent>(const std::string& query,
-                                                          const std::function<void(StorageElementComponent&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(fmt::format("SELECT element_id, type, data FROM element_component {};", query));
+bool decodeRow(CppSQLite3Query& query, StorageErrorView& row) {
+  row.id = static_cast<Id>(query.getIntField(0, 0));
+  row.message = getTextField(query, 1);
+  row.fatal = query.getIntField(2, 0) != 0;
+  row.indexed = query.getIntField(3, 0) != 0;
+  row.translationUnit = getTextField(query, 4);
+  return 0 != row.id;
+}
+}    // namespace
 
-  while(!queryResult.eof()) {
-    const Id elementId = static_cast<uint32_t>(queryResult.getIntField(0, 0));
-    const int type = queryResult.getIntField(1, -1);
-    const std::string data = queryResult.getStringField(2, "");
+template <typename Row>
+SqliteIndexStorage::Cursor<Row>::Cursor(const SqliteIndexStorage& storage,
+                                        const std::string& query,
+                                        const std::vector<Parameter>& parameters)
+    : m_statement(storage.getCachedStatement(fmt::format("{} {};", getSelect(std::type_identity<Row>()), query), parameters))
+    , m_query(storage.executeQuery(m_statement.get())) {}
+
+template <typename Row>
+bool SqliteIndexStorage::Cursor<Row>::next() {
+  if(m_started) {
+    m_query.nextRow();
+  }
+  m_started = true;
 
-    if(elementId != 0 && type != -1) {
-      func(StorageElementComponent(elementId, type, utility::decodeFromUtf8(data)));
+  for(; !m_query.eof(); m_query.nextRow()) {
+    if(decodeRow(m_query, m_row)) {
+      return true;
     }
-
-    queryResult.nextRow();
   }
+  return false;
 }
 
-template <>
-void SqliteIndexStorage::forEach<StorageError>(const std::string& query, const std::function<void(StorageError&&)>& func) const {
-  CppSQLite3Query queryResult = executeQuery(
-      fmt::format("SELECT id, message, fatal, indexed, translation_unit FROM error {};", query));
+template class SqliteIndexStorage::Cursor<StorageEdge>;
+template class SqliteIndexStorage::Cursor<StorageNodeView>;
+template class SqliteIndexStorage::Cursor<StorageSymbol>;
+template class SqliteIndexStorage::Cursor<StorageFileView>;
+template class SqliteIndexStorage::Cursor<StorageLocalSymbolView>;
+template class SqliteIndexStorage::Cursor<StorageSourceLocation>;
+template class SqliteIndexStorage::Cursor<StorageOccurrence>;
+template class SqliteIndexStorage::Cursor<StorageComponentAccess>;
+template class SqliteIndexStorage::Cursor<StorageElementComponentView>;
+template class SqliteIndexStorage::Cursor<StorageErrorView>;
 
-  while(!queryResult.eof()) {
-    const Id errorId = static_cast<uint32_t>(queryResult.getIntField(0, 0));
-    const std::string message = queryResult.getStringField(1, "");
-    const bool fatal = queryResult.getIntField(2, 0) != 0;
-    const bool indexed = queryResult.getIntField(3, 0) != 0;
-    const std::string translationUnit = queryResult.getStringField(4, "");
+StorageNode SqliteIndexStorage::toStorageType(const StorageNodeView& row) {
+  return {row.id, row.type, utility::decodeFromUtf8(std::string(row.serializedName))};
+}
 
-    if(0 != errorId) {
-      func(StorageError(errorId, utility::decodeFromUtf8(message), utility::decodeFromUtf8(translationUnit), fatal, indexed));
-    }
+StorageFile SqliteIndexStorage::toStorageType(const StorageFileView& row) {
+  return {row.id,
+          utility::decodeFromUtf8(std::string(row.filePath)),
+          utility::decodeFromUtf8(std::string(row.languageIdentifier)),
+          std::string(row.modificationTime),
+          row.indexed,
+          row.complete};
+}
 
-    queryResult.nextRow();
-  }
+StorageLocalSymbol SqliteIndexStorage::toStorageType(const StorageLocalSymbolView& row) {
+  return {row.id, utility::decodeFromUtf8(std::string(row.name))};
+}
+
+StorageElementComponent SqliteIndexStorage::toStorageType(const StorageElementComponentView& row) {
+  return {row.elementId, row.type, utility::decodeFromUtf8(std::string(row.data))};
+}
+
+StorageError SqliteIndexStorage::toStorageType(const StorageErrorView& row) {
+  return {row.id, utility::decodeFromUtf8(std::string(row.message)), utility::decodeFromUtf8(std::string(row.translationUnit)), row.fatal, row.indexed};
 }
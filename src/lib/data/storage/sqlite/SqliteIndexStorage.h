@@ -23,14 +23,21 @@
  * for the source code indexing system.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "ErrorInfo.h"
 #include "GlobalId.hpp"
 #include "LocationType.h"
-#include "LowMemoryStringMap.h"
+#include "NameTable.h"
 #include "SqliteDatabaseIndex.h"
 #include "SqliteStorage.h"
 #include "StorageComponentAccess.h"
@@ -38,6 +45,7 @@
 #include "StorageElementComponent.h"
 #include "StorageError.h"
 #include "StorageFile.h"
+#include "StorageIndexingCost.h"
 #include "StorageLocalSymbol.h"
 #include "StorageNode.h"
 #include "StorageOccurrence.h"
@@ -51,6 +59,14 @@ class Version;
 class SourceLocationCollection;
 class SourceLocationFile;
 
+/**
+ * @brief Cursor rows whose strings borrow the text of the current row
+ */
+template <typename Row>
+concept StorageRowView = std::is_same_v<Row, StorageNodeView> || std::is_same_v<Row, StorageFileView> ||
+    std::is_same_v<Row, StorageLocalSymbolView> || std::is_same_v<Row, StorageElementComponentView> ||
+    std::is_same_v<Row, StorageErrorView>;
+
 /**
  * @class SqliteIndexStorage
  * @brief SQLite-based storage implementation for managing indexed source code elements
@@ -69,6 +85,8 @@ class SourceLocationFile;
  * - STORAGE_MODE_READ: Read-only access to the database
  * - STORAGE_MODE_WRITE: Read-write access to the database
  * - STORAGE_MODE_CLEAR: Allows clearing of database contents
+ * - STORAGE_MODE_BULK_LOAD: Write-only filling of a fresh database; ids are allocated in memory, foreign key checks
+ *   and read indices are off and durability pragmas are relaxed until another mode is set
  *
  * @note This class is marked as final and inherits from SqliteStorage
  *
@@ -96,7 +114,7 @@ public:
   /**
    * @brief Storage modes for the storage
    */
-  enum StorageModeType { STORAGE_MODE_READ = 1, STORAGE_MODE_WRITE = 2, STORAGE_MODE_CLEAR = 4 };
+  enum StorageModeType { STORAGE_MODE_READ = 1, STORAGE_MODE_WRITE = 2, STORAGE_MODE_CLEAR = 4, STORAGE_MODE_BULK_LOAD = 8 };
 
   /**
    * @brief Default constructor that initializes an in-memory SQLite database
@@ -106,8 +124,9 @@ public:
   /**
    * @brief Constructor that initializes a SQLite database at the specified file path
    * @param dbFilePath Path to the SQLite database file
+   * @param openMode ReadOnly for additional connections that only query an existing database, these skip setup()
    */
-  explicit SqliteIndexStorage(const FilePath& dbFilePath);
+  explicit SqliteIndexStorage(const FilePath& dbFilePath, OpenMode openMode = OpenMode::ReadWrite);
 
   /**
    * @brief Returns the static version of the storage
@@ -133,6 +152,32 @@ public:
    */
   void setProjectSettingsText(const std::string& text);
 
+  /**
+   * @brief Returns the token of the graph snapshot that matches the current content
+   * @return The token or 0 if no snapshot matches
+   */
+  uint64_t getGraphSnapshotToken() const;
+
+  /**
+   * @brief Ties a graph snapshot to the current content, 0 marks every snapshot as outdated
+   * @param token The token written into the snapshot
+   */
+  void setGraphSnapshotToken(uint64_t token);
+
+  /**
+   * @brief Starts recording the ids of nodes that are added, removed, change their type or their symbol definition
+   *
+   * The ids are written to a table of the database by triggers of this connection, so they survive until another
+   * storage of the same file reads them with takeChangedNodeIds(). Calling it again starts a new, empty record.
+   */
+  void trackNodeChanges();
+
+  /**
+   * @brief Returns the ids recorded since trackNodeChanges() and ends the record
+   * @return The ids or std::nullopt if nothing was recorded for this database
+   */
+  std::optional<std::vector<Id>> takeChangedNodeIds();
+
   /**
    * @brief Adds a node to the storage
    * @param data The data to add
@@ -164,11 +209,34 @@ public:
   /**
    * @brief Adds multiple symbols to the storage
    * @brief Adds a file to the storage
+   *
+   * An indexed file without captured content is stored without content, see setFileContent and
+   * addMissingFileContentsFromDisk.
+   *
    * @param data The data to add
    * @return True if the file was added successfully, false otherwise
    */
   bool addFile(const StorageFile& data);
 
+  /**
+   * @brief Returns whether the content of the file is stored
+   */
+  bool hasFileContent(Id fileId) const;
+
+  /**
+   * @brief Stores the content of a file that was added without it
+   * @param fileId The ID of the file
+   * @param content The text of the file with normalized line breaks
+   * @return True if the content was stored successfully, false otherwise
+   */
+  bool setFileContent(Id fileId, std::string_view content);
+
+  /**
+   * @brief Reads the content of all indexed files that are still stored without it from disk
+   * @return The number of files read
+   */
+  size_t addMissingFileContentsFromDisk();
+
   /**
    * @brief Adds an edge to the storage
    * @param data The data to add
@@ -465,6 +533,61 @@ public:
    */
   std::shared_ptr<TextAccess> getFileContentById(Id fileId) const;
 
+  /**
+   * @brief Returns some lines of a file's stored content
+   *
+   * Only the content blocks covering the lines are decompressed.
+   *
+   * @param filePath The path of the file
+   * @param firstLine The first line to return, starting at 1
+   * @param lastLine The last line to return
+   * @return The lines including their line breaks, empty if the content isn't stored or the lines are out of range
+   */
+  std::vector<std::string> getFileLinesByPath(const std::wstring& filePath, uint32_t firstLine, uint32_t lastLine) const;
+
+  /**
+   * @brief Returns the content hashes of all files whose content is stored
+   * @return File paths with the TextAccess::getContentHash of their content at indexing time
+   */
+  std::vector<std::pair<std::wstring, uint64_t>> getFileContentHashes() const;
+
+  /**
+   * @brief Stores the encoded fulltext search trigrams of files in one transaction
+   *
+   * The trigrams are a cache of the file content and are removed together with their file.
+   * @param fileTrigrams File IDs with trigrams as encoded by FullTextSearchIndex::encodeTrigrams
+   * @param codecName The text codec the file contents were decoded with
+   */
+  void addFullTextSearchTrigrams(const std::vector<std::pair<Id, std::string>>& fileTrigrams, const std::string& codecName);
+
+  /**
+   * @brief Returns the indexed files that have no fulltext search trigrams stored for a text codec
+   * @param codecName The text codec
+   * @return The file IDs
+   */
+  std::vector<Id> getIndexedFileIdsWithoutFullTextSearchTrigrams(const std::string& codecName) const;
+
+  /**
+   * @brief Iterates over the stored fulltext search trigrams that were computed with a text codec
+   * @param codecName The text codec
+   * @param func The function called with the file ID and the encoded trigrams
+   */
+  void forEachFullTextSearchTrigrams(const std::string& codecName, const std::function<void(Id, std::string_view)>& func) const;
+
+  /**
+   * @brief Stores how long translation units took to index in one transaction, replacing earlier records of the same path
+   *
+   * The records are keyed by path so they outlive the file entries that are removed before a file is indexed again.
+   * @param costs The indexing costs of the translation units
+   */
+  void setIndexingCosts(const std::vector<StorageIndexingCost>& costs);
+
+  /**
+   * @brief Returns the recorded indexing costs of all translation units
+   * @return The indexing costs
+   */
+  std::vector<StorageIndexingCost> getIndexingCosts() const;
+
   /**
    * @brief Sets the indexed status of a file
    * @param fileId The ID of the file to set
@@ -490,10 +613,13 @@ public:
   /**
    * @brief Returns the source locations for a file
    * @param filePath The path of the file to return
-   * @param query The query to return
+   * @param query Additional conditions for the source locations
+   * @param parameters The values bound to the `?` parameters of the query
    * @return The source locations
    */
-  std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(const FilePath& filePath, const std::string& query = "") const;
+  std::shared_ptr<SourceLocationFile> getSourceLocationsForFile(const FilePath& filePath,
+                                                                const std::string& query = "",
+                                                                const std::vector<Parameter>& parameters = {}) const;
 
   /**
    * @brief Returns the source locations for lines in a file
@@ -575,7 +701,7 @@ public:
    */
   template <typename ResultType>
   std::vector<ResultType> getAll() const {
-    return doGetAll<ResultType>("");
+    return doGetAll<ResultType>("", {});
   }
 
   /**
@@ -586,7 +712,7 @@ public:
   template <typename ResultType>
   ResultType getFirstById(const Id elementId) const {
     if(0 != elementId) {
-      return doGetFirst<ResultType>("WHERE id == " + std::to_string(elementId));
+      return doGetFirst<ResultType>("WHERE id == ?", {elementId});
     }
     return ResultType();
   }
@@ -599,7 +725,8 @@ public:
   template <typename ResultType>
   std::vector<ResultType> getAllByIds(const std::vector<Id>& ids) const {
     if(!ids.empty()) {
-      return doGetAll<ResultType>("WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")");
+      const IdList idList(*this, ids);
+      return doGetAll<ResultType>("WHERE id IN " + idList.getSelect(), {});
     }
     return std::vector<ResultType>();
   }
@@ -610,7 +737,7 @@ public:
    */
   template <typename StorageType>
   void forEach(const std::function<void(StorageType&&)>& func) const {
-    forEach("", func);
+    forEach<StorageType>("", {}, func);
   }
 
   /**
@@ -620,7 +747,7 @@ public:
    */
   template <typename StorageType>
   void forEachOfType(int type, const std::function<void(StorageType&&)>& func) const {
-    forEach("WHERE type == " + std::to_string(type), func);
+    forEach<StorageType>("WHERE type == ?", {type}, func);
   }
 
   /**
@@ -631,10 +758,85 @@ public:
   template <typename StorageType>
   void forEachByIds(const std::vector<Id>& ids, const std::function<void(StorageType&&)>& func) const {
     if(!ids.empty()) {
-      forEach("WHERE id IN (" + utility::join(utility::toStrings(ids), ',') + ")", func);
+      const IdList idList(*this, ids);
+      forEach<StorageType>("WHERE id IN " + idList.getSelect(), {}, func);
     }
   }
 
+  /**
+   * @brief Forward-only cursor that decodes each row of a table scan in place
+   *
+   * Row is StorageEdge, StorageSymbol, StorageSourceLocation, StorageOccurrence, StorageComponentAccess or one of the
+   * Storage*View types. The strings of a view borrow the UTF-8 text of the current row and are only valid until the next
+   * call of next(). The cursor holds a statement of the storage and must not outlive it.
+   *
+   * @code
+   * auto cursor = storage.getCursor<StorageNodeView>();
+   * while(cursor.next()) {
+   *   use(cursor.get().serializedName);
+   * }
+   * @endcode
+   */
+  template <typename Row>
+  class Cursor final {
+  public:
+    Cursor(const Cursor&) = delete;
+    Cursor(Cursor&&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+    Cursor& operator=(Cursor&&) = delete;
+    ~Cursor() = default;
+
+    /**
+     * @brief Moves to the next valid row, false once there is none left
+     */
+    bool next();
+
+    [[nodiscard]] const Row& get() const {
+      return m_row;
+    }
+
+    /**
+     * @brief Replaces batch with up to maxSize of the following rows, false if there were none left
+     *
+     * Not available for the view rows, their strings would not stay valid after the cursor moved on.
+     */
+    bool nextBatch(std::vector<Row>& batch, size_t maxSize)
+      requires(!StorageRowView<Row>)
+    {
+      batch.clear();
+      while(batch.size() < maxSize && next()) {
+        batch.push_back(m_row);
+      }
+      return !batch.empty();
+    }
+
+  private:
+    friend class SqliteIndexStorage;
+
+    Cursor(const SqliteIndexStorage& storage, const std::string& query, const std::vector<Parameter>& parameters);
+
+    CachedStatement m_statement;
+    CppSQLite3Query m_query;
+    bool m_started = false;
+    Row m_row;
+  };
+
+  /**
+   * @brief Returns a cursor over all rows of the table of Row
+   */
+  template <typename Row>
+  Cursor<Row> getCursor() const {
+    return Cursor<Row>(*this, "", {});
+  }
+
+  /**
+   * @brief Returns a cursor over the rows of the table of Row with a specific type
+   */
+  template <typename Row>
+  Cursor<Row> getCursorOfType(int type) const {
+    return Cursor<Row>(*this, "WHERE type == ?", {type});
+  }
+
   /**
    * @brief Returns the number of nodes in the storage
    * @return The number of nodes
@@ -680,6 +882,11 @@ public:
 private:
   static const size_t sStorageVersion;
 
+  struct TempNode {
+    uint32_t id;
+    int type;
+  };
+
   struct TempSourceLocation {
     TempSourceLocation(uint32_t startLine_, uint16_t lineDiff_, uint16_t startCol_, uint16_t endCol_, uint8_t type_)
         : startLine(startLine_), lineDiff(lineDiff_), startCol(startCol_), endCol(endCol_), type(type_) {}
@@ -707,49 +914,140 @@ private:
 
   std::vector<std::pair<int, SqliteDatabaseIndex>> getIndices() const;
 
+  void beginBulkLoad();
+  void endBulkLoad();
+
+  void dropNodeChangeTracking();
+
+  /**
+   * @brief Stores text as compressed blocks of whole lines under its content hash
+   *
+   * Files with the same content share the blocks, so nothing is written if blocks for the hash exist already. The blocks
+   * are deleted by a trigger once no file has the hash anymore.
+   */
+  bool addFileContent(const std::string& contentHash, std::string_view text);
+
+  /**
+   * @brief Decompresses the content blocks selected by sql
+   * @param sql A query for first_line, size and data of content blocks ordered by first_line, taking the file, the first
+   * and the last line as parameters
+   * @param textFirstLine Set to the line number the returned text starts with
+   */
+  std::string readFileContent(const std::string& sql,
+                              const Parameter& file,
+                              uint32_t firstLine,
+                              uint32_t lastLine,
+                              uint32_t* textFirstLine = nullptr) const;
+
+  /**
+   * @brief Reserves a new element id
+   *
+   * Outside of bulk loading the element row is inserted right away. While bulk loading the id is taken from an in
+   * memory counter and the row is written by the next flushPendingElements() as part of a multi-row insert.
+   */
+  Id insertElement();
+  void flushPendingElements();
+
   void clearTables() override;
   void setupTables() override;
   void setupPrecompiledStatements() override;
 
+  /**
+   * @brief Ids written to a temporary table for the lifetime of the object
+   *
+   * Queries select the ids with getSelect() instead of inlining them, so the query text stays the same and the cached
+   * statement is reused, and long id lists don't run into SQLite's statement limits. Each nesting level of queries gets
+   * its own table.
+   */
+  class IdList {
+  public:
+    IdList(const SqliteIndexStorage& storage, const std::vector<Id>& ids);
+    IdList(const IdList&) = delete;
+    IdList& operator=(const IdList&) = delete;
+    ~IdList();
+
+    /**
+     * @brief The subquery "(SELECT id FROM temp.id_list_<level>)" for use after IN
+     */
+    [[nodiscard]] std::string getSelect() const;
+
+  private:
+    const SqliteIndexStorage& m_storage;
+    // the id list table of m_level belongs to this thread until the object is destroyed
+    UseScope m_use;
+    size_t m_level;
+  };
+
   template <typename ResultType>
-  std::vector<ResultType> doGetAll(const std::string& query) const {
+  std::vector<ResultType> doGetAll(const std::string& query, const std::vector<Parameter>& parameters) const {
     std::vector<ResultType> elements;
-    forEach<ResultType>(query, [&elements](ResultType&& element) { elements.emplace_back(element); });
+    forEach<ResultType>(query, parameters, [&elements](ResultType&& element) { elements.push_back(std::move(element)); });
     return elements;
   }
 
   template <typename ResultType>
-  ResultType doGetFirst(const std::string& query) const {
-    std::vector<ResultType> results = doGetAll<ResultType>(query + " LIMIT 1");
+  ResultType doGetFirst(const std::string& query, const std::vector<Parameter>& parameters) const {
+    std::vector<ResultType> results = doGetAll<ResultType>(query + " LIMIT 1", parameters);
     if(!results.empty()) {
       return results[0];
     }
     return ResultType();
   }
 
+  // the cursor row a storage type is decoded from, the strings of views are converted to std::wstring
   template <typename StorageType>
-  void forEach(const std::string& query, const std::function<void(StorageType&&)>& func) const;
+  struct CursorRow {
+    using Type = StorageType;
+  };
+
+  template <typename Row>
+  static const Row& toStorageType(const Row& row) {
+    return row;
+  }
+  static StorageNode toStorageType(const StorageNodeView& row);
+  static StorageFile toStorageType(const StorageFileView& row);
+  static StorageLocalSymbol toStorageType(const StorageLocalSymbolView& row);
+  static StorageElementComponent toStorageType(const StorageElementComponentView& row);
+  static StorageError toStorageType(const StorageErrorView& row);
+
+  /**
+   * @brief Runs "SELECT <columns> FROM <table> <query>" as a cached statement with the parameters bound
+   */
+  template <typename StorageType, typename Func>
+  void forEach(const std::string& query, const std::vector<Parameter>& parameters, Func&& func) const {
+    Cursor<typename CursorRow<StorageType>::Type> cursor(*this, query, parameters);
+    while(cursor.next()) {
+      func(StorageType(toStorageType(cursor.get())));
+    }
+  }
 
-  LowMemoryStringMap<std::string, uint32_t, 0> m_tempNodeNameIndex;
-  LowMemoryStringMap<std::wstring, uint32_t, 0> m_tempWNodeNameIndex;
-  std::map<uint32_t, int> m_tempNodeTypes;
+  // node id and type by the handle of the UTF-8 serialized name
+  NameTable m_tempNodeNames;
+  std::vector<TempNode> m_tempNodes;
   std::map<StorageEdgeData, uint32_t> m_tempEdgeIndex;
   std::map<std::wstring, std::map<std::wstring, uint32_t>> m_tempLocalSymbolIndex;
   std::map<uint32_t, std::map<TempSourceLocation, uint32_t>> m_tempSourceLocationIndices;
 
+  bool m_bulkLoading = false;
+  Id m_lastElementId = 0;
+  Id m_lastSourceLocationId = 0;
+  std::vector<Id> m_pendingElementIds;
+
   template <typename StorageType>
   class InsertBatchStatement {
   public:
     void compile(const std::string& header,
                  size_t valueCount,
                  std::function<void(CppSQLite3Statement& stmt, const StorageType&, size_t)> bindValuesFunc,
+                 size_t maxVariableCount,
                  CppSQLite3DB& database) {
       m_bindValuesFunc = std::move(bindValuesFunc);
 
       std::string valueStr = '(' + utility::join(std::vector<std::string>(valueCount, "?"), ',') + ')';
 
-      const size_t MAX_VARIABLE_COUNT = 999;
-      size_t batchSize = MAX_VARIABLE_COUNT / valueCount;
+      // capped at SQLite's default limit, builds that allow more (Debian's allows 250000) would compile huge statements
+      constexpr size_t MaxBatchVariableCount = 32766;
+      size_t batchSize = std::max<size_t>(std::min(maxVariableCount, MaxBatchVariableCount) / valueCount, 1);
 
       while(true) {
         std::stringstream stmt;
@@ -773,7 +1071,7 @@ private:
       }
     }
 
-    bool execute(const std::vector<StorageType>& types, SqliteIndexStorage* storage) {
+    bool execute(const std::vector<StorageType>& types, const SqliteIndexStorage* storage) {
       size_t index = 0;
       for(auto& [batchSize, stmt] : m_stmts) {
         while(types.size() - index >= batchSize) {
@@ -799,6 +1097,7 @@ private:
     std::function<void(CppSQLite3Statement& stmt, const StorageType&, size_t)> m_bindValuesFunc;
   };
 
+  InsertBatchStatement<Id> m_insertElementBatchStatement;
   InsertBatchStatement<StorageNode> m_insertNodeBatchStatement;
   InsertBatchStatement<StorageEdge> m_insertEdgeBatchStatement;
   InsertBatchStatement<StorageSymbol> m_insertSymbolBatchStatement;
@@ -807,36 +1106,48 @@ private:
   InsertBatchStatement<StorageOccurrence> m_insertOccurrenceBatchStatement;
   InsertBatchStatement<StorageComponentAccess> m_insertComponentAccessBatchStatement;
 
+  // one insert statement per temp.id_list_<level> table, the size is the number of created tables
+  mutable std::vector<std::unique_ptr<InsertBatchStatement<Id>>> m_idListInsertStatements;
+  mutable size_t m_idListLevel = 0;
+
   CppSQLite3Statement m_insertElementStmt;
   CppSQLite3Statement m_insertElementComponentStmt;
   CppSQLite3Statement m_insertFileStmt;
-  CppSQLite3Statement m_insertFileContentStmt;
+  CppSQLite3Statement m_insertFileContentBlockStmt;
+  CppSQLite3Statement m_insertFullTextSearchTrigramsStmt;
+  CppSQLite3Statement m_insertIndexingCostStmt;
   CppSQLite3Statement m_checkErrorExistsStmt;
   CppSQLite3Statement m_insertErrorStmt;
 };
 
 template <>
-void SqliteIndexStorage::forEach<StorageEdge>(const std::string& query, const std::function<void(StorageEdge&&)>& func) const;
-template <>
-void SqliteIndexStorage::forEach<StorageNode>(const std::string& query, const std::function<void(StorageNode&&)>& func) const;
-template <>
-void SqliteIndexStorage::forEach<StorageSymbol>(const std::string& query, const std::function<void(StorageSymbol&&)>& func) const;
-template <>
-void SqliteIndexStorage::forEach<StorageFile>(const std::string& query, const std::function<void(StorageFile&&)>& func) const;
-template <>
-void SqliteIndexStorage::forEach<StorageLocalSymbol>(const std::string& query,
-                                                     const std::function<void(StorageLocalSymbol&&)>& func) const;
-template <>
-void SqliteIndexStorage::forEach<StorageSourceLocation>(const std::string& query,
-                                                        const std::function<void(StorageSourceLocation&&)>& func) const;
+struct SqliteIndexStorage::CursorRow<StorageNode> {
+  using Type = StorageNodeView;
+};
 template <>
-void SqliteIndexStorage::forEach<StorageOccurrence>(const std::string& query,
-                                                    const std::function<void(StorageOccurrence&&)>& func) const;
+struct SqliteIndexStorage::CursorRow<StorageFile> {
+  using Type = StorageFileView;
+};
 template <>
-void SqliteIndexStorage::forEach<StorageComponentAccess>(const std::string& query,
-                                                         const std::function<void(StorageComponentAccess&&)>& func) const;
+struct SqliteIndexStorage::CursorRow<StorageLocalSymbol> {
+  using Type = StorageLocalSymbolView;
+};
 template <>
-void SqliteIndexStorage::forEach<StorageElementComponent>(const std::string& query,
-                                                          const std::function<void(StorageElementComponent&&)>& func) const;
+struct SqliteIndexStorage::CursorRow<StorageElementComponent> {
+  using Type = StorageElementComponentView;
+};
 template <>
-void SqliteIndexStorage::forEach<StorageError>(const std::string& query, const std::function<void(StorageError&&)>& func) const;
+struct SqliteIndexStorage::CursorRow<StorageError> {
+  using Type = StorageErrorView;
+};
+
+extern template class SqliteIndexStorage::Cursor<StorageEdge>;
+extern template class SqliteIndexStorage::Cursor<StorageNodeView>;
+extern template class SqliteIndexStorage::Cursor<StorageSymbol>;
+extern template class SqliteIndexStorage::Cursor<StorageFileView>;
+extern template class SqliteIndexStorage::Cursor<StorageLocalSymbolView>;
+extern template class SqliteIndexStorage::Cursor<StorageSourceLocation>;
+extern template class SqliteIndexStorage::Cursor<StorageOccurrence>;
+extern template class SqliteIndexStorage::Cursor<StorageComponentAccess>;
+extern template class SqliteIndexStorage::Cursor<StorageElementComponentView>;
+extern template class SqliteIndexStorage::Cursor<StorageErrorView>;
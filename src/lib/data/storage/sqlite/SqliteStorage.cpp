@@ -1,5 +1,7 @@
 #include "SqliteStorage.h"
 
+#include <cassert>
+
 #include "FileSystem.h"
 #include "logging.h"
 #include "TimeStamp.h"
@@ -12,11 +14,24 @@ SqliteStorage::SqliteStorage() {
     LOG_ERROR(L"Failed to load database file \":memory:\" with message: " + utility::decodeFromUtf8(e.errorMessage()));
     throw;
   }
+  m_maxVariableCount = static_cast<size_t>(m_database.getLimit(SQLITE_LIMIT_VARIABLE_NUMBER));
 
   executeStatement("PRAGMA foreign_keys=ON;");
 }
 
-SqliteStorage::SqliteStorage(const FilePath& dbFilePath) : m_dbFilePath(dbFilePath.getCanonical()) {
+SqliteStorage::SqliteStorage(const FilePath& dbFilePath, OpenMode openMode) : m_dbFilePath(dbFilePath.getCanonical()) {
+  if(OpenMode::ReadOnly == openMode) {
+    try {
+      m_database.openReadOnly(utility::encodeToUtf8(m_dbFilePath.wstr()).c_str());
+    } catch(CppSQLite3Exception& e) {
+      LOG_ERROR(L"Failed to open database file \"" + m_dbFilePath.wstr() + L"\" for reading with message: " +
+                utility::decodeFromUtf8(e.errorMessage()));
+      throw;
+    }
+    m_maxVariableCount = static_cast<size_t>(m_database.getLimit(SQLITE_LIMIT_VARIABLE_NUMBER));
+    return;
+  }
+
   if(!m_dbFilePath.getParentDirectory().empty() && !m_dbFilePath.getParentDirectory().exists()) {
     FileSystem::createDirectory(m_dbFilePath.getParentDirectory());
   }
@@ -28,11 +43,14 @@ SqliteStorage::SqliteStorage(const FilePath& dbFilePath) : m_dbFilePath(dbFilePa
               utility::decodeFromUtf8(e.errorMessage()));
     throw;
   }
+  m_maxVariableCount = static_cast<size_t>(m_database.getLimit(SQLITE_LIMIT_VARIABLE_NUMBER));
 
   executeStatement("PRAGMA foreign_keys=ON;");
 }
 
 SqliteStorage::~SqliteStorage() {
+  clearStatementCache();
+
   try {
     m_database.close();
   } catch(CppSQLite3Exception& e) {
@@ -90,6 +108,15 @@ void SqliteStorage::optimizeMemory() const {
   executeStatement("VACUUM;");
 }
 
+void SqliteStorage::checkpoint() const {
+  // a no-op for databases that are not in WAL mode
+  executeStatement("PRAGMA wal_checkpoint(TRUNCATE);");
+}
+
+void SqliteStorage::leaveWriteAheadLog() const {
+  executeStatement("PRAGMA journal_mode=DELETE;");
+}
+
 bool SqliteStorage::isEmpty() const {
   return getVersion() <= 0;
 }
@@ -181,6 +208,11 @@ int SqliteStorage::executeStatementScalar(CppSQLite3Statement& statement, const
 }
 
 CppSQLite3Query SqliteStorage::executeQuery(const std::string& statement) const {
+  if(s_queryPlanAuditEnabled && !m_auditedQueryPlans.contains(statement)) {
+    const UseScope use(this);
+    auditQueryPlan(statement);
+  }
+
   try {
     return m_database.execQuery(statement.c_str());
   } catch(CppSQLite3Exception& exception) {
@@ -230,3 +262,145 @@ void SqliteStorage::insertOrUpdateMetaValue(const std::string& key, const std::s
   stmt.bind(3, value.c_str());
   executeStatement(stmt);
 }
+
+void SqliteStorage::Parameter::bind(CppSQLite3Statement& statement, int index) const {
+  if(const int* value = std::get_if<int>(&m_value); value != nullptr) {
+    statement.bind(index, *value);
+  } else {
+    statement.bind(index, std::get<std::string>(m_value).c_str());
+  }
+}
+
+SqliteStorage::UseScope::UseScope(const SqliteStorage* storage) : m_storage(storage) {
+  if(m_storage != nullptr) {
+    const std::lock_guard<std::mutex> lock(m_storage->m_useMutex);
+    assert(m_storage->m_useCount == 0 || m_storage->m_usingThread == std::this_thread::get_id());
+    m_storage->m_usingThread = std::this_thread::get_id();
+    m_storage->m_useCount++;
+  }
+}
+
+SqliteStorage::UseScope::UseScope(UseScope&& other) noexcept : m_storage(other.m_storage) {
+  other.m_storage = nullptr;
+}
+
+SqliteStorage::UseScope::~UseScope() {
+  if(m_storage != nullptr) {
+    const std::lock_guard<std::mutex> lock(m_storage->m_useMutex);
+    m_storage->m_useCount--;
+  }
+}
+
+SqliteStorage::CachedStatement::CachedStatement(UseScope use, CppSQLite3Statement* statement, bool* borrowed)
+    : m_use(std::move(use)), m_statement(statement), m_borrowed(borrowed) {
+  *m_borrowed = true;
+}
+
+SqliteStorage::CachedStatement::CachedStatement(UseScope use, CppSQLite3Statement&& statement)
+    : m_use(std::move(use)), m_ownStatement(statement) {}
+
+SqliteStorage::CachedStatement::CachedStatement(CachedStatement&& other) noexcept
+    : m_use(std::move(other.m_use))
+    , m_statement(other.m_statement)
+    , m_borrowed(other.m_borrowed)
+    , m_ownStatement(other.m_ownStatement) {
+  other.m_statement = nullptr;
+  other.m_borrowed = nullptr;
+}
+
+SqliteStorage::CachedStatement::~CachedStatement() {
+  if(m_borrowed != nullptr) {
+    try {
+      m_statement->reset();
+    } catch(CppSQLite3Exception& exception) {
+      LOG_ERROR(fmt::format("{}: {}", exception.errorCode(), exception.errorMessage()));
+    }
+    *m_borrowed = false;
+  }
+}
+
+SqliteStorage::CachedStatement SqliteStorage::getCachedStatement(const std::string& sql,
+                                                                 const std::vector<Parameter>& parameters) const {
+  UseScope use(this);
+  auto iterator = m_statementCache.find(sql);
+  if(iterator == m_statementCache.end()) {
+    try {
+      iterator = m_statementCache.try_emplace(sql).first;
+      iterator->second.statement = m_database.compileStatement(sql.c_str());
+    } catch(CppSQLite3Exception& exception) {
+      LOG_ERROR(fmt::format("{}: {}", exception.errorCode(), exception.errorMessage()));
+      m_statementCache.erase(sql);
+      return CachedStatement(UseScope(nullptr), CppSQLite3Statement());
+    }
+  }
+
+  // sqlite plans a statement again when the schema changes, so its plan is audited again after each index change
+  if(s_queryPlanAuditEnabled && !m_auditedQueryPlans.contains(sql)) {
+    auditQueryPlan(sql);
+  }
+
+  try {
+    // a nested query with the same sql must not reset the statement of the enclosing one
+    CachedStatement statement = iterator->second.borrowed
+        ? CachedStatement(std::move(use), m_database.compileStatement(sql.c_str()))
+        : CachedStatement(std::move(use), &iterator->second.statement, &iterator->second.borrowed);
+
+    for(size_t i = 0; i < parameters.size(); i++) {
+      parameters[i].bind(statement.get(), static_cast<int>(i) + 1);
+    }
+    return statement;
+  } catch(CppSQLite3Exception& exception) {
+    LOG_ERROR(fmt::format("{}: {}", exception.errorCode(), exception.errorMessage()));
+  }
+  return CachedStatement(UseScope(nullptr), CppSQLite3Statement());
+}
+
+bool SqliteStorage::executeCachedStatement(const std::string& sql, const std::vector<Parameter>& parameters) const {
+  CachedStatement statement = getCachedStatement(sql, parameters);
+  return executeStatement(statement.get());
+}
+
+int SqliteStorage::executeCachedStatementScalar(const std::string& sql,
+                                                const std::vector<Parameter>& parameters,
+                                                const int nullValue) const {
+  CachedStatement statement = getCachedStatement(sql, parameters);
+  return executeStatementScalar(statement.get(), nullValue);
+}
+
+void SqliteStorage::auditQueryPlan(const std::string& sql) const {
+  try {
+    // unbound parameters are NULL, which does not change the plan
+    CppSQLite3Query query = m_database.execQuery(("EXPLAIN QUERY PLAN " + sql).c_str());
+    // reading a whole table is only worth a warning if the query filters or joins it
+    const bool filtered = sql.find(" WHERE ") != std::string::npos || sql.find(" JOIN ") != std::string::npos;
+    std::string plan;
+    bool fullScan = false;
+    for(; !query.eof(); query.nextRow()) {
+      const std::string detail = query.getStringField(3, "");
+      // "SCAN table" without "USING ... INDEX" walks the whole table, temp tables and subqueries are expected to be scanned
+      if(filtered && detail.starts_with("SCAN ") && detail.find(" USING ") == std::string::npos &&
+         detail.find("id_list_") == std::string::npos && !detail.starts_with("SCAN (")) {
+        fullScan = true;
+      }
+      plan += "\n  " + detail;
+    }
+    m_auditedQueryPlans[sql] = plan;
+
+    if(fullScan) {
+      LOG_WARNING(fmt::format("Full table scan in query \"{}\":{}", sql, plan));
+    } else {
+      LOG_DEBUG(fmt::format("Query plan of \"{}\":{}", sql, plan));
+    }
+  } catch(CppSQLite3Exception& exception) {
+    LOG_WARNING(fmt::format("Failed to explain query \"{}\": {}", sql, exception.errorMessage()));
+    m_auditedQueryPlans[sql] = {};
+  }
+}
+
+void SqliteStorage::clearStatementCache() const {
+  m_statementCache.clear();
+}
+
+void SqliteStorage::clearAuditedQueryPlans() const {
+  m_auditedQueryPlans.clear();
+}
@@ -4,17 +4,31 @@
  * @brief This file contains the SqliteStorage class, which is a base class for SQLite-based storage.
  */
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
 #include "CppSQLite3.h"    // TODO(Hussein): Should be removed
 #include "FilePath.h"
+#include "GlobalId.hpp"
 
 class SqliteStorageMigration;
 class TimeStamp;
 
 /**
  * @brief The SqliteStorage class is a base class for SQLite-based storage.
+ *
+ * A connection serves one thread at a time, see UseScope.
  */
 class SqliteStorage {
 public:
+  enum class OpenMode : uint8_t { ReadWrite, ReadOnly };
+
   /**
    * @brief Construct a new SqliteStorage object
    *
@@ -26,10 +40,11 @@ public:
   /**
    * @brief Construct a new SqliteStorage object
    *
-   * This constructor is used for SQLite databases that are stored on the file system.
+   * This constructor is used for SQLite databases that are stored on the file system. A read-only connection can still
+   * create temporary tables, but never writes to the database file.
    * @throw CppSQLite3Exception
    */
-  explicit SqliteStorage(const FilePath& dbFilePath);
+  explicit SqliteStorage(const FilePath& dbFilePath, OpenMode openMode = OpenMode::ReadWrite);
 
   /**
    * @brief Destroy the SqliteStorage object
@@ -82,6 +97,17 @@ public:
    */
   void optimizeMemory() const;
 
+  /**
+   * @brief Moves the write-ahead log into the database file, which has to happen before the file is copied or renamed
+   */
+  void checkpoint() const;
+
+  /**
+   * @brief Moves the write-ahead log into the database file and switches to a rollback journal, which removes the -wal and
+   * -shm files. Requires that no other connection to the database is open.
+   */
+  void leaveWriteAheadLog() const;
+
   /**
    * @brief Get the file path of the database
    * @return The file path of the database
@@ -114,7 +140,126 @@ public:
    */
   TimeStamp getTime() const;
 
+  /**
+   * @brief Logs the `EXPLAIN QUERY PLAN` of every query once per index set and warns about full table scans
+   *
+   * Covers cached statements and queries run from their sql text. Statements compiled by hand, like the precompiled
+   * inserts, are not audited. Meant for checking the index set against the queries, so it is off by default and
+   * enabled with debug logging.
+   */
+  static void setQueryPlanAuditEnabled(bool enabled) noexcept {
+    s_queryPlanAuditEnabled = enabled;
+  }
+
+  [[nodiscard]] static bool isQueryPlanAuditEnabled() noexcept {
+    return s_queryPlanAuditEnabled;
+  }
+
+  /**
+   * @brief The plans audited since the index set last changed by sql, with each `EXPLAIN QUERY PLAN` detail on its own line
+   */
+  [[nodiscard]] const std::unordered_map<std::string, std::string>& getAuditedQueryPlans() const {
+    return m_auditedQueryPlans;
+  }
+
 protected:
+  /**
+   * @brief A value bound to a `?` parameter, ids are bound as int like everywhere else in the storage
+   */
+  class Parameter {
+  public:
+    Parameter(int value) : m_value(value) {}    // NOLINT(google-explicit-constructor)
+    Parameter(Id value) : m_value(static_cast<int>(value)) {}    // NOLINT(google-explicit-constructor)
+    Parameter(std::string value) : m_value(std::move(value)) {}    // NOLINT(google-explicit-constructor)
+    Parameter(const char* value) : m_value(std::string(value)) {}    // NOLINT(google-explicit-constructor)
+
+    void bind(CppSQLite3Statement& statement, int index) const;
+
+  private:
+    std::variant<int, std::string> m_value;
+  };
+
+  /**
+   * @brief Marks the connection as used by the calling thread for the lifetime of the object
+   *
+   * A connection serves one thread at a time, its statement cache and temporary id lists are not synchronized. Nested uses
+   * on the same thread are fine, a use from a second thread while another one is still in progress fails an assertion.
+   */
+  class UseScope {
+  public:
+    explicit UseScope(const SqliteStorage* storage);
+    UseScope(UseScope&& other) noexcept;
+    UseScope(const UseScope&) = delete;
+    UseScope& operator=(const UseScope&) = delete;
+    UseScope& operator=(UseScope&&) = delete;
+    ~UseScope();
+
+  private:
+    const SqliteStorage* m_storage;
+  };
+
+  /**
+   * @brief A statement borrowed from the statement cache
+   *
+   * The statement is reset when the handle goes out of scope, so a CppSQLite3Query created from it must not outlive the
+   * handle. If the cached statement is still borrowed by an enclosing query, the handle owns a freshly compiled one.
+   */
+  class CachedStatement {
+  public:
+    CachedStatement(UseScope use, CppSQLite3Statement* statement, bool* borrowed);
+    CachedStatement(UseScope use, CppSQLite3Statement&& statement);
+    CachedStatement(CachedStatement&& other) noexcept;
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+    CachedStatement& operator=(CachedStatement&&) = delete;
+    ~CachedStatement();
+
+    CppSQLite3Statement& get() {
+      return m_statement != nullptr ? *m_statement : m_ownStatement;
+    }
+
+  private:
+    // declared first, so the connection is released only after the statement was reset
+    UseScope m_use;
+    CppSQLite3Statement* m_statement = nullptr;
+    bool* m_borrowed = nullptr;
+    CppSQLite3Statement m_ownStatement;
+  };
+
+  /**
+   * @brief Returns the prepared statement for sql with the parameters bound, compiling it on first use
+   *
+   * The sql text is the cache key, so it must not contain values that change between calls.
+   */
+  CachedStatement getCachedStatement(const std::string& sql, const std::vector<Parameter>& parameters = {}) const;
+
+  /**
+   * @brief Execute a cached statement
+   * @param sql The statement to execute
+   * @param parameters The values bound to the `?` parameters of the statement
+   * @return True if the statement was executed successfully, false otherwise
+   */
+  bool executeCachedStatement(const std::string& sql, const std::vector<Parameter>& parameters = {}) const;
+
+  /**
+   * @brief Execute a cached statement and return a scalar value
+   * @param sql The statement to execute
+   * @param parameters The values bound to the `?` parameters of the statement
+   * @param nullValue The value to return if the statement returns no rows
+   * @return The scalar value
+   */
+  int executeCachedStatementScalar(const std::string& sql, const std::vector<Parameter>& parameters, const int nullValue) const;
+
+  /**
+   * @brief Finalizes all cached statements, which has to happen before the database is closed
+   */
+  void clearStatementCache() const;
+
+  /**
+   * @brief Makes the query plan audit explain every query again, has to be called when indices are added or dropped
+   */
+  void clearAuditedQueryPlans() const;
+
   /**
    * @brief Setup the meta table
    */
@@ -192,6 +337,8 @@ protected:
 
   mutable CppSQLite3DB m_database;
   FilePath m_dbFilePath;
+  // host parameters one statement of this connection may bind, builds can lower SQLITE_MAX_VARIABLE_NUMBER
+  size_t m_maxVariableCount = 0;
 
 private:
   virtual size_t getStaticVersion() const = 0;
@@ -199,7 +346,24 @@ private:
   virtual void setupTables() = 0;
   virtual void setupPrecompiledStatements() = 0;
 
+  void auditQueryPlan(const std::string& sql) const;
+
   bool m_precompiledStatementsInitialized = false;
 
+  struct CachedStatementEntry {
+    CppSQLite3Statement statement;
+    bool borrowed = false;
+  };
+
+  mutable std::unordered_map<std::string, CachedStatementEntry> m_statementCache;
+
+  // the thread holding UseScopes of this connection and how many, see UseScope
+  mutable std::mutex m_useMutex;
+  mutable std::thread::id m_usingThread;
+  mutable size_t m_useCount = 0;
+  mutable std::unordered_map<std::string, std::string> m_auditedQueryPlans;
+
+  static inline std::atomic<bool> s_queryPlanAuditEnabled = false;
+
   friend SqliteStorageMigration;
 };
@@ -1,6 +1,7 @@
 #pragma once
 // STL
 #include <string>
+#include <string_view>
 // internal
 #include "GlobalId.hpp"
 
@@ -24,3 +25,12 @@ struct StorageElementComponent {
   int type = 0;
   std::wstring data = {};
 };
+
+/**
+ * @brief An element component row as read by SqliteIndexStorage::Cursor, the data borrows the UTF-8 text of the row
+ */
+struct StorageElementComponentView {
+  Id elementId = 0;
+  int type = 0;
+  std::string_view data;
+};
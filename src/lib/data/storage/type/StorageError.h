@@ -1,6 +1,7 @@
 #pragma once
 // STL
 #include <string>
+#include <string_view>
 // internal
 #include "GlobalId.hpp"
 
@@ -38,3 +39,14 @@ struct StorageError final : public StorageErrorData {
 
   Id id = 0;
 };
+
+/**
+ * @brief An error row as read by SqliteIndexStorage::Cursor, the strings borrow the UTF-8 text of the row
+ */
+struct StorageErrorView {
+  Id id = 0;
+  std::string_view message;
+  std::string_view translationUnit;
+  bool fatal = false;
+  bool indexed = false;
+};
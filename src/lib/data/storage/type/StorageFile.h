@@ -1,6 +1,8 @@
 #pragma once
 // STL
+#include <memory>
 #include <string>
+#include <string_view>
 // internal
 #include "GlobalId.hpp"
 
@@ -26,4 +28,18 @@ struct StorageFile {
   std::string modificationTime = {};
   bool indexed = true;
   bool complete = true;
+  // text of the file as read by the indexer with normalized line breaks, nullptr if it was not captured
+  std::shared_ptr<const std::string> content = {};
+};
+
+/**
+ * @brief A file row as read by SqliteIndexStorage::Cursor, the strings borrow the UTF-8 text of the row
+ */
+struct StorageFileView {
+  Id id = 0;
+  std::string_view filePath;
+  std::string_view languageIdentifier;
+  std::string_view modificationTime;
+  bool indexed = true;
+  bool complete = true;
 };
@@ -0,0 +1,16 @@
+#pragma once
+// STL
+#include <cstdint>
+#include <string>
+
+// indexing effort of one translation unit, used to schedule the expensive ones first in the next run
+struct StorageIndexingCost {
+  StorageIndexingCost() = default;
+
+  StorageIndexingCost(std::wstring filePath_, uint64_t durationMs_, uint64_t storageSize_)
+      : filePath(std::move(filePath_)), durationMs(durationMs_), storageSize(storageSize_) {}
+
+  std::wstring filePath = {};
+  uint64_t durationMs = 0;
+  uint64_t storageSize = 0;    // byte size of the intermediate storage the translation unit produced
+};
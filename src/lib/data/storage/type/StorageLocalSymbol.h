@@ -1,6 +1,7 @@
 #pragma once
 // STL
 #include <string>
+#include <string_view>
 // internal
 #include "GlobalId.hpp"
 
@@ -25,3 +26,11 @@ struct StorageLocalSymbol : public StorageLocalSymbolData {
 
   Id id = 0;
 };
+
+/**
+ * @brief A local symbol row as read by SqliteIndexStorage::Cursor, the name borrows the UTF-8 text of the row
+ */
+struct StorageLocalSymbolView {
+  Id id = 0;
+  std::string_view name;
+};
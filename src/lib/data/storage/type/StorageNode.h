@@ -1,6 +1,7 @@
 #pragma once
 // STL
 #include <string>
+#include <string_view>
 // internal
 #include "GlobalId.hpp"
 
@@ -26,3 +27,12 @@ struct StorageNode : public StorageNodeData {
 
   Id id = 0;
 };
+
+/**
+ * @brief A node row as read by SqliteIndexStorage::Cursor, the name borrows the UTF-8 text of the row
+ */
+struct StorageNodeView {
+  Id id = 0;
+  int type = 0;
+  std::string_view serializedName;
+};
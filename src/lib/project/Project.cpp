@@ -1,6 +1,8 @@
 #include "Project.h"
 
+#include <algorithm>
 #include <cassert>
+#include <map>
 #include <tuple>
 #include <utility>
 
@@ -27,6 +29,7 @@
 #include "SourceGroup.h"
 #include "SourceGroupFactory.h"
 #include "SourceGroupStatusType.h"
+#include "SqliteIndexStorage.h"
 #include "StorageCache.h"
 #include "StorageProvider.h"
 #include "TabId.h"
@@ -52,6 +55,8 @@
 
 namespace {
 constexpr int DefaultIndexerThreadCount = 4;
+constexpr int IndexerThreadsPerMergeThread = 4;
+constexpr int MinIndexerCommandQueueSize = 20;
 
 int getIndexerThreadCount() {
   int indexerThreadCount = IApplicationSettings::getInstanceRaw()->getIndexerThreadCount();
@@ -64,6 +69,22 @@ int getIndexerThreadCount() {
   return indexerThreadCount;
 }
 
+// a stale write-ahead log next to a database file would be replayed into whatever database is created there next
+void removeWriteAheadLog(const FilePath& dbFilePath) {
+  std::ignore = FileSystem::remove(FilePath(dbFilePath.wstr() + L"-wal"));
+  std::ignore = FileSystem::remove(FilePath(dbFilePath.wstr() + L"-shm"));
+}
+
+// a crashed indexer run can leave committed transactions of the temp database in its write-ahead log, which has to be
+// moved into the database file before that file is renamed
+void foldWriteAheadLog(const FilePath& dbFilePath) {
+  try {
+    SqliteIndexStorage(dbFilePath).leaveWriteAheadLog();
+  } catch(...) {
+    // already logged, the database file is used as it is
+  }
+}
+
 }    // namespace
 
 Project::Project(std::shared_ptr<ProjectSettings> settings,
@@ -142,6 +163,7 @@ void Project::load(const std::shared_ptr<DialogView>& dialogView) {
                                L"before indexing?",
                                {L"Keep and Continue", L"Discard and Restore"}) == 0) {
           LOG_INFO("Switching to temporary indexing data on user's decision");
+          foldWriteAheadLog(tempDbPath);
           if(!swapToTempStorageFile(dbPath, tempDbPath, dialogView)) {
             m_state = ProjectStateType::NOT_LOADED;
             MessageStatus(L"Unable to load project", true, false).dispatch();
@@ -150,11 +172,13 @@ void Project::load(const std::shared_ptr<DialogView>& dialogView) {
         } else {
           LOG_INFO("Discarding temporary indexing data on user's decision");
           FileSystem::remove(tempDbPath);
+          removeWriteAheadLog(tempDbPath);
         }
       } else {
         LOG_INFO(
             "Switching to temporary indexing data because no other persistent data was "
             "found");
+        foldWriteAheadLog(tempDbPath);
         FileSystem::rename(tempDbPath, dbPath);
       }
     }
@@ -199,7 +223,7 @@ void Project::load(const std::shared_ptr<DialogView>& dialogView) {
 
   if(canLoad) {
     m_storage->setMode(SqliteIndexStorage::STORAGE_MODE_READ);
-    m_storage->buildCaches();
+    m_storage->buildCaches(true);
     m_storageCache->setSubject(m_storage);
 
     if(m_hasGUI) {
@@ -424,7 +448,9 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
   const FilePath tempIndexDbFilePath = m_settings->getTempDBFilePath();
 
   // store the indexed data into the temp db but keep the current state to allow browsing while indexing
+  removeWriteAheadLog(tempIndexDbFilePath);
   if(RefreshMode::AllFiles != info.mode) {
+    m_storage->checkpoint();
     std::ignore = FileSystem::copyFile(indexDbFilePath, tempIndexDbFilePath);
   }
 
@@ -432,6 +458,9 @@ void Project::buildIndex(RefreshInfo info, std::shared_ptr<DialogView> dialogVie
   // TODO(SOUR-102): Create PersistentStorage using factory pattern
   const auto tempStorage = std::make_shared<PersistentStorage>(tempIndexDbFilePath, m_storage->getBookmarkDbFilePath());
   tempStorage->setup();
+  if(RefreshMode::AllFiles != info.mode) {
+    tempStorage->trackSymbolIndexChanges();
+  }
   // Store the setting at temp storage
   tempStorage->setProjectSettingsText(TextAccess::createFromFile(getProjectSettingsFilePath())->getText());
   tempStorage->updateVersion();
@@ -451,6 +480,8 @@ void Project::swapToTempStorage(std::shared_ptr<DialogView> dialogView) {
   const FilePath tempIndexDbFilePath = m_settings->getTempDBFilePath();
   const FilePath bookmarkDbFilePath = m_settings->getBookmarkDBFilePath();
 
+  // the temp database started as a copy of the current one, so its symbol index only needs the changed nodes
+  SearchIndex symbolIndex = m_storage->takeSymbolIndex();
   m_storage.reset();
 
   if(!swapToTempStorageFile(indexDbFilePath, tempIndexDbFilePath, dialogView)) {
@@ -460,11 +491,14 @@ void Project::swapToTempStorage(std::shared_ptr<DialogView> dialogView) {
 
   m_storage = std::make_shared<PersistentStorage>(indexDbFilePath, bookmarkDbFilePath);
   m_storage->setup();
+  m_storage->setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  m_storage->writeGraphSnapshot();
+  m_storage->adoptSymbolIndex(std::move(symbolIndex));
 
   // std::shared_ptr<DialogView> dialogView =
   // Application::getInstance()->getDialogView(DialogView::UseCase::INDEXING);
   // dialogView->showUnknownProgressDialog(L"Finish Indexing", L"Building caches");
-  m_storage->buildCaches();
+  m_storage->buildCaches(true);
   // dialogView->hideUnknownProgressDialog();
 
   m_storageCache->setSubject(m_storage);
@@ -475,7 +509,10 @@ bool Project::swapToTempStorageFile(const FilePath& indexDbFilePath,
                                     const FilePath& tempIndexDbFilePath,
                                     std::shared_ptr<DialogView> dialogView) {
   try {
+    // the current storage is closed at this point, so its -wal and -shm files are stale
     FileSystem::remove(indexDbFilePath);
+    removeWriteAheadLog(indexDbFilePath);
+    // the temp storage left WAL mode when indexing finished, see TaskFinishParsing, and has no files next to it
     FileSystem::rename(tempIndexDbFilePath, indexDbFilePath);
   } catch(std::exception& /*e*/) {
     if(m_hasGUI) {
@@ -496,6 +533,7 @@ void Project::discardTempStorage() {
   if(tempIndexDbPath.exists()) {
     LOG_INFO("Discarding temporary indexing data");
     FileSystem::remove(tempIndexDbPath);
+    removeWriteAheadLog(tempIndexDbPath);
   }
 }
 
@@ -531,12 +569,16 @@ std::shared_ptr<TaskGroupSequence> Project::createIndexTasks(RefreshInfo info,
   // TODO(Hussein): Create Tasks using factory pattern
   auto indexerCommandProvider = std::make_unique<CombinedIndexerCommandProvider>();
   auto customIndexerCommandProvider = std::make_unique<CombinedIndexerCommandProvider>();
+  // the pre-index task of a source group prepares what the commands of its provider rely on
+  std::vector<std::pair<std::shared_ptr<SourceGroup>, std::shared_ptr<IndexerCommandProvider>>> sourceGroupProviders;
   for(const std::shared_ptr<SourceGroup>& sourceGroup : m_sourceGroups) {
     if(SOURCE_GROUP_STATUS_ENABLED == sourceGroup->getStatus()) {
+      std::shared_ptr<IndexerCommandProvider> sourceGroupProvider = sourceGroup->getIndexerCommandProvider(info);
+      sourceGroupProviders.emplace_back(sourceGroup, sourceGroupProvider);
       if(SOURCE_GROUP_CUSTOM_COMMAND == sourceGroup->getType()) {
-        customIndexerCommandProvider->addProvider(sourceGroup->getIndexerCommandProvider(info));
+        customIndexerCommandProvider->addProvider(sourceGroupProvider);
       } else {
-        indexerCommandProvider->addProvider(sourceGroup->getIndexerCommandProvider(info));
+        indexerCommandProvider->addProvider(sourceGroupProvider);
       }
     }
   }
@@ -566,23 +608,32 @@ std::shared_ptr<TaskGroupSequence> Project::createIndexTasks(RefreshInfo info,
     // TODO(Hussein): Create Tasks using factory pattern
     auto preIndexTasks = std::make_shared<TaskGroupSequence>();
     taskSequential->addTask(preIndexTasks);
-    for(const std::shared_ptr<SourceGroup>& sourceGroup : m_sourceGroups) {
-      if(sourceGroup->getStatus() == SOURCE_GROUP_STATUS_ENABLED) {
-        preIndexTasks->addTask(sourceGroup->getPreIndexTask(storageProvider, dialogView));
-      }
+    for(const auto& [sourceGroup, sourceGroupProvider] : sourceGroupProviders) {
+      preIndexTasks->addTask(sourceGroup->getPreIndexTask(*sourceGroupProvider, storageProvider, dialogView));
     }
 
     // TODO(Hussein): Create Tasks using factory pattern
-    auto taskParserWrapper = std::make_shared<TaskParseWrapper>(tempStorage, dialogView);
+    // a full refresh starts from an empty temp database, which can be filled without any read indices
+    auto taskParserWrapper = std::make_shared<TaskParseWrapper>(
+        tempStorage, dialogView, RefreshMode::AllFiles == info.mode);
     taskSequential->addTask(taskParserWrapper);
 
     // TODO(Hussein): Create Tasks using factory pattern
     auto taskParallelIndexing = std::make_shared<TaskGroupParallel>();
     taskParserWrapper->setTask(taskParallelIndexing);
 
-    // add task for refilling the indexer command queue
+    // add task for refilling the indexer command queue, the durations of the last runs put the slowest files first
+    std::map<FilePath, uint64_t> expectedDurationsMs;
+    if(m_storage) {
+      for(const StorageIndexingCost& cost : m_storage->getIndexingCosts()) {
+        expectedDurationsMs.emplace(FilePath(cost.filePath), cost.durationMs);
+      }
+    }
+
     // TODO(Hussein): Create Tasks using factory pattern
-    taskParallelIndexing->addTask(std::make_shared<TaskFillIndexerCommandsQueue>(m_appUUID, std::move(indexerCommandProvider), 20));
+    const size_t commandQueueSize = static_cast<size_t>(std::max(MinIndexerCommandQueueSize, 2 * adjustedIndexerThreadCount));
+    taskParallelIndexing->addTask(std::make_shared<TaskFillIndexerCommandsQueue>(
+        m_appUUID, std::move(indexerCommandProvider), std::move(expectedDurationsMs), commandQueueSize));
 
     // add task for indexing
     const bool multiProcess = IApplicationSettings::getInstanceRaw()->getMultiProcessIndexingEnabled() && hasCxxSourceGroup();
@@ -594,18 +645,21 @@ std::shared_ptr<TaskGroupSequence> Project::createIndexTasks(RefreshInfo info,
                 "indexer_command_queue_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
         std::make_shared<TaskBuildIndex>(adjustedIndexerThreadCount, storageProvider, dialogView, m_appUUID, multiProcess)));
 
-    // add task for merging the intermediate storages
-    taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
-        // block until there are indexers running
-        std::make_shared<TaskDecoratorRepeat>(TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
-            ->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
-                "indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
-        // merge until all indexers stopped and nothing left to merge
-        std::make_shared<TaskDecoratorRepeat>(TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 250)
-            ->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
-                std::make_shared<TaskMergeStorages>(storageProvider),
-                std::make_shared<TaskReturnSuccessIf<bool>>(
-                    "indexer_threads_stopped", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)))));
+    // add tasks for merging the intermediate storages, several lanes so merge throughput keeps up with the indexers
+    const int mergeThreadCount = std::max(1, adjustedIndexerThreadCount / IndexerThreadsPerMergeThread);
+    for(int i = 0; i < mergeThreadCount; i++) {
+      taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
+          // block until there are indexers running
+          std::make_shared<TaskDecoratorRepeat>(TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 25)
+              ->addChildTask(std::make_shared<TaskReturnSuccessIf<bool>>(
+                  "indexer_threads_started", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)),
+          // merge until all indexers stopped and nothing left to merge
+          std::make_shared<TaskDecoratorRepeat>(TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 250)
+              ->addChildTask(std::make_shared<TaskGroupSelector>()->addChildTasks(
+                  std::make_shared<TaskMergeStorages>(storageProvider),
+                  std::make_shared<TaskReturnSuccessIf<bool>>(
+                      "indexer_threads_stopped", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false)))));
+    }
 
     // add task for injecting the intermediate storages into the persistent storage
     taskParallelIndexing->addTask(std::make_shared<TaskGroupSequence>()->addChildTasks(
@@ -1,5 +1,8 @@
 #include "RefreshInfoGenerator.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "FileInfo.h"
 #include "FileSystem.h"
 #include "PersistentStorage.h"
@@ -8,6 +11,7 @@
 #include "SourceGroupStatusType.h"
 #include "TextAccess.h"
 #include "utility.h"
+#include "utilityApp.h"
 
 RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(const std::vector<std::shared_ptr<SourceGroup>>& sourceGroups,
                                                                 std::shared_ptr<const PersistentStorage> storage) {
@@ -19,6 +23,7 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(const std::vecto
 
   {
     const std::vector<FileInfo> fileInfosFromStorage = storage->getFileInfoForAllFiles();
+    const std::vector<FileStatus> fileStatuses = getFileStatuses(fileInfosFromStorage, storage->getContentHashesForAllFiles());
 
     std::set<FilePath> alreadyKnownPaths;
     {
@@ -33,10 +38,12 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(const std::vecto
     }
 
     // checking source and header files
-    for(const FileInfo& info : fileInfosFromStorage) {
-      if(alreadyKnownPaths.find(info.path) != alreadyKnownPaths.end() && info.path.exists()) {
+    for(size_t i = 0; i < fileInfosFromStorage.size(); i++) {
+      const FileInfo& info = fileInfosFromStorage[i];
+      const FileStatus& status = fileStatuses[i];
+      if(alreadyKnownPaths.find(info.path) != alreadyKnownPaths.end() && status.exists) {
         if(storage->getFilePathIndexed(info.path)) {
-          if(didFileChange(info, storage)) {
+          if(status.changed) {
             changedFilePaths.insert(info.path);
           } else {
             unchangedIndexedFilePaths.insert(info.path);
@@ -44,7 +51,7 @@ RefreshInfo RefreshInfoGenerator::getRefreshInfoForUpdatedFiles(const std::vecto
         } else {
           changedFilePaths.insert(info.path);
         }
-      } else if(!storage->getFilePathIndexed(info.path) && !didFileChange(info, storage)) {
+      } else if(!storage->getFilePathIndexed(info.path) && !status.changed) {
         unchangedNonindexedFilePaths.insert(info.path);
       } else    // file has been removed
       {
@@ -181,29 +188,46 @@ std::set<FilePath> RefreshInfoGenerator::getAllSourceFilePaths(const std::vector
   return allSourceFilePaths;
 }
 
-bool RefreshInfoGenerator::didFileChange(const FileInfo& info, std::shared_ptr<const PersistentStorage> storage) {
-  FileInfo diskFileInfo = FileSystem::getFileInfoForPath(info.path);
-  if(diskFileInfo.lastWriteTime > info.lastWriteTime) {
-    if(!storage->hasContentForFile(info.path)) {
-      return true;
-    }
-
-    std::shared_ptr<TextAccess> storedFileContent = storage->getFileContent(info.path, false);
-    std::shared_ptr<TextAccess> diskFileContent = TextAccess::createFromFile(diskFileInfo.path);
+std::vector<RefreshInfoGenerator::FileStatus> RefreshInfoGenerator::getFileStatuses(
+    const std::vector<FileInfo>& fileInfos, const std::map<FilePath, uint64_t>& storedContentHashes) {
+  std::vector<FileStatus> fileStatuses(fileInfos.size());
+
+  const size_t threadCount = std::max<size_t>(
+      1, std::min(static_cast<size_t>(utility::getIdealThreadCount()), fileInfos.size()));
+  const size_t partSize = (fileInfos.size() + threadCount - 1) / threadCount;
+
+  // every thread writes its own range of fileStatuses, so no locking is needed
+  std::vector<std::thread> threads;
+  for(size_t begin = 0; begin < fileInfos.size(); begin += partSize) {
+    const size_t end = std::min(begin + partSize, fileInfos.size());
+    threads.emplace_back([&, begin, end]() {
+      for(size_t i = begin; i < end; i++) {
+        const FileInfo& info = fileInfos[i];
+        const auto storedContentHash = storedContentHashes.find(info.path);
+
+        fileStatuses[i].exists = info.path.exists();
+        fileStatuses[i].changed = didFileChange(
+            info,
+            storedContentHash != storedContentHashes.end() ? std::optional<uint64_t>(storedContentHash->second) : std::nullopt);
+      }
+    });
+  }
+  for(std::thread& thread : threads) {
+    thread.join();
+  }
 
-    const std::vector<std::string>& diskFileLines = diskFileContent->getAllLines();
-    const std::vector<std::string>& storedFileLines = storedFileContent->getAllLines();
+  return fileStatuses;
+}
 
-    if(diskFileLines.size() != storedFileLines.size()) {
+bool RefreshInfoGenerator::didFileChange(const FileInfo& info, std::optional<uint64_t> storedContentHash) {
+  FileInfo diskFileInfo = FileSystem::getFileInfoForPath(info.path);
+  if(diskFileInfo.lastWriteTime > info.lastWriteTime) {
+    if(!storedContentHash) {
       return true;
     }
 
-    for(size_t i = 0; i < diskFileLines.size(); i++) {
-      if(diskFileLines[i] != storedFileLines[i]) {
-        return true;
-      }
-    }
-    return false;
+    // only the disk file is read, the stored content is represented by its hash
+    return TextAccess::createFromFile(diskFileInfo.path)->getContentHash() != *storedContentHash;
   }
   return false;
-}
\ No newline at end of file
+}
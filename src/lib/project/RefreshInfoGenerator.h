@@ -1,5 +1,8 @@
 #pragma once
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -22,5 +25,17 @@ public:
 private:
   static std::set<FilePath> getAllSourceFilePaths(const std::vector<std::shared_ptr<SourceGroup>>& sourceGroups);
 
-  static bool didFileChange(const FileInfo& info, std::shared_ptr<const PersistentStorage> storage);
+  struct FileStatus {
+    bool exists = false;
+    bool changed = false;
+  };
+
+  /**
+   * @brief Stats and, if the modification time moved, hashes all files in parallel
+   * @return The status of each file, in the order of fileInfos
+   */
+  static std::vector<FileStatus> getFileStatuses(const std::vector<FileInfo>& fileInfos,
+                                                 const std::map<FilePath, uint64_t>& storedContentHashes);
+
+  static bool didFileChange(const FileInfo& info, std::optional<uint64_t> storedContentHash);
 };
\ No newline at end of file
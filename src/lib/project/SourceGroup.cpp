@@ -13,7 +13,8 @@ std::shared_ptr<IndexerCommandProvider> SourceGroup::getIndexerCommandProvider(c
   return std::make_shared<MemoryIndexerCommandProvider>(getIndexerCommands(info));
 }
 
-std::shared_ptr<Task> SourceGroup::getPreIndexTask(std::shared_ptr<StorageProvider> /*storageProvider*/,
+std::shared_ptr<Task> SourceGroup::getPreIndexTask(const IndexerCommandProvider& /*indexerCommandProvider*/,
+                                                   std::shared_ptr<StorageProvider> /*storageProvider*/,
                                                    std::shared_ptr<DialogView> /*dialogView*/) const {
   return std::make_shared<TaskLambda>([]() {});
 }
@@ -31,7 +31,9 @@ public:
   virtual std::set<FilePath> getAllSourceFilePaths() const = 0;
   virtual std::shared_ptr<IndexerCommandProvider> getIndexerCommandProvider(const RefreshInfo& info) const;
   virtual std::vector<std::shared_ptr<IndexerCommand>> getIndexerCommands(const RefreshInfo& info) const = 0;
-  virtual std::shared_ptr<Task> getPreIndexTask(std::shared_ptr<StorageProvider> storageProvider,
+  // indexerCommandProvider is the one getIndexerCommandProvider() returned for this refresh
+  virtual std::shared_ptr<Task> getPreIndexTask(const IndexerCommandProvider& indexerCommandProvider,
+                                                std::shared_ptr<StorageProvider> storageProvider,
                                                 std::shared_ptr<DialogView> dialogView) const;
 
   SourceGroupType getType() const;
@@ -0,0 +1,140 @@
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "FlatIntermediateStorage.h"
+#include "IntermediateStorage.h"
+#include "LocationType.h"
+
+namespace {
+
+using testing::IsEmpty;
+
+std::shared_ptr<IntermediateStorage> roundTrip(const IntermediateStorage& storage) {
+  const FlatIntermediateStorageWriter writer(storage);
+  // a vector of uint64_t guarantees the alignment the writer expects
+  std::vector<uint64_t> aligned((writer.getByteSize() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  writer.write(reinterpret_cast<char*>(aligned.data()));
+  return FlatIntermediateStorageView(reinterpret_cast<const char*>(aligned.data()), writer.getByteSize()).toIntermediateStorage();
+}
+
+TEST(FlatIntermediateStorageFix, emptyStorage) {
+  // Given:
+  const IntermediateStorage storage;
+  // When:
+  const auto result = roundTrip(storage);
+  // Then:
+  ASSERT_TRUE(result);
+  EXPECT_THAT(result->getStorageNodes(), IsEmpty());
+  EXPECT_THAT(result->getStorageFiles(), IsEmpty());
+  EXPECT_THAT(result->getStorageSourceLocations(), IsEmpty());
+  EXPECT_THAT(result->getErrors(), IsEmpty());
+  EXPECT_EQ(storage.getNextId(), result->getNextId());
+}
+
+TEST(FlatIntermediateStorageFix, nodesAndFiles) {
+  // Given:
+  IntermediateStorage storage;
+  storage.setStorageNodes({StorageNode{1, 2, L"ns::Foo"}, StorageNode{2, 4, L"ns::Foo::bär"}});
+  storage.setStorageFiles({StorageFile{3, L"main.cpp", L"cpp", "now", true, false}});
+  storage.setNextId(42);
+  // When:
+  const auto result = roundTrip(storage);
+  // Then:
+  ASSERT_TRUE(result);
+  const auto& nodes = result->getStorageNodes();
+  ASSERT_EQ(2, nodes.size());
+  EXPECT_EQ(1, nodes[0].id);
+  EXPECT_EQ(2, nodes[0].type);
+  EXPECT_EQ(L"ns::Foo", nodes[0].serializedName);
+  EXPECT_EQ(L"ns::Foo::bär", nodes[1].serializedName);
+
+  const auto& files = result->getStorageFiles();
+  ASSERT_EQ(1, files.size());
+  EXPECT_EQ(3, files[0].id);
+  EXPECT_EQ(L"main.cpp", files[0].filePath);
+  EXPECT_EQ(L"cpp", files[0].languageIdentifier);
+  EXPECT_TRUE(files[0].indexed);
+  EXPECT_FALSE(files[0].complete);
+
+  EXPECT_EQ(42, result->getNextId());
+}
+
+TEST(FlatIntermediateStorageFix, fileContents) {
+  // Given: one file with captured content and one without
+  IntermediateStorage storage;
+  storage.addFile(StorageFile{3, L"main.cpp", L"cpp", "", true, true});
+  storage.addFile(StorageFile{4, L"other.h", L"cpp", "", false, true});
+  storage.setFileContent(3, "int main() {\r\n  return 0;\r\n}");
+  // When:
+  const auto result = roundTrip(storage);
+  // Then: the content arrives with normalized line breaks
+  ASSERT_TRUE(result);
+  const auto& files = result->getStorageFiles();
+  ASSERT_EQ(2, files.size());
+  ASSERT_TRUE(files[0].content);
+  EXPECT_EQ("int main() {\n  return 0;\n}\n", *files[0].content);
+  EXPECT_FALSE(files[1].content);
+}
+
+TEST(FlatIntermediateStorageFix, setBasedMembers) {
+  // Given:
+  IntermediateStorage storage;
+  storage.setStorageLocalSymbols({StorageLocalSymbol{5, L"main.cpp<1:2>"}});
+  storage.setStorageSourceLocations({
+      StorageSourceLocation{6, 3, 1, 2, 1, 5, locationTypeToInt(LOCATION_TOKEN)},
+      StorageSourceLocation{7, 3, 4, 1, 4, 9, locationTypeToInt(LOCATION_SCOPE)},
+  });
+  storage.setStorageOccurrences({StorageOccurrence{1, 6}, StorageOccurrence{2, 7}});
+  storage.setComponentAccesses({StorageComponentAccess{2, 1}});
+  storage.setElementComponents({StorageElementComponent{1, 1, L"component"}});
+  // When:
+  const auto result = roundTrip(storage);
+  // Then:
+  ASSERT_TRUE(result);
+  EXPECT_EQ(storage.getStorageLocalSymbols().size(), result->getStorageLocalSymbols().size());
+  EXPECT_EQ(L"main.cpp<1:2>", result->getStorageLocalSymbols().begin()->name);
+  ASSERT_EQ(2, result->getStorageSourceLocations().size());
+  const auto& location = *result->getStorageSourceLocations().rbegin();
+  EXPECT_EQ(7, location.id);
+  EXPECT_EQ(4, location.startLine);
+  EXPECT_EQ(9, location.endCol);
+  EXPECT_EQ(locationTypeToInt(LOCATION_SCOPE), location.type);
+  EXPECT_EQ(storage.getStorageOccurrences().size(), result->getStorageOccurrences().size());
+  EXPECT_EQ(storage.getComponentAccesses().size(), result->getComponentAccesses().size());
+  ASSERT_EQ(1, result->getElementComponents().size());
+  EXPECT_EQ(L"component", result->getElementComponents().begin()->data);
+}
+
+TEST(FlatIntermediateStorageFix, errors) {
+  // Given:
+  IntermediateStorage storage;
+  storage.setErrors({{8, L"missing include", L"main.cpp", true, false}});
+  // When:
+  const auto result = roundTrip(storage);
+  // Then:
+  ASSERT_TRUE(result);
+  ASSERT_EQ(1, result->getErrors().size());
+  EXPECT_EQ(L"missing include", result->getErrors()[0].message);
+  EXPECT_EQ(L"main.cpp", result->getErrors()[0].translationUnit);
+  EXPECT_TRUE(result->getErrors()[0].fatal);
+  EXPECT_FALSE(result->getErrors()[0].indexed);
+}
+
+TEST(FlatIntermediateStorageFix, truncatedBufferIsInvalid) {
+  // Given:
+  IntermediateStorage storage;
+  storage.setStorageNodes({StorageNode{1, 2, L"Foo"}});
+  std::vector<uint64_t> aligned(64);
+  const FlatIntermediateStorageWriter writer(storage);
+  ASSERT_LE(writer.getByteSize(), aligned.size() * sizeof(uint64_t));
+  writer.write(reinterpret_cast<char*>(aligned.data()));
+  // When:
+  const FlatIntermediateStorageView view(reinterpret_cast<const char*>(aligned.data()), writer.getByteSize() - 1);
+  // Then:
+  EXPECT_FALSE(view.isValid());
+  EXPECT_FALSE(view.toIntermediateStorage());
+}
+
+}    // namespace
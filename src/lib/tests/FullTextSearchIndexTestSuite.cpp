@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "FullTextSearchIndex.h"
+
+TEST(FullTextSearchIndex, getTrigramsIsCaseInsensitiveAndUnique) {
+  EXPECT_EQ(FullTextSearchIndex::getTrigrams(L"abcABC"), FullTextSearchIndex::getTrigrams(L"ABCabc"));
+  EXPECT_EQ(3, FullTextSearchIndex::getTrigrams(L"abcabc").size());
+  EXPECT_TRUE(FullTextSearchIndex::getTrigrams(L"ab").empty());
+}
+
+TEST(FullTextSearchIndex, encodedTrigramsCanBeDecoded) {
+  const std::vector<FullTextSearchIndex::Trigram> trigrams = FullTextSearchIndex::getTrigrams(L"void foo() { return äö; }");
+
+  EXPECT_EQ(trigrams, FullTextSearchIndex::decodeTrigrams(FullTextSearchIndex::encodeTrigrams(trigrams)));
+  EXPECT_TRUE(FullTextSearchIndex::decodeTrigrams(FullTextSearchIndex::encodeTrigrams({})).empty());
+}
+
+TEST(FullTextSearchIndex, candidatesContainAllTrigramsOfTerm) {
+  FullTextSearchIndex index;
+  index.addFile(1, FullTextSearchIndex::getTrigrams(L"int foo = bar;"));
+  index.addFile(2, FullTextSearchIndex::getTrigrams(L"int baz = foo;"));
+  index.addFile(3, FullTextSearchIndex::getTrigrams(L"float bar;"));
+  index.finishSetup();
+
+  EXPECT_EQ(3, index.fileCount());
+  EXPECT_EQ(std::vector<Id>({1, 2}), index.getCandidateFileIds(L"FOO"));
+  EXPECT_EQ(std::vector<Id>({1}), index.getCandidateFileIds(L"int foo"));
+  EXPECT_TRUE(index.getCandidateFileIds(L"qux").empty());
+}
+
+TEST(FullTextSearchIndex, shortTermsMatchEveryFile) {
+  FullTextSearchIndex index;
+  index.addFile(2, FullTextSearchIndex::getTrigrams(L"int baz;"));
+  index.addFile(1, FullTextSearchIndex::getTrigrams(L"int foo;"));
+  index.finishSetup();
+
+  EXPECT_EQ(std::vector<Id>({1, 2}), index.getCandidateFileIds(L"xy"));
+
+  index.clear();
+  EXPECT_EQ(0, index.fileCount());
+  EXPECT_TRUE(index.getCandidateFileIds(L"foo").empty());
+}
+
+TEST(FullTextSearchIndex, findTermPositionsIsCaseInsensitive) {
+  EXPECT_EQ(std::vector<int>({0, 8, 12}), FullTextSearchIndex::findTermPositions(L"Foo bar foo FOO", L"foo"));
+  EXPECT_TRUE(FullTextSearchIndex::findTermPositions(L"Foo bar", L"baz").empty());
+}
+
+TEST(FullTextSearchIndex, filesCanBeAddedAfterSetup) {
+  FullTextSearchIndex index;
+  index.addFile(1, FullTextSearchIndex::getTrigrams(L"int foo;"));
+  index.finishSetup();
+  index.addFile(2, FullTextSearchIndex::getTrigrams(L"long foo;"));
+  index.finishSetup();
+
+  EXPECT_EQ(std::vector<Id>({1, 2}), index.getCandidateFileIds(L"foo"));
+  EXPECT_EQ(std::vector<Id>({2}), index.getCandidateFileIds(L"long"));
+}
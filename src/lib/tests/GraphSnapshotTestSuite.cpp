@@ -0,0 +1,90 @@
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "FilePath.h"
+#include "GraphSnapshot.h"
+
+namespace {
+
+class GraphSnapshotFix : public testing::Test {
+public:
+  void SetUp() override {
+    mFilePath = FilePath((std::filesystem::temp_directory_path() / "GraphSnapshotTestSuite.graph").wstring());
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(mFilePath.wstr());
+  }
+
+  bool writeSnapshot(uint64_t token) const {
+    return GraphSnapshot::write(
+        mFilePath,
+        token,
+        {StorageNode{3, 1, L"Baz"}, StorageNode{1, 1, L"Foo"}, StorageNode{2, 2, L"Bar"}},
+        {StorageEdge{10, 8, 1, 2}, StorageEdge{11, 1, 1, 3}, StorageEdge{12, 4, 3, 2}, StorageEdge{13, 4, 1, 99}});
+  }
+
+  FilePath mFilePath;
+};
+
+TEST_F(GraphSnapshotFix, nodesAndEdgesCanBeReadById) {
+  ASSERT_TRUE(writeSnapshot(7));
+  const auto snapshot = GraphSnapshot::open(mFilePath, 7);
+  ASSERT_TRUE(snapshot);
+
+  EXPECT_EQ(3, snapshot->getNodeCount());
+  EXPECT_EQ(4, snapshot->getEdgeCount());
+  EXPECT_EQ(L"Bar", snapshot->getNodeById(2).serializedName);
+  EXPECT_EQ(2, snapshot->getNodeType(2));
+  EXPECT_EQ(0, snapshot->getNodeById(42).id);
+  EXPECT_FALSE(snapshot->getNodeType(42));
+
+  const std::vector<StorageNode> nodes = snapshot->getNodesByIds({3, 42, 1});
+  ASSERT_EQ(2, nodes.size());
+  EXPECT_EQ(L"Baz", nodes[0].serializedName);
+  EXPECT_EQ(L"Foo", nodes[1].serializedName);
+
+  EXPECT_TRUE(snapshot->isEdge(12));
+  EXPECT_FALSE(snapshot->isEdge(1));
+  const std::vector<StorageEdge> edges = snapshot->getEdgesByIds({12});
+  ASSERT_EQ(1, edges.size());
+  EXPECT_EQ(3, edges[0].sourceNodeId);
+  EXPECT_EQ(2, edges[0].targetNodeId);
+}
+
+TEST_F(GraphSnapshotFix, adjacentEdgesAreOrderedByType) {
+  ASSERT_TRUE(writeSnapshot(7));
+  const auto snapshot = GraphSnapshot::open(mFilePath, 7);
+  ASSERT_TRUE(snapshot);
+
+  const std::vector<StorageEdge> outgoing = snapshot->getEdgesBySourceIds({1});
+  ASSERT_EQ(3, outgoing.size());
+  EXPECT_EQ(11, outgoing[0].id);
+  EXPECT_EQ(13, outgoing[1].id);
+  EXPECT_EQ(10, outgoing[2].id);
+
+  const std::vector<StorageEdge> incoming = snapshot->getEdgesByTargetIds({2});
+  ASSERT_EQ(2, incoming.size());
+  EXPECT_EQ(12, incoming[0].id);
+  EXPECT_EQ(10, incoming[1].id);
+
+  EXPECT_EQ(2, snapshot->getEdgesBySourceOrTargetId(3).size());
+
+  int memberEdgeCount = 0;
+  snapshot->forEachEdgeOfType(4, [&memberEdgeCount](const StorageEdge&) { memberEdgeCount++; });
+  EXPECT_EQ(2, memberEdgeCount);
+}
+
+TEST_F(GraphSnapshotFix, snapshotWithOtherTokenIsNotOpened) {
+  ASSERT_TRUE(writeSnapshot(7));
+
+  EXPECT_FALSE(GraphSnapshot::open(mFilePath, 8));
+  EXPECT_FALSE(GraphSnapshot::open(mFilePath, 0));
+}
+
+TEST_F(GraphSnapshotFix, missingSnapshotIsNotOpened) {
+  EXPECT_FALSE(GraphSnapshot::open(mFilePath, 7));
+}
+
+}    // namespace
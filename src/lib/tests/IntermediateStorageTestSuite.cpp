@@ -534,4 +534,55 @@ TEST(IntermediateStorageFix, SetNextId) {
   // Then: the symbols didn't change
   EXPECT_EQ(storage.getNextId(), 10);
 }
+
+TEST(IntermediateStorageFix, addNodeAfterSetStorageNodes) {
+  // Given: nodes were replaced as a whole
+  IntermediateStorage storage;
+  storage.setStorageNodes({StorageNode{5, 1, L"Foo"}, StorageNode{6, 1, L"Bar"}});
+  // When: a node with an existing name is added
+  const auto [id, inserted] = storage.addNode(StorageNodeData{2, L"Bar"});
+  // Then: the existing node is found through the rebuilt index
+  EXPECT_EQ(6, id);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(2, storage.getStorageNodes()[1].type);
+}
+
+TEST(IntermediateStorageFix, addManyNodesKeepsIndexValid) {
+  // Given: enough nodes to reallocate the node vector several times
+  IntermediateStorage storage;
+  for(int i = 0; i < 1000; i++) {
+    storage.addNode(StorageNodeData{1, L"node" + std::to_wstring(i)});
+  }
+  // When: every node is added again
+  size_t insertedCount = 0;
+  for(int i = 0; i < 1000; i++) {
+    insertedCount += storage.addNode(StorageNodeData{1, L"node" + std::to_wstring(i)}).second ? 1 : 0;
+  }
+  // Then: no duplicates were created
+  EXPECT_EQ(0, insertedCount);
+  EXPECT_EQ(1000, storage.getStorageNodes().size());
+}
+
+TEST(IntermediateStorageFix, addSameSourceLocationTwice) {
+  // Given: a source location exists
+  IntermediateStorage storage;
+  const StorageSourceLocationData location{3, 1, 2, 1, 5, locationTypeToInt(LOCATION_TOKEN)};
+  const Id firstId = storage.addSourceLocation(location);
+  // When: the same location is added again
+  const Id secondId = storage.addSourceLocation(location);
+  // Then: the existing id is returned
+  EXPECT_EQ(firstId, secondId);
+  EXPECT_EQ(1, storage.getSourceLocationCount());
+  EXPECT_EQ(firstId + 1, storage.getNextId());
+}
+
+TEST(IntermediateStorageFix, clearElementComponents) {
+  // Given: an element component exists
+  IntermediateStorage storage;
+  storage.addElementComponent(StorageElementComponent{1, 1, L"data"});
+  // When:
+  storage.clear();
+  // Then:
+  EXPECT_THAT(storage.getElementComponents(), IsEmpty());
+}
 }    // namespace
\ No newline at end of file
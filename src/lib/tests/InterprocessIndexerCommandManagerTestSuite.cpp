@@ -0,0 +1,64 @@
+#include <chrono>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "IndexerCommand.h"
+#include "InterprocessIndexerCommandManager.h"
+#include "ISharedMemoryGarbageCollector.hpp"
+#include "MockedSharedMemoryGarbageCollector.hpp"
+
+using namespace testing;
+
+struct InterprocessIndexerCommandManagerFix : Test {
+  void SetUp() override {
+    mGarbageCollector = std::make_shared<NiceMock<lib::MockedSharedMemoryGarbageCollector>>();
+    lib::ISharedMemoryGarbageCollector::setInstance(mGarbageCollector);
+    mManager = std::make_unique<InterprocessIndexerCommandManager>("icmd_test_uuid", 0, true);
+  }
+
+  void TearDown() override {
+    mManager.reset();
+    lib::ISharedMemoryGarbageCollector::setInstance(nullptr);
+    mGarbageCollector.reset();
+  }
+
+  std::shared_ptr<NiceMock<lib::MockedSharedMemoryGarbageCollector>> mGarbageCollector;
+  std::unique_ptr<InterprocessIndexerCommandManager> mManager;
+};
+
+TEST_F(InterprocessIndexerCommandManagerFix, waitForIndexerCommandTimesOutWhileQueueIsOpen) {
+  // When:
+  const auto command = mManager->waitForIndexerCommand(std::chrono::milliseconds(20));
+  // Then:
+  EXPECT_EQ(nullptr, command);
+  EXPECT_FALSE(mManager->isIndexerCommandQueueDrained());
+}
+
+TEST_F(InterprocessIndexerCommandManagerFix, stoppingTheQueueWakesWaitingIndexers) {
+  // Given: an indexer waiting for commands
+  const auto waitStart = std::chrono::steady_clock::now();
+  std::thread indexer([]() {
+    InterprocessIndexerCommandManager manager("icmd_test_uuid", 1, false);
+    EXPECT_EQ(nullptr, manager.waitForIndexerCommand(std::chrono::seconds(30)));
+    EXPECT_TRUE(manager.isIndexerCommandQueueDrained());
+  });
+  // When:
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  mManager->setIndexerCommandQueueStopped(true);
+  indexer.join();
+  // Then: the indexer returned long before its timeout
+  EXPECT_LT(std::chrono::steady_clock::now() - waitStart, std::chrono::seconds(10));
+}
+
+TEST_F(InterprocessIndexerCommandManagerFix, reopeningTheQueueKeepsIndexersWaiting) {
+  // Given:
+  mManager->setIndexerCommandQueueStopped(true);
+  ASSERT_TRUE(mManager->isIndexerCommandQueueDrained());
+  // When:
+  mManager->setIndexerCommandQueueStopped(false);
+  // Then:
+  EXPECT_FALSE(mManager->isIndexerCommandQueueDrained());
+  EXPECT_EQ(nullptr, mManager->waitForIndexerCommand(std::chrono::milliseconds(20)));
+}
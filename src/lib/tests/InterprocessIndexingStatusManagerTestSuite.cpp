@@ -0,0 +1,162 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "FilePath.h"
+#include "InterprocessIndexingStatusManager.h"
+#include "ISharedMemoryGarbageCollector.hpp"
+#include "MockedSharedMemoryGarbageCollector.hpp"
+
+using namespace testing;
+
+struct InterprocessIndexingStatusManagerFix : Test {
+  void SetUp() override {
+    mGarbageCollector = std::make_shared<NiceMock<lib::MockedSharedMemoryGarbageCollector>>();
+    lib::ISharedMemoryGarbageCollector::setInstance(mGarbageCollector);
+    mManager = std::make_unique<InterprocessIndexingStatusManager>("ists_test_uuid", 0, true);
+  }
+
+  void TearDown() override {
+    mManager.reset();
+    lib::ISharedMemoryGarbageCollector::setInstance(nullptr);
+    mGarbageCollector.reset();
+  }
+
+  std::shared_ptr<NiceMock<lib::MockedSharedMemoryGarbageCollector>> mGarbageCollector;
+  std::unique_ptr<InterprocessIndexingStatusManager> mManager;
+};
+
+TEST_F(InterprocessIndexingStatusManagerFix, claimIndexedHeaderOnlyOnce) {
+  // Given:
+  const FilePath headerPath(L"/tmp/project/header.h");
+  // When:
+  const bool firstClaim = mManager->claimIndexedHeader(headerPath, 1);
+  const bool secondClaim = mManager->claimIndexedHeader(headerPath, 1);
+  // Then:
+  EXPECT_TRUE(firstClaim);
+  EXPECT_FALSE(secondClaim);
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, claimIndexedHeaderDependsOnPreprocessorContext) {
+  // Given:
+  const FilePath headerPath(L"/tmp/project/header.h");
+  ASSERT_TRUE(mManager->claimIndexedHeader(headerPath, 1));
+  // When:
+  const bool result = mManager->claimIndexedHeader(headerPath, 2);
+  // Then:
+  EXPECT_TRUE(result);
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, clearIndexedHeadersAllowsNewClaim) {
+  // Given:
+  const FilePath headerPath(L"/tmp/project/header.h");
+  ASSERT_TRUE(mManager->claimIndexedHeader(headerPath, 1));
+  // When:
+  mManager->clearIndexedHeaders();
+  // Then:
+  EXPECT_TRUE(mManager->claimIndexedHeader(headerPath, 1));
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, claimManyHeadersGrowsMemory) {
+  // Given:
+  constexpr int HeaderCount = 20000;
+  // When:
+  int claimedCount = 0;
+  for(int i = 0; i < HeaderCount; ++i) {
+    if(mManager->claimIndexedHeader(FilePath(L"/tmp/project/header_" + std::to_wstring(i) + L".h"), 0)) {
+      ++claimedCount;
+    }
+  }
+  // Then:
+  EXPECT_EQ(HeaderCount, claimedCount);
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, claimsOfCrashedTranslationUnitAreReleasedOnRestart) {
+  // Given:
+  InterprocessIndexingStatusManager indexer("ists_test_uuid", 1, false);
+  const FilePath headerPath(L"/tmp/project/header.h");
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/crashed.cpp"));
+  ASSERT_TRUE(indexer.claimIndexedHeader(headerPath, 1));
+  // When:
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/next.cpp"));
+  // Then:
+  EXPECT_TRUE(indexer.claimIndexedHeader(headerPath, 1));
+  EXPECT_TRUE(mManager->popLostHeaderPaths().empty());
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, headerOfCrashedTranslationUnitIsLostIfNotClaimedAgain) {
+  // Given:
+  InterprocessIndexingStatusManager indexer("ists_test_uuid", 1, false);
+  const FilePath headerPath(L"/tmp/project/header.h");
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/crashed.cpp"));
+  ASSERT_TRUE(indexer.claimIndexedHeader(headerPath, 1));
+  // When:
+  const std::vector<FilePath> crashedFiles = mManager->getCrashedSourceFilePaths();
+  // Then:
+  EXPECT_THAT(crashedFiles, ElementsAre(FilePath(L"/tmp/project/crashed.cpp")));
+  EXPECT_THAT(mManager->popLostHeaderPaths(), ElementsAre(headerPath));
+  EXPECT_TRUE(mManager->popLostHeaderPaths().empty());
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, claimsOfTranslationUnitWithoutStorageAreReleased) {
+  // Given:
+  InterprocessIndexingStatusManager indexer("ists_test_uuid", 1, false);
+  const FilePath headerPath(L"/tmp/project/header.h");
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/main.cpp"));
+  ASSERT_TRUE(indexer.claimIndexedHeader(headerPath, 1));
+  // When:
+  indexer.finishIndexingSourceFile(10, 0);
+  // Then:
+  EXPECT_TRUE(mManager->claimIndexedHeader(headerPath, 1));
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, releasingClaimsKeepsClaimsOfFetchedStorages) {
+  // Given:
+  InterprocessIndexingStatusManager indexer("ists_test_uuid", 1, false);
+  const FilePath fetchedHeaderPath(L"/tmp/project/fetched.h");
+  const FilePath droppedHeaderPath(L"/tmp/project/dropped.h");
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/a.cpp"));
+  ASSERT_TRUE(indexer.claimIndexedHeader(fetchedHeaderPath, 1));
+  indexer.finishIndexingSourceFile(10, 100);
+  indexer.startIndexingSourceFile(FilePath(L"/tmp/project/b.cpp"));
+  ASSERT_TRUE(indexer.claimIndexedHeader(droppedHeaderPath, 1));
+  indexer.finishIndexingSourceFile(10, 100);
+  mManager->confirmHeaderClaims(1);
+  // When:
+  mManager->releaseHeaderClaims();
+  // Then:
+  EXPECT_THAT(mManager->popLostHeaderPaths(), ElementsAre(droppedHeaderPath));
+  EXPECT_FALSE(mManager->claimIndexedHeader(fetchedHeaderPath, 1));
+  EXPECT_TRUE(mManager->claimIndexedHeader(droppedHeaderPath, 1));
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, finishIndexingSourceFileRecordsCost) {
+  // Given:
+  const FilePath sourcePath(L"/tmp/project/main.cpp");
+  mManager->startIndexingSourceFile(sourcePath);
+  // When:
+  mManager->finishIndexingSourceFile(1500, 4096);
+  const auto costs = mManager->popIndexingCosts();
+  // Then:
+  ASSERT_EQ(1, costs.size());
+  EXPECT_EQ(0, costs[0].first);
+  EXPECT_EQ(sourcePath.wstr(), costs[0].second.filePath);
+  EXPECT_EQ(1500, costs[0].second.durationMs);
+  EXPECT_EQ(4096, costs[0].second.storageSize);
+  EXPECT_TRUE(mManager->popIndexingCosts().empty());
+  EXPECT_TRUE(mManager->getCrashedSourceFilePaths().empty());
+}
+
+TEST_F(InterprocessIndexingStatusManagerFix, reportedIndexerLifetimesArePoppedOnce) {
+  // Given:
+  mManager->reportIndexerLifetime({3, 120, 250, 60000, 1500});
+  // When:
+  const auto lifetimes = mManager->popIndexerLifetimes();
+  // Then:
+  ASSERT_EQ(1, lifetimes.size());
+  EXPECT_EQ(3, lifetimes[0].processId);
+  EXPECT_EQ(120, lifetimes[0].translationUnitCount);
+  EXPECT_EQ(250, lifetimes[0].startupMs);
+  EXPECT_EQ(60000, lifetimes[0].busyMs);
+  EXPECT_EQ(1500, lifetimes[0].waitingMs);
+  EXPECT_TRUE(mManager->popIndexerLifetimes().empty());
+}
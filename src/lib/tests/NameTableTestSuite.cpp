@@ -0,0 +1,80 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "NameTable.h"
+
+namespace {
+
+TEST(NameTable, equalNamesShareOneHandle) {
+  NameTable table;
+
+  const auto [fooHandle, fooAdded] = table.intern("Foo");
+  const auto [barHandle, barAdded] = table.intern("Bar");
+  const auto [againHandle, againAdded] = table.intern(std::string("Foo"));
+
+  EXPECT_TRUE(fooAdded);
+  EXPECT_TRUE(barAdded);
+  EXPECT_FALSE(againAdded);
+  EXPECT_EQ(0, fooHandle);
+  EXPECT_EQ(1, barHandle);
+  EXPECT_EQ(fooHandle, againHandle);
+  EXPECT_EQ(2, table.size());
+  EXPECT_EQ(barHandle, table.find("Bar"));
+  EXPECT_FALSE(table.find("Baz").has_value());
+}
+
+TEST(NameTable, storedNamesStayValidWhileTheTableGrows) {
+  NameTable table;
+  const std::string longName(100000, 'x');
+
+  const NameTable::Handle first = table.intern("Gr\xC3\xBC\xC3\x9F" "e").first;
+  const std::string_view firstName = table.get(first);
+  const NameTable::Handle longHandle = table.intern(longName).first;
+  for(int i = 0; i < 20000; ++i) {
+    table.intern("name" + std::to_string(i));
+  }
+
+  EXPECT_EQ(firstName.data(), table.get(first).data());
+  EXPECT_EQ("Gr\xC3\xBC\xC3\x9F" "e", table.get(first));
+  EXPECT_EQ(longName, table.get(longHandle));
+  EXPECT_EQ("name19999", table.get(table.find("name19999").value()));
+  EXPECT_EQ(20002, table.size());
+}
+
+TEST(NameTable, memoryStaysCloseToTheNameText) {
+  NameTable table;
+  size_t textSize = 0;
+  for(int i = 0; i < 100000; ++i) {
+    const std::string name = "\tmns" + std::to_string(i % 40) + "\ts\tp\tnClass" + std::to_string(i % 3000) + "\ts\tp\tnmethod" +
+        std::to_string(i) + "\ts(int)\tp";
+    textSize += name.size();
+    table.intern(name);
+  }
+
+  // each name is stored once, plus a view, a hash node and a bucket of bookkeeping
+  EXPECT_GE(table.getByteSize(), textSize);
+  EXPECT_LE(table.getByteSize(), textSize + table.size() * 80);
+}
+
+TEST(NameTable, emptyNameIsAName) {
+  NameTable table;
+
+  EXPECT_TRUE(table.intern("").second);
+  EXPECT_FALSE(table.intern("").second);
+  EXPECT_EQ("", table.get(0));
+}
+
+TEST(NameTable, clearStartsOverAtHandleZero) {
+  NameTable table;
+  table.intern("Foo");
+  table.intern("Bar");
+
+  table.clear();
+
+  EXPECT_TRUE(table.empty());
+  EXPECT_FALSE(table.find("Foo").has_value());
+  EXPECT_EQ(0, table.intern("Bar").first);
+}
+
+}    // namespace
@@ -1,8 +1,12 @@
+#include <random>
+#include <unordered_set>
+
 #include <gtest/gtest.h>
 
 #include "NameHierarchy.h"
 #include "SearchIndex.h"
 #include "utility.h"
+#include "utilityString.h"
 
 TEST(SearchIndex, searchIndexFindsIdOfElementAdded) {
   SearchIndex index;
@@ -82,3 +86,135 @@ TEST(SearchIndex, searchIndexRatesHigherOnConsecutiveLetters) {
   EXPECT_TRUE(L"ocbcabc" == results[0].text);
   EXPECT_TRUE(L"oaabbcc" == results[1].text);
 }
+
+TEST(SearchIndex, searchIndexDoesNotFindRemovedNodes) {
+  SearchIndex index;
+  index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo\tsvoid\tp() const").getQualifiedName());
+  index.addNode(2, NameHierarchy::deserialize(L"::\tmfoobar\tsvoid\tp() const").getQualifiedName());
+  index.finishSetup();
+  index.removeNodes({2});
+  std::vector<SearchResult> results = index.search(L"oo", NodeTypeSet::all(), 0);
+
+  EXPECT_TRUE(1 == results.size());
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 1));
+  EXPECT_TRUE(index.search(L"bar", NodeTypeSet::all(), 0).empty());
+}
+
+TEST(SearchIndex, searchIndexJoinsEdgesLeftByRemovedNodes) {
+  SearchIndex index;
+  index.addNode(1, L"foobar");
+  index.addNode(2, L"foobaz");
+  index.finishSetup();
+  index.removeNodes({1});
+
+  EXPECT_TRUE(index.search(L"r", NodeTypeSet::all(), 0).empty());
+  std::vector<SearchResult> results = index.search(L"fbz", NodeTypeSet::all(), 0);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(L"foobaz", results[0].text);
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 2));
+
+  index.addNode(3, L"foobar");
+  results = index.search(L"br", NodeTypeSet::all(), 0);
+  ASSERT_EQ(1, results.size());
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 3));
+}
+
+TEST(SearchIndex, searchIndexFindsNodesAddedAfterSetup) {
+  SearchIndex index;
+  index.addNode(1, NameHierarchy::deserialize(L"::\tmfoo\tsvoid\tp() const").getQualifiedName());
+  index.finishSetup();
+  index.addNode(2, NameHierarchy::deserialize(L"::\tmfoxtrot\tsvoid\tp() const").getQualifiedName());
+  index.finishSetup();
+  std::vector<SearchResult> results = index.search(L"xt", NodeTypeSet::all(), 0);
+
+  EXPECT_TRUE(1 == results.size());
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 2));
+}
+
+TEST(SearchIndex, searchIndexFindsNonAsciiCharacters) {
+  SearchIndex index;
+  index.addNode(1, L"Gr\u00FC\u00DFe");
+  index.addNode(2, L"Grenze");
+  index.finishSetup();
+  std::vector<SearchResult> results = index.search(L"\u00FCe", NodeTypeSet::all(), 0);
+
+  EXPECT_TRUE(1 == results.size());
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 1));
+}
+
+namespace {
+std::wstring createSymbolName(std::mt19937& random) {
+  static const std::vector<std::wstring> parts = {L"get", L"set", L"Value", L"Node", L"Edge", L"Graph", L"Index", L"Search",
+                                                  L"Storage", L"Sqlite", L"Tab", L"View", L"Controller", L"Widget", L"impl"};
+  std::wstring name;
+  const size_t partCount = 1 + random() % 5;
+  for(size_t i = 0; i < partCount; i++) {
+    if(i > 0 && random() % 2 == 0) {
+      name += L"::";
+    }
+    name += parts[random() % parts.size()];
+    if(random() % 3 == 0) {
+      name += std::to_wstring(random() % 100);
+    }
+  }
+  return name;
+}
+}    // namespace
+
+TEST(SearchIndex, searchIndexFindsNodesOfLargeIndex) {
+  // large enough for the root subtrees to be searched in parallel
+  std::mt19937 random(1);
+  SearchIndex index;
+  for(Id id = 1; id <= 100000; id++) {
+    index.addNode(id, createSymbolName(random));
+  }
+  index.addNode(100001, L"zzTarget");
+  index.finishSetup();
+  std::vector<SearchResult> results = index.search(L"zzt", NodeTypeSet::all(), 0);
+
+  EXPECT_TRUE(1 == results.size());
+  EXPECT_TRUE(utility::containsElement<Id>(results[0].elementIds, 100001));
+}
+
+TEST(SearchIndex, searchIndexWithRemovedNodesFindsSameResultsAsRebuiltIndex) {
+  // Given:
+  std::mt19937 random(2);
+  std::vector<std::wstring> names;
+  for(size_t i = 0; i < 20000; i++) {
+    names.push_back(createSymbolName(random));
+  }
+
+  SearchIndex index;
+  std::unordered_set<Id> removedIds;
+  for(size_t i = 0; i < names.size(); i++) {
+    index.addNode(static_cast<Id>(i + 1), names[i]);
+    if(i % 3 == 0) {
+      removedIds.insert(static_cast<Id>(i + 1));
+    }
+  }
+  index.finishSetup();
+
+  SearchIndex rebuiltIndex;
+  for(size_t i = 0; i < names.size(); i++) {
+    if(!removedIds.contains(static_cast<Id>(i + 1))) {
+      rebuiltIndex.addNode(static_cast<Id>(i + 1), names[i]);
+    }
+  }
+  rebuiltIndex.finishSetup();
+
+  // When:
+  index.removeNodes(removedIds);
+
+  // Then:
+  for(const std::wstring query : {L"gv", L"tabc1", L"sqlite::impl", L"w"}) {
+    const std::vector<SearchResult> results = index.search(query, NodeTypeSet::all(), 0);
+    const std::vector<SearchResult> rebuiltResults = rebuiltIndex.search(query, NodeTypeSet::all(), 0);
+
+    ASSERT_EQ(rebuiltResults.size(), results.size());
+    for(size_t i = 0; i < results.size(); i++) {
+      EXPECT_EQ(rebuiltResults[i].text, results[i].text);
+      EXPECT_EQ(rebuiltResults[i].elementIds, results[i].elementIds);
+      EXPECT_EQ(rebuiltResults[i].score, results[i].score);
+    }
+  }
+}
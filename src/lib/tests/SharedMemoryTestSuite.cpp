@@ -100,3 +100,46 @@ TEST_F(SharedMemoryFixture, goodCase) {
     }
   }
 }
+
+TEST_F(SharedMemoryFixture, waitForChangeWakesOnNotify) {
+  EXPECT_CALL(*mSharedMemoryGarbageCollector, registerSharedMemory).WillOnce(Return());
+  EXPECT_CALL(*mSharedMemoryGarbageCollector, unregisterSharedMemory).WillOnce(Return());
+
+  SharedMemory memory("waiting", 1000, SharedMemory::CREATE_AND_DELETE);
+
+  std::thread notifier([]() {
+    SharedMemory memory_("waiting", 0, SharedMemory::OPEN_ONLY);
+    SharedMemory::ScopedAccess access(&memory_);
+    access.growMemory(4000);
+    *access.accessValue<int>("value") = 42;
+    access.notifyAll();
+  });
+
+  bool notified = false;
+  {
+    SharedMemory::ScopedAccess access(&memory);
+    while(*access.accessValue<int>("value") != 42) {
+      notified = access.waitForChange(std::chrono::seconds(10));
+      if(!notified) {
+        break;
+      }
+    }
+
+    // the memory grown while waiting is mapped again
+    EXPECT_EQ(5000, access.getMemorySize());
+  }
+  notifier.join();
+
+  EXPECT_TRUE(notified);
+}
+
+TEST_F(SharedMemoryFixture, waitForChangeTimesOut) {
+  EXPECT_CALL(*mSharedMemoryGarbageCollector, registerSharedMemory).WillOnce(Return());
+  EXPECT_CALL(*mSharedMemoryGarbageCollector, unregisterSharedMemory).WillOnce(Return());
+
+  SharedMemory memory("timeout", 1000, SharedMemory::CREATE_AND_DELETE);
+  SharedMemory::ScopedAccess access(&memory);
+
+  EXPECT_FALSE(access.waitForChange(std::chrono::milliseconds(20)));
+  EXPECT_EQ(0, *access.accessValue<int>("value"));
+}
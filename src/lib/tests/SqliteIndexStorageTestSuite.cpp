@@ -0,0 +1,534 @@
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "FilePath.h"
+#include "FullTextSearchIndex.h"
+#include "LocationType.h"
+#include "ScopedTemporaryFile.hpp"
+#include "SourceLocation.h"
+#include "SourceLocationCollection.h"
+#include "SourceLocationFile.h"
+#include "SqliteIndexStorage.h"
+#include "TextAccess.h"
+
+namespace {
+
+class SqliteIndexStorageFix : public testing::Test {
+public:
+  void SetUp() override {
+    mStorage.setup();
+  }
+
+  SqliteIndexStorage mStorage;
+};
+
+TEST_F(SqliteIndexStorageFix, bulkLoadAssignsSequentialIds) {
+  // Given: the storage is in bulk load mode
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+  // When: nodes and an edge between them are added
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Bar"}});
+  const Id edgeId = mStorage.addEdge(StorageEdgeData{1, nodeIds[0], nodeIds[1]});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: ids are unique and everything can be read back
+  ASSERT_EQ(2, nodeIds.size());
+  EXPECT_EQ(nodeIds[0] + 1, nodeIds[1]);
+  EXPECT_EQ(nodeIds[1] + 1, edgeId);
+  EXPECT_EQ(L"Bar", mStorage.getNodeById(nodeIds[1]).serializedName);
+  EXPECT_EQ(nodeIds[0], mStorage.getEdgeById(edgeId).sourceNodeId);
+  EXPECT_EQ(2, mStorage.getNodeCount());
+  EXPECT_EQ(1, mStorage.getEdgeCount());
+}
+
+TEST_F(SqliteIndexStorageFix, bulkLoadDeduplicatesNodes) {
+  // Given: the storage is in bulk load mode
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+  const Id firstId = mStorage.addNode(StorageNodeData{1, L"Foo"});
+  // When: the same node is added again
+  const Id secondId = mStorage.addNode(StorageNodeData{1, L"Foo"});
+  // Then: the existing id is returned
+  EXPECT_EQ(firstId, secondId);
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  EXPECT_EQ(1, mStorage.getNodeCount());
+}
+
+TEST_F(SqliteIndexStorageFix, bulkLoadSourceLocationsContinueAfterWriteMode) {
+  // Given: a file node and a source location written in the regular write mode
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const Id fileId = mStorage.addNode(StorageNodeData{1, L"main.cpp"});
+  const Id firstLocationId = mStorage.addSourceLocation(
+      StorageSourceLocationData{fileId, 1, 1, 1, 5, locationTypeToInt(LOCATION_TOKEN)});
+  // When: more source locations are added in bulk load mode
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+  const std::vector<Id> locationIds = mStorage.addSourceLocations({
+      StorageSourceLocation{0, fileId, 2, 1, 2, 5, locationTypeToInt(LOCATION_TOKEN)},
+      StorageSourceLocation{0, fileId, 3, 1, 3, 5, locationTypeToInt(LOCATION_TOKEN)},
+  });
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: the in memory ids match the rows in the database
+  ASSERT_EQ(2, locationIds.size());
+  EXPECT_EQ(firstLocationId + 1, locationIds[0]);
+  EXPECT_EQ(firstLocationId + 2, locationIds[1]);
+  EXPECT_EQ(3, mStorage.getSourceLocationCount());
+  EXPECT_EQ(3, mStorage.getFirstById<StorageSourceLocation>(locationIds[1]).startLine);
+}
+
+TEST_F(SqliteIndexStorageFix, contentHashIsStoredForIndexedFiles) {
+  // Given: an indexed and a non-indexed file on disk
+  const auto indexedFile = utility::ScopedTemporaryFile::createFile(
+      std::filesystem::temp_directory_path() / "SqliteIndexStorageIndexed.cpp", "int a;\r\nint b;\n");
+  const auto nonIndexedFile = utility::ScopedTemporaryFile::createFile(
+      std::filesystem::temp_directory_path() / "SqliteIndexStorageNonIndexed.h", "int c;\n");
+  ASSERT_TRUE(indexedFile && nonIndexedFile);
+  const std::wstring indexedPath = indexedFile->getFilePath().wstring();
+  const std::wstring nonIndexedPath = nonIndexedFile->getFilePath().wstring();
+
+  // When: both are added to the storage
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const Id indexedId = mStorage.addNode(StorageNodeData{1, L"indexed"});
+  const Id nonIndexedId = mStorage.addNode(StorageNodeData{1, L"nonIndexed"});
+  ASSERT_TRUE(mStorage.addFile(StorageFile{indexedId, indexedPath, L"cpp", "", true, true}));
+  ASSERT_TRUE(mStorage.addFile(StorageFile{nonIndexedId, nonIndexedPath, L"cpp", "", false, true}));
+  EXPECT_EQ(1, mStorage.addMissingFileContentsFromDisk());
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+  // Then: only the indexed file has a hash, and it matches the content on disk
+  const auto contentHashes = mStorage.getFileContentHashes();
+  ASSERT_EQ(1, contentHashes.size());
+  EXPECT_EQ(indexedPath, contentHashes[0].first);
+  EXPECT_EQ(TextAccess::createFromFile(FilePath(indexedPath))->getContentHash(), contentHashes[0].second);
+}
+
+TEST_F(SqliteIndexStorageFix, indexedFileWithoutCapturedContentIsReadFromDisk) {
+  // Given: an indexed file on disk whose content was not captured by the indexer
+  const std::string content = "int first_variable;\nint second_variable;\nint third_variable;\n";
+  const auto diskFile = utility::ScopedTemporaryFile::createFile(
+      std::filesystem::temp_directory_path() / "SqliteIndexStorageUncaptured.cpp", content);
+  ASSERT_TRUE(diskFile);
+  StorageFile file{0, diskFile->getFilePath().wstring(), L"cpp", "2020-01-01 00:00:00", true, true};
+
+  // When: it is added to the storage, which leaves its content to the end of indexing
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  file.id = mStorage.addNode(StorageNodeData{1, L"file"});
+  ASSERT_TRUE(mStorage.addFile(file));
+  EXPECT_FALSE(mStorage.hasFileContent(file.id));
+  EXPECT_EQ(1, mStorage.addMissingFileContentsFromDisk());
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+  // Then: its lines and content are read back from the storage
+  EXPECT_THAT(mStorage.getFileLinesByPath(file.filePath, 1, 3),
+              testing::ElementsAre("int first_variable;\n", "int second_variable;\n", "int third_variable;\n"));
+  EXPECT_EQ(content, mStorage.getFileContentById(file.id)->getText());
+  EXPECT_EQ(TextAccess::createFromString(content)->getContentHash(), mStorage.getFileContentHashes().at(0).second);
+}
+
+TEST_F(SqliteIndexStorageFix, capturedFileContentIsStoredInsteadOfTheFileOnDisk) {
+  // Given: an indexed file whose content was captured by the indexer
+  StorageFile file{0, L"/tmp/SqliteIndexStorageMissing.cpp", L"cpp", "2020-01-01 00:00:00", true, true};
+  file.content = std::make_shared<const std::string>("int a;\nint b;\n");
+
+  // When: it is added to the storage
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  file.id = mStorage.addNode(StorageNodeData{1, L"file"});
+  ASSERT_TRUE(mStorage.addFile(file));
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+  // Then: the content is read back without the file existing on disk
+  EXPECT_EQ(*file.content, mStorage.getFileContentById(file.id)->getText());
+  EXPECT_EQ(*file.content, mStorage.getFileContentByPath(file.filePath)->getText());
+  EXPECT_EQ(TextAccess::createFromString(*file.content)->getContentHash(), mStorage.getFileContentHashes().at(0).second);
+}
+
+TEST_F(SqliteIndexStorageFix, fileLinesAreReadAcrossContentBlocks) {
+  // Given: a file large enough for several content blocks
+  std::string content;
+  for(int line = 1; line <= 20000; line++) {
+    content += "int variable" + std::to_string(line) + ";\n";
+  }
+  StorageFile file{0, L"/tmp/large.cpp", L"cpp", "2020-01-01 00:00:00", true, true};
+  file.content = std::make_shared<const std::string>(content);
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  file.id = mStorage.addNode(StorageNodeData{1, L"file"});
+  ASSERT_TRUE(mStorage.addFile(file));
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+
+  // When: line ranges within and across blocks are read
+  const auto allLines = TextAccess::createFromString(content)->getAllLines();
+  // Then: they match the lines of the whole content
+  for(const auto& [firstLine, lastLine] :
+      std::vector<std::pair<uint32_t, uint32_t>>{{1, 1}, {1, 3}, {1900, 2300}, {9999, 10001}, {19990, 20000}, {20000, 20000}}) {
+    const std::vector<std::string> lines = mStorage.getFileLinesByPath(file.filePath, firstLine, lastLine);
+    EXPECT_THAT(lines, testing::ElementsAreArray(allLines.begin() + firstLine - 1, allLines.begin() + lastLine));
+  }
+  EXPECT_TRUE(mStorage.getFileLinesByPath(file.filePath, 20001, 20001).empty());
+  EXPECT_TRUE(mStorage.getFileLinesByPath(file.filePath, 0, 1).empty());
+  EXPECT_EQ(content, mStorage.getFileContentByPath(file.filePath)->getText());
+}
+
+TEST_F(SqliteIndexStorageFix, fileContentIsSharedByHashAndDeletedWithTheLastFile) {
+  // Given: two files with the same content
+  const auto content = std::make_shared<const std::string>("int a;\n");
+  StorageFile first{0, L"/tmp/first.h", L"cpp", "2020-01-01 00:00:00", true, true};
+  StorageFile second{0, L"/tmp/second.h", L"cpp", "2020-01-01 00:00:00", true, true};
+  first.content = second.content = content;
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  first.id = mStorage.addNode(StorageNodeData{1, L"first"});
+  second.id = mStorage.addNode(StorageNodeData{1, L"second"});
+  ASSERT_TRUE(mStorage.addFile(first));
+  // the blocks are keyed by hash and first line, storing them twice would fail the insert
+  ASSERT_TRUE(mStorage.addFile(second));
+
+  // When: they are removed one after the other
+  // Then: the content stays until the last file is removed
+  mStorage.removeElement(first.id);
+  EXPECT_EQ(*content, mStorage.getFileContentById(second.id)->getText());
+  mStorage.removeElement(second.id);
+  EXPECT_TRUE(mStorage.getFileLinesByPath(second.filePath, 1, 1).empty());
+}
+
+TEST_F(SqliteIndexStorageFix, indexingCostsReplaceEarlierRecords) {
+  // Given: the cost of two translation units was recorded
+  mStorage.setIndexingCosts({StorageIndexingCost{L"/tmp/a.cpp", 120, 4096}, StorageIndexingCost{L"/tmp/b.cpp", 30, 512}});
+  // When: one of them is indexed again
+  mStorage.setIndexingCosts({StorageIndexingCost{L"/tmp/a.cpp", 80, 2048}});
+  // Then: only the latest record of each path is returned
+  auto costs = mStorage.getIndexingCosts();
+  std::ranges::sort(costs, {}, &StorageIndexingCost::filePath);
+  ASSERT_EQ(2, costs.size());
+  EXPECT_EQ(L"/tmp/a.cpp", costs[0].filePath);
+  EXPECT_EQ(80, costs[0].durationMs);
+  EXPECT_EQ(2048, costs[0].storageSize);
+  EXPECT_EQ(L"/tmp/b.cpp", costs[1].filePath);
+  EXPECT_EQ(30, costs[1].durationMs);
+}
+
+TEST_F(SqliteIndexStorageFix, idListQueriesAreNotLimitedByStatementSize) {
+  // Given: more nodes than SQLite allows bound parameters in one statement
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_BULK_LOAD);
+  std::vector<StorageNode> nodes;
+  for(size_t i = 0; i < 40000; i++) {
+    nodes.emplace_back(0, 1, L"Node" + std::to_wstring(i));
+  }
+  std::vector<Id> nodeIds = mStorage.addNodes(nodes);
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: all of them are requested, some of them twice
+  nodeIds.push_back(nodeIds.front());
+  // Then: every node is returned once
+  EXPECT_EQ(40000, mStorage.getAllByIds<StorageNode>(nodeIds).size());
+}
+
+TEST_F(SqliteIndexStorageFix, nestedIdListQueriesDoNotInterfere) {
+  // Given: two nodes with an edge between them
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Bar"}});
+  const Id edgeId = mStorage.addEdge(StorageEdgeData{1, nodeIds[0], nodeIds[1]});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: the edges of each node are queried while the nodes are iterated
+  std::vector<Id> visitedNodeIds;
+  std::vector<Id> edgeIds;
+  mStorage.forEachByIds<StorageNode>(nodeIds, [&](StorageNode&& node) {
+    visitedNodeIds.push_back(node.id);
+    for(const StorageEdge& edge : mStorage.getEdgesBySourceIds({node.id})) {
+      edgeIds.push_back(edge.id);
+    }
+  });
+  // Then: the outer iteration sees all nodes
+  EXPECT_THAT(visitedNodeIds, testing::UnorderedElementsAreArray(nodeIds));
+  EXPECT_THAT(edgeIds, testing::ElementsAre(edgeId));
+}
+
+TEST_F(SqliteIndexStorageFix, contentCapturedAfterTheFileWasAddedIsStored) {
+  // Given: an indexed file that is not on disk, added first without content
+  const std::string content = "int a;\nint b;";
+  StorageFile file{0, L"/tmp/SqliteIndexStorageNotOnDisk.h", L"cpp", "2020-01-01 00:00:00", true, true};
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  file.id = mStorage.addNode(StorageNodeData{1, file.filePath});
+  ASSERT_TRUE(mStorage.addFile(file));
+  // When: the captured content arrives later
+  ASSERT_TRUE(mStorage.setFileContent(file.id, content));
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: the captured content is stored and nothing is left to read from disk
+  EXPECT_TRUE(mStorage.hasFileContent(file.id));
+  EXPECT_EQ(0, mStorage.addMissingFileContentsFromDisk());
+  EXPECT_THAT(mStorage.getFileLinesByPath(file.filePath, 1, 2), testing::ElementsAre("int a;\n", "int b;"));
+  EXPECT_EQ(TextAccess::createFromString(content)->getContentHash(), mStorage.getFileContentHashes().at(0).second);
+}
+
+TEST_F(SqliteIndexStorageFix, indexedFilesWithoutTrigramsOfACodecAreListed) {
+  // Given: two indexed files and one non-indexed file
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  std::vector<Id> fileIds;
+  for(const wchar_t* path : {L"/tmp/a.cpp", L"/tmp/b.cpp", L"/tmp/c.h"}) {
+    const Id fileId = mStorage.addNode(StorageNodeData{1, path});
+    StorageFile file{fileId, path, L"cpp", "2020-01-01 00:00:00", fileIds.size() < 2, true};
+    file.content = std::make_shared<const std::string>("int a;\n");
+    ASSERT_TRUE(mStorage.addFile(file));
+    fileIds.push_back(fileId);
+  }
+  // When: trigrams of the first file are stored for one codec
+  mStorage.addFullTextSearchTrigrams({{fileIds[0], FullTextSearchIndex::encodeTrigrams({1, 2})}}, "UTF-8");
+  // Then: only the other indexed file lacks them for that codec, both lack them for another one
+  EXPECT_THAT(mStorage.getIndexedFileIdsWithoutFullTextSearchTrigrams("UTF-8"), testing::ElementsAre(fileIds[1]));
+  EXPECT_THAT(mStorage.getIndexedFileIdsWithoutFullTextSearchTrigrams("ISO 8859-1"),
+              testing::UnorderedElementsAre(fileIds[0], fileIds[1]));
+}
+
+TEST_F(SqliteIndexStorageFix, filePathsAreBoundAsParameters) {
+  // Given: a file whose path contains a quote
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const Id fileId = mStorage.addNode(StorageNodeData{1, L"file"});
+  ASSERT_TRUE(mStorage.addFile(StorageFile{fileId, L"/tmp/it's.cpp", L"cpp", "2020-01-01 00:00:00", false, true}));
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: it can be found by its path
+  EXPECT_EQ(fileId, mStorage.getFileByPath(L"/tmp/it's.cpp").id);
+  EXPECT_EQ(1, mStorage.getFilesByPaths({FilePath(L"/tmp/it's.cpp"), FilePath(L"/tmp/other.cpp")}).size());
+}
+
+TEST_F(SqliteIndexStorageFix, filesAreFoundByPathsOverSeveralBatches) {
+  // Given: more files than one query binds paths for
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  std::vector<FilePath> paths;
+  std::set<Id> fileIds;
+  for(int i = 0; i < 600; i++) {
+    const std::wstring path = L"/tmp/file_" + std::to_wstring(i) + L".cpp";
+    const Id fileId = mStorage.addNode(StorageNodeData{1, path});
+    ASSERT_TRUE(mStorage.addFile(StorageFile{fileId, path, L"cpp", "2020-01-01 00:00:00", false, true}));
+    fileIds.insert(fileId);
+    paths.emplace_back(path);
+    paths.emplace_back(path);
+  }
+  paths.emplace_back(L"/tmp/missing.cpp");
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: the files are looked up by duplicated and missing paths
+  std::set<Id> foundIds;
+  for(const StorageFile& file : mStorage.getFilesByPaths(paths)) {
+    foundIds.insert(file.id);
+  }
+  // Then: every file is found once
+  EXPECT_EQ(fileIds, foundIds);
+  EXPECT_EQ(fileIds.size(), mStorage.getFilesByPaths(paths).size());
+  EXPECT_TRUE(mStorage.getFilesByPaths({}).empty());
+}
+
+TEST_F(SqliteIndexStorageFix, readModeIndicesAnswerEdgeQueriesWithQueryPlanAudit) {
+  // Given: edges of two types between three nodes and the query plan audit enabled
+  SqliteStorage::setQueryPlanAuditEnabled(true);
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> nodeIds = mStorage.addNodes(
+      {StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Bar"}, StorageNode{0, 1, L"Baz"}});
+  const Id memberEdgeId = mStorage.addEdge(StorageEdgeData{1, nodeIds[0], nodeIds[1]});
+  const Id callEdgeId = mStorage.addEdge(StorageEdgeData{2, nodeIds[0], nodeIds[2]});
+  const Id otherCallEdgeId = mStorage.addEdge(StorageEdgeData{2, nodeIds[1], nodeIds[2]});
+  // When: the storage switches to the read index set
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: edges are found by either end and by type
+  auto edgeIds = [](const std::vector<StorageEdge>& edges) {
+    std::vector<Id> ids;
+    std::ranges::transform(edges, std::back_inserter(ids), [](const StorageEdge& edge) { return edge.id; });
+    return ids;
+  };
+  EXPECT_THAT(edgeIds(mStorage.getEdgesBySourceIds({nodeIds[0]})), testing::UnorderedElementsAre(memberEdgeId, callEdgeId));
+  EXPECT_THAT(edgeIds(mStorage.getEdgesByTargetIds({nodeIds[2]})), testing::UnorderedElementsAre(callEdgeId, otherCallEdgeId));
+  EXPECT_THAT(edgeIds(mStorage.getEdgesByType(2)), testing::UnorderedElementsAre(callEdgeId, otherCallEdgeId));
+  EXPECT_EQ(callEdgeId, mStorage.getEdgeBySourceTargetType(nodeIds[0], nodeIds[2], 2).id);
+  // And: every edge query reads one of the covering edge indices and never the edge table itself
+  std::set<std::string> usedIndices;
+  for(const auto& [sql, plan] : mStorage.getAuditedQueryPlans()) {
+    if(sql.find(" FROM edge ") == std::string::npos) {
+      continue;
+    }
+    EXPECT_EQ(std::string::npos, (plan + "\n").find("SCAN edge\n")) << sql << plan;
+    const std::regex coveringIndex("(SEARCH|SCAN) edge USING COVERING INDEX (edge_[a-z_]+_index)");
+    std::smatch match;
+    EXPECT_TRUE(std::regex_search(plan, match, coveringIndex)) << sql << plan;
+    if(!match.empty()) {
+      usedIndices.insert(match[2]);
+    }
+  }
+  EXPECT_THAT(usedIndices,
+              testing::ElementsAre(
+                  "edge_source_type_target_index", "edge_target_type_source_index", "edge_type_source_target_index"));
+  SqliteStorage::setQueryPlanAuditEnabled(false);
+}
+
+TEST_F(SqliteIndexStorageFix, cursorsDecodeRowsInPlace) {
+  // Given: an ASCII and a non-ASCII node and three edges
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 2, L"Gr\u00FC\u00DFe"}});
+  mStorage.addEdge(StorageEdgeData{1, nodeIds[0], nodeIds[1]});
+  mStorage.addEdge(StorageEdgeData{2, nodeIds[0], nodeIds[0]});
+  mStorage.addEdge(StorageEdgeData{2, nodeIds[1], nodeIds[0]});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: the nodes are read through a cursor of views
+  std::vector<std::string> names;
+  auto nodeCursor = mStorage.getCursor<StorageNodeView>();
+  while(nodeCursor.next()) {
+    names.emplace_back(nodeCursor.get().serializedName);
+  }
+  // Then: the names are the stored UTF-8 text
+  EXPECT_THAT(names, testing::ElementsAre("Foo", "Gr\xC3\xBC\xC3\x9F" "e"));
+  EXPECT_EQ(L"Gr\u00FC\u00DFe", mStorage.getNodeById(nodeIds[1]).serializedName);
+  // And: edges of a type are read in batches
+  std::vector<StorageEdge> batch;
+  auto edgeCursor = mStorage.getCursorOfType<StorageEdge>(2);
+  ASSERT_TRUE(edgeCursor.nextBatch(batch, 1));
+  EXPECT_EQ(1, batch.size());
+  ASSERT_TRUE(edgeCursor.nextBatch(batch, 5));
+  EXPECT_EQ(1, batch.size());
+  EXPECT_EQ(nodeIds[1], batch.front().sourceNodeId);
+  EXPECT_FALSE(edgeCursor.nextBatch(batch, 5));
+}
+
+TEST_F(SqliteIndexStorageFix, storedNodesAreFoundByNameAfterModeChange) {
+  // Given: an ASCII and a non-ASCII node written in an earlier write session
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Gr\u00FC\u00DFe"}});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: the same names are added again with a higher type
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> againIds = mStorage.addNodes({StorageNode{0, 4, L"Gr\u00FC\u00DFe"}, StorageNode{0, 1, L"Foo"}});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: the stored nodes are reused and the type is raised
+  EXPECT_EQ(nodeIds[1], againIds[0]);
+  EXPECT_EQ(nodeIds[0], againIds[1]);
+  EXPECT_EQ(2, mStorage.getNodeCount());
+  EXPECT_EQ(4, mStorage.getNodeById(nodeIds[1]).type);
+}
+
+TEST_F(SqliteIndexStorageFix, sourceLocationsOfFileCarryTheirElementIds) {
+  // Given: a file with three locations, one shared by two nodes and one without occurrences
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const Id fileId = mStorage.addNode(StorageNodeData{1, L"file"});
+  ASSERT_TRUE(mStorage.addFile(StorageFile{fileId, L"/tmp/main.cpp", L"cpp", "2020-01-01 00:00:00", true, true}));
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Bar"}});
+  const int token = locationTypeToInt(LOCATION_TOKEN);
+  const Id sharedId = mStorage.addSourceLocation(StorageSourceLocationData{fileId, 3, 1, 3, 5, token});
+  const Id emptyId = mStorage.addSourceLocation(StorageSourceLocationData{fileId, 1, 1, 1, 5, token});
+  const Id laterId = mStorage.addSourceLocation(StorageSourceLocationData{fileId, 5, 1, 5, 5, token});
+  mStorage.addOccurrences(
+      {StorageOccurrence{nodeIds[0], sharedId}, StorageOccurrence{nodeIds[1], sharedId}, StorageOccurrence{nodeIds[1], laterId}});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // When: the locations are read for the whole file and for a line range
+  const auto wholeFile = mStorage.getSourceLocationsForFile(FilePath(L"/tmp/main.cpp"));
+  const auto lines = mStorage.getSourceLocationsForLinesInFile(FilePath(L"/tmp/main.cpp"), 2, 4);
+  // Then: every location is there once with all of its element ids
+  ASSERT_EQ(3, wholeFile->getSourceLocationCount());
+  EXPECT_THAT(wholeFile->getSourceLocationById(sharedId)->getTokenIds(), testing::UnorderedElementsAre(nodeIds[0], nodeIds[1]));
+  EXPECT_TRUE(wholeFile->getSourceLocationById(emptyId)->getTokenIds().empty());
+  EXPECT_THAT(wholeFile->getSourceLocationById(laterId)->getTokenIds(), testing::ElementsAre(nodeIds[1]));
+  ASSERT_EQ(1, lines->getSourceLocationCount());
+  EXPECT_NE(nullptr, lines->getSourceLocationById(sharedId));
+  // And: the locations of an element are found with the path of their file
+  const auto collection = mStorage.getSourceLocationsForElementIds({nodeIds[1]});
+  EXPECT_EQ(2, collection->getSourceLocationCount());
+  const auto file = collection->getSourceLocationFileByPath(FilePath(L"/tmp/main.cpp"));
+  ASSERT_TRUE(file);
+  EXPECT_THAT(file->getSourceLocationById(sharedId)->getTokenIds(), testing::ElementsAre(nodeIds[1]));
+}
+
+TEST_F(SqliteIndexStorageFix, trackedNodeChangesAreTakenOnce) {
+  // Given: two stored nodes and a record of the changes started afterwards
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const std::vector<Id> nodeIds = mStorage.addNodes({StorageNode{0, 1, L"Foo"}, StorageNode{0, 1, L"Bar"}});
+  EXPECT_FALSE(mStorage.takeChangedNodeIds().has_value());
+  mStorage.trackNodeChanges();
+  // When: a node is added, one changes its type and the element of the other is removed
+  const Id addedId = mStorage.addNode(StorageNodeData{1, L"Baz"});
+  mStorage.addNodes({StorageNode{0, 4, L"Foo"}});
+  mStorage.removeElement(nodeIds[1]);
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: all three ids were recorded and the record ends when it is taken
+  const auto changedIds = mStorage.takeChangedNodeIds();
+  ASSERT_TRUE(changedIds.has_value());
+  EXPECT_THAT(*changedIds, testing::UnorderedElementsAre(nodeIds[0], nodeIds[1], addedId));
+  EXPECT_FALSE(mStorage.takeChangedNodeIds().has_value());
+}
+
+TEST(SqliteIndexStorage, readOnlyConnectionSeesCommittedDataWhileWriting) {
+  const std::filesystem::path dbPath = std::filesystem::temp_directory_path() / "SqliteIndexStorageReadConnection.sqlite";
+  const auto removeDatabase = [&dbPath]() {
+    for(const char* suffix : {"", "-wal", "-shm"}) {
+      std::filesystem::remove(dbPath.string() + suffix);
+    }
+  };
+  removeDatabase();
+  {
+    // Given: a database with one committed node
+    SqliteIndexStorage storage(FilePath(dbPath.wstring()));
+    storage.setup();
+    storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+    const Id committedId = storage.addNode(StorageNodeData{1, L"Foo"});
+    // When: a read-only connection queries it while the writer has a transaction open
+    SqliteIndexStorage reader(FilePath(dbPath.wstring()), SqliteStorage::OpenMode::ReadOnly);
+    storage.beginTransaction();
+    const Id pendingId = storage.addNode(StorageNodeData{1, L"Bar"});
+    // Then: the reader is not blocked, sees the committed node only and can still use temporary id lists
+    EXPECT_EQ(1, reader.getAllByIds<StorageNode>({committedId, pendingId}).size());
+    storage.commitTransaction();
+    EXPECT_EQ(2, reader.getAllByIds<StorageNode>({committedId, pendingId}).size());
+  }
+  removeDatabase();
+}
+
+
+TEST(SqliteIndexStorage, corruptHashesAreTreatedAsMissing) {
+  const std::filesystem::path dbPath = std::filesystem::temp_directory_path() / "SqliteIndexStorageCorruptHash.sqlite";
+  std::filesystem::remove(dbPath);
+  {
+    // Given: a file with captured content and a graph snapshot token
+    SqliteIndexStorage storage(FilePath(dbPath.wstring()));
+    storage.setup();
+    storage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+    StorageFile file{0, L"/tmp/corrupt.cpp", L"cpp", "2020-01-01 00:00:00", true, true};
+    file.content = std::make_shared<const std::string>("int a;\n");
+    file.id = storage.addNode(StorageNodeData{1, file.filePath});
+    ASSERT_TRUE(storage.addFile(file));
+    storage.setGraphSnapshotToken(0x1234);
+    storage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+    ASSERT_EQ(1, storage.getFileContentHashes().size());
+    ASSERT_EQ(0x1234, storage.getGraphSnapshotToken());
+  }
+  {
+    // When: both values are overwritten with text that is not a hex number
+    CppSQLite3DB database;
+    database.open(dbPath.string().c_str());
+    database.execDML("UPDATE file SET content_hash = 'not a hash';");
+    database.execDML("UPDATE meta SET value = '12zz' WHERE key = 'graph_snapshot_token';");
+    database.close();
+  }
+  {
+    // Then: reading them does not throw, the file has no hash and there is no snapshot
+    const SqliteIndexStorage storage(FilePath(dbPath.wstring()), SqliteStorage::OpenMode::ReadOnly);
+    EXPECT_TRUE(storage.getFileContentHashes().empty());
+    EXPECT_EQ(0, storage.getGraphSnapshotToken());
+  }
+  std::filesystem::remove(dbPath);
+}
+
+#ifndef NDEBUG
+TEST_F(SqliteIndexStorageFix, connectionUsedByTwoThreadsAtOnceFailsAssertion) {
+  // Given: a node and a cursor over the nodes that is still open on this thread
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_WRITE);
+  const Id nodeId = mStorage.addNode(StorageNodeData{1, L"Foo"});
+  mStorage.setMode(SqliteIndexStorage::STORAGE_MODE_READ);
+  // Then: a query of a second thread on the same connection is caught
+  ASSERT_DEATH(
+      {
+        auto cursor = mStorage.getCursor<StorageNodeView>();
+        std::thread([this, nodeId]() { std::ignore = mStorage.getNodeById(nodeId); }).join();
+      },
+      "m_useCount == 0");
+  // And: nested queries on one thread are fine
+  auto cursor = mStorage.getCursor<StorageNodeView>();
+  ASSERT_TRUE(cursor.next());
+  EXPECT_EQ(L"Foo", mStorage.getNodeById(cursor.get().id).serializedName);
+}
+#endif
+
+}    // namespace
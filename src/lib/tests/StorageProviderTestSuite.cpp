@@ -46,58 +46,70 @@ TEST(StorageProvider, insert_multipleStorages) {
   EXPECT_EQ(3, result);
 }
 
-TEST(StorageProvider, consumeSecondLargestStorage_empty) {
+TEST(StorageProvider, consumeLargestStorage_empty) {
   // Given:
   StorageProvider provider;
   // When:
-  const auto result = provider.consumeSecondLargestStorage();
+  const auto result = provider.consumeLargestStorage();
   // Then:
   ASSERT_FALSE(result.has_value());
   EXPECT_EQ(result.error(), "No Storage found");
 }
 
-TEST(StorageProvider, consumeSecondLargestStorage_oneStorageExists) {
+TEST(StorageProvider, consumeLargestStorage_oneStorageExists) {
   // Given:
   StorageProvider provider;
   // And:
   provider.insert(std::make_shared<IntermediateStorage>());
   // When:
-  const auto result = provider.consumeSecondLargestStorage();
+  const auto result = provider.consumeLargestStorage();
   // Then:
-  ASSERT_FALSE(result.has_value());
-  EXPECT_EQ(result.error(), "No Storage found");
+  EXPECT_TRUE(result.has_value());
 }
 
-TEST(StorageProvider, consumeSecondLargestStorage_multiStorageExists) {
+namespace {
+std::shared_ptr<IntermediateStorage> makeStorage(size_t sourceLocationCount) {
+  auto storage = std::make_shared<IntermediateStorage>();
+  std::set<StorageSourceLocation> locations;
+  for(size_t i = 0; i < sourceLocationCount; i++) {
+    locations.emplace(static_cast<Id>(i + 1), 1, i + 1, 1, i + 1, 2, 0);
+  }
+  storage->setStorageSourceLocations(std::move(locations));
+  return storage;
+}
+}    // namespace
+
+TEST(StorageProvider, consumeStoragesToMerge_twoStoragesExist) {
   // Given:
   StorageProvider provider;
   // And:
   provider.insert(std::make_shared<IntermediateStorage>());
   provider.insert(std::make_shared<IntermediateStorage>());
-  provider.insert(std::make_shared<IntermediateStorage>());
   // When:
-  const auto result = provider.consumeSecondLargestStorage();
-  // Then:
-  ASSERT_TRUE(result.has_value());
-}
-
-TEST(StorageProvider, consumeLargestStorage_empty) {
-  // Given:
-  StorageProvider provider;
-  // When:
-  const auto result = provider.consumeLargestStorage();
+  const auto result = provider.consumeStoragesToMerge();
   // Then:
   ASSERT_FALSE(result.has_value());
   EXPECT_EQ(result.error(), "No Storage found");
+  EXPECT_EQ(2, provider.getStorageCount());
 }
 
-TEST(StorageProvider, consumeLargestStorage_oneStorageExists) {
+TEST(StorageProvider, consumeStoragesToMerge_takesSmallestPair) {
   // Given:
   StorageProvider provider;
   // And:
-  provider.insert(std::make_shared<IntermediateStorage>());
+  provider.insert(makeStorage(1));
+  provider.insert(makeStorage(10));
+  provider.insert(makeStorage(3));
+  provider.insert(makeStorage(2));
   // When:
-  const auto result = provider.consumeLargestStorage();
+  const auto result = provider.consumeStoragesToMerge();
   // Then:
-  EXPECT_TRUE(result.has_value());
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(2, result->first->getSourceLocationCount());
+  EXPECT_EQ(1, result->second->getSourceLocationCount());
+  EXPECT_EQ(2, provider.getStorageCount());
+  // And:
+  const auto largest = provider.consumeLargestStorage();
+  ASSERT_TRUE(largest.has_value());
+  EXPECT_EQ(10, largest.value()->getSourceLocationCount());
 }
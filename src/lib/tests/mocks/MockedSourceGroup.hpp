@@ -19,7 +19,9 @@ struct MockedSourceGroup : SourceGroup {
   MOCK_METHOD(std::vector<std::shared_ptr<IndexerCommand>>, getIndexerCommands, (const RefreshInfo& info), (const, override));
   MOCK_METHOD(std::shared_ptr<Task>,
               getPreIndexTask,
-              (std::shared_ptr<StorageProvider> storageProvider, std::shared_ptr<DialogView> dialogView),
+              (const IndexerCommandProvider& indexerCommandProvider,
+               std::shared_ptr<StorageProvider> storageProvider,
+               std::shared_ptr<DialogView> dialogView),
               (const, override));
 
   MOCK_METHOD(std::shared_ptr<SourceGroupSettings>, getSourceGroupSettings, (), (override));
@@ -1,5 +1,6 @@
 #include "SharedMemory.h"
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <fmt/format.h>
 
 #include "details/SharedMemoryGarbageCollector.h"
@@ -7,9 +8,11 @@
 
 const char* SharedMemory::s_memoryNamePrefix = "srctrlmem_";
 const char* SharedMemory::s_mutexNamePrefix = "srctrlmtx_";
+const char* SharedMemory::s_conditionNamePrefix = "srctrlcnd_";
 
 SharedMemory::ScopedAccess::ScopedAccess(SharedMemory* memory)
     : boost::interprocess::scoped_lock<boost::interprocess::named_mutex>(memory->getMutex())
+    , m_condition(memory->getCondition())
     //, m_memory(boost::interprocess::open_only, memory->getMemoryName().c_str())
     , m_memoryName(memory->getMemoryName())
     , m_minimumMemorySize(memory->getInitialMemorySize()) {
@@ -66,6 +69,22 @@ void SharedMemory::ScopedAccess::shrinkToFitMemory() {
   m_memory = boost::interprocess::managed_shared_memory(boost::interprocess::open_only, m_memoryName.c_str());
 }
 
+bool SharedMemory::ScopedAccess::waitForChange(std::chrono::milliseconds timeout) {
+  // unmapped while waiting, another process may grow the memory in the meantime
+  m_memory = boost::interprocess::managed_shared_memory();
+
+  const boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() +
+      boost::posix_time::milliseconds(timeout.count());
+  const bool notified = m_condition.timed_wait(*this, deadline);
+
+  m_memory = boost::interprocess::managed_shared_memory(boost::interprocess::open_only, m_memoryName.c_str());
+  return notified;
+}
+
+void SharedMemory::ScopedAccess::notifyAll() {
+  m_condition.notify_all();
+}
+
 std::string SharedMemory::ScopedAccess::logString() const {
   std::string log = m_memoryName + " -";
   log += " size: " + std::to_string(getMemorySize());
@@ -96,6 +115,7 @@ std::string SharedMemory::checkSharedMemory(const std::string& name) {
 void SharedMemory::deleteSharedMemory(const std::string& name) {
   boost::interprocess::shared_memory_object::remove((s_memoryNamePrefix + name).c_str());
   boost::interprocess::named_mutex::remove((s_mutexNamePrefix + name).c_str());
+  boost::interprocess::named_condition::remove((s_conditionNamePrefix + name).c_str());
 }
 
 SharedMemory::SharedMemory(const std::string& name, size_t initialMemorySize, AccessMode mode)
@@ -196,6 +216,10 @@ std::string SharedMemory::getMutexName() const {
   return s_mutexNamePrefix + m_name;
 }
 
+std::string SharedMemory::getConditionName() const {
+  return s_conditionNamePrefix + m_name;
+}
+
 boost::interprocess::named_mutex& SharedMemory::getMutex() {
   if(!m_mutex) {
     m_mutex = std::make_shared<boost::interprocess::named_mutex>(boost::interprocess::open_only, getMutexName().c_str());
@@ -204,6 +228,18 @@ boost::interprocess::named_mutex& SharedMemory::getMutex() {
   return *m_mutex;
 }
 
+boost::interprocess::named_condition& SharedMemory::getCondition() {
+  if(!m_condition) {
+    // created on first use, so processes opening the memory don't depend on the owner having waited or notified
+    boost::interprocess::permissions permissions;
+    permissions.set_unrestricted();
+    m_condition = std::make_shared<boost::interprocess::named_condition>(
+        boost::interprocess::open_or_create, getConditionName().c_str(), permissions);
+  }
+
+  return *m_condition;
+}
+
 size_t SharedMemory::getInitialMemorySize() const {
   return m_initialMemorySize;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include <boost/interprocess/containers/deque.hpp>
@@ -8,6 +9,7 @@
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/named_condition.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
@@ -53,6 +55,20 @@ public:
     void growMemory(size_t size);
     void shrinkToFitMemory();
 
+    /**
+     * @brief Releases the memory until notifyAll() is called by any process or the timeout expires
+     *
+     * Values accessed before are invalid afterwards, the memory may have grown in between.
+     *
+     * @return false if the timeout expired
+     */
+    bool waitForChange(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Wakes all processes in waitForChange(), they continue once this access is released
+     */
+    void notifyAll();
+
     template <typename T>
     T* accessValue(const std::string& key) {
       return m_memory.find_or_construct<T>(key.c_str())();
@@ -81,6 +97,7 @@ public:
     [[nodiscard]] std::string logString() const;
 
   private:
+    boost::interprocess::named_condition& m_condition;
     boost::interprocess::managed_shared_memory m_memory;
     std::string m_memoryName;
     size_t m_minimumMemorySize;
@@ -91,15 +108,19 @@ public:
 private:
   static const char* s_memoryNamePrefix;
   static const char* s_mutexNamePrefix;
+  static const char* s_conditionNamePrefix;
 
   [[nodiscard]] std::string getMemoryName() const;
   [[nodiscard]] std::string getMutexName() const;
+  [[nodiscard]] std::string getConditionName() const;
 
   boost::interprocess::named_mutex& getMutex();
+  boost::interprocess::named_condition& getCondition();
 
   [[nodiscard]] size_t getInitialMemorySize() const;
 
   std::shared_ptr<boost::interprocess::named_mutex> m_mutex;
+  std::shared_ptr<boost::interprocess::named_condition> m_condition;
   std::string m_name;
   AccessMode m_mode;
 
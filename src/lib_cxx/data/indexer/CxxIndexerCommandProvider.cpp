@@ -135,6 +135,14 @@ size_t CxxIndexerCommandProvider::size() const {
   return m_commands.size();
 }
 
+void CxxIndexerCommandProvider::setSharedPreambles(std::vector<utility::SharedPreamble> sharedPreambles) {
+  m_sharedPreambles = std::move(sharedPreambles);
+}
+
+const std::vector<utility::SharedPreamble>& CxxIndexerCommandProvider::getSharedPreambles() const {
+  return m_sharedPreambles;
+}
+
 void CxxIndexerCommandProvider::logStats() const {
   LOG_INFO("CxxIndexerCommandProvider stats:");
   LOG_INFO("\tindexed path count: " + std::to_string(m_idsToIndexedPaths.size()));
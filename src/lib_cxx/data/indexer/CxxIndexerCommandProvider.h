@@ -9,6 +9,7 @@
 
 #include "GlobalId.hpp"
 #include "IndexerCommandProvider.h"
+#include "utilitySourceGroupCxx.h"
 
 class IndexerCommandCxx;
 
@@ -24,6 +25,10 @@ public:
   size_t size() const override;
   void logStats() const;
 
+  // groups of the commands that load a precompiled header of their leading includes, which the pre-index task builds
+  void setSharedPreambles(std::vector<utility::SharedPreamble> sharedPreambles);
+  const std::vector<utility::SharedPreamble>& getSharedPreambles() const;
+
 private:
   struct CommandRepresentation {
     std::set<Id> m_indexedPathIds;
@@ -51,6 +56,8 @@ private:
   std::map<FilePath, Id> m_workingDirectoriesToIds;
   std::map<Id, std::wstring> m_idsToCompilerFlags;
   std::unordered_map<std::wstring, Id> m_compilerFlagsToIds;
+
+  std::vector<utility::SharedPreamble> m_sharedPreambles;
 };
 
 #endif    // CXX_INDEXER_COMMAND_PROVIDER_H
@@ -1,15 +1,38 @@
 #include "IndexerCxx.h"
+// clang
+#include <clang/Basic/FileManager.h>
+// llvm
+#include <llvm/Support/VirtualFileSystem.h>
 // internal
+#include "ClangInvocationCache.h"
 #include "CxxParser.h"
+#include "CxxSymbolNameCache.h"
 #include "FileRegister.h"
 
+IndexerCxx::IndexerCxx()
+    : m_symbolNameCache(std::make_shared<CxxSymbolNameCache>()), m_invocationCache(std::make_shared<ClangInvocationCache>()) {}
+
+IndexerCxx::~IndexerCxx() {
+  m_symbolNameCache->logStats();
+  m_invocationCache->logStats();
+}
+
 void IndexerCxx::doIndex(std::shared_ptr<IndexerCommandCxx> indexerCommand,
                          std::shared_ptr<ParserClientImpl> parserClient,
                          std::shared_ptr<IndexerStateInfo> indexerStateInfo) {
+  const std::wstring workingDirectory = indexerCommand->getWorkingDirectory().wstr();
+  if(!m_fileManager || workingDirectory != m_fileManagerWorkingDirectory) {
+    m_fileManager = llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions(), llvm::vfs::getRealFileSystem());
+    m_fileManagerWorkingDirectory = workingDirectory;
+  }
+
   CxxParser parser(parserClient,
                    std::make_shared<FileRegister>(
                        indexerCommand->getSourceFilePath(), indexerCommand->getIndexedPaths(), indexerCommand->getExcludeFilters()),
-                   indexerStateInfo);
+                   indexerStateInfo,
+                   m_fileManager,
+                   m_symbolNameCache,
+                   m_invocationCache);
 
   parser.buildIndex(indexerCommand);
 }
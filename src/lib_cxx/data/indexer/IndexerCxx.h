@@ -1,11 +1,35 @@
 #pragma once
+// STL
+#include <memory>
+#include <string>
+// llvm
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
 // internal
 #include "Indexer.h"
 #include "IndexerCommandCxx.h"
 
+namespace clang {
+class FileManager;
+}    // namespace clang
+
+class ClangInvocationCache;
+class CxxSymbolNameCache;
+
 class IndexerCxx final : public Indexer<IndexerCommandCxx> {
+public:
+  IndexerCxx();
+  ~IndexerCxx() override;
+
 private:
   void doIndex(std::shared_ptr<IndexerCommandCxx> indexerCommand,
                std::shared_ptr<ParserClientImpl> parserClient,
                std::shared_ptr<IndexerStateInfo> indexerStateInfo) override;
+
+  // reused by the translation units of one working directory, relative paths would resolve differently in others
+  llvm::IntrusiveRefCntPtr<clang::FileManager> m_fileManager;
+  std::wstring m_fileManagerWorkingDirectory;
+  // names of symbols that resolve the same in every translation unit, e.g. the ones declared in shared headers
+  std::shared_ptr<CxxSymbolNameCache> m_symbolNameCache;
+  // driver results of command lines that only differ in their source file
+  std::shared_ptr<ClangInvocationCache> m_invocationCache;
 };
@@ -7,15 +7,21 @@
 
 ASTAction::ASTAction(std::shared_ptr<ParserClient> client,
                      std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                     std::shared_ptr<IndexerStateInfo> indexerStateInfo)
+                     std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                     std::shared_ptr<CxxSymbolNameCache> symbolNameCache)
     : m_client(client)
     , m_canonicalFilePathCache(canonicalFilePathCache)
     , m_indexerStateInfo(indexerStateInfo)
+    , m_symbolNameCache(symbolNameCache)
     , m_commentHandler(client, canonicalFilePathCache) {}
 
 std::unique_ptr<clang::ASTConsumer> ASTAction::CreateASTConsumer(clang::CompilerInstance& compiler, llvm::StringRef /*inFile*/) {
-  return std::unique_ptr<clang::ASTConsumer>(new ASTConsumer(
-      &compiler.getASTContext(), &compiler.getPreprocessor(), m_client, m_canonicalFilePathCache, m_indexerStateInfo));
+  return std::unique_ptr<clang::ASTConsumer>(new ASTConsumer(&compiler.getASTContext(),
+                                                             &compiler.getPreprocessor(),
+                                                             m_client,
+                                                             m_canonicalFilePathCache,
+                                                             m_indexerStateInfo,
+                                                             m_symbolNameCache));
 }
 
 bool ASTAction::BeginSourceFileAction(clang::CompilerInstance& compiler) {
@@ -8,13 +8,15 @@
 
 class ParserClient;
 class CanonicalFilePathCache;
+class CxxSymbolNameCache;
 struct IndexerStateInfo;
 
 class ASTAction : public clang::ASTFrontendAction {
 public:
   explicit ASTAction(std::shared_ptr<ParserClient> client,
                      std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                     std::shared_ptr<IndexerStateInfo> indexerStateInfo);
+                     std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                     std::shared_ptr<CxxSymbolNameCache> symbolNameCache = nullptr);
 
 protected:
   std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compiler, llvm::StringRef inFile) override;
@@ -25,5 +27,6 @@ private:
   std::shared_ptr<ParserClient> m_client;
   std::shared_ptr<CanonicalFilePathCache> m_canonicalFilePathCache;
   std::shared_ptr<IndexerStateInfo> m_indexerStateInfo;
+  std::shared_ptr<CxxSymbolNameCache> m_symbolNameCache;
   CommentHandler m_commentHandler;
 };
\ No newline at end of file
@@ -8,13 +8,16 @@ ASTConsumer::ASTConsumer(clang::ASTContext* context,
                          clang::Preprocessor* preprocessor,
                          std::shared_ptr<ParserClient> client,
                          std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                         std::shared_ptr<IndexerStateInfo> indexerStateInfo) {
+                         std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                         std::shared_ptr<CxxSymbolNameCache> symbolNameCache) {
   auto* pAppSettings = IApplicationSettings::getInstanceRaw();
 
   if(pAppSettings->getLoggingEnabled() && pAppSettings->getVerboseIndexerLoggingEnabled()) {
-    m_visitor = std::make_shared<CxxVerboseAstVisitor>(context, preprocessor, client, canonicalFilePathCache, indexerStateInfo);
+    m_visitor = std::make_shared<CxxVerboseAstVisitor>(
+        context, preprocessor, client, canonicalFilePathCache, indexerStateInfo, symbolNameCache);
   } else {
-    m_visitor = std::make_shared<CxxAstVisitor>(context, preprocessor, client, canonicalFilePathCache, indexerStateInfo);
+    m_visitor = std::make_shared<CxxAstVisitor>(
+        context, preprocessor, client, canonicalFilePathCache, indexerStateInfo, symbolNameCache);
   }
 }
 
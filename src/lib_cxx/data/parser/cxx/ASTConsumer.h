@@ -5,6 +5,7 @@
 
 class CanonicalFilePathCache;
 class CxxAstVisitor;
+class CxxSymbolNameCache;
 class ParserClient;
 struct IndexerStateInfo;
 
@@ -14,7 +15,8 @@ public:
                        clang::Preprocessor* preprocessor,
                        std::shared_ptr<ParserClient> client,
                        std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                       std::shared_ptr<IndexerStateInfo> indexerStateInfo);
+                       std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                       std::shared_ptr<CxxSymbolNameCache> symbolNameCache);
 
   ~ASTConsumer() override;
 
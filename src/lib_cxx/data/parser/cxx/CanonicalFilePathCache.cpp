@@ -154,3 +154,37 @@ bool CanonicalFilePathCache::isProjectFile(const clang::FileID& fileId, const cl
   m_isProjectFileMap.emplace(fileId, ret);
   return ret;
 }
+
+void CanonicalFilePathCache::setHeaderClaimFunction(HeaderClaimFunction claimHeader) {
+  m_claimHeader = std::move(claimHeader);
+}
+
+void CanonicalFilePathCache::stopClaimingHeaders() {
+  m_claimHeader = {};
+}
+
+bool CanonicalFilePathCache::isIndexedFile(const clang::FileID& fileId, const clang::SourceManager& sourceManager) {
+  if(!isProjectFile(fileId, sourceManager)) {
+    return false;
+  }
+
+  auto it = m_isIndexedFileMap.find(fileId);
+  if(it != m_isIndexedFileMap.end()) {
+    return it->second;
+  }
+
+  if(!m_claimHeader || fileId == sourceManager.getMainFileID()) {
+    return true;
+  }
+
+  // a header included multiple times by this translation unit is only claimed once
+  const FilePath filePath = getCanonicalFilePath(fileId, sourceManager);
+  bool ret = m_claimedHeaderPaths.find(filePath) != m_claimedHeaderPaths.end();
+  if(!ret && m_claimHeader(filePath)) {
+    m_claimedHeaderPaths.insert(filePath);
+    ret = true;
+  }
+
+  m_isIndexedFileMap.emplace(fileId, ret);
+  return ret;
+}
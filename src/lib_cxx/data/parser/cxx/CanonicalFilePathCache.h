@@ -1,7 +1,9 @@
 #ifndef CANONICAL_FILE_PATH_CACHE_H
 #define CANONICAL_FILE_PATH_CACHE_H
 
+#include <functional>
 #include <map>
+#include <set>
 #include <string>
 
 #include <clang/AST/Decl.h>
@@ -14,6 +16,9 @@
 
 class CanonicalFilePathCache {
 public:
+  // Returns false if the content of the header is recorded by another translation unit.
+  using HeaderClaimFunction = std::function<bool(const FilePath& headerPath)>;
+
   CanonicalFilePathCache(std::shared_ptr<FileRegister> fileRegister);
 
   std::shared_ptr<FileRegister> getFileRegister() const;
@@ -33,8 +38,17 @@ public:
 
   bool isProjectFile(const clang::FileID& fileId, const clang::SourceManager& sourceManager);
 
+  // without a claim function every project file is recorded by the current translation unit
+  void setHeaderClaimFunction(HeaderClaimFunction claimHeader);
+  // headers reached from now on are recorded without claiming them, decisions made so far are kept
+  void stopClaimingHeaders();
+
+  // project file whose content has to be recorded by the current translation unit
+  bool isIndexedFile(const clang::FileID& fileId, const clang::SourceManager& sourceManager);
+
 private:
   std::shared_ptr<FileRegister> m_fileRegister;
+  HeaderClaimFunction m_claimHeader;
 
   std::map<clang::FileID, FilePath> m_fileIdMap;
   std::unordered_map<std::wstring, FilePath> m_fileStringMap;
@@ -44,6 +58,8 @@ private:
   std::unordered_map<std::wstring, Id> m_fileStringSymbolIdMap;
 
   std::map<clang::FileID, bool> m_isProjectFileMap;
+  std::map<clang::FileID, bool> m_isIndexedFileMap;
+  std::set<FilePath> m_claimedHeaderPaths;
 };
 
 #endif    // CANONICAL_FILE_PATH_CACHE_H
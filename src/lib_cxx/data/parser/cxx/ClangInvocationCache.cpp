@@ -0,0 +1,107 @@
+#include "ClangInvocationCache.h"
+// llvm
+#include <llvm/Support/Path.h>
+// internal
+#include "logging.h"
+
+namespace {
+const std::string MainFileNameFlag = "-main-file-name";
+
+bool isMainFileNameValue(const std::vector<std::string>& arguments, size_t index) {
+  return index > 0 && arguments[index - 1] == MainFileNameFlag;
+}
+
+std::optional<size_t> findSourceArgumentIndex(const std::vector<std::string>& arguments, const std::string& sourceFileName) {
+  std::optional<size_t> sourceArgumentIndex;
+  for(size_t i = 1; i < arguments.size(); i++) {
+    const std::string& argument = arguments[i];
+    if(!argument.starts_with('-') && !isMainFileNameValue(arguments, i) &&
+       llvm::sys::path::filename(argument) == sourceFileName) {
+      if(sourceArgumentIndex) {
+        return std::nullopt;
+      }
+      sourceArgumentIndex = i;
+    }
+  }
+  return sourceArgumentIndex;
+}
+}    // namespace
+
+ClangInvocationCache::ClangInvocationCache(size_t maxEntryCount) : m_maxEntryCount(maxEntryCount) {}
+
+ClangInvocationInfo ClangInvocationCache::getInvocationInfo(const std::vector<std::string>& commandLine,
+                                                            const std::string& workingDirectory,
+                                                            const std::string& sourceFileName) {
+  const std::optional<size_t> sourceArgumentIndex = findSourceArgumentIndex(commandLine, sourceFileName);
+  if(!sourceArgumentIndex) {
+    return ClangInvocationInfo::getClangInvocationInfo(commandLine);
+  }
+  const std::string& sourceArgument = commandLine[*sourceArgumentIndex];
+
+  // the extension of the source file decides about its language
+  std::string key = workingDirectory;
+  for(size_t i = 0; i < commandLine.size(); i++) {
+    key += '\n';
+    key += i == *sourceArgumentIndex ? "<source>" + llvm::sys::path::extension(sourceArgument).str() : commandLine[i];
+  }
+
+  if(auto it = m_entries.find(key); it != m_entries.end()) {
+    m_hitCount++;
+
+    const Entry& entry = it->second;
+    ClangInvocationInfo invocationInfo = entry.invocationInfo;
+    invocationInfo.frontendArguments[entry.sourceArgumentIndex] = sourceArgument;
+    if(entry.mainFileNameIndex) {
+      invocationInfo.frontendArguments[*entry.mainFileNameIndex] = sourceFileName;
+    }
+    return invocationInfo;
+  }
+
+  m_missCount++;
+
+  ClangInvocationInfo invocationInfo = ClangInvocationInfo::getClangInvocationInfo(commandLine);
+
+  std::optional<size_t> frontendSourceArgumentIndex;
+  std::optional<size_t> mainFileNameIndex;
+  // e.g. the names of output files are derived from the source file
+  const std::string derivedFileNamePrefix = llvm::sys::path::stem(sourceArgument).str() + '.';
+  bool isCacheable = true;
+  for(size_t i = 0; i < invocationInfo.frontendArguments.size(); i++) {
+    const std::string& argument = invocationInfo.frontendArguments[i];
+    if(argument == sourceArgument && !frontendSourceArgumentIndex) {
+      frontendSourceArgumentIndex = i;
+    } else if(isMainFileNameValue(invocationInfo.frontendArguments, i) && !mainFileNameIndex) {
+      mainFileNameIndex = i;
+    } else if(argument.find(derivedFileNamePrefix) != std::string::npos) {
+      isCacheable = false;
+    }
+  }
+
+  if(isCacheable && frontendSourceArgumentIndex) {
+    if(m_entries.size() >= m_maxEntryCount) {
+      m_entries.clear();
+    }
+    m_entries.emplace(std::move(key), Entry{invocationInfo, *frontendSourceArgumentIndex, mainFileNameIndex});
+  }
+  return invocationInfo;
+}
+
+size_t ClangInvocationCache::getHitCount() const {
+  return m_hitCount;
+}
+
+size_t ClangInvocationCache::getMissCount() const {
+  return m_missCount;
+}
+
+void ClangInvocationCache::logStats() const {
+  const size_t lookupCount = m_hitCount + m_missCount;
+  if(lookupCount == 0) {
+    return;
+  }
+
+  LOG_INFO("clang invocation cache - {} entries, driver skipped for {} of {} translation units",
+           m_entries.size(),
+           m_hitCount,
+           lookupCount);
+}
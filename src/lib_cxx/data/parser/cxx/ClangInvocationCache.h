@@ -0,0 +1,50 @@
+#pragma once
+// STL
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// internal
+#include "ClangInvocationInfo.h"
+
+/**
+ * Driver results of one indexer process, shared by all command lines that only differ in their source file.
+ *
+ * The driver turns such command lines into frontend arguments that only differ in the source file argument and the main file
+ * name, both are replaced on a cache hit. Results that name the source file in any other argument are not cached. The cache
+ * is cleared once it holds `maxEntryCount` results.
+ */
+class ClangInvocationCache final {
+public:
+  static constexpr size_t DefaultMaxEntryCount = 1000;
+
+  explicit ClangInvocationCache(size_t maxEntryCount = DefaultMaxEntryCount);
+
+  /**
+   * @param commandLine Driver command line containing the source file
+   * @param workingDirectory Directory the driver resolves relative paths against
+   * @param sourceFileName File name of the source file, the driver is run without caching if the command line does not
+   * contain exactly one argument with this file name
+   */
+  [[nodiscard]] ClangInvocationInfo getInvocationInfo(const std::vector<std::string>& commandLine,
+                                                      const std::string& workingDirectory,
+                                                      const std::string& sourceFileName);
+
+  [[nodiscard]] size_t getHitCount() const;
+  [[nodiscard]] size_t getMissCount() const;
+
+  void logStats() const;
+
+private:
+  struct Entry {
+    ClangInvocationInfo invocationInfo;
+    size_t sourceArgumentIndex;
+    std::optional<size_t> mainFileNameIndex;
+  };
+
+  size_t m_maxEntryCount;
+  std::unordered_map<std::string, Entry> m_entries;
+  size_t m_hitCount = 0;
+  size_t m_missCount = 0;
+};
@@ -3,7 +3,9 @@
 #include <clang/Basic/Version.h>
 #include <clang/Driver/Compilation.h>
 #include <clang/Driver/Driver.h>
+#include <clang/Driver/Job.h>
 #include <clang/Driver/Options.h>
+#include <clang/Driver/Tool.h>
 #include <clang/Frontend/CompilerInvocation.h>
 #include <clang/Tooling/Tooling.h>
 #include <llvm/Option/ArgList.h>
@@ -33,52 +35,90 @@ clang::driver::Driver* newDriver(clang::DiagnosticsEngine* Diagnostics,
 #endif
   return CompilerDriver;
 }
-}    // namespace
 
 // copied and stitched together from clang codebase
-ClangInvocationInfo ClangInvocationInfo::getClangInvocationString(const clang::tooling::CompilationDatabase* compilationDatabase) {
-  ClangInvocationInfo invocationInfo;
+template <typename JobsHandler>
+void runDriver(const std::vector<std::string>& CommandLine, ClangInvocationInfo& invocationInfo, const JobsHandler& handleJobs) {
+  std::vector<const char*> Argv;
+  for(const std::string& Str : CommandLine)
+    Argv.push_back(Str.c_str());
+  const char* const BinaryName = Argv[0];
+  clang::IntrusiveRefCntPtr<clang::DiagnosticOptions> DiagOpts = new clang::DiagnosticOptions();
+  unsigned MissingArgIndex, MissingArgCount;
+  const llvm::opt::OptTable& Opts = clang::driver::getDriverOptTable();
+  llvm::opt::InputArgList ParsedArgs = Opts.ParseArgs(
+      clang::ArrayRef<const char*>(Argv).slice(1), MissingArgIndex, MissingArgCount);
+  clang::ParseDiagnosticArgs(*DiagOpts, ParsedArgs);
 
-  if(!compilationDatabase->getAllCompileCommands().empty()) {
-    std::vector<std::string> CommandLine = compilationDatabase->getAllCompileCommands().front().CommandLine;
-
-    std::vector<const char*> Argv;
-    for(const std::string& Str : CommandLine)
-      Argv.push_back(Str.c_str());
-    const char* const BinaryName = Argv[0];
-    clang::IntrusiveRefCntPtr<clang::DiagnosticOptions> DiagOpts = new clang::DiagnosticOptions();
-    unsigned MissingArgIndex, MissingArgCount;
-    const llvm::opt::OptTable& Opts = clang::driver::getDriverOptTable();
-    llvm::opt::InputArgList ParsedArgs = Opts.ParseArgs(
-        clang::ArrayRef<const char*>(Argv).slice(1), MissingArgIndex, MissingArgCount);
-    clang::ParseDiagnosticArgs(*DiagOpts, ParsedArgs);
-
-    llvm::raw_string_ostream diagnosticsStream(invocationInfo.errors);
-    clang::TextDiagnosticPrinter DiagnosticPrinter(diagnosticsStream, &*DiagOpts);
-    clang::DiagnosticsEngine Diagnostics(
-        clang::IntrusiveRefCntPtr<clang::DiagnosticIDs>(new clang::DiagnosticIDs()), &*DiagOpts, &DiagnosticPrinter, false);
-
-    llvm::IntrusiveRefCntPtr<clang::FileManager> Files(new clang::FileManager(clang::FileSystemOptions()));
-
-    const std::unique_ptr<clang::driver::Driver> Driver(newDriver(&Diagnostics, BinaryName, &Files->getVirtualFileSystem()));
-    // Since the input might only be virtual, don't check whether it exists.
-    Driver->setCheckInputsExist(false);
+  llvm::raw_string_ostream diagnosticsStream(invocationInfo.errors);
+  clang::TextDiagnosticPrinter DiagnosticPrinter(diagnosticsStream, &*DiagOpts);
+  clang::DiagnosticsEngine Diagnostics(
+      clang::IntrusiveRefCntPtr<clang::DiagnosticIDs>(new clang::DiagnosticIDs()), &*DiagOpts, &DiagnosticPrinter, false);
+
+  llvm::IntrusiveRefCntPtr<clang::FileManager> Files(new clang::FileManager(clang::FileSystemOptions()));
+
+  const std::unique_ptr<clang::driver::Driver> Driver(newDriver(&Diagnostics, BinaryName, &Files->getVirtualFileSystem()));
+  // Since the input might only be virtual, don't check whether it exists.
+  Driver->setCheckInputsExist(false);
 #if CLANG_VERSION_MAJOR > 15
-    const std::unique_ptr<clang::driver::Compilation> Compilation(Driver->BuildCompilation(llvm::ArrayRef<const char*>(Argv)));
+  const std::unique_ptr<clang::driver::Compilation> Compilation(Driver->BuildCompilation(llvm::ArrayRef<const char*>(Argv)));
 #else
-    const std::unique_ptr<clang::driver::Compilation> Compilation(Driver->BuildCompilation(llvm::makeArrayRef(Argv)));
+  const std::unique_ptr<clang::driver::Compilation> Compilation(Driver->BuildCompilation(llvm::makeArrayRef(Argv)));
 #endif
 
-    if(Compilation) {
-      llvm::raw_string_ostream ss(invocationInfo.invocation);
-      Compilation->getJobs().Print(ss, "", true);
-      ss.flush();
-    }
+  if(Compilation) {
+    handleJobs(Compilation->getJobs());
+  }
+
+  diagnosticsStream.flush();
+
+  invocationInfo.errors = utility::trim(invocationInfo.errors);
+}
+}    // namespace
+
+ClangInvocationInfo ClangInvocationInfo::getClangInvocationString(const clang::tooling::CompilationDatabase* compilationDatabase) {
+  ClangInvocationInfo invocationInfo;
 
-    diagnosticsStream.flush();
+  if(!compilationDatabase->getAllCompileCommands().empty()) {
+    runDriver(compilationDatabase->getAllCompileCommands().front().CommandLine,
+              invocationInfo,
+              [&invocationInfo](const clang::driver::JobList& jobs) {
+                llvm::raw_string_ostream ss(invocationInfo.invocation);
+                jobs.Print(ss, "", true);
+                ss.flush();
+              });
 
     invocationInfo.invocation = utility::trim(invocationInfo.invocation);
-    invocationInfo.errors = utility::trim(invocationInfo.errors);
   }
   return invocationInfo;
 }
+
+ClangInvocationInfo ClangInvocationInfo::getClangInvocationInfo(const std::vector<std::string>& commandLine) {
+  ClangInvocationInfo invocationInfo;
+
+  if(!commandLine.empty()) {
+    runDriver(commandLine, invocationInfo, [&invocationInfo](const clang::driver::JobList& jobs) {
+      for(const clang::driver::Command& job : jobs) {
+        // the frontend job, a syntax only command line has no other clang job
+        if(llvm::StringRef(job.getCreator().getName()) == "clang") {
+          invocationInfo.executable = job.getExecutable();
+          invocationInfo.frontendArguments.assign(job.getArguments().begin(), job.getArguments().end());
+          break;
+        }
+      }
+    });
+  }
+  return invocationInfo;
+}
+
+std::string ClangInvocationInfo::getInvocationString() const {
+  if(!invocation.empty() || frontendArguments.empty()) {
+    return invocation;
+  }
+
+  std::string invocationString = '"' + executable + '"';
+  for(const std::string& argument : frontendArguments) {
+    invocationString += " \"" + argument + '"';
+  }
+  return invocationString;
+}
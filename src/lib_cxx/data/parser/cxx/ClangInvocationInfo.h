@@ -2,6 +2,7 @@
 #define CLANG_INVOCATION_INFO_H
 
 #include <string>
+#include <vector>
 
 namespace clang { namespace tooling {
 class CompilationDatabase;
@@ -9,9 +10,16 @@ class CompilationDatabase;
 
 struct ClangInvocationInfo {
   static ClangInvocationInfo getClangInvocationString(const clang::tooling::CompilationDatabase* compilationDatabase);
+  // runs the driver on the command line and keeps the arguments of its frontend job instead of printing them
+  static ClangInvocationInfo getClangInvocationInfo(const std::vector<std::string>& commandLine);
+
+  // the printed invocation, built from the frontend arguments if it was not printed by the driver
+  std::string getInvocationString() const;
 
   std::string invocation;
   std::string errors;
+  std::string executable;
+  std::vector<std::string> frontendArguments;
 };
 
 #endif    // CLANG_INVOCATION_INFO_H
@@ -14,7 +14,7 @@ bool CommentHandler::HandleComment(clang::Preprocessor& preprocessor, clang::Sou
   const clang::FileID fileId = sourceManager.getFileID(sourceRange.getBegin());
   Id fileSymbolId = m_canonicalFilePathCache->getFileSymbolId(fileId);
 
-  if(fileSymbolId && m_canonicalFilePathCache->isProjectFile(fileId, sourceManager)) {
+  if(fileSymbolId && m_canonicalFilePathCache->isIndexedFile(fileId, sourceManager)) {
     const clang::PresumedLoc& presumedBegin = sourceManager.getPresumedLoc(sourceRange.getBegin(), false);
     const clang::PresumedLoc& presumedEnd = sourceManager.getPresumedLoc(sourceRange.getEnd(), false);
 
@@ -15,7 +15,8 @@ CxxAstVisitor::CxxAstVisitor(clang::ASTContext* astContext,
                              clang::Preprocessor* preprocessor,
                              std::shared_ptr<ParserClient> client,
                              std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                             std::shared_ptr<IndexerStateInfo> indexerStateInfo)
+                             std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                             std::shared_ptr<CxxSymbolNameCache> symbolNameCache)
     : m_astContext(astContext)
     , m_preprocessor(preprocessor)
     , m_client(client)
@@ -25,7 +26,7 @@ CxxAstVisitor::CxxAstVisitor(clang::ASTContext* astContext,
     , m_declRefKindComponent(this)
     , m_typeRefKindComponent(this)
     , m_implicitCodeComponent(this)
-    , m_indexerComponent(this, astContext, client)
+    , m_indexerComponent(this, astContext, client, symbolNameCache)
     , m_braceRecorderComponent(this, astContext, client) {}
 
 CxxAstVisitor::~CxxAstVisitor() = default;
@@ -118,6 +119,7 @@ bool CxxAstVisitor::checkIgnoresTypeLoc(const clang::TypeLoc& tl) const {
 
 bool CxxAstVisitor::TraverseDecl(clang::Decl* decl) {
   bool traverse = true;
+  bool instantiatesClaimedHeader = false;
   if(decl) {
     const clang::SourceManager& sourceManager = m_astContext->getSourceManager();
     clang::SourceLocation loc = sourceManager.getExpansionLoc(decl->getLocation());
@@ -138,13 +140,26 @@ bool CxxAstVisitor::TraverseDecl(clang::Decl* decl) {
       }
 
       traverse = isLocatedInProjectFile(loc);
+
+      // the translation unit that claimed the header does not see the instantiations of this one
+      if(!traverse && m_implicitCodeDepth == 0 && utility::isImplicit(decl) && fileId.isValid() &&
+         m_canonicalFilePathCache->isProjectFile(fileId, sourceManager)) {
+        traverse = true;
+        instantiatesClaimedHeader = true;
+      }
     }
   }
 
   if(traverse) {
+    if(instantiatesClaimedHeader) {
+      m_implicitCodeDepth++;
+    }
     FOREACH_COMPONENT(beginTraverseDecl(decl));
     Base::TraverseDecl(decl);
     FOREACH_COMPONENT(endTraverseDecl(decl));
+    if(instantiatesClaimedHeader) {
+      m_implicitCodeDepth--;
+    }
   }
 
   if(m_indexerStateInfo && m_indexerStateInfo->indexingInterrupted) {
@@ -603,5 +618,8 @@ bool CxxAstVisitor::isLocatedInProjectFile(clang::SourceLocation loc) const {
   }
 
   const clang::SourceManager& sourceManager = m_astContext->getSourceManager();
-  return m_canonicalFilePathCache->isProjectFile(sourceManager.getFileID(loc), sourceManager);
+  if(m_implicitCodeDepth > 0) {
+    return m_canonicalFilePathCache->isProjectFile(sourceManager.getFileID(loc), sourceManager);
+  }
+  return m_canonicalFilePathCache->isIndexedFile(sourceManager.getFileID(loc), sourceManager);
 }
\ No newline at end of file
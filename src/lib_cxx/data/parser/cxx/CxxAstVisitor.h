@@ -11,6 +11,7 @@
 #include "CxxAstVisitorComponentTypeRefKind.h"
 
 class CanonicalFilePathCache;
+class CxxSymbolNameCache;
 class ParserClient;
 class FilePath;
 
@@ -34,7 +35,8 @@ public:
                 clang::Preprocessor* preprocessor,
                 std::shared_ptr<ParserClient> client,
                 std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache,
-                std::shared_ptr<IndexerStateInfo> indexerStateInfo);
+                std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                std::shared_ptr<CxxSymbolNameCache> symbolNameCache = nullptr);
 
   virtual ~CxxAstVisitor();
 
@@ -171,6 +173,9 @@ protected:
   CxxAstVisitorComponentImplicitCode m_implicitCodeComponent;
   CxxAstVisitorComponentIndexer m_indexerComponent;
   CxxAstVisitorComponentBraceRecorder m_braceRecorderComponent;
+
+  // > 0 while traversing implicit code located in a header recorded by another translation unit
+  size_t m_implicitCodeDepth = 0;
 };
 
 template <>
@@ -5,7 +5,9 @@
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
 #include <clang/Basic/Version.h>
+#include <clang/Index/USRGeneration.h>
 #include <clang/Lex/Preprocessor.h>
+#include <llvm/ADT/SmallString.h>
 
 #include "CanonicalFilePathCache.h"
 #include "CxxAstVisitor.h"
@@ -14,14 +16,19 @@
 #include "CxxAstVisitorComponentTypeRefKind.h"
 #include "CxxDeclNameResolver.h"
 #include "CxxFunctionDeclName.h"
+#include "CxxSymbolNameCache.h"
 #include "CxxTypeNameResolver.h"
 #include "ParserClient.h"
 #include "utilityClang.h"
 
 CxxAstVisitorComponentIndexer::CxxAstVisitorComponentIndexer(CxxAstVisitor* astVisitor,
                                                              clang::ASTContext* astContext,
-                                                             std::shared_ptr<ParserClient> client)
-    : CxxAstVisitorComponent(astVisitor), m_astContext(astContext), m_client(client) {}
+                                                             std::shared_ptr<ParserClient> client,
+                                                             std::shared_ptr<CxxSymbolNameCache> symbolNameCache)
+    : CxxAstVisitorComponent(astVisitor)
+    , m_astContext(astContext)
+    , m_client(client)
+    , m_symbolNameCache(std::move(symbolNameCache)) {}
 
 void CxxAstVisitorComponentIndexer::beginTraverseNestedNameSpecifierLoc(const clang::NestedNameSpecifierLoc& loc) {
   if(!getAstVisitor()->shouldVisitReference(loc.getBeginLoc())) {
@@ -744,6 +751,15 @@ Id CxxAstVisitorComponentIndexer::getOrCreateSymbolId(const clang::NamedDecl* de
     return it->second;
   }
 
+  const std::string cacheKey = getSymbolNameCacheKey(decl);
+  if(!cacheKey.empty()) {
+    if(const NameHierarchy* cachedSymbolName = m_symbolNameCache->find(cacheKey)) {
+      Id symbolId = m_client->recordSymbol(*cachedSymbolName);
+      m_declSymbolIds.emplace(decl, symbolId);
+      return symbolId;
+    }
+  }
+
   NameHierarchy symbolName(L"global", NAME_DELIMITER_UNKNOWN);
   if(decl) {
     std::unique_ptr<CxxDeclName> declName = CxxDeclNameResolver(getAstVisitor()->getCanonicalFilePathCache()).getName(decl);
@@ -758,6 +774,10 @@ Id CxxAstVisitorComponentIndexer::getOrCreateSymbolId(const clang::NamedDecl* de
                                     sig.getPrefix(),
                                     sig.getPostfix()));
       }
+
+      if(!cacheKey.empty()) {
+        m_symbolNameCache->insert(cacheKey, symbolName);
+      }
     }
   }
 
@@ -772,11 +792,24 @@ Id CxxAstVisitorComponentIndexer::getOrCreateSymbolId(const clang::Type* type) {
     return it->second;
   }
 
+  const std::string cacheKey = getSymbolNameCacheKey(type);
+  if(!cacheKey.empty()) {
+    if(const NameHierarchy* cachedSymbolName = m_symbolNameCache->find(cacheKey)) {
+      Id symbolId = m_client->recordSymbol(*cachedSymbolName);
+      m_typeSymbolIds.emplace(type, symbolId);
+      return symbolId;
+    }
+  }
+
   NameHierarchy symbolName(L"global", NAME_DELIMITER_UNKNOWN);
   if(type) {
     std::unique_ptr<CxxTypeName> typeName = CxxTypeNameResolver(getAstVisitor()->getCanonicalFilePathCache()).getName(type);
     if(typeName) {
       symbolName = typeName->toNameHierarchy();
+
+      if(!cacheKey.empty()) {
+        m_symbolNameCache->insert(cacheKey, symbolName);
+      }
     }
   }
 
@@ -809,3 +842,60 @@ Id CxxAstVisitorComponentIndexer::getOrCreateSymbolId(const CxxContext* context,
 
   return m_client->recordSymbol(fallback);    // TODO: cache result somehow
 }
+
+std::string CxxAstVisitorComponentIndexer::getSymbolNameCacheKey(const clang::NamedDecl* decl) const {
+  if(!m_symbolNameCache || !decl) {
+    return {};
+  }
+
+  // names of internal symbols, templated code and main functions contain parts that are local to the translation unit
+  if(!decl->isExternallyVisible() || decl->isTemplated()) {
+    return {};
+  }
+  if(const auto* functionDecl = clang::dyn_cast<clang::FunctionDecl>(decl); functionDecl && functionDecl->isMain()) {
+    return {};
+  }
+  for(const clang::DeclContext* context = decl->getDeclContext(); context != nullptr; context = context->getParent()) {
+    const auto* namedContext = clang::dyn_cast<clang::NamedDecl>(context);
+    if(namedContext && namedContext->getDeclName().isEmpty()) {
+      return {};
+    }
+  }
+  if(decl->getDeclName().isEmpty()) {
+    return {};
+  }
+
+  llvm::SmallString<128> usr;
+  if(clang::index::generateUSRForDecl(decl, usr)) {
+    return {};
+  }
+  return std::string(usr.str());
+}
+
+std::string CxxAstVisitorComponentIndexer::getSymbolNameCacheKey(const clang::Type* type) const {
+  if(!type || type->isDependentType()) {
+    return {};
+  }
+
+  // these resolve to the name of their tag declaration, see CxxTypeNameResolver
+  switch(type->getTypeClass()) {
+  case clang::Type::Enum:
+  case clang::Type::Record:
+  case clang::Type::TemplateSpecialization:
+    break;
+  default:
+    return {};
+  }
+
+  const auto* tagType = type->getAs<clang::TagType>();
+  if(!tagType) {
+    return {};
+  }
+
+  const std::string declKey = getSymbolNameCacheKey(tagType->getDecl());
+  if(declKey.empty()) {
+    return {};
+  }
+  // type names are built differently from decl names, keep them apart
+  return "type:" + declKey;
+}
@@ -1,5 +1,6 @@
 #pragma once
 // STL
+#include <string>
 #include <unordered_map>
 // internal
 #include "CxxAstVisitorComponent.h"
@@ -8,6 +9,7 @@
 #include "SymbolKind.h"
 
 class CxxContext;
+class CxxSymbolNameCache;
 class ParserClient;
 class NameHierarchy;
 
@@ -15,7 +17,10 @@ class NameHierarchy;
 // visited AST.
 class CxxAstVisitorComponentIndexer : public CxxAstVisitorComponent {
 public:
-  CxxAstVisitorComponentIndexer(CxxAstVisitor* astVisitor, clang::ASTContext* astContext, std::shared_ptr<ParserClient> client);
+  CxxAstVisitorComponentIndexer(CxxAstVisitor* astVisitor,
+                                clang::ASTContext* astContext,
+                                std::shared_ptr<ParserClient> client,
+                                std::shared_ptr<CxxSymbolNameCache> symbolNameCache = nullptr);
 
   void beginTraverseNestedNameSpecifierLoc(const clang::NestedNameSpecifierLoc& loc);
   void beginTraverseTemplateArgumentLoc(const clang::TemplateArgumentLoc& loc);
@@ -70,9 +75,13 @@ private:
   Id getOrCreateSymbolId(const CxxContext* context);
   Id getOrCreateSymbolId(const CxxContext* context, const NameHierarchy& fallback);
 
+  // empty if the name of the symbol may differ between translation units and must not be cached
+  std::string getSymbolNameCacheKey(const clang::NamedDecl* decl) const;
+  std::string getSymbolNameCacheKey(const clang::Type* type) const;
 
   clang::ASTContext* m_astContext;
   std::shared_ptr<ParserClient> m_client;
+  std::shared_ptr<CxxSymbolNameCache> m_symbolNameCache;
 
   std::map<const clang::NamedDecl*, Id> m_declSymbolIds;
   std::map<const clang::Type*, Id> m_typeSymbolIds;
@@ -1,19 +1,27 @@
 #include "CxxParser.h"
 // clang
+#include <clang/Basic/FileManager.h>
 #include <clang/Driver/Compilation.h>
 #include <clang/Driver/Driver.h>
 #include <clang/Driver/Options.h>
 #include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Lex/HeaderSearchOptions.h>
+#include <clang/Lex/PreprocessorOptions.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
 #include <clang/Tooling/Tooling.h>
-// llvm
+// STL
+#include <algorithm>
+#include <tuple>
 #include <utility>
-
+// llvm
+#include <llvm/ADT/Hashing.h>
 #include <llvm/Option/ArgList.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/VirtualFileSystem.h>
 // internal
 #include "ASTAction.h"
 #include "CanonicalFilePathCache.h"
+#include "ClangInvocationCache.h"
 #include "ClangInvocationInfo.h"
 #include "CxxCompilationDatabaseSingle.h"
 #include "CxxDiagnosticConsumer.h"
@@ -21,6 +29,7 @@
 #include "FileRegister.h"
 #include "IApplicationSettings.hpp"
 #include "IndexerCommandCxx.h"
+#include "IndexerStateInfo.h"
 #include "logging.h"
 #include "ParserClient.h"
 #include "SingleFrontendActionFactory.h"
@@ -37,6 +46,63 @@ std::vector<std::string> appendFilePath(const std::vector<std::string>& args, ll
   return utility::concat(args, {filePath.str()});
 }
 
+// a precompiled header that could not be built would abort parsing, without it its includes are parsed from source
+void removeMissingIncludePchFlags(std::vector<std::wstring>& args) {
+  for(size_t i = 0; i + 1 < args.size();) {
+    if(args[i] == L"-include-pch" && !FilePath(args[i + 1]).exists()) {
+      LOG_WARNING(L"Precompiled header \"{}\" does not exist, parsing without it.", args[i + 1]);
+      args.erase(args.begin() + static_cast<long>(i), args.begin() + static_cast<long>(i) + 2);
+    } else {
+      i++;
+    }
+  }
+}
+
+// applies the argument adjusters and the resource directory of clang::tooling::ClangTool
+std::vector<std::string> adjustToolArgs(std::vector<std::string> args, llvm::StringRef filePath) {
+  for(const clang::tooling::ArgumentsAdjuster& adjuster : {clang::tooling::getClangStripOutputAdjuster(),
+                                                            clang::tooling::getClangSyntaxOnlyAdjuster(),
+                                                            clang::tooling::getClangStripDependencyFileAdjuster()}) {
+    args = adjuster(args, filePath);
+  }
+
+  const auto isResourceDirFlag = [](const std::string& arg) {
+    return utility::isPrefix<std::string>("-resource-dir", arg);
+  };
+  if(std::none_of(args.begin(), args.end(), isResourceDirFlag)) {
+    static int staticSymbol;
+    args.push_back("-resource-dir=" + clang::CompilerInvocation::GetResourcesPath("clang_tool", &staticSymbol));
+  }
+  return args;
+}
+
+// the frontend part of clang::tooling::ToolInvocation, the driver already ran for the invocation info
+std::shared_ptr<clang::CompilerInvocation> createCompilerInvocation(const ClangInvocationInfo& invocationInfo,
+                                                                    const char* binaryName,
+                                                                    clang::DiagnosticConsumer* diagnosticConsumer) {
+  if(invocationInfo.frontendArguments.empty()) {
+    return nullptr;
+  }
+
+  std::vector<const char*> argv;
+  argv.reserve(invocationInfo.frontendArguments.size());
+  for(const std::string& argument : invocationInfo.frontendArguments) {
+    argv.push_back(argument.c_str());
+  }
+
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> options = new clang::DiagnosticOptions();
+  clang::DiagnosticsEngine diagnostics(
+      llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs>(new clang::DiagnosticIDs()), &*options, diagnosticConsumer, false);
+
+  auto invocation = std::make_shared<clang::CompilerInvocation>();
+  if(!clang::CompilerInvocation::CreateFromArgs(*invocation, argv, diagnostics, binaryName)) {
+    return nullptr;
+  }
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getCodeGenOpts().DisableFree = false;
+  return invocation;
+}
+
 // custom implementation of clang::runToolOnCodeWithArgs which also sets our custom DiagnosticConsumer
 bool runToolOnCodeWithArgs(
     clang::DiagnosticConsumer* DiagConsumer,
@@ -97,6 +163,30 @@ std::vector<std::string> CxxParser::getCommandlineArgumentsEssential(const std::
   return args;
 }
 
+size_t CxxParser::getPreprocessorContextHash(const clang::CompilerInvocation& invocation) {
+  // language, target, sysroot and macros, as for the compatibility of precompiled modules
+  llvm::hash_code code = llvm::hash_value(invocation.getModuleHash());
+
+  const clang::HeaderSearchOptions& headerSearchOptions = invocation.getHeaderSearchOpts();
+  for(const clang::HeaderSearchOptions::Entry& entry : headerSearchOptions.UserEntries) {
+    code = llvm::hash_combine(code, entry.Path, entry.Group, entry.IsFramework);
+  }
+  for(const clang::HeaderSearchOptions::SystemHeaderPrefix& prefix : headerSearchOptions.SystemHeaderPrefixes) {
+    code = llvm::hash_combine(code, prefix.Prefix, prefix.IsSystemHeader);
+  }
+
+  const clang::PreprocessorOptions& preprocessorOptions = invocation.getPreprocessorOpts();
+  for(const auto& [macro, isUndef] : preprocessorOptions.Macros) {
+    code = llvm::hash_combine(code, macro, isUndef);
+  }
+  code = llvm::hash_combine(code, llvm::hash_combine_range(preprocessorOptions.Includes.begin(), preprocessorOptions.Includes.end()));
+  code = llvm::hash_combine(
+      code, llvm::hash_combine_range(preprocessorOptions.MacroIncludes.begin(), preprocessorOptions.MacroIncludes.end()));
+  code = llvm::hash_combine(code, preprocessorOptions.ImplicitPCHInclude);
+
+  return static_cast<size_t>(code);
+}
+
 void CxxParser::initializeLLVM() {
   static bool initialized = false;
   if(!initialized) {
@@ -110,12 +200,22 @@ void CxxParser::initializeLLVM() {
 
 CxxParser::CxxParser(std::shared_ptr<ParserClient> client,
                      std::shared_ptr<FileRegister> fileRegister,
-                     std::shared_ptr<IndexerStateInfo> indexerStateInfo)
-    : Parser(std::move(client)), m_fileRegister(std::move(fileRegister)), m_indexerStateInfo(std::move(indexerStateInfo)) {
+                     std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+                     llvm::IntrusiveRefCntPtr<clang::FileManager> fileManager,
+                     std::shared_ptr<CxxSymbolNameCache> symbolNameCache,
+                     std::shared_ptr<ClangInvocationCache> invocationCache)
+    : Parser(std::move(client))
+    , m_fileRegister(std::move(fileRegister))
+    , m_indexerStateInfo(std::move(indexerStateInfo))
+    , m_fileManager(std::move(fileManager))
+    , m_symbolNameCache(std::move(symbolNameCache))
+    , m_invocationCache(std::move(invocationCache)) {
   llvm::InitializeNativeTarget();
   llvm::InitializeNativeTargetAsmParser();
 }
 
+CxxParser::~CxxParser() = default;
+
 void CxxParser::buildIndex(const std::shared_ptr<IndexerCommandCxx>& indexerCommand) {
   clang::tooling::CompileCommand compileCommand;
   compileCommand.Filename = utility::encodeToUtf8(indexerCommand->getSourceFilePath().wstr());
@@ -124,6 +224,7 @@ void CxxParser::buildIndex(const std::shared_ptr<IndexerCommandCxx>& indexerComm
   if(!args.empty() && !utility::isPrefix<std::wstring>(L"-", args.front())) {
     args.erase(args.begin());
   }
+  removeMissingIncludePchFlags(args);
   compileCommand.CommandLine = getCommandlineArgumentsEssential(args);
   compileCommand.CommandLine = prependSyntaxOnlyToolArgs(compileCommand.CommandLine);
 
@@ -137,7 +238,7 @@ void CxxParser::buildIndex(const std::wstring& fileName,
   auto canonicalFilePathCache = std::make_shared<CanonicalFilePathCache>(m_fileRegister);
 
   auto diagnostics = getDiagnostics(FilePath(), canonicalFilePathCache, false);
-  auto action = std::make_unique<ASTAction>(m_client, canonicalFilePathCache, m_indexerStateInfo);
+  auto action = std::make_unique<ASTAction>(m_client, canonicalFilePathCache, m_indexerStateInfo, m_symbolNameCache);
 
   auto args = getCommandlineArgumentsEssential(compilerFlags);
 
@@ -147,39 +248,72 @@ void CxxParser::buildIndex(const std::wstring& fileName,
 void CxxParser::runTool(clang::tooling::CompilationDatabase* pCompilationDatabase, const FilePath& sourceFilePath) {
   initializeLLVM();
 
-  clang::tooling::ClangTool tool(*pCompilationDatabase, std::vector<std::string>(1, utility::encodeToUtf8(sourceFilePath.wstr())));
+  const std::vector<clang::tooling::CompileCommand> compileCommands = pCompilationDatabase->getAllCompileCommands();
+  if(compileCommands.empty()) {
+    return;
+  }
+  const clang::tooling::CompileCommand& compileCommand = compileCommands.front();
 
-  auto pCanonicalFilePathCache = std::make_shared<CanonicalFilePathCache>(m_fileRegister);
-  auto pDiagnostics = getDiagnostics(sourceFilePath, pCanonicalFilePathCache, true);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> fileManager = m_fileManager;
+  if(!fileManager) {
+    fileManager = llvm::makeIntrusiveRefCnt<clang::FileManager>(clang::FileSystemOptions(), llvm::vfs::getRealFileSystem());
+  }
+
+  // like clang::tooling::ClangTool, this changes the working directory of the real file system for the driver and the parser
+  llvm::vfs::FileSystem& fileSystem = fileManager->getVirtualFileSystem();
+  const llvm::ErrorOr<std::string> initialWorkingDirectory = fileSystem.getCurrentWorkingDirectory();
+  if(const std::error_code error = fileSystem.setCurrentWorkingDirectory(compileCommand.Directory)) {
+    LOG_ERROR("Cannot change to working directory \"{}\": {}", compileCommand.Directory, error.message());
+    return;
+  }
+
+  const std::vector<std::string> commandLine = adjustToolArgs(compileCommand.CommandLine, compileCommand.Filename);
 
-  tool.setDiagnosticConsumer(pDiagnostics.get());
+  // the driver only runs for the first of all command lines that differ in their source file
+  const ClangInvocationInfo info = m_invocationCache
+      ? m_invocationCache->getInvocationInfo(
+            commandLine, compileCommand.Directory, utility::encodeToUtf8(sourceFilePath.fileName()))
+      : ClangInvocationInfo::getClangInvocationInfo(commandLine);
 
-  ClangInvocationInfo info;
-  info = ClangInvocationInfo::getClangInvocationString(pCompilationDatabase);
-  LOG_INFO("Clang Invocation: " +
-           info.invocation.substr(
-               0, IApplicationSettings::getInstanceRaw()->getVerboseIndexerLoggingEnabled() ? std::string::npos : 20000));
+  auto* pAppSettings = IApplicationSettings::getInstanceRaw();
+  if(pAppSettings->getLoggingEnabled()) {
+    LOG_INFO("Clang Invocation: " +
+             info.getInvocationString().substr(0, pAppSettings->getVerboseIndexerLoggingEnabled() ? std::string::npos : 20000));
 
-  if(!info.errors.empty()) {
-    LOG_INFO("Clang Invocation errors: " + info.errors);
+    if(!info.errors.empty()) {
+      LOG_INFO("Clang Invocation errors: " + info.errors);
+    }
   }
 
-  auto* pAction = new ASTAction(m_client, pCanonicalFilePathCache, m_indexerStateInfo);
-  tool.run(new SingleFrontendActionFactory(pAction));
+  auto pCanonicalFilePathCache = std::make_shared<CanonicalFilePathCache>(m_fileRegister);
+  auto pDiagnostics = getDiagnostics(sourceFilePath, pCanonicalFilePathCache, true);
 
-  if(!m_client->hasContent()) {
-    if(info.invocation.empty()) {
-      info = ClangInvocationInfo::getClangInvocationString(pCompilationDatabase);
+  if(std::shared_ptr<clang::CompilerInvocation> invocation =
+         createCompilerInvocation(info, commandLine.front().c_str(), pDiagnostics.get())) {
+    if(m_indexerStateInfo && m_indexerStateInfo->claimHeader) {
+      pCanonicalFilePathCache->setHeaderClaimFunction([indexerStateInfo = m_indexerStateInfo,
+                                                       preprocessorContextHash = getPreprocessorContextHash(*invocation)](
+                                                          const FilePath& headerPath) {
+        return indexerStateInfo->claimHeader(headerPath, preprocessorContextHash);
+      });
     }
 
-    if(!info.errors.empty()) {
-      Id fileId = m_client->recordFile(sourceFilePath, true);
-      m_client->recordError(L"Clang Invocation errors: " + utility::decodeFromUtf8(info.errors),
-                            true,
-                            true,
-                            sourceFilePath,
-                            ParseLocation(fileId, 1, 1));
-    }
+    auto* pAction = new ASTAction(m_client, pCanonicalFilePathCache, m_indexerStateInfo, m_symbolNameCache);
+    SingleFrontendActionFactory(pAction).runInvocation(
+        std::move(invocation), fileManager.get(), std::make_shared<clang::PCHContainerOperations>(), pDiagnostics.get());
+  }
+
+  if(initialWorkingDirectory) {
+    std::ignore = fileSystem.setCurrentWorkingDirectory(*initialWorkingDirectory);
+  }
+
+  if(!m_client->hasContent() && !info.errors.empty()) {
+    Id fileId = m_client->recordFile(sourceFilePath, true);
+    m_client->recordError(L"Clang Invocation errors: " + utility::decodeFromUtf8(info.errors),
+                          true,
+                          true,
+                          sourceFilePath,
+                          ParseLocation(fileId, 1, 1));
   }
 }
 
@@ -2,17 +2,26 @@
 // STL
 #include <string>
 #include <vector>
+// llvm
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
 // internal
 #include "Parser.h"
 
 class CanonicalFilePathCache;
+class ClangInvocationCache;
 class CxxDiagnosticConsumer;
+class CxxSymbolNameCache;
 class FilePath;
 class FileRegister;
 class IndexerCommandCxx;
 class TaskParseCxx;
 class TextAccess;
 
+namespace clang {
+class CompilerInvocation;
+class FileManager;
+}    // namespace clang
+
 namespace clang::tooling {
 class CompilationDatabase;
 class FixedCompilationDatabase;
@@ -23,11 +32,24 @@ struct IndexerStateInfo;
 class CxxParser final : public Parser {
 public:
   static std::vector<std::string> getCommandlineArgumentsEssential(const std::vector<std::wstring>& compilerFlags);
+  // hash of the options that influence how a header is preprocessed, used to share indexed headers between translation units
+  static size_t getPreprocessorContextHash(const clang::CompilerInvocation& invocation);
   static void initializeLLVM();
 
+  /**
+   * @param fileManager Shared by consecutive translation units to reuse its stat cache, the tool creates its own if null
+   * @param symbolNameCache Shared by consecutive translation units to reuse resolved symbol names, names are resolved per
+   * translation unit if null
+   * @param invocationCache Shared by consecutive translation units to reuse driver results, the driver runs for every
+   * translation unit if null
+   */
   CxxParser(std::shared_ptr<ParserClient> client,
             std::shared_ptr<FileRegister> fileRegister,
-            std::shared_ptr<IndexerStateInfo> indexerStateInfo);
+            std::shared_ptr<IndexerStateInfo> indexerStateInfo,
+            llvm::IntrusiveRefCntPtr<clang::FileManager> fileManager = nullptr,
+            std::shared_ptr<CxxSymbolNameCache> symbolNameCache = nullptr,
+            std::shared_ptr<ClangInvocationCache> invocationCache = nullptr);
+  ~CxxParser() override;
 
   void buildIndex(const std::shared_ptr<IndexerCommandCxx>& indexerCommand);
 
@@ -46,4 +68,7 @@ private:
 
   std::shared_ptr<FileRegister> m_fileRegister;
   std::shared_ptr<IndexerStateInfo> m_indexerStateInfo;
+  llvm::IntrusiveRefCntPtr<clang::FileManager> m_fileManager;
+  std::shared_ptr<CxxSymbolNameCache> m_symbolNameCache;
+  std::shared_ptr<ClangInvocationCache> m_invocationCache;
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "CxxSymbolNameCache.h"
+// internal
+#include "logging.h"
+
+CxxSymbolNameCache::CxxSymbolNameCache(size_t maxEntryCount) : m_maxEntryCount(maxEntryCount) {}
+
+const NameHierarchy* CxxSymbolNameCache::find(const std::string& key) {
+  auto it = m_symbolNames.find(key);
+  if(it == m_symbolNames.end()) {
+    m_missCount++;
+    return nullptr;
+  }
+
+  m_hitCount++;
+  return &it->second;
+}
+
+void CxxSymbolNameCache::insert(const std::string& key, const NameHierarchy& symbolName) {
+  if(m_symbolNames.size() >= m_maxEntryCount) {
+    m_symbolNames.clear();
+  }
+  m_symbolNames.emplace(key, symbolName);
+}
+
+size_t CxxSymbolNameCache::getEntryCount() const {
+  return m_symbolNames.size();
+}
+
+size_t CxxSymbolNameCache::getHitCount() const {
+  return m_hitCount;
+}
+
+size_t CxxSymbolNameCache::getMissCount() const {
+  return m_missCount;
+}
+
+void CxxSymbolNameCache::logStats() const {
+  const size_t lookupCount = m_hitCount + m_missCount;
+  if(lookupCount == 0) {
+    return;
+  }
+
+  LOG_INFO("symbol name cache - {} entries, {} of {} lookups hit ({}%)",
+           m_symbolNames.size(),
+           m_hitCount,
+           lookupCount,
+           m_hitCount * 100 / lookupCount);
+}
@@ -0,0 +1,35 @@
+#pragma once
+// STL
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+// internal
+#include "NameHierarchy.h"
+
+/**
+ * Resolved symbol names of one indexer process, shared by all of its translation units.
+ *
+ * Keys are clang USRs, which are identical for the same symbol in every translation unit. Only names that do not depend on
+ * the translation unit they were resolved in may be inserted. The cache is cleared once it holds `maxEntryCount` names.
+ */
+class CxxSymbolNameCache final {
+public:
+  static constexpr size_t DefaultMaxEntryCount = 500000;
+
+  explicit CxxSymbolNameCache(size_t maxEntryCount = DefaultMaxEntryCount);
+
+  [[nodiscard]] const NameHierarchy* find(const std::string& key);
+  void insert(const std::string& key, const NameHierarchy& symbolName);
+
+  [[nodiscard]] size_t getEntryCount() const;
+  [[nodiscard]] size_t getHitCount() const;
+  [[nodiscard]] size_t getMissCount() const;
+
+  void logStats() const;
+
+private:
+  size_t m_maxEntryCount;
+  std::unordered_map<std::string, NameHierarchy> m_symbolNames;
+  size_t m_hitCount = 0;
+  size_t m_missCount = 0;
+};
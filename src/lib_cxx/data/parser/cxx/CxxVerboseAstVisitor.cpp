@@ -44,8 +44,9 @@ CxxVerboseAstVisitor::CxxVerboseAstVisitor(clang::ASTContext* context,
                                            clang::Preprocessor* preprocessor,
                                            const std::shared_ptr<ParserClient>& client,
                                            const std::shared_ptr<CanonicalFilePathCache>& canonicalFilePathCache,
-                                           const std::shared_ptr<IndexerStateInfo>& indexerStateInfo)
-    : base(context, preprocessor, client, canonicalFilePathCache, indexerStateInfo) {}
+                                           const std::shared_ptr<IndexerStateInfo>& indexerStateInfo,
+                                           const std::shared_ptr<CxxSymbolNameCache>& symbolNameCache)
+    : base(context, preprocessor, client, canonicalFilePathCache, indexerStateInfo, symbolNameCache) {}
 
 bool CxxVerboseAstVisitor::TraverseDecl(clang::Decl* decl) {
   if(nullptr != decl) {
@@ -12,7 +12,8 @@ public:
                        clang::Preprocessor* preprocessor,
                        const std::shared_ptr<ParserClient>& client,
                        const std::shared_ptr<CanonicalFilePathCache>& canonicalFilePathCache,
-                       const std::shared_ptr<IndexerStateInfo>& indexerStateInfo);
+                       const std::shared_ptr<IndexerStateInfo>& indexerStateInfo,
+                       const std::shared_ptr<CxxSymbolNameCache>& symbolNameCache);
 
 private:
   using base = CxxAstVisitor;
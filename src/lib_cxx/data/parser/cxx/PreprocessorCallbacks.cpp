@@ -22,14 +22,26 @@ void PreprocessorCallbacks::FileChanged(clang::SourceLocation location,
   const clang::FileID fileId = m_sourceManager.getFileID(location);
   const FilePath currentPath = m_canonicalFilePathCache->getCanonicalFilePath(fileId, m_sourceManager);
   m_currentPathIsProjectFile = false;
+  m_currentPathIsIndexedFile = false;
 
   if(!currentPath.empty()) {
     m_currentPathIsProjectFile = m_canonicalFilePathCache->isProjectFile(fileId, m_sourceManager);
+    m_currentPathIsIndexedFile = m_canonicalFilePathCache->isIndexedFile(fileId, m_sourceManager);
 
     if(m_fileWasRecorded.find(fileId) == m_fileWasRecorded.end()) {
       m_currentFileSymbolId = m_client->recordFile(currentPath, m_currentPathIsProjectFile);    // todo: fix for tests
       m_client->recordFileLanguage(m_currentFileSymbolId, L"cpp");
 
+      // the content of indexed files is stored with the index, clang has read it already. headers claimed by another
+      // translation unit get their content from that one
+      if(m_currentPathIsIndexedFile) {
+        bool invalid = false;
+        const llvm::StringRef content = m_sourceManager.getBufferData(fileId, &invalid);
+        if(!invalid) {
+          m_client->recordFileContent(m_currentFileSymbolId, std::string_view(content.data(), content.size()));
+        }
+      }
+
       m_canonicalFilePathCache->addFileSymbolId(fileId, currentPath, m_currentFileSymbolId);
       m_fileWasRecorded.insert(fileId);
     } else {
@@ -62,7 +74,8 @@ void PreprocessorCallbacks::InclusionDirective(clang::SourceLocation /*hashLocat
                                                const clang::Module* /*imported*/,
                                                clang::SrcMgr::CharacteristicKind /*fileType*/) {
 #endif
-  if(m_currentFileSymbolId && fileEntry) {
+  // includes of project headers recorded by another translation unit are recorded there as well
+  if(m_currentFileSymbolId && fileEntry && (m_currentPathIsIndexedFile || !m_currentPathIsProjectFile)) {
     const FilePath includedFilePath = m_canonicalFilePathCache->getCanonicalFilePath(*fileEntry);
     const NameHierarchy includedFileNameHierarchy(includedFilePath.wstr(), NAME_DELIMITER_FILE);
 
@@ -74,7 +87,9 @@ void PreprocessorCallbacks::InclusionDirective(clang::SourceLocation /*hashLocat
 }
 
 void PreprocessorCallbacks::MacroDefined(const clang::Token& macroNameToken, const clang::MacroDirective* macroDirective) {
-  if(m_currentPathIsProjectFile) {
+  onMacroChange(macroNameToken);
+
+  if(m_currentPathIsIndexedFile) {
     // ignore builtin macros
     if(m_sourceManager.getSpellingLoc(macroNameToken.getLocation()).printToString(m_sourceManager)[0] == '<') {
       return;
@@ -94,6 +109,7 @@ void PreprocessorCallbacks::MacroDefined(const clang::Token& macroNameToken, con
 void PreprocessorCallbacks::MacroUndefined(const clang::Token& macroNameToken,
                                            const clang::MacroDefinition& /*macroDefinition*/,
                                            const clang::MacroDirective* /*macroUndefinition*/) {
+  onMacroChange(macroNameToken);
   onMacroUsage(macroNameToken);
 }
 
@@ -121,8 +137,15 @@ void PreprocessorCallbacks::MacroExpands(const clang::Token& macroNameToken,
   onMacroUsage(macroNameToken);
 }
 
+void PreprocessorCallbacks::onMacroChange(const clang::Token& macroNameToken) {
+  // headers included after a macro of the source file itself may preprocess differently than in other translation units
+  if(m_sourceManager.isWrittenInMainFile(macroNameToken.getLocation())) {
+    m_canonicalFilePathCache->stopClaimingHeaders();
+  }
+}
+
 void PreprocessorCallbacks::onMacroUsage(const clang::Token& macroNameToken) {
-  if(m_currentPathIsProjectFile && isLocatedInProjectFile(macroNameToken.getLocation())) {
+  if(m_currentPathIsIndexedFile && isLocatedInProjectFile(macroNameToken.getLocation())) {
     const ParseLocation loc = getParseLocation(macroNameToken);
 
     const NameHierarchy referencedNameHierarchy(
@@ -186,5 +209,5 @@ bool PreprocessorCallbacks::isLocatedInProjectFile(const clang::SourceLocation l
     return false;
   }
 
-  return m_canonicalFilePathCache->isProjectFile(m_sourceManager.getFileID(spellingLoc), m_sourceManager);
+  return m_canonicalFilePathCache->isIndexedFile(m_sourceManager.getFileID(spellingLoc), m_sourceManager);
 }
@@ -70,6 +70,7 @@ public:
                     const clang::MacroArgs* args) override;
 
 private:
+  void onMacroChange(const clang::Token& macroNameToken);
   void onMacroUsage(const clang::Token& macroNameToken);
 
   ParseLocation getParseLocation(const clang::Token& macroNameToc) const;
@@ -83,6 +84,7 @@ private:
 
   Id m_currentFileSymbolId;
   bool m_currentPathIsProjectFile = false;
+  bool m_currentPathIsIndexedFile = false;
 
   std::set<clang::FileID> m_fileWasRecorded;
 };
@@ -1,5 +1,7 @@
 #include "SourceGroupCxxCdb.h"
 
+#include <map>
+
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/transform.hpp>
 
@@ -19,6 +21,11 @@
 #include "utility.h"
 #include "utilitySourceGroupCxx.h"
 
+namespace {
+// building a precompiled header costs about as much as parsing its includes once, so it only pays off for several files
+constexpr size_t MinSharedPreambleSourceFileCount = 3;
+}    // namespace
+
 SourceGroupCxxCdb::SourceGroupCxxCdb(std::shared_ptr<SourceGroupSettingsCxxCdb> settings) : m_settings(std::move(settings)) {}
 
 bool SourceGroupCxxCdb::prepareIndexing() {
@@ -81,6 +88,10 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
   const std::set<FilePathFilter> excludeFilters = utility::toSet(m_settings->getExcludeFiltersExpandedAndAbsolute());
   const std::set<FilePath>& sourceFilePaths = getAllSourceFilePaths(cdb);
 
+  std::vector<std::shared_ptr<IndexerCommandCxx>> commands;
+  // commands that don't use a precompiled header already can share a precompiled header of their leading includes
+  std::vector<std::shared_ptr<IndexerCommandCxx>> commandsWithoutPch;
+
   for(const clang::tooling::CompileCommand& command : cdb->getAllCompileCommands()) {
     FilePath sourcePath = FilePath(utility::decodeFromUtf8(command.Filename)).makeCanonical();
     if(!sourcePath.isAbsolute()) {
@@ -111,19 +122,49 @@ std::shared_ptr<IndexerCommandProvider> SourceGroupCxxCdb::getIndexerCommandProv
 
       utility::removeIncludePchFlag(cdbFlags);
 
-      if(command.CommandLine.size() != cdbFlags.size()) {
+      const bool usesPch = command.CommandLine.size() != cdbFlags.size();
+      if(usesPch) {
         utility::append(cdbFlags, includePchFlags);
       }
 
-      provider->addCommand(std::make_shared<IndexerCommandCxx>(sourcePath,
-                                                               utility::concat(indexedHeaderPaths, {sourcePath}),
-                                                               excludeFilters,
-                                                               std::set<FilePathFilter>(),
-                                                               FilePath(utility::decodeFromUtf8(command.Directory)),
-                                                               utility::concat(cdbFlags, compilerFlags)));
+      commands.push_back(std::make_shared<IndexerCommandCxx>(sourcePath,
+                                                             utility::concat(indexedHeaderPaths, {sourcePath}),
+                                                             excludeFilters,
+                                                             std::set<FilePathFilter>(),
+                                                             FilePath(utility::decodeFromUtf8(command.Directory)),
+                                                             utility::concat(cdbFlags, compilerFlags)));
+      if(!usesPch && includePchFlags.empty()) {
+        commandsWithoutPch.push_back(commands.back());
+      }
+    }
+  }
+
+  std::vector<utility::SharedPreamble> sharedPreambles = utility::getSharedPreambles(
+      commandsWithoutPch, m_settings->getPchDependenciesDirectoryPath().getConcatenated(L"preamble"), MinSharedPreambleSourceFileCount);
+
+  std::map<FilePath, std::vector<std::wstring>> includeSharedPreambleFlags;
+  for(const utility::SharedPreamble& sharedPreamble : sharedPreambles) {
+    for(const FilePath& sharedPreambleSourcePath : sharedPreamble.sourceFilePaths) {
+      includeSharedPreambleFlags.emplace(sharedPreambleSourcePath, utility::getIncludeSharedPreambleFlags(sharedPreamble));
+    }
+  }
+
+  for(const std::shared_ptr<IndexerCommandCxx>& command : commands) {
+    const auto it = includeSharedPreambleFlags.find(command->getSourceFilePath());
+    if(it == includeSharedPreambleFlags.end()) {
+      provider->addCommand(command);
+    } else {
+      provider->addCommand(std::make_shared<IndexerCommandCxx>(command->getSourceFilePath(),
+                                                               command->getIndexedPaths(),
+                                                               command->getExcludeFilters(),
+                                                               command->getIncludeFilters(),
+                                                               command->getWorkingDirectory(),
+                                                               utility::concat(command->getCompilerFlags(), it->second)));
     }
   }
 
+  LOG_INFO(L"Sharing the leading includes of {} groups of source files through precompiled headers", sharedPreambles.size());
+  provider->setSharedPreambles(std::move(sharedPreambles));
   provider->logStats();
 
   return provider;
@@ -133,10 +174,17 @@ std::vector<std::shared_ptr<IndexerCommand>> SourceGroupCxxCdb::getIndexerComman
   return getIndexerCommandProvider(info)->consumeAllCommands();
 }
 
-std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(std::shared_ptr<StorageProvider> storageProvider,
+std::shared_ptr<Task> SourceGroupCxxCdb::getPreIndexTask(const IndexerCommandProvider& indexerCommandProvider,
+                                                         std::shared_ptr<StorageProvider> storageProvider,
                                                          std::shared_ptr<DialogView> dialogView) const {
   if(m_settings->getPchInputFilePath().empty()) {
-    return std::make_shared<TaskLambda>([]() {});
+    // the commands of the provider already carry the flags that load the shared preambles
+    const auto* cxxIndexerCommandProvider = dynamic_cast<const CxxIndexerCommandProvider*>(&indexerCommandProvider);
+    return utility::createBuildSharedPreamblesTask(
+        cxxIndexerCommandProvider != nullptr ? cxxIndexerCommandProvider->getSharedPreambles() :
+                                               std::vector<utility::SharedPreamble>(),
+        storageProvider,
+        dialogView);
   }
 
   std::vector<std::wstring> compilerFlags;
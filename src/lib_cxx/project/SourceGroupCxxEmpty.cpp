@@ -86,7 +86,8 @@ std::vector<std::shared_ptr<IndexerCommand>> SourceGroupCxxEmpty::getIndexerComm
   return getIndexerCommandProvider(info)->consumeAllCommands();
 }
 
-std::shared_ptr<Task> SourceGroupCxxEmpty::getPreIndexTask(std::shared_ptr<StorageProvider> storageProvider,
+std::shared_ptr<Task> SourceGroupCxxEmpty::getPreIndexTask(const IndexerCommandProvider& /*indexerCommandProvider*/,
+                                                           std::shared_ptr<StorageProvider> storageProvider,
                                                            std::shared_ptr<DialogView> dialogView) const {
   const auto* pchSettings = dynamic_cast<const SourceGroupSettingsWithCxxPchOptions*>(mSettings.get());
   if(nullptr == pchSettings || pchSettings->getPchInputFilePath().empty()) {
@@ -14,7 +14,8 @@ public:
   std::set<FilePath> getAllSourceFilePaths() const override;
   std::shared_ptr<IndexerCommandProvider> getIndexerCommandProvider(const RefreshInfo& info) const override;
   std::vector<std::shared_ptr<IndexerCommand>> getIndexerCommands(const RefreshInfo& info) const override;
-  std::shared_ptr<Task> getPreIndexTask(std::shared_ptr<StorageProvider> storageProvider,
+  std::shared_ptr<Task> getPreIndexTask(const IndexerCommandProvider& indexerCommandProvider,
+                                        std::shared_ptr<StorageProvider> storageProvider,
                                         std::shared_ptr<DialogView> dialogView) const override;
 
 private:
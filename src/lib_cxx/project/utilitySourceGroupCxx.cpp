@@ -1,7 +1,10 @@
 #include "utilitySourceGroupCxx.h"
 
 #include <algorithm>
+#include <fstream>
 #include <iterator>
+#include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -18,12 +21,16 @@
 #include "FileRegister.h"
 #include "FileSystem.h"
 #include "GeneratePCHAction.h"
+#include "IncludeDirective.h"
+#include "IncludeProcessing.h"
+#include "IndexerCommandCxx.h"
 #include "logging.h"
 #include "ParserClientImpl.h"
 #include "SingleFrontendActionFactory.h"
 #include "SourceGroupSettingsWithCxxPchOptions.h"
 #include "StorageProvider.h"
 #include "TaskLambda.h"
+#include "TextAccess.h"
 #include "utility.h"
 #include "utilityString.h"
 
@@ -31,9 +38,262 @@ namespace {
 bool contains(const std::wstring& text, const std::wstring& value) {
   return text.find(value) != std::wstring::npos;
 }
+
+// flags taking their value as the next argument that only influence the output of a compilation
+bool isSeparateOutputFlag(const std::wstring& flag) {
+  static const std::set<std::wstring> flags = {L"-o", L"-MF", L"-MT", L"-MQ"};
+  return flags.contains(flag);
+}
+
+bool isOutputFlag(const std::wstring& flag) {
+  static const std::set<std::wstring> flags = {L"-c", L"-MD", L"-MMD"};
+  return flags.contains(flag);
+}
+
+std::vector<std::wstring> getCompilerFlagsWithoutSourceAndOutput(const std::vector<std::wstring>& compilerFlags,
+                                                                 const FilePath& sourceFilePath) {
+  std::vector<std::wstring> flags;
+  for(size_t index = 0; index < compilerFlags.size(); index++) {
+    const std::wstring& flag = compilerFlags[index];
+    if(isSeparateOutputFlag(flag)) {
+      index++;
+    } else if((index > 0 || utility::isPrefix<std::wstring>(L"-", flag)) && !isOutputFlag(flag) &&
+              FilePath(flag).fileName() != sourceFilePath.fileName()) {
+      flags.push_back(flag);
+    }
+  }
+  return flags;
+}
+
+std::set<FilePath> getHeaderSearchDirectories(const std::vector<std::wstring>& compilerFlags, const FilePath& workingDirectory) {
+  static const std::vector<std::wstring> prefixes = {L"-I", L"-isystem", L"-iquote", L"-idirafter"};
+
+  std::set<FilePath> headerSearchDirectories;
+  for(size_t index = 0; index < compilerFlags.size(); index++) {
+    const std::wstring& flag = compilerFlags[index];
+    for(const std::wstring& prefix : prefixes) {
+      if(utility::isPrefix(prefix, flag)) {
+        FilePath directory(flag == prefix && index + 1 < compilerFlags.size() ? compilerFlags[++index]
+                                                                              : flag.substr(prefix.size()));
+        if(!directory.isAbsolute()) {
+          directory = workingDirectory.getConcatenated(directory);
+        }
+        headerSearchDirectories.insert(directory);
+        break;
+      }
+    }
+  }
+  return headerSearchDirectories;
+}
+
+// the leading includes of the source file up to the first one that may not be skipped when it is included a second time
+std::vector<IncludeDirective> getSharedIncludeDirectives(const FilePath& sourceFilePath,
+                                                         const std::set<FilePath>& headerSearchDirectories,
+                                                         std::map<FilePath, bool>& includeGuardedHeaders) {
+  std::vector<IncludeDirective> includeDirectives = IncludeProcessing::getLeadingIncludeDirectives(
+      TextAccess::createFromFile(sourceFilePath));
+
+  for(size_t index = 0; index < includeDirectives.size(); index++) {
+    const FilePath headerFilePath = IncludeProcessing::resolveIncludeDirective(includeDirectives[index], headerSearchDirectories);
+
+    // headers not found in the search directories of the flags are system headers, which are guarded
+    bool isGuarded = includeDirectives[index].usesBrackets();
+    if(!headerFilePath.empty()) {
+      auto it = includeGuardedHeaders.find(headerFilePath);
+      if(it == includeGuardedHeaders.end()) {
+        it = includeGuardedHeaders
+                 .emplace(headerFilePath, IncludeProcessing::hasIncludeGuard(TextAccess::createFromFile(headerFilePath)))
+                 .first;
+      }
+      isGuarded = it->second;
+    }
+
+    if(!isGuarded) {
+      includeDirectives.erase(includeDirectives.begin() + static_cast<long>(index), includeDirectives.end());
+      break;
+    }
+  }
+
+  return includeDirectives;
+}
+
+// compileFlags have to contain the input file and the flags for emitting the precompiled header
+void buildPch(const FilePath& inputFilePath,
+              const FilePath& outputFilePath,
+              const FilePath& workingDirectory,
+              const std::vector<std::wstring>& compilerFlags,
+              const std::set<FilePath>& indexedPaths,
+              const std::set<FilePathFilter>& excludeFilters,
+              StorageProvider& storageProvider) {
+  CxxParser::initializeLLVM();
+
+  if(!outputFilePath.getParentDirectory().exists()) {
+    FileSystem::createDirectory(outputFilePath.getParentDirectory());
+  }
+
+  const std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
+  const std::shared_ptr<ParserClientImpl> client = std::make_shared<ParserClientImpl>(storage.get());
+
+  const std::shared_ptr<FileRegister> fileRegister = std::make_shared<FileRegister>(inputFilePath, indexedPaths, excludeFilters);
+
+  const std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache = std::make_shared<CanonicalFilePathCache>(fileRegister);
+
+  clang::tooling::CompileCommand pchCommand;
+  pchCommand.Filename = utility::encodeToUtf8(inputFilePath.fileName());
+  pchCommand.Directory = workingDirectory.str();
+  // DON'T use "-fsyntax-only" here because it will cause the output file to be erased
+  pchCommand.CommandLine = utility::concat({"clang-tool"}, CxxParser::getCommandlineArgumentsEssential(compilerFlags));
+
+  const CxxCompilationDatabaseSingle compilationDatabase(pchCommand);
+  clang::tooling::ClangTool tool(compilationDatabase, {utility::encodeToUtf8(inputFilePath.wstr())});
+  auto* action = new GeneratePCHAction(client, canonicalFilePathCache);    // NOLINT(cppcoreguidelines-owning-memory)
+
+  const llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> options =
+      new clang::DiagnosticOptions;    // NOLINT(cppcoreguidelines-owning-memory)
+  CxxDiagnosticConsumer diagnostics(llvm::errs(), &*options, client, canonicalFilePathCache, inputFilePath, true);
+
+  tool.setDiagnosticConsumer(&diagnostics);
+  tool.clearArgumentsAdjusters();
+  tool.run(new SingleFrontendActionFactory(action));    // NOLINT(cppcoreguidelines-owning-memory)
+
+  storageProvider.insert(storage);
+}
 }    // namespace
 
 namespace utility {
+std::vector<SharedPreamble> getSharedPreambles(const std::vector<std::shared_ptr<IndexerCommandCxx>>& commands,
+                                               const FilePath& outputDirectoryPath,
+                                               size_t minSourceFileCount) {
+  static const std::vector<std::wstring> cSourceExtensions = {L".c"};
+  static const std::vector<std::wstring> cxxSourceExtensions = {L".cpp", L".cxx", L".cc", L".c++", L".C"};
+
+  std::map<std::wstring, SharedPreamble> sharedPreambles;
+  std::map<FilePath, bool> includeGuardedHeaders;
+
+  for(const std::shared_ptr<IndexerCommandCxx>& command : commands) {
+    const FilePath& sourceFilePath = command->getSourceFilePath();
+    const bool isCSource = sourceFilePath.hasExtension(cSourceExtensions);
+    if(!isCSource && !sourceFilePath.hasExtension(cxxSourceExtensions)) {
+      continue;
+    }
+
+    std::vector<std::wstring> compilerFlags = getCompilerFlagsWithoutSourceAndOutput(command->getCompilerFlags(), sourceFilePath);
+    // an explicit language would also apply to the shared includes, which need to be compiled as header
+    if(std::ranges::find(compilerFlags, L"-x") != compilerFlags.end()) {
+      continue;
+    }
+
+    const std::vector<IncludeDirective> includeDirectives = getSharedIncludeDirectives(
+        sourceFilePath,
+        getHeaderSearchDirectories(compilerFlags, command->getWorkingDirectory()),
+        includeGuardedHeaders);
+    if(includeDirectives.empty()) {
+      continue;
+    }
+
+    // quoted includes are looked up next to the including file first, the shared includes are not compiled there
+    if(std::ranges::any_of(includeDirectives, [](const IncludeDirective& directive) { return !directive.usesBrackets(); })) {
+      compilerFlags.insert(compilerFlags.begin(), {L"-iquote", sourceFilePath.getParentDirectory().wstr()});
+    }
+    compilerFlags.emplace_back(L"-x");
+    compilerFlags.emplace_back(isCSource ? L"c-header" : L"c++-header");
+
+    std::set<FilePath> indexedPaths = command->getIndexedPaths();
+    indexedPaths.erase(sourceFilePath);
+
+    std::wstring key = command->getWorkingDirectory().wstr() + L'\n';
+    for(const std::wstring& flag : compilerFlags) {
+      key += flag + L'\n';
+    }
+    for(const IncludeDirective& includeDirective : includeDirectives) {
+      key += includeDirective.getDirective() + L'\n';
+    }
+    for(const FilePath& indexedPath : indexedPaths) {
+      key += indexedPath.wstr() + L'\n';
+    }
+    for(const FilePathFilter& excludeFilter : command->getExcludeFilters()) {
+      key += excludeFilter.wstr() + L'\n';
+    }
+
+    auto [it, inserted] = sharedPreambles.try_emplace(key);
+    SharedPreamble& sharedPreamble = it->second;
+    if(inserted) {
+      for(const IncludeDirective& includeDirective : includeDirectives) {
+        sharedPreamble.includeDirectives.push_back(includeDirective.getDirective());
+      }
+      sharedPreamble.workingDirectory = command->getWorkingDirectory();
+      sharedPreamble.compilerFlags = std::move(compilerFlags);
+      sharedPreamble.indexedPaths = std::move(indexedPaths);
+      sharedPreamble.excludeFilters = command->getExcludeFilters();
+
+      const std::wstring fileName = L"preamble_" + std::to_wstring(std::hash<std::wstring>{}(key));
+      sharedPreamble.headerFilePath = outputDirectoryPath.getConcatenated(fileName + L".h");
+      sharedPreamble.pchFilePath = outputDirectoryPath.getConcatenated(fileName + L".pch");
+    }
+    sharedPreamble.sourceFilePaths.push_back(sourceFilePath);
+  }
+
+  std::vector<SharedPreamble> ret;
+  for(auto& [key, sharedPreamble] : sharedPreambles) {
+    if(sharedPreamble.sourceFilePaths.size() >= minSourceFileCount) {
+      ret.push_back(std::move(sharedPreamble));
+    }
+  }
+  return ret;
+}
+
+std::vector<std::wstring> getIncludeSharedPreambleFlags(const SharedPreamble& sharedPreamble) {
+  return {L"-fallow-pch-with-compiler-errors", L"-include-pch", sharedPreamble.pchFilePath.wstr()};
+}
+
+std::shared_ptr<Task> createBuildSharedPreamblesTask(std::vector<SharedPreamble> sharedPreambles,
+                                                     const std::shared_ptr<StorageProvider>& storageProvider,
+                                                     const std::shared_ptr<DialogView>& dialogView) {
+  if(sharedPreambles.empty()) {
+    return std::make_shared<TaskLambda>([]() {});
+  }
+
+  return std::make_shared<TaskLambda>([dialogView, storageProvider, sharedPreambles = std::move(sharedPreambles)]() {
+    dialogView->showUnknownProgressDialog(L"Preparing Indexing", L"Processing Shared Includes");
+
+    for(const SharedPreamble& sharedPreamble : sharedPreambles) {
+      // NOLINTNEXTLINE(bugprone-lambda-function-name): It will be solved with SOUR-125
+      LOG_INFO(L"Generating precompiled header for {} includes shared by {} source files at location \"{}\"",
+               sharedPreamble.includeDirectives.size(),
+               sharedPreamble.sourceFilePaths.size(),
+               sharedPreamble.pchFilePath.wstr());
+
+      if(!sharedPreamble.headerFilePath.getParentDirectory().exists()) {
+        FileSystem::createDirectory(sharedPreamble.headerFilePath.getParentDirectory());
+      }
+
+      {
+        std::ofstream headerFile(sharedPreamble.headerFilePath.str(), std::ios::trunc);
+        for(const std::wstring& includeDirective : sharedPreamble.includeDirectives) {
+          headerFile << utility::encodeToUtf8(includeDirective) << '\n';
+        }
+      }
+
+      // an outdated precompiled header from a previous refresh must not be used if it can't be rebuilt
+      FileSystem::remove(sharedPreamble.pchFilePath);
+
+      std::vector<std::wstring> compilerFlags = sharedPreamble.compilerFlags;
+      compilerFlags.push_back(sharedPreamble.headerFilePath.wstr());
+      compilerFlags.emplace_back(L"-emit-pch");
+      compilerFlags.emplace_back(L"-o");
+      compilerFlags.push_back(sharedPreamble.pchFilePath.wstr());
+
+      buildPch(sharedPreamble.headerFilePath,
+               sharedPreamble.pchFilePath,
+               sharedPreamble.workingDirectory,
+               compilerFlags,
+               sharedPreamble.indexedPaths,
+               sharedPreamble.excludeFilters,
+               *storageProvider);
+    }
+  });
+}
+
 std::shared_ptr<Task> createBuildPchTask(const SourceGroupSettingsWithCxxPchOptions* settings,
                                          std::vector<std::wstring> compilerFlags,
                                          const std::shared_ptr<StorageProvider>& storageProvider,
@@ -66,39 +326,13 @@ std::shared_ptr<Task> createBuildPchTask(const SourceGroupSettingsWithCxxPchOpti
              pchInputFilePath.wstr(),
              pchOutputFilePath.wstr());
 
-    CxxParser::initializeLLVM();
-
-    if(!pchOutputFilePath.getParentDirectory().exists()) {
-      FileSystem::createDirectory(pchOutputFilePath.getParentDirectory());
-    }
-
-    const std::shared_ptr<IntermediateStorage> storage = std::make_shared<IntermediateStorage>();
-    const std::shared_ptr<ParserClientImpl> client = std::make_shared<ParserClientImpl>(storage.get());
-
-    const std::shared_ptr<FileRegister> fileRegister = std::make_shared<FileRegister>(
-        pchInputFilePath, std::set<FilePath>{pchInputFilePath}, std::set<FilePathFilter>{});
-
-    const std::shared_ptr<CanonicalFilePathCache> canonicalFilePathCache = std::make_shared<CanonicalFilePathCache>(fileRegister);
-
-    clang::tooling::CompileCommand pchCommand;
-    pchCommand.Filename = utility::encodeToUtf8(pchInputFilePath.fileName());
-    pchCommand.Directory = pchOutputFilePath.getParentDirectory().str();
-    // DON'T use "-fsyntax-only" here because it will cause the output file to be erased
-    pchCommand.CommandLine = utility::concat({"clang-tool"}, CxxParser::getCommandlineArgumentsEssential(compilerFlags));
-
-    const CxxCompilationDatabaseSingle compilationDatabase(pchCommand);
-    clang::tooling::ClangTool tool(compilationDatabase, {utility::encodeToUtf8(pchInputFilePath.wstr())});
-    auto* action = new GeneratePCHAction(client, canonicalFilePathCache);    // NOLINT(cppcoreguidelines-owning-memory)
-
-    const llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> options =
-        new clang::DiagnosticOptions;    // NOLINT(cppcoreguidelines-owning-memory)
-    CxxDiagnosticConsumer diagnostics(llvm::errs(), &*options, client, canonicalFilePathCache, pchInputFilePath, true);
-
-    tool.setDiagnosticConsumer(&diagnostics);
-    tool.clearArgumentsAdjusters();
-    tool.run(new SingleFrontendActionFactory(action));    // NOLINT(cppcoreguidelines-owning-memory)
-
-    storageProvider->insert(storage);
+    buildPch(pchInputFilePath,
+             pchOutputFilePath,
+             pchOutputFilePath.getParentDirectory(),
+             compilerFlags,
+             {pchInputFilePath},
+             {},
+             *storageProvider);
   });
 }
 
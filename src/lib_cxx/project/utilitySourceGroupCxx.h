@@ -1,19 +1,54 @@
 #pragma once
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "FilePath.h"
+#include "FilePathFilter.h"
+
 namespace clang::tooling {
 class JSONCompilationDatabase;
 }    // namespace clang::tooling
 
 class DialogView;
-class FilePath;
+class IndexerCommandCxx;
 class SourceGroupSettingsWithCxxPchOptions;
 class StorageProvider;
 class Task;
 
 namespace utility {
+/**
+ * @brief Leading includes shared by translation units that are compiled with the same flags
+ *
+ * The includes are compiled once into a precompiled header that the translation units load instead of parsing them again.
+ */
+struct SharedPreamble {
+  std::vector<std::wstring> includeDirectives;
+  FilePath workingDirectory;
+  // flags of the translation units without their source and output files
+  std::vector<std::wstring> compilerFlags;
+  std::set<FilePath> indexedPaths;
+  std::set<FilePathFilter> excludeFilters;
+  std::vector<FilePath> sourceFilePaths;
+  FilePath headerFilePath;
+  FilePath pchFilePath;
+};
+
+/**
+ * @brief Groups the commands by their leading includes, flags and working directory
+ *
+ * Only includes of headers with an include guard are shared, because the translation units still include them after loading
+ * the precompiled header. Groups of less than minSourceFileCount translation units are dropped.
+ */
+std::vector<SharedPreamble> getSharedPreambles(const std::vector<std::shared_ptr<IndexerCommandCxx>>& commands,
+                                               const FilePath& outputDirectoryPath,
+                                               size_t minSourceFileCount);
+std::vector<std::wstring> getIncludeSharedPreambleFlags(const SharedPreamble& sharedPreamble);
+std::shared_ptr<Task> createBuildSharedPreamblesTask(std::vector<SharedPreamble> sharedPreambles,
+                                                     const std::shared_ptr<StorageProvider>& storageProvider,
+                                                     const std::shared_ptr<DialogView>& dialogView);
+
 std::shared_ptr<Task> createBuildPchTask(const SourceGroupSettingsWithCxxPchOptions* settings,
                                          std::vector<std::wstring> compilerFlags,
                                          const std::shared_ptr<StorageProvider>& storageProvider,
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <tuple>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "ClangInvocationCache.h"
+
+using namespace testing;
+
+namespace {
+
+std::vector<std::string> getCommandLine(const std::string& sourceFilePath, const std::string& define = "-DFOO") {
+  return {"clang-tool", "-fsyntax-only", "-std=c++17", define, sourceFilePath};
+}
+
+std::string getMainFileName(const std::vector<std::string>& frontendArguments) {
+  auto it = std::find(frontendArguments.begin(), frontendArguments.end(), "-main-file-name");
+  return it != frontendArguments.end() && std::next(it) != frontendArguments.end() ? *std::next(it) : "";
+}
+
+TEST(ClangInvocationCache, reusesDriverResultForOtherSourceFile) {
+  ClangInvocationCache cache;
+
+  const ClangInvocationInfo first = cache.getInvocationInfo(getCommandLine("/src/a.cpp"), "/src", "a.cpp");
+  const ClangInvocationInfo second = cache.getInvocationInfo(getCommandLine("/src/b.cpp"), "/src", "b.cpp");
+
+  EXPECT_EQ(1U, cache.getMissCount());
+  EXPECT_EQ(1U, cache.getHitCount());
+  ASSERT_FALSE(second.frontendArguments.empty());
+  EXPECT_THAT(first.frontendArguments, Contains("/src/a.cpp"));
+  EXPECT_THAT(second.frontendArguments, Contains("/src/b.cpp"));
+  EXPECT_THAT(second.frontendArguments, Not(Contains("/src/a.cpp")));
+  EXPECT_EQ("b.cpp", getMainFileName(second.frontendArguments));
+  EXPECT_EQ(ClangInvocationInfo::getClangInvocationInfo(getCommandLine("/src/b.cpp")).frontendArguments,
+            second.frontendArguments);
+}
+
+TEST(ClangInvocationCache, runsDriverForDifferentFlags) {
+  ClangInvocationCache cache;
+
+  std::ignore = cache.getInvocationInfo(getCommandLine("/src/a.cpp", "-DFOO"), "/src", "a.cpp");
+  std::ignore = cache.getInvocationInfo(getCommandLine("/src/b.cpp", "-DBAR"), "/src", "b.cpp");
+
+  EXPECT_EQ(2U, cache.getMissCount());
+  EXPECT_EQ(0U, cache.getHitCount());
+}
+
+TEST(ClangInvocationCache, runsDriverForDifferentExtension) {
+  ClangInvocationCache cache;
+
+  std::ignore = cache.getInvocationInfo(getCommandLine("/src/a.cpp"), "/src", "a.cpp");
+  std::ignore = cache.getInvocationInfo(getCommandLine("/src/b.c"), "/src", "b.c");
+
+  EXPECT_EQ(2U, cache.getMissCount());
+  EXPECT_EQ(0U, cache.getHitCount());
+}
+
+TEST(ClangInvocationCache, runsDriverForDifferentWorkingDirectory) {
+  ClangInvocationCache cache;
+
+  std::ignore = cache.getInvocationInfo(getCommandLine("a.cpp"), "/src/first", "a.cpp");
+  std::ignore = cache.getInvocationInfo(getCommandLine("b.cpp"), "/src/second", "b.cpp");
+
+  EXPECT_EQ(2U, cache.getMissCount());
+  EXPECT_EQ(0U, cache.getHitCount());
+}
+
+TEST(ClangInvocationCache, skipsCacheWithoutSourceFileArgument) {
+  ClangInvocationCache cache;
+
+  const ClangInvocationInfo info = cache.getInvocationInfo(getCommandLine("/src/a.cpp"), "/src", "other.cpp");
+
+  EXPECT_FALSE(info.frontendArguments.empty());
+  EXPECT_EQ(0U, cache.getMissCount());
+  EXPECT_EQ(0U, cache.getHitCount());
+}
+
+}    // namespace
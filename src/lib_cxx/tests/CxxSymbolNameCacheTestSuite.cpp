@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "CxxSymbolNameCache.h"
+
+namespace {
+
+NameHierarchy createName(const std::wstring& name) {
+  return NameHierarchy(name, NAME_DELIMITER_CXX);
+}
+
+TEST(CxxSymbolNameCache, findReturnsInsertedName) {
+  CxxSymbolNameCache cache;
+  cache.insert("c:@N@foo@S@Bar", createName(L"Bar"));
+
+  const NameHierarchy* name = cache.find("c:@N@foo@S@Bar");
+
+  ASSERT_NE(nullptr, name);
+  EXPECT_EQ(L"Bar", name->getQualifiedName());
+}
+
+TEST(CxxSymbolNameCache, countsHitsAndMisses) {
+  CxxSymbolNameCache cache;
+  EXPECT_EQ(nullptr, cache.find("c:@F@foo#"));
+  cache.insert("c:@F@foo#", createName(L"foo"));
+  EXPECT_NE(nullptr, cache.find("c:@F@foo#"));
+  EXPECT_NE(nullptr, cache.find("c:@F@foo#"));
+
+  EXPECT_EQ(2U, cache.getHitCount());
+  EXPECT_EQ(1U, cache.getMissCount());
+}
+
+TEST(CxxSymbolNameCache, clearsWhenFull) {
+  CxxSymbolNameCache cache(2);
+  cache.insert("a", createName(L"a"));
+  cache.insert("b", createName(L"b"));
+  EXPECT_EQ(2U, cache.getEntryCount());
+
+  cache.insert("c", createName(L"c"));
+
+  EXPECT_EQ(1U, cache.getEntryCount());
+  EXPECT_EQ(nullptr, cache.find("a"));
+  EXPECT_NE(nullptr, cache.find("c"));
+}
+
+}    // namespace
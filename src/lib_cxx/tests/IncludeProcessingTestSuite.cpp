@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "IApplicationSettings.hpp"
+#include "IncludeDirective.h"
+#include "IncludeProcessing.h"
+#include "MockedApplicationSetting.hpp"
+#include "TextAccess.h"
+
+using namespace testing;
+
+namespace {
+
+struct IncludeProcessingFix : Test {
+  void SetUp() override {
+    auto settings = std::make_shared<NiceMock<MockedApplicationSettings>>();
+    ON_CALL(*settings, getTextEncoding).WillByDefault(Return("UTF-8"));
+    IApplicationSettings::setInstance(settings);
+  }
+
+  void TearDown() override {
+    IApplicationSettings::setInstance(nullptr);
+  }
+};
+
+TEST_F(IncludeProcessingFix, leadingIncludeDirectivesSkipCommentsAndEmptyLines) {
+  const auto textAccess = TextAccess::createFromString(
+      "// license\n"
+      "/* multi\n"
+      "   line */\n"
+      "\n"
+      "#include <vector>\n"
+      "  #  include \"a.h\" // a\n"
+      "#include \"b.h\"\n");
+
+  const std::vector<IncludeDirective> includeDirectives = IncludeProcessing::getLeadingIncludeDirectives(textAccess);
+
+  ASSERT_EQ(3U, includeDirectives.size());
+  EXPECT_EQ(L"#include <vector>", includeDirectives[0].getDirective());
+  EXPECT_TRUE(includeDirectives[0].usesBrackets());
+  EXPECT_EQ(5U, includeDirectives[0].getLineNumber());
+  EXPECT_EQ(L"#include \"a.h\"", includeDirectives[1].getDirective());
+  EXPECT_FALSE(includeDirectives[1].usesBrackets());
+  EXPECT_EQ(L"#include \"b.h\"", includeDirectives[2].getDirective());
+}
+
+TEST_F(IncludeProcessingFix, leadingIncludeDirectivesStopAtFirstOtherLine) {
+  const auto textAccess = TextAccess::createFromString(
+      "#include <vector>\n"
+      "#define A\n"
+      "#include \"a.h\"\n");
+
+  const std::vector<IncludeDirective> includeDirectives = IncludeProcessing::getLeadingIncludeDirectives(textAccess);
+
+  ASSERT_EQ(1U, includeDirectives.size());
+  EXPECT_EQ(L"#include <vector>", includeDirectives[0].getDirective());
+}
+
+TEST_F(IncludeProcessingFix, leadingIncludeDirectivesStopAtIncludeOfMacro) {
+  const auto textAccess = TextAccess::createFromString(
+      "#include HEADER\n"
+      "#include <vector>\n");
+
+  EXPECT_THAT(IncludeProcessing::getLeadingIncludeDirectives(textAccess), IsEmpty());
+}
+
+TEST_F(IncludeProcessingFix, includeGuardIsDetected) {
+  EXPECT_TRUE(IncludeProcessing::hasIncludeGuard(TextAccess::createFromString("// a\n#pragma once\nint a;\n")));
+  EXPECT_TRUE(IncludeProcessing::hasIncludeGuard(
+      TextAccess::createFromString("/* a */\n#ifndef A_H\n#define A_H\nint a;\n#endif // A_H\n")));
+}
+
+TEST_F(IncludeProcessingFix, missingIncludeGuardIsDetected) {
+  EXPECT_FALSE(IncludeProcessing::hasIncludeGuard(TextAccess::createFromString("int a;\n")));
+  EXPECT_FALSE(IncludeProcessing::hasIncludeGuard(TextAccess::createFromString("#ifndef A_H\n#define B_H\nint a;\n#endif\n")));
+  EXPECT_FALSE(IncludeProcessing::hasIncludeGuard(TextAccess::createFromString("#ifdef A_H\n#define A_H\nint a;\n#endif\n")));
+}
+
+}    // namespace
@@ -1,9 +1,16 @@
 #include <codecvt>
+#include <filesystem>
 
 #include <boost/range/algorithm/count.hpp>
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "IApplicationSettings.hpp"
+#include "IndexerCommandCxx.h"
+#include "MockedApplicationSetting.hpp"
+#include "ScopedTemporaryFile.hpp"
+#include "utility.h"
 #include "utilitySourceGroupCxx.h"
 
 
@@ -142,4 +149,99 @@ TEST_F(WindowsFlagConverterTest, RealWorldMsvcCommand) {
   ExpectContains(args, LR"(src\core\utility\commandline\commands\commandlineCommandConfig\CommandlineCommandConfig.cpp")");
 }
 
+// ============================================================================
+// SHARED PREAMBLES
+// ============================================================================
+
+class SharedPreambleTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto settings = std::make_shared<testing::NiceMock<MockedApplicationSettings>>();
+    ON_CALL(*settings, getTextEncoding).WillByDefault(testing::Return("UTF-8"));
+    IApplicationSettings::setInstance(settings);
+
+    mDirectory = std::filesystem::temp_directory_path() / "SharedPreambleTest";
+    std::filesystem::create_directories(mDirectory);
+    mFiles.push_back(utility::ScopedTemporaryFile::createFile(mDirectory / "guarded.h", "#pragma once\nint a;\n"));
+    mFiles.push_back(utility::ScopedTemporaryFile::createFile(mDirectory / "unguarded.h", "int b;\n"));
+  }
+
+  void TearDown() override {
+    mFiles.clear();
+    std::filesystem::remove_all(mDirectory);
+    IApplicationSettings::setInstance(nullptr);
+  }
+
+  std::shared_ptr<IndexerCommandCxx> createCommand(const std::string& fileName,
+                                                   std::string_view content,
+                                                   const std::vector<std::wstring>& compilerFlags) {
+    mFiles.push_back(utility::ScopedTemporaryFile::createFile(mDirectory / fileName, content));
+    const FilePath sourceFilePath(mFiles.back()->getFilePath().wstring());
+    const std::vector<std::wstring> cdbFlags = {L"clang++", L"-c", sourceFilePath.wstr(), L"-o", L"a.o"};
+    return std::make_shared<IndexerCommandCxx>(sourceFilePath,
+                                               std::set<FilePath>{sourceFilePath},
+                                               std::set<FilePathFilter>{},
+                                               std::set<FilePathFilter>{},
+                                               FilePath(mDirectory.wstring()),
+                                               utility::concat(cdbFlags, compilerFlags));
+  }
+
+  std::filesystem::path mDirectory;
+  std::vector<utility::ScopedTemporaryFile::Ptr> mFiles;
+};
+
+TEST_F(SharedPreambleTest, SourceFilesWithSameIncludesAndFlagsAreGrouped) {
+  constexpr std::string_view Content = "#include <vector>\n#include \"guarded.h\"\nint c;\n";
+  const std::vector<std::shared_ptr<IndexerCommandCxx>> commands = {
+      createCommand("a.cpp", Content, {L"-std=c++20"}),
+      createCommand("b.cpp", Content, {L"-std=c++20"}),
+      createCommand("c.cpp", Content, {L"-std=c++17"}),
+  };
+
+  const std::vector<utility::SharedPreamble> sharedPreambles = utility::getSharedPreambles(
+      commands, FilePath(mDirectory.wstring()).getConcatenated(L"preamble"), 2);
+
+  ASSERT_EQ(1U, sharedPreambles.size());
+  const utility::SharedPreamble& sharedPreamble = sharedPreambles.front();
+  EXPECT_EQ((std::vector<std::wstring>{L"#include <vector>", L"#include \"guarded.h\""}), sharedPreamble.includeDirectives);
+  EXPECT_EQ((std::vector<FilePath>{commands[0]->getSourceFilePath(), commands[1]->getSourceFilePath()}),
+            sharedPreamble.sourceFilePaths);
+  EXPECT_EQ((std::vector<std::wstring>{L"-iquote", FilePath(mDirectory.wstring()).wstr(), L"-std=c++20", L"-x", L"c++-header"}),
+            sharedPreamble.compilerFlags);
+  EXPECT_EQ(L".h", sharedPreamble.headerFilePath.extension());
+  EXPECT_EQ(L".pch", sharedPreamble.pchFilePath.extension());
+  EXPECT_TRUE(sharedPreamble.indexedPaths.empty());
+
+  const std::vector<std::wstring> includeFlags = utility::getIncludeSharedPreambleFlags(sharedPreamble);
+  ASSERT_EQ(3U, includeFlags.size());
+  EXPECT_EQ(L"-include-pch", includeFlags[1]);
+  EXPECT_EQ(sharedPreamble.pchFilePath.wstr(), includeFlags[2]);
+}
+
+TEST_F(SharedPreambleTest, IncludesAreSharedUpToFirstUnguardedHeader) {
+  constexpr std::string_view Content = "#include <vector>\n#include \"unguarded.h\"\n#include \"guarded.h\"\n";
+  const std::vector<std::shared_ptr<IndexerCommandCxx>> commands = {
+      createCommand("a.cpp", Content, {}),
+      createCommand("b.cpp", Content, {}),
+  };
+
+  const std::vector<utility::SharedPreamble> sharedPreambles = utility::getSharedPreambles(
+      commands, FilePath(mDirectory.wstring()).getConcatenated(L"preamble"), 2);
+
+  ASSERT_EQ(1U, sharedPreambles.size());
+  EXPECT_EQ((std::vector<std::wstring>{L"#include <vector>"}), sharedPreambles.front().includeDirectives);
+  EXPECT_EQ((std::vector<std::wstring>{L"-x", L"c++-header"}), sharedPreambles.front().compilerFlags);
+}
+
+TEST_F(SharedPreambleTest, GroupsSmallerThanMinimumAreDropped) {
+  constexpr std::string_view Content = "#include <vector>\n";
+  const std::vector<std::shared_ptr<IndexerCommandCxx>> commands = {
+      createCommand("a.cpp", Content, {}),
+      createCommand("b.cpp", Content, {}),
+      createCommand("c.cpp", "int c;\n", {}),
+  };
+
+  EXPECT_TRUE(utility::getSharedPreambles(commands, FilePath(mDirectory.wstring()), 3).empty());
+}
+
 }    // namespace
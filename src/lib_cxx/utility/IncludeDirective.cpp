@@ -26,3 +26,7 @@ std::wstring IncludeDirective::getDirective() const {
 uint32_t IncludeDirective::getLineNumber() const {
   return m_lineNumber;
 }
+
+bool IncludeDirective::usesBrackets() const {
+  return m_usesBrackets;
+}
@@ -10,6 +10,7 @@ public:
   FilePath getIncludingFile() const;
   std::wstring getDirective() const;
   uint32_t getLineNumber() const;
+  bool usesBrackets() const;
 
 private:
   FilePath m_includedFilePath;
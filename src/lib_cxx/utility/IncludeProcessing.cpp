@@ -20,6 +20,61 @@ struct IncludeDirectiveComparator {
     return a.getIncludedFile() < b.getIncludedFile();
   }
 };
+
+// lineTrimmedToHash has to start with "#", the returned directive is empty if it is no include with a literal path
+IncludeDirective toIncludeDirective(const std::wstring& lineTrimmedToHash, const FilePath& filePath, uint32_t lineNumber) {
+  const std::wstring lineTrimmedToInclude = utility::trim(lineTrimmedToHash.substr(1));
+  if(utility::isPrefix<std::wstring>(L"include", lineTrimmedToInclude)) {
+    std::wstring includeString = utility::substrBetween<std::wstring>(lineTrimmedToInclude, L"<", L">");
+    bool usesBrackets = true;
+    if(includeString.empty()) {
+      includeString = utility::substrBetween<std::wstring>(lineTrimmedToInclude, L"\"", L"\"");
+      usesBrackets = false;
+    }
+
+    if(!includeString.empty()) {
+      return IncludeDirective(FilePath(includeString), filePath, lineNumber, usesBrackets);
+    }
+  }
+  return IncludeDirective(FilePath(), filePath, lineNumber, false);
+}
+
+// the code of a line without its comments, inBlockComment carries an unterminated block comment over to the next line
+std::wstring removeComments(const std::wstring& line, bool& inBlockComment) {
+  std::wstring code;
+  for(size_t i = 0; i < line.size(); i++) {
+    if(inBlockComment) {
+      if(line.compare(i, 2, L"*/") == 0) {
+        inBlockComment = false;
+        i++;
+      }
+    } else if(line.compare(i, 2, L"/*") == 0) {
+      inBlockComment = true;
+      code += L' ';
+      i++;
+    } else if(line.compare(i, 2, L"//") == 0) {
+      break;
+    } else {
+      code += line[i];
+    }
+  }
+  return utility::trim(code);
+}
+
+// the lines of a file that contain code, without comments and surrounding whitespace, paired with their line numbers
+template <typename Callback>
+void forEachCodeLine(const std::shared_ptr<TextAccess>& textAccess, Callback callback) {
+  TextCodec codec(IApplicationSettings::getInstanceRaw()->getTextEncoding());
+  bool inBlockComment = false;
+  const std::vector<std::string>& lines = textAccess->getAllLines();
+  for(unsigned i = 0; i < lines.size(); i++) {
+    const std::wstring code = removeComments(codec.decode(lines[i]), inBlockComment);
+    // lines are 1 based
+    if(!code.empty() && !callback(code, i + 1)) {
+      return;
+    }
+  }
+}
 }    // namespace
 
 std::vector<IncludeDirective> IncludeProcessing::getUnresolvedIncludeDirectives(const std::set<FilePath>& sourceFilePaths,
@@ -134,19 +189,10 @@ std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(std::share
     const std::wstring line = codec.decode(lines[i]);
     const std::wstring lineTrimmedToHash = utility::trim(line);
     if(utility::isPrefix<std::wstring>(L"#", lineTrimmedToHash)) {
-      const std::wstring lineTrimmedToInclude = utility::trim(lineTrimmedToHash.substr(1));
-      if(utility::isPrefix<std::wstring>(L"include", lineTrimmedToInclude)) {
-        std::wstring includeString = utility::substrBetween<std::wstring>(lineTrimmedToInclude, L"<", L">");
-        bool usesBrackets = true;
-        if(includeString.empty()) {
-          includeString = utility::substrBetween<std::wstring>(lineTrimmedToInclude, L"\"", L"\"");
-          usesBrackets = false;
-        }
-
-        if(!includeString.empty()) {
-          // lines are 1 based
-          includeDirectives.push_back(IncludeDirective(FilePath(includeString), textAccess->getFilePath(), i + 1, usesBrackets));
-        }
+      // lines are 1 based
+      IncludeDirective includeDirective = toIncludeDirective(lineTrimmedToHash, textAccess->getFilePath(), i + 1);
+      if(!includeDirective.getIncludedFile().empty()) {
+        includeDirectives.push_back(std::move(includeDirective));
       }
     }
   }
@@ -154,6 +200,55 @@ std::vector<IncludeDirective> IncludeProcessing::getIncludeDirectives(std::share
   return includeDirectives;
 }
 
+std::vector<IncludeDirective> IncludeProcessing::getLeadingIncludeDirectives(std::shared_ptr<TextAccess> textAccess) {
+  std::vector<IncludeDirective> includeDirectives;
+
+  forEachCodeLine(textAccess, [&](const std::wstring& code, uint32_t lineNumber) {
+    if(!utility::isPrefix<std::wstring>(L"#", code)) {
+      return false;
+    }
+
+    IncludeDirective includeDirective = toIncludeDirective(code, textAccess->getFilePath(), lineNumber);
+    if(includeDirective.getIncludedFile().empty()) {
+      return false;
+    }
+
+    includeDirectives.push_back(std::move(includeDirective));
+    return true;
+  });
+
+  return includeDirectives;
+}
+
+bool IncludeProcessing::hasIncludeGuard(std::shared_ptr<TextAccess> textAccess) {
+  std::wstring guardMacro;
+  bool hasGuard = false;
+
+  forEachCodeLine(textAccess, [&](const std::wstring& code, uint32_t /*lineNumber*/) {
+    const std::wstring spacedCode = utility::replace(utility::replace(code, L"\t", L" "), L"#", L"# ");
+    std::vector<std::wstring> words;
+    for(const std::wstring& token : utility::splitToVector(spacedCode, L' ')) {
+      if(!token.empty()) {
+        words.push_back(token);
+      }
+    }
+
+    if(guardMacro.empty()) {
+      if(words.size() == 3 && words[0] == L"#" && words[1] == L"pragma" && words[2] == L"once") {
+        hasGuard = true;
+      } else if(words.size() == 3 && words[0] == L"#" && words[1] == L"ifndef") {
+        guardMacro = words[2];
+        return true;
+      }
+    } else {
+      hasGuard = words.size() >= 3 && words[0] == L"#" && words[1] == L"define" && words[2] == guardMacro;
+    }
+    return false;
+  });
+
+  return hasGuard;
+}
+
 std::vector<IncludeDirective> IncludeProcessing::doGetUnresolvedIncludeDirectives(
     std::set<FilePath> filePathsToProcess,
     std::unordered_set<std::wstring>& processedFilePaths,
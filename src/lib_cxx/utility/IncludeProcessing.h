@@ -32,15 +32,21 @@ public:
 
   static std::vector<IncludeDirective> getIncludeDirectives(std::shared_ptr<TextAccess> textAccess);
 
+  // the include directives in front of the first other line of code, comments and empty lines are skipped
+  static std::vector<IncludeDirective> getLeadingIncludeDirectives(std::shared_ptr<TextAccess> textAccess);
+
+  // whether the file starts with "#pragma once" or an "#ifndef X" "#define X" include guard
+  static bool hasIncludeGuard(std::shared_ptr<TextAccess> textAccess);
+
+  static FilePath resolveIncludeDirective(const IncludeDirective& includeDirective,
+                                          const std::set<FilePath>& headerSearchDirectories);
+
 private:
   static std::vector<IncludeDirective> doGetUnresolvedIncludeDirectives(std::set<FilePath> filePathsToProcess,
                                                                         std::unordered_set<std::wstring>& processedFilePaths,
                                                                         const std::set<FilePath>& indexedPaths,
                                                                         const std::set<FilePath>& headerSearchDirectories);
 
-  static FilePath resolveIncludeDirective(const IncludeDirective& includeDirective,
-                                          const std::set<FilePath>& headerSearchDirectories);
-
   IncludeProcessing() = delete;
 };
 
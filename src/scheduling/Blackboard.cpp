@@ -12,12 +12,34 @@ bool Blackboard::exists(const std::string& key) {
 }
 
 bool Blackboard::clear(const std::string& key) {
-  std::lock_guard<std::mutex> lock(m_itemMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_itemMutex);
 
-  ItemMap::const_iterator it = m_items.find(key);
-  if(it != m_items.end()) {
+    ItemMap::const_iterator it = m_items.find(key);
+    if(it == m_items.end()) {
+      return false;
+    }
     m_items.erase(it);
-    return true;
+    m_changeCount++;
+  }
+  m_changeCondition.notify_all();
+  return true;
+}
+
+void Blackboard::notifyChange() {
+  {
+    std::lock_guard<std::mutex> lock(m_itemMutex);
+    m_changeCount++;
   }
-  return false;
+  m_changeCondition.notify_all();
+}
+
+size_t Blackboard::getChangeCount() {
+  std::lock_guard<std::mutex> lock(m_itemMutex);
+  return m_changeCount;
+}
+
+bool Blackboard::waitForChange(size_t changeCount, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(m_itemMutex);
+  return m_changeCondition.wait_for(lock, timeout, [this, changeCount]() { return m_changeCount != changeCount; });
 }
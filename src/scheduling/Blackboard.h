@@ -1,6 +1,8 @@
 #ifndef BLACKBOARD_H
 #define BLACKBOARD_H
 
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
@@ -42,6 +44,15 @@ public:
   bool exists(const std::string& key);
   bool clear(const std::string& key);
 
+  // wakes waiting tasks without changing a value, used when state shared outside of the blackboard changed
+  void notifyChange();
+
+  // number of changes so far, every set, successful update or clear and every notifyChange counts as one
+  size_t getChangeCount();
+
+  // blocks until the change count moved past changeCount or the timeout elapsed, returns whether it moved
+  bool waitForChange(size_t changeCount, std::chrono::milliseconds timeout);
+
 private:
   typedef std::map<std::string, std::shared_ptr<BlackboardItemBase>> ItemMap;
 
@@ -49,14 +60,21 @@ private:
 
   ItemMap m_items;
   std::mutex m_itemMutex;
+
+  size_t m_changeCount = 0;
+  std::condition_variable m_changeCondition;
 };
 
 
 template <typename T>
 void Blackboard::set(const std::string& key, const T& value) {
-  std::lock_guard<std::mutex> lock(m_itemMutex);
+  {
+    std::lock_guard<std::mutex> lock(m_itemMutex);
 
-  m_items[key] = std::make_shared<BlackboardItem<T>>(value);
+    m_items[key] = std::make_shared<BlackboardItem<T>>(value);
+    m_changeCount++;
+  }
+  m_changeCondition.notify_all();
 }
 
 template <typename T>
@@ -80,12 +98,15 @@ bool Blackboard::get(const std::string& key, T& value) {
 
 template <typename T>
 bool Blackboard::update(const std::string& key, std::function<T(const T&)> updater) {
-  std::lock_guard<std::mutex> lock(m_itemMutex);
+  std::unique_lock<std::mutex> lock(m_itemMutex);
 
   ItemMap::const_iterator it = m_items.find(key);
   if(it != m_items.end()) {
     if(std::shared_ptr<BlackboardItem<T>> item = std::dynamic_pointer_cast<BlackboardItem<T>>(it->second)) {
       item->value = updater(item->value);
+      m_changeCount++;
+      lock.unlock();
+      m_changeCondition.notify_all();
       return true;
     }
   }
@@ -1,7 +1,8 @@
 #include "TaskDecoratorRepeat.h"
 
 #include <chrono>
-#include <thread>
+
+#include "Blackboard.h"
 
 TaskDecoratorRepeat::TaskDecoratorRepeat(ConditionType condition, TaskState exitState, size_t delayMS)
     : m_condition(condition), m_exitState(exitState), m_delayMS(delayMS) {}
@@ -9,6 +10,7 @@ TaskDecoratorRepeat::TaskDecoratorRepeat(ConditionType condition, TaskState exit
 void TaskDecoratorRepeat::doEnter(std::shared_ptr<Blackboard> /*blackboard*/) {}
 
 Task::TaskState TaskDecoratorRepeat::doUpdate(std::shared_ptr<Blackboard> blackboard) {
+  const size_t changeCount = blackboard->getChangeCount();
   TaskState state = m_taskRunner->update(blackboard);
 
   switch(m_condition) {
@@ -22,7 +24,8 @@ Task::TaskState TaskDecoratorRepeat::doUpdate(std::shared_ptr<Blackboard> blackb
     break;
   }
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMS));
+  // repeat right away if anything changed since this iteration started, otherwise wait for the next change
+  blackboard->waitForChange(changeCount, std::chrono::milliseconds(m_delayMS));
 
   return state;
 }
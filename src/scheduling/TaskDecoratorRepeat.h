@@ -10,6 +10,7 @@ class TaskDecoratorRepeat : public TaskDecorator {
 public:
   enum ConditionType { CONDITION_WHILE_SUCCESS };
 
+  // delayMS is the longest time between two repetitions, a change of the blackboard repeats earlier
   TaskDecoratorRepeat(ConditionType condition, TaskState exitState, size_t delayMS);
 
 private:
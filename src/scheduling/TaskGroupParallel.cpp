@@ -5,6 +5,11 @@
 
 #include "ScopedFunctor.h"
 
+namespace {
+// upper bound for a single update, so the scheduler can still terminate the group while children are running
+constexpr auto MaxUpdateWaitTime = std::chrono::milliseconds(100);
+}    // namespace
+
 TaskGroupParallel::TaskGroupParallel() : m_needsToStartThreads(true) {}
 
 void TaskGroupParallel::addTask(std::shared_ptr<Task> task) {
@@ -25,7 +30,10 @@ void TaskGroupParallel::doEnter(std::shared_ptr<Blackboard> blackboard) {
 }
 
 Task::TaskState TaskGroupParallel::doUpdate(std::shared_ptr<Blackboard> /*blackboard*/) {
-  std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  {
+    std::unique_lock<std::mutex> lock(m_activeTaskMutex);
+    m_activeTaskCondition.wait_for(lock, MaxUpdateWaitTime, [this]() { return getActiveTaskCount() == 0; });
+  }
 
   if(m_tasks.size() != 0 && getActiveTaskCount() > 0) {
     return STATE_RUNNING;
@@ -67,7 +75,13 @@ void TaskGroupParallel::doTerminate() {
 }
 
 void TaskGroupParallel::processTaskThreaded(std::shared_ptr<TaskInfo> taskInfo, std::shared_ptr<Blackboard> blackboard) {
-  ScopedFunctor functor([&]() { m_activeTaskCount--; });
+  ScopedFunctor functor([&]() {
+    {
+      std::lock_guard<std::mutex> lock(m_activeTaskMutex);
+      m_activeTaskCount--;
+    }
+    m_activeTaskCondition.notify_all();
+  });
 
   while(true) {
     TaskState state = taskInfo->taskRunner->update(blackboard);
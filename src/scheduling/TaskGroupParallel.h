@@ -1,7 +1,9 @@
 #pragma once
 // STL
 #include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <thread>
 // internal
 #include "TaskGroup.h"
@@ -35,4 +37,8 @@ private:
 
   volatile bool m_taskFailed;
   std::atomic<int> m_activeTaskCount;
+
+  // signaled whenever a child task finished
+  std::mutex m_activeTaskMutex;
+  std::condition_variable m_activeTaskCondition;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -39,4 +40,8 @@ private:
   mutable std::mutex m_tasksMutex;
   mutable std::mutex m_loopMutex;
   mutable std::mutex m_threadMutex;
+
+  // the idle loop waits for new tasks or a stop request, stopSchedulerLoop waits for the loop thread to finish
+  std::condition_variable m_tasksCondition;
+  std::condition_variable m_threadCondition;
 };
\ No newline at end of file
@@ -5,8 +5,11 @@
 
 #include "../Blackboard.h"
 #include "../Task.h"
+#include "../TaskDecoratorRepeat.h"
+#include "../TaskGroupParallel.h"
 #include "../TaskGroupSelector.h"
 #include "../TaskGroupSequence.h"
+#include "../TaskReturnSuccessIf.h"
 #include "../TaskScheduler.h"
 
 namespace {
@@ -247,4 +250,63 @@ TEST(TaskScheduler, taskSchedulingWithinTaskProcessing) {
   EXPECT_TRUE(4 == task->subTask->enterCallOrder);
   EXPECT_TRUE(5 == task->subTask->updateCallOrder);
   EXPECT_TRUE(6 == task->subTask->exitCallOrder);
-}
\ No newline at end of file
+}
+
+TEST(TaskScheduler, blackboardWaitForChangeTimesOutWithoutChange) {
+  Blackboard blackboard;
+  blackboard.set<bool>("flag", false);
+
+  EXPECT_FALSE(blackboard.waitForChange(blackboard.getChangeCount(), std::chrono::milliseconds(1)));
+}
+
+TEST(TaskScheduler, blackboardWaitForChangeReturnsForEarlierChange) {
+  Blackboard blackboard;
+  const size_t changeCount = blackboard.getChangeCount();
+  blackboard.set<bool>("flag", false);
+
+  // the change happened before waiting, so the wait must not block
+  EXPECT_TRUE(blackboard.waitForChange(changeCount, std::chrono::hours(1)));
+}
+
+TEST(TaskScheduler, repeatDecoratorWakesUpOnBlackboardChange) {
+  using namespace std::chrono_literals;
+
+  std::shared_ptr<Blackboard> blackboard = std::make_shared<Blackboard>();
+  blackboard->set<bool>("flag", false);
+
+  // repeats as long as the flag is false, with a delay that would exceed the test timeout
+  std::shared_ptr<TaskDecorator> task =
+      std::make_shared<TaskDecoratorRepeat>(TaskDecoratorRepeat::CONDITION_WHILE_SUCCESS, Task::STATE_SUCCESS, 600000)
+          ->addChildTask(
+              std::make_shared<TaskReturnSuccessIf<bool>>("flag", TaskReturnSuccessIf<bool>::CONDITION_EQUALS, false));
+
+  std::thread setter([blackboard]() {
+    std::this_thread::sleep_for(20ms);
+    blackboard->set<bool>("flag", true);
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  Task::TaskState state = Task::STATE_RUNNING;
+  while(state == Task::STATE_RUNNING) {
+    state = task->update(blackboard);
+  }
+  const auto duration = std::chrono::steady_clock::now() - start;
+  setter.join();
+
+  EXPECT_EQ(Task::STATE_SUCCESS, state);
+  EXPECT_LT(duration, 10s);
+}
+
+TEST(TaskScheduler, parallelTaskGroupFinishesWhenChildrenFinish) {
+  int order = 0;
+  std::shared_ptr<TaskGroupParallel> group = std::make_shared<TaskGroupParallel>();
+  group->addTask(std::make_shared<TestTask>(&order, 1));
+
+  std::shared_ptr<Blackboard> blackboard = std::make_shared<Blackboard>();
+  Task::TaskState state = Task::STATE_RUNNING;
+  while(state == Task::STATE_RUNNING) {
+    state = group->update(blackboard);
+  }
+
+  EXPECT_EQ(Task::STATE_SUCCESS, state);
+}